@@ -0,0 +1,103 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CAPTURETHREADPOOL__H__
+#define __SGCT__CAPTURETHREADPOOL__H__
+
+#include <sgct/framesignal.h>
+#include <sgct/settings.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+class Image;
+
+/**
+ * A pool of persistent worker threads that encode and save the screenshots of all
+ * windows. The render thread hands off an image by pushing a Job into a bounded
+ * lock-free queue, from which the workers take the jobs in the order they were added.
+ * What happens when the queue is full is determined by the policy: the render thread
+ * can wait for a free slot, the oldest job in the queue can be discarded, or the new
+ * job can be discarded.
+ *
+ * Once a job has been handled, regardless of whether it was saved or dropped, its
+ * completion callback is called with the image so that the owner can reuse it for the
+ * next screenshot. The callback is called from a worker thread or, for dropped jobs,
+ * from the thread that has pushed the job.
+ */
+class CaptureThreadPool {
+public:
+    using Policy = Settings::CaptureQueuePolicy;
+
+    struct Job {
+        std::unique_ptr<Image> image;
+        std::string filename;
+        /// If set, this is called with the image instead of saving it to the filename
+        std::function<void(const Image&)> write;
+        std::function<void(std::unique_ptr<Image>)> completion;
+    };
+
+    /// Creates the pool on first use with the values currently stored in the Settings
+    static CaptureThreadPool& instance();
+    static void destroy();
+
+    /**
+     * Adds the \p job to the queue. If the queue is full, the behavior depends on the
+     * policy, in which case this function either blocks until a worker has taken a job,
+     * discards the oldest job in the queue, or discards the \p job.
+     *
+     * \return true if the job was added to the queue, false if it was dropped
+     */
+    bool push(Job job);
+
+    /// \return the number of worker threads
+    int numberOfThreads() const;
+
+    /// \return the maximum number of jobs that can wait in the queue
+    int queueSize() const;
+
+private:
+    CaptureThreadPool(int nThreads, int queueSize, Policy policy, bool fastEncoding);
+    ~CaptureThreadPool();
+
+    bool tryPush(Job& job);
+    bool tryPop(Job& job);
+    void worker();
+    static void complete(Job& job);
+
+    static CaptureThreadPool* _instance;
+
+    struct Cell {
+        std::atomic_size_t sequence;
+        Job job;
+    };
+    std::unique_ptr<Cell[]> _cells;
+    const size_t _mask;
+
+    // Producers and consumers each touch only their own position, so they live on
+    // separate cache lines
+    alignas(64) std::atomic_size_t _enqueuePosition = 0;
+    alignas(64) std::atomic_size_t _dequeuePosition = 0;
+
+    const Policy _policy;
+    const bool _useFastEncoding;
+    std::atomic_bool _isRunning = true;
+    FrameSignal _jobAdded;
+    FrameSignal _jobRemoved;
+    std::vector<std::thread> _workers;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CAPTURETHREADPOOL__H__
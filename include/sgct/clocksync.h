@@ -0,0 +1,97 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CLOCKSYNC__H__
+#define __SGCT__CLOCKSYNC__H__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace sgct {
+
+/**
+ * The points in time of a single frame on one node in seconds of the cluster timebase,
+ * which is the clock of the master. Stages that do not happen on a node are left at 0;
+ * the master encodes and sends, the clients receive and decode the sync data.
+ */
+struct FrameTimestamps {
+    static constexpr const int SerializedSize = sizeof(int32_t) + 8 * sizeof(double);
+
+    int32_t frame = -1;
+    double encode = 0.0;
+    /// The sync data was written to the sockets of all clients; 0 if it was still being
+    /// sent when the frame was finished, which can happen with pipelined sync
+    double send = 0.0;
+    double receive = 0.0;
+    double decode = 0.0;
+    double draw = 0.0;
+    /// The client sent or the master received all acknowledgements for the frame
+    double ack = 0.0;
+    /// The offset of the local clock to the cluster timebase when the frame was drawn
+    double clockOffset = 0.0;
+    /// The round trip time of the clock synchronization when the frame was drawn
+    double roundTripTime = 0.0;
+
+    /// Writes the timestamps into \p buffer, which needs to hold SerializedSize bytes
+    void serialize(char* buffer) const;
+
+    /// Reads the timestamps from \p buffer, which needs to hold SerializedSize bytes
+    static FrameTimestamps deserialize(const char* buffer);
+};
+
+/**
+ * Estimates the offset between the clock of a client and the clock of the master in the
+ * same way as NTP. The client stores its time t0 in a request, the master answers with
+ * the time t1 at which the request arrived and the time t2 at which the answer was sent,
+ * and the client notes the time t3 at which the answer arrives. Then
+ *     offset = ((t1 - t0) + (t2 - t3)) / 2
+ *     roundTripTime = (t3 - t0) - (t2 - t1)
+ * The error of the offset is at most half of the round trip time, so out of the latest
+ * exchanges the one with the shortest round trip time is used.
+ */
+class ClockSync {
+public:
+    static constexpr const int NumberOfSamples = 8;
+
+    /// Adds the result of one exchange, all times are in seconds
+    void addSample(double t0, double t1, double t2, double t3);
+
+    /// \return true if at least one exchange has completed
+    bool hasEstimate() const;
+
+    /// \return the time in seconds that has to be added to the local clock to get the
+    ///         time of the master
+    double offset() const;
+
+    /// \return the round trip time in seconds of the exchange the offset is based on
+    double roundTripTime() const;
+
+    /// Discards all exchanges, for example after a reconnect
+    void reset();
+
+private:
+    struct Sample {
+        double offset = 0.0;
+        double roundTripTime = 0.0;
+    };
+
+    std::mutex _mutex;
+    std::array<Sample, NumberOfSamples> _samples;
+    int _nSamples = 0;
+    int _nextSample = 0;
+
+    std::atomic_bool _hasEstimate = false;
+    std::atomic<double> _offset = 0.0;
+    std::atomic<double> _roundTripTime = 0.0;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__CLOCKSYNC__H__
@@ -10,7 +10,9 @@
 #define __SGCT__CLUSTERMANAGER__H__
 
 #include <sgct/math.h>
+#include <sgct/multicast.h>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -21,6 +23,7 @@ namespace sgct {
 
 class Node;
 class User;
+enum class NetworkCompression;
 
 /**
  * The ClusterManager manages all nodes and cluster settings. This class is a static
@@ -108,6 +111,61 @@ public:
     /// \param the state of the firm frame lock sync
     void setFirmFrameLockSyncStatus(bool state);
 
+    /// \return whether shared data is synchronized as the difference to the last frame
+    bool useDeltaSync() const;
+
+    /// \param whether shared data should be synchronized as the difference to the last
+    ///        frame rather than the full data block
+    void setUseDeltaSync(bool state);
+
+    /// \return the number of frames after which a full data block is sent in delta sync
+    int deltaSyncKeyframeInterval() const;
+
+    /// \param the number of frames after which a full data block is sent in delta sync
+    void setDeltaSyncKeyframeInterval(int interval);
+
+    /// \return the compression used for sync and data transfer messages
+    NetworkCompression compression() const;
+
+    /// \param the compression used for sync and data transfer messages
+    void setCompression(NetworkCompression compression);
+
+    /// \return the minimum payload size in bytes for which messages are compressed
+    int compressionThreshold() const;
+
+    /// \param the minimum payload size in bytes for which messages are compressed
+    void setCompressionThreshold(int threshold);
+
+    /// \return whether all connections are serviced by a single NetworkReactor thread
+    bool useNetworkReactor() const;
+
+    /// \param whether all connections should be serviced by a single thread
+    void setUseNetworkReactor(bool state);
+
+    /// \return the time in microseconds the frame lock busy-waits before blocking
+    int frameLockSpinTime() const;
+
+    /// \param the time in microseconds the frame lock busy-waits before blocking
+    void setFrameLockSpinTime(int microseconds);
+
+    /// \return whether the sync data of the next frame is sent while rendering
+    bool pipelinedSync() const;
+
+    /// \param whether the sync data of the next frame is sent while rendering
+    void setPipelinedSync(bool state);
+
+    /// \return whether the clients report the timestamps of each frame to the master
+    bool sendFrameTimestamps() const;
+
+    /// \param whether the clients report the timestamps of each frame to the master
+    void setSendFrameTimestamps(bool state);
+
+    /// \return the multicast group used to send the sync data, if one was configured
+    const std::optional<MulticastGroup>& multicastGroup() const;
+
+    /// \param the multicast group used to send the sync data, or nullopt to use TCP
+    void setMulticastGroup(std::optional<MulticastGroup> group);
+
     /// \return the external control port number
     int externalControlPort() const;
 
@@ -129,6 +187,15 @@ private:
     const int _thisNodeId;
     bool _firmFrameLockSync = false;
     bool _ignoreSync = false;
+    bool _useDeltaSync = false;
+    int _deltaSyncKeyframeInterval = 60;
+    NetworkCompression _compression;
+    int _compressionThreshold = 1024;
+    bool _useNetworkReactor = false;
+    int _frameLockSpinTime = 0;
+    bool _pipelinedSync = false;
+    bool _sendFrameTimestamps = false;
+    std::optional<MulticastGroup> _multicastGroup;
     std::string _masterAddress;
     int _externalControlPort = 0;
 
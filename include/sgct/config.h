@@ -34,7 +34,8 @@ void validateUser(const User& user);
 
 
 struct Capture {
-    enum class Format { PNG, JPG, TGA };
+    enum class Format { PNG, JPG, TGA, EXR, RAW };
+    enum class QueuePolicy { Block, DropOldest, DropNewest };
     struct ScreenShotRange {
         int first = -1; // inclusive
         int last = -1;  // exclusive
@@ -43,6 +44,9 @@ struct Capture {
     std::optional<std::string> path;
     std::optional<Format> format;
     std::optional<ScreenShotRange> range;
+    std::optional<int> queueSize;
+    std::optional<QueuePolicy> queuePolicy;
+    std::optional<bool> fastEncoding;
 };
 void validateCapture(const Capture& capture);
 
@@ -70,6 +74,11 @@ struct Settings {
     std::optional<bool> usePositionTexture;
     std::optional<BufferFloatPrecision> bufferFloatPrecision;
     std::optional<Display> display;
+    std::optional<std::string> textureCachePath;
+    std::optional<int> textureUploadBudget;
+    std::optional<std::string> frameTracePath;
+    std::optional<std::string> meshCachePath;
+    std::optional<float> meshSimplificationError;
 };
 void validateSettings(const Settings& settings);
 
@@ -95,6 +104,9 @@ struct Device {
     std::vector<Axes> axes;
     std::optional<vec3> offset;
     std::optional<mat4> transformation;
+    /// If set, the pose of the device is extrapolated to the time at which a frame is
+    /// displayed, plus this additional latency of the display system in seconds
+    std::optional<double> predictionLatency;
 };
 void validateDevice(const Device& device);
 
@@ -326,6 +338,7 @@ struct Window {
     std::optional<int> blitWindowId;
     std::optional<int> monitor;
     std::optional<std::string> mpcdi;
+    std::optional<std::string> mpcdiBuffer;
     std::optional<StereoMode> stereo;
     std::optional<ivec2> pos;
     ivec2 size = ivec2{ 1, 1 };
@@ -348,7 +361,17 @@ void validateNode(const Node& node);
 
 
 
+struct Multicast {
+    std::string address;
+    int port = 0;
+    std::optional<int> ttl;
+    std::optional<std::string> interfaceAddress;
+};
+void validateMulticast(const Multicast& multicast);
+
 struct Cluster {
+    enum class Compression { None, Fast, High };
+
     bool success = false;
 
     std::string masterAddress;
@@ -356,6 +379,15 @@ struct Cluster {
     std::optional<int> setThreadAffinity;
     std::optional<int> externalControlPort;
     std::optional<bool> firmSync;
+    std::optional<bool> deltaSync;
+    std::optional<int> deltaSyncKeyframeInterval;
+    std::optional<Compression> compression;
+    std::optional<int> compressionThreshold;
+    std::optional<bool> networkReactor;
+    std::optional<int> frameLockSpinTime;
+    std::optional<bool> pipelinedSync;
+    std::optional<bool> frameTimestamps;
+    std::optional<Multicast> multicast;
     std::optional<Scene> scene;
     std::vector<Node> nodes;
     std::vector<User> users;
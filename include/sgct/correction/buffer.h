@@ -9,6 +9,8 @@
 #ifndef __SGCT__BUFFER__H__
 #define __SGCT__BUFFER__H__
 
+#include <sgct/math.h>
+#include <optional>
 #include <vector>
 
 namespace sgct::correction {
@@ -25,9 +27,24 @@ struct CorrectionMeshVertex {
 };
 
 struct Buffer {
+    /// Field of view of the viewport in degrees that is stored in some mesh formats
+    struct ViewPlane {
+        float up = 0.f;
+        float down = 0.f;
+        float left = 0.f;
+        float right = 0.f;
+        quat orientation = quat{ 0.f, 0.f, 0.f, 1.f };
+    };
+
     std::vector<CorrectionMeshVertex> vertices;
     std::vector<unsigned int> indices;
     unsigned int geometryType = 0x0004; // = GL_TRIANGLES
+
+    // Changes to the viewport that the mesh is loaded for, which are applied after the
+    // mesh has been loaded
+    std::optional<vec3> userPosition;
+    std::optional<ViewPlane> viewPlane;
+    std::optional<vec3> projectionPlaneOffset;
 };
 
 } // namespace sgct::correction
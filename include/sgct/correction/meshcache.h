@@ -0,0 +1,53 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CORRECTION_MESHCACHE__H__
+#define __SGCT__CORRECTION_MESHCACHE__H__
+
+#include <sgct/correction/buffer.h>
+#include <sgct/math.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/**
+ * Generated warping meshes are cached as a raw dump of their vertex and index buffers.
+ * Each cache file starts with a header, followed by the key that the mesh was generated
+ * for and the buffers. A file is only used if its key matches the key of the requested
+ * mesh exactly, so a changed source file or viewport leads to a new cache entry.
+ */
+namespace sgct::correction {
+
+/**
+ * \return a description of everything that the generated mesh depends on, which is the
+ *         source file, the viewport that the mesh is loaded for, and the optimization of
+ *         the mesh, or an empty string if the source file can't be inspected
+ */
+std::string meshCacheKey(const std::string& path, const vec2& pos, const vec2& size,
+    float aspectRatio, std::optional<float> maxError);
+
+/// \return the name of the cache file for the \p key
+std::string meshCacheName(const std::string& key);
+
+/**
+ * \return the mesh that is stored in the cache file \p path or std::nullopt if the file
+ *         does not exist, is damaged, or was written for a different \p key
+ */
+std::optional<Buffer> readMeshCache(const std::filesystem::path& path,
+    const std::string& key);
+
+/**
+ * Stores the \p buffer for the \p key in the cache file \p path. Failures are logged as
+ * warnings, as the mesh can always be generated again
+ */
+void writeMeshCache(const std::filesystem::path& path, const std::string& key,
+    const Buffer& buffer);
+
+} // namespace sgct::correction
+
+#endif // __SGCT__CORRECTION_MESHCACHE__H__
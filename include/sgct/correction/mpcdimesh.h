@@ -10,9 +10,24 @@
 #define __SGCT__CORRECTION_MPCDIMESH__H__
 
 #include <sgct/correction/buffer.h>
+#include <functional>
+#include <vector>
 
 namespace sgct::correction {
 
+/**
+ * Reads up to \p size bytes of the PFM file into \p dst and returns the number of bytes
+ * that were read. Fewer bytes than requested are only returned at the end of the file.
+ */
+using ReadFunction = std::function<size_t(char* dst, size_t size)>;
+
+/**
+ * Generates the warping mesh of an MPCDI region while its PFM file is read row by row
+ * with \p read, so that the file never has to be kept in memory as a whole.
+ */
+Buffer generateMpcdiMesh(const ReadFunction& read);
+
+/// Generates the warping mesh of an MPCDI region from a PFM file that is in memory
 Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh);
 
 } // namespace sgct::correction
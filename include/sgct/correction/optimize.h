@@ -0,0 +1,51 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CORRECTION_OPTIMIZE__H__
+#define __SGCT__CORRECTION_OPTIMIZE__H__
+
+#include <sgct/correction/buffer.h>
+
+namespace sgct::correction {
+
+/**
+ * Converts a triangle strip into a list of triangles with the same winding. Degenerate
+ * triangles, which strips use to jump between rows, are removed. Buffers that already
+ * contain a triangle list are not changed.
+ */
+void convertToTriangleList(Buffer& buffer);
+
+/// Merges all vertices that are bit-identical and updates the indices accordingly
+void mergeVertices(Buffer& buffer);
+
+/**
+ * Removes vertices from the triangle list in \p buffer for as long as none of the removed
+ * vertices is farther than \p maxError away from the simplified mesh and none of their
+ * texture coordinates and colors differ by more than \p maxError from the values that
+ * the simplified mesh interpolates at their position. Flat regions of a warping mesh
+ * therefore collapse into a few large triangles. The outline of the mesh only shrinks
+ * within the same error bound and no triangle is ever flipped.
+ */
+void simplifyMesh(Buffer& buffer, float maxError);
+
+/**
+ * Reorders the triangles in \p buffer so that the GPU can reuse as many transformed
+ * vertices from its post-transform cache as possible and then orders the vertices by
+ * their first use. Vertices that are not used by any triangle are removed.
+ */
+void optimizeVertexCache(Buffer& buffer);
+
+/**
+ * Runs all of the steps above to prepare a loaded warping mesh for rendering. The result
+ * is always a triangle list. If \p maxError is 0, the mesh is only reordered.
+ */
+void optimizeMesh(Buffer& buffer, float maxError);
+
+} // namespace sgct::correction
+
+#endif // __SGCT__CORRECTION_OPTIMIZE__H__
@@ -17,7 +17,7 @@ namespace sgct { class BaseViewport; }
 
 namespace sgct::correction {
 
-Buffer generateScalableMesh(const std::string& path, BaseViewport& parent);
+Buffer generateScalableMesh(const std::string& path, const BaseViewport& parent);
 
 } // namespace sgct::correction
 
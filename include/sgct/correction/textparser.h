@@ -0,0 +1,99 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__CORRECTION_TEXTPARSER__H__
+#define __SGCT__CORRECTION_TEXTPARSER__H__
+
+#include <string>
+#include <string_view>
+
+namespace sgct::correction {
+
+/**
+ * A text file that is memory-mapped and read line by line. None of the lines are copied,
+ * they are views into the mapping and only valid while the TextFile exists.
+ */
+class TextFile {
+public:
+    /// Opens the file at \p path. Check isOpen to see whether that was successful
+    explicit TextFile(const std::string& path);
+    ~TextFile();
+
+    TextFile(const TextFile&) = delete;
+    TextFile& operator=(const TextFile&) = delete;
+
+    bool isOpen() const;
+
+    /// The entire contents of the file
+    std::string_view contents() const;
+
+    /**
+     * Advances to the next line and stores it without the line break in \p line.
+     *
+     * \return false if the end of the file has been reached
+     */
+    bool nextLine(std::string_view& line);
+
+    /// The 1-based number of the line that was last returned by nextLine
+    int lineNumber() const;
+
+private:
+    bool _isOpen = false;
+    void* _base = nullptr;
+#ifdef WIN32
+    void* _handle = nullptr;
+    void* _mapping = nullptr;
+#else // WIN32
+    int _handle = -1;
+#endif // WIN32
+    std::string_view _contents;
+    size_t _position = 0;
+    int _lineNumber = 0;
+};
+
+/**
+ * Extracts tokens and numbers from a piece of text without allocating any memory. The
+ * numbers are parsed independent of the current locale and a parsed floating point value
+ * is bit-identical to the result of std::strtof for the same characters.
+ */
+class Scanner {
+public:
+    explicit Scanner(std::string_view text);
+
+    /// \return the next token that is delimited by whitespace or an empty string if there
+    ///         are no tokens left
+    std::string_view token();
+
+    /// Parses the next number, which can be preceded by whitespace and a '+' sign. If
+    /// the text does not start with a number, false is returned and nothing but the
+    /// whitespace is consumed
+    bool number(float& value);
+    bool number(int& value);
+    bool number(unsigned int& value);
+
+    /// Consumes \p c if it is the next character and returns whether it was consumed
+    bool character(char c);
+
+    /// Consumes \p prefix if the text starts with it and returns whether it was consumed
+    bool literal(std::string_view prefix);
+
+    /// \return the remaining text without leading whitespace
+    std::string_view rest();
+
+    /// \return true if only whitespace is left
+    bool isEmpty();
+
+private:
+    void skipWhitespace();
+
+    std::string_view _text;
+};
+
+} // namespace sgct::correction
+
+#endif // __SGCT__CORRECTION_TEXTPARSER__H__
@@ -9,6 +9,9 @@
 #ifndef __SGCT__CORRECTION_MESH__H__
 #define __SGCT__CORRECTION_MESH__H__
 
+#include <sgct/correction/buffer.h>
+#include <future>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -16,8 +19,6 @@ namespace sgct {
 
 class BaseViewport;
 
-namespace correction { struct Buffer; }
-
 /**
  * Helper class for reading and rendering a correction mesh. A correction mesh is used for
  * warping and edge-blending.
@@ -25,7 +26,39 @@ namespace correction { struct Buffer; }
 class CorrectionMesh {
 public:
     /**
-     * This function finds a suitable parser for warping meshes and loads them.
+     * Starts reading the warping mesh and generating all other meshes on one of the
+     * ImageLoader threads. This does not require an OpenGL context and does not change
+     * \p parent, so the meshes of all viewports can be prepared at the same time. A later
+     * call to loadMesh with the same \p path waits for the result and only uploads the
+     * meshes.
+     *
+     * \param path the path to the mesh data
+     * \param parent the viewport that the meshes are generated for. It has to stay alive
+     *        until loadMesh is called
+     * \param needsMaskGeometry If true, a separate geometry to applying blend masks is
+     *        generated
+     */
+    void prepareMesh(std::string path, const BaseViewport& parent,
+        bool needsMaskGeometry = false);
+
+    /**
+     * Starts generating all meshes from the warping mesh \p warp that has already been
+     * read, for example as part of an MPCDI file, instead of reading it from \p path. The
+     * mesh is moved into the generated meshes, so no copy of it is kept.
+     *
+     * \param path the name of the mesh that is passed to loadMesh
+     * \param warp the warping mesh
+     * \param parent the viewport that the meshes are generated for. It has to stay alive
+     *        until loadMesh is called
+     * \param needsMaskGeometry If true, a separate geometry to applying blend masks is
+     *        generated
+     */
+    void prepareMesh(std::string path, correction::Buffer warp,
+        const BaseViewport& parent, bool needsMaskGeometry = false);
+
+    /**
+     * This function finds a suitable parser for warping meshes and loads them. If the
+     * meshes were started with prepareMesh, this function waits for them instead.
      *
      * \param path the path to the mesh data
      * \param parent the pointer to parent viewport
@@ -55,13 +88,27 @@ private:
         unsigned int nVertices = 0;
         unsigned int nIndices = 0;
         unsigned int type = 0x0005; // = GL_TRIANGLE_STRIP;
+        unsigned int indexType = 0x1405; // = GL_UNSIGNED_INT
     };
 
+    /// All meshes of a viewport before they are uploaded
+    struct Buffers {
+        correction::Buffer quad;
+        correction::Buffer warp;
+        std::optional<correction::Buffer> mask;
+    };
+
+    static Buffers generateBuffers(const std::string& path, const BaseViewport& parent,
+        bool needsMaskGeometry, std::optional<correction::Buffer> warp);
+
     void createMesh(CorrectionMeshGeometry& geom, const correction::Buffer& buffer);
 
     CorrectionMeshGeometry _quadGeometry;
     CorrectionMeshGeometry _warpGeometry;
     CorrectionMeshGeometry _maskGeometry;
+
+    std::string _preparedPath;
+    std::future<Buffers> _preparedBuffers;
 };
 
 } // namespace sgct
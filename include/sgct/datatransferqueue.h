@@ -0,0 +1,93 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__DATATRANSFERQUEUE__H__
+#define __SGCT__DATATRANSFERQUEUE__H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+class Network;
+
+/**
+ * Sends data transfer packages in the background. Every connection has its own sender
+ * thread, so all nodes receive a package at the same time and a slow node only holds
+ * back its own transfers, as its thread is blocked by the flow control of its socket.
+ * The packages are split into chunks, and the chunks of all packages that are queued for
+ * a connection are sent in turn, so a small package does not have to wait for a large
+ * one to finish. The data of a package is shared between all connections and each chunk
+ * is compressed at most once per codec.
+ */
+class DataTransferQueue {
+public:
+    /// The maximum number of bytes of a package that are sent in a single message
+    static constexpr const int ChunkSize = 1024 * 1024;
+
+    /**
+     * The \p progress function is called on the sender threads whenever a chunk has been
+     * sent with the package id, the id of the connection, and the fraction of the
+     * package that has been sent to that connection.
+     */
+    explicit DataTransferQueue(std::function<void(int, int, float)> progress);
+    ~DataTransferQueue();
+
+    /**
+     * Queues the \p data to be sent as the package \p packageId to all \p connections
+     * and returns immediately. The package ids of all packages that are in flight at the
+     * same time have to be unique.
+     */
+    void push(std::shared_ptr<const std::vector<char>> data, int packageId,
+        const std::vector<Network*>& connections);
+
+    /// \return the number of package transfers that have not been sent completely, each
+    ///         package is counted once per connection it is sent to
+    int nPendingTransfers() const;
+
+    /**
+     * Blocks until all queued packages have been sent. Transfers to a connection that
+     * fails or is closed are dropped, so they do not hold up this function
+     */
+    void waitUntilEmpty();
+
+private:
+    struct Package;
+    struct Transfer {
+        std::shared_ptr<Package> package;
+        int nextChunk = 0;
+    };
+    struct Worker {
+        Network* connection = nullptr;
+        std::deque<Transfer> transfers;
+        std::thread thread;
+    };
+
+    void sendLoop(Worker& worker);
+    /// Sends the next chunk of the \p transfer and throws if the connection fails
+    void sendChunk(Network& connection, Transfer& transfer);
+    Worker& worker(Network& connection);
+
+    std::function<void(int, int, float)> _progress;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+    std::condition_variable _emptyCond;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    int _nPendingTransfers = 0;
+    bool _shouldTerminate = false;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__DATATRANSFERQUEUE__H__
@@ -11,7 +11,9 @@
 
 #include <sgct/actions.h>
 #include <sgct/callbackdata.h>
+#include <sgct/clocksync.h>
 #include <sgct/config.h>
+#include <sgct/frametrace.h>
 #include <sgct/frustum.h>
 #include <sgct/joystick.h>
 #include <sgct/keys.h>
@@ -19,9 +21,11 @@
 #include <sgct/mouse.h>
 #include <sgct/window.h>
 #include <array>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <thread>
+#include <vector>
 
 namespace sgct {
 
@@ -39,15 +43,66 @@ config::Cluster loadCluster(std::optional<std::string> path);
 class Engine {
 public:
     // Structure with all statistics gathered over the frame. The newest value is always
-    // at the front of the array
+    // at index 0 of each history
     struct Statistics {
         static inline const int HistoryLength = 128;
 
-        std::array<double, HistoryLength> frametimes = {};
-        std::array<double, HistoryLength> drawTimes = {};
-        std::array<double, HistoryLength> syncTimes = {};
-        std::array<double, HistoryLength> loopTimeMin = {};
-        std::array<double, HistoryLength> loopTimeMax = {};
+        /// The latest HistoryLength values of a statistic. Adding a value overwrites the
+        /// oldest one, so no values have to be moved
+        class History {
+        public:
+            void add(double value);
+
+            /// \return the value that was added \p i values ago
+            double operator[](size_t i) const;
+
+            /// \return the newest value
+            double front() const;
+
+            // Iterates over the values in the order in which they are stored, which is
+            // not the order in which they were added
+            std::array<double, HistoryLength>::const_iterator begin() const;
+            std::array<double, HistoryLength>::const_iterator end() const;
+
+        private:
+            std::array<double, HistoryLength> _values = {};
+            size_t _newest = 0;
+        };
+
+        History frametimes;
+        History drawTimes;
+        History syncTimes;
+        History loopTimeMin;
+        History loopTimeMax;
+
+        /// The time it took to send the sync data to each client, indexed by the sync
+        /// connection. As the sending happens in the background, the latest value
+        /// belongs to the frame before the current one
+        std::vector<History> sendLatencies;
+
+        /// Histogram of the time that was spent waiting for the frame lock. Bucket 0
+        /// counts the waits that took less than 1 microsecond, bucket i the waits that
+        /// took less than 2^i and at least 2^(i-1) microseconds, and the last bucket
+        /// collects all waits that took longer than that
+        struct WaitHistogram {
+            static constexpr int NumberOfBuckets = 24;
+
+            std::array<uint64_t, NumberOfBuckets> buckets = {};
+
+            /// Adds a wait that took \p seconds to the histogram
+            void add(double seconds);
+
+            /// \return the number of waits that were added to the histogram
+            uint64_t count() const;
+
+            /// \return the exclusive upper limit of the bucket \p index in seconds
+            static double bucketLimit(int index);
+        };
+
+        /// The time the clients waited for the sync data of the master before a frame or
+        /// that the master waited for the clients to finish rendering after a frame. One
+        /// value is added per frame
+        WaitHistogram frameLockWaits;
 
         /// \return the frame time (delta time) in seconds
         double dt() const;
@@ -97,6 +152,11 @@ public:
         /// connected nodes in a clustered setup.
         std::function<std::vector<std::byte>()> encode;
 
+        /// Alternative to encode that serializes the shared data into a buffer that is
+        /// owned by SGCT and reused between frames. The buffer is empty when this
+        /// function is called. If this function is set, encode is not called.
+        std::function<void(std::vector<std::byte>&)> encodeToBuffer;
+
         /// This function is called by decode all shared data sent to us from the master
         /// The first parameter is the block of data that contains the data to be decoded,
         /// the second parameter is the position in the data at which to start the
@@ -118,6 +178,12 @@ public:
         /// This function is called when data is successfully sent
         std::function<void(int, int)> dataTransferAcknowledge;
 
+        /// This function is called on a background thread whenever a chunk of a package
+        /// that was sent with NetworkManager::transferDataAsync has been sent to a node.
+        /// The parameters are the package id, the connection id, and the fraction of
+        /// the package that has been sent to that node
+        std::function<void(int, int, float)> dataTransferProgress;
+
         /// This function sets the keyboard callback (GLFW wrapper) for all windows
         std::function<void(Key, Modifier, Action, int)> keyboard;
 
@@ -156,6 +222,20 @@ public:
     /// Returns the statistic object containing all information about the frametimes, etc
     const Statistics& statistics() const;
 
+    /**
+     * \return the timestamps of the last completed frame of this node in the cluster
+     *         timebase
+     */
+    const FrameTimestamps& frameTimestamps() const;
+
+    /**
+     * \return the timestamps that the clients have reported since the last call, indexed
+     *         by the sync connection and ordered by frame. Clients only report their
+     *         timestamps if the cluster enables 'frametimestamps', and this list is
+     *         always empty on the clients
+     */
+    std::vector<std::vector<FrameTimestamps>> takeClientFrameTimestamps();
+
     /// \return the clear color as 4 floats (RGBA)
     vec4 clearColor() const;
 
@@ -233,6 +313,13 @@ public:
     /// Get the time from program start in seconds
     static double getTime();
 
+    /**
+     * \return the current time in seconds in the cluster timebase, which is the time of
+     *         the master. On the clients, the offset between the local clock and the
+     *         master's clock is continuously estimated through the sync connection
+     */
+    double clusterTime() const;
+
     /// \return a reference to this node (running on this computer).
     const Node& thisNode() const;
 
@@ -290,6 +377,12 @@ private:
      */
     void frameLockPostStage();
 
+    /// Completes the timestamps of the current frame and reports them to the master
+    void finishFrameTimestamps();
+
+    /// Adds the record of the frame that has just been swapped to the frame trace
+    void writeFrameTrace(double swapBegin, double swapEnd);
+
     /// Draw viewport overlays if there are any.
     void drawOverlays(const Window& window, Frustum::Mode frustum);
 
@@ -337,7 +430,11 @@ private:
 
     Statistics _statistics;
     double _statsPrevTimestamp = 0.0;
+    FrameTimestamps _frameTimestamps;
+    FrameTimestamps _lastFrameTimestamps;
     std::unique_ptr<StatisticsRenderer> _statisticsRenderer;
+    std::unique_ptr<FrameTraceWriter> _frameTrace;
+    std::optional<frametrace::Record> _pendingTraceRecord;
 
     bool _createDebugContext = false;
     bool _takeScreenshot = false;
@@ -358,8 +455,6 @@ private:
     ShaderProgram _fboQuad;
     ShaderProgram _overlay;
 
-    std::unique_ptr<std::thread> _thread;
-
     unsigned int _frameCounter = 0;
     unsigned int _shotCounter = 0;
 };
@@ -22,12 +22,16 @@ namespace sgct {
  * 1003: User / Name 'default' is not permitted for a user
  * 1010: Capture / Capture path must not be empty
  * 1011: Capture / Screenshot ranges beginning has to be before the end
+ * 1012: Capture / Capture queue size must be positive
  * 1020: Settings / Swap interval must not be negative
  * 1021: Settings / Refresh rate must not be negative
+ * 1022: Settings / Texture upload budget must be positive
+ * 1023: Settings / Mesh simplification error must not be negative
  * 1030: Device / Device name must not be empty
  * 1031: Device / VRPN address for sensors must not be empty
  * 1032: Device / VRPN address for buttons must not be empty
  * 1033: Device / VRPN address for axes must not be empty
+ * 1034: Device / Prediction latency must not be negative
  * 1040: Tracker / Tracker name must not be empty
  * 1050: Planar Projection / Up and down field of views can not be the same
  * 1051: Planar Projection / Left and right field of views can not be the same
@@ -74,6 +78,12 @@ namespace sgct {
  * 1125: Cluster / All trackers specified in the 'User's have to be valid tracker names
  * 1127: Cluster / Configuration must contain at least one node
  * 1128: Cluster / Two or more nodes are using the same port
+ * 1129: Cluster / Delta sync keyframe interval must be positive
+ * 1130: Cluster / Compression threshold must be non-negative
+ * 1131: Multicast / Multicast address must not be empty
+ * 1132: Multicast / Multicast port must be positive
+ * 1133: Multicast / Multicast TTL must be between 0 and 255
+ * 1134: Cluster / Frame lock spin time must be non-negative
 
  * 2000s: Correction Meshes
  * 2000: CorrectionMesh / Failed to export. Geometry type is not supported"
@@ -83,10 +93,12 @@ namespace sgct {
  * 2021: MPCDIMesh / Error reading from file. Could not find lines
  * 2022: MPCDIMesh / Invalid header information in MPCDI mesh
  * 2023: MPCDIMesh / Incorrect file type. Unknown header type
+ * 2024: MPCDIMesh / Error reading correction values in MPCDI mesh
  * 2030: OBJ / Failed to open '%s'
  * 2031: OBJ / Vertex count doesn't match number of texture coordinates in '%s'
  * 2032: OBJ / Faces in mesh '%s' referenced vertices that were undefined
  * 2033: OBJ / Faces in mesh '%s' are using relative index positions that are unsupported
+ * 2034: OBJ / Error parsing line %i in mesh '%s'
  * 2040: PaulBourke / Failed to open file '%s'
  * 2041: PaulBourke / Error reading mapping type in file '%s'
  * 2042: PaulBourke / Invalid data in file '%s'
@@ -97,6 +109,7 @@ namespace sgct {
  * 2054: Pfm / Error reading correction values in file '%s'
  * 2060: Scalable / Failed to open file '%s'
  * 2061: Scalable / Incorrect mesh data geometry in file '%s'
+ * 2062: Scalable / Error parsing line %i in mesh '%s'
  * 2070: SCISS / Failed to open '%s'
  * 2071: SCISS / Incorrect file id in file '%s'
  * 2072: SCISS / Error parsing file version from file '%s'
@@ -111,6 +124,7 @@ namespace sgct {
  * 2082: SimCAD / Error reading file '{}'. Missing 'GeometryDefinition'
  * 2083: SimCAD / Not the same x coords as y coords
  * 2084: SimCAD / Not a valid squared matrix read from SimCAD file
+ * 2085: SimCAD / Error parsing correction value '%s'
  * 2090: SkySkan / Failed to open file '%s'
  * 2091: SkySkan / Data reading error in file '%s'
 
@@ -132,11 +146,11 @@ namespace sgct {
  * 4004: MPCDI / Failed to parse frustum element. Conversion error
  * 4005: MPCDI / Require both xResolution and yResolution values
  * 4006: MPCDI / No 'id' attribute provided for region
- * 4007: MPCDI / Multiple 'buffer' elements not supported
+ * 4007: MPCDI / Multiple 'buffer' elements require selecting one
  * 4008: MPCDI / GeometryWarpFile requires interpolation
  * 4009: MPCDI / Only linear interpolation is supported
- * 4010: MPCDI / GeometryWarpFile requires path
- * 4011: MPCDI / No matching geometryWarpFile found
+ * 4010: MPCDI / %s requires path
+ * 4011: MPCDI / File %s of region %s not found in %s
  * 4012: MPCDI / Cannot find XML root
  * 4013: MPCDI / Error parsing MPCDI, missing or wrong 'profile'
  * 4014: MPCDI / Error parsing MPCDI, missing or wrong 'geometry'
@@ -149,10 +163,13 @@ namespace sgct {
  * 4021: MPCDI / Unable to get info on file
  * 4022: MPCDI / Unable to open XML file
  * 4023: MPCDI / Read from XML file failed
- * 4024: MPCDI / Unable to open PFM file
- * 4025: MPCDI / Read from PFM file failed
- * 4026: MPCDI / MPCDI does not contain the XML and/or PFM file
+ * 4024: MPCDI / Unable to open file in archive
+ * 4025: MPCDI / Read from file in archive failed
+ * 4026: MPCDI / MPCDI does not contain the XML file
  * 4027: MPCDI / Error parsing main XML file
+ * 4028: MPCDI / Missing 'buffer' element with id '%s'
+ * 4029: MPCDI / Unable to decode image %s
+ * 4030: MPCDI / No 'region' attribute provided for fileset
 
  * 5000s: Network
  * 5000: Network / Failed to parse hints for connection
@@ -170,15 +187,26 @@ namespace sgct {
  * 5012: Network / Failed to uncompress data for connection %i: %s // Data Transfer
  * 5013: Network / TCP connection %i receive failed: %s
  * 5014: Network / Send data failed: %s
+ * 5015: Network / Delta block of size %i is too small
+ * 5016: Network / Delta block is based on a block of size %i but %i was available
+ * 5017: Network / Delta block contains a truncated run
+ * 5018: Network / Delta block contains a run outside of the data block
+ * 5019: Network / Failed to compress data: %s
  * 5020: NetworkManager / Winsock 2.2 startup failed
  * 5021: NetworkManager / No address information for this node available
  * 5022: NetworkManager / No address information for master available
  * 5023: NetworkManager / Port %i is already used by connection %i
- * 5024: NetworkManager / Failed to compress data: %s
  * 5025: NetworkManager / No port provided for connection to %s
  * 5026: NetworkManager / Empty address for connection to %i
  * 5027: NetworkManager / Failed to get host name
  * 5028: NetworkManager / Failed to get address info: %s
+ * 5030: Multicast / Failed to create multicast socket: %s
+ * 5031: Multicast / Failed to bind multicast socket to port %i: %s
+ * 5032: Multicast / Invalid multicast address %s
+ * 5033: Multicast / Failed to join multicast group %s: %s
+ * 5034: Multicast / Failed to configure multicast socket: %s
+ * 5035: NetworkReactor / Failed to create network reactor: %s
+ * 5036: NetworkReactor / Failed to add connection %i to the network reactor: %s
 
  * 6000s: XML configuration parsing
  * 6000: PlanarProjection / Missing specification of field-of-view values
@@ -207,7 +235,11 @@ namespace sgct {
  * 6086: Parsing / Unknown color bit depth %s
  * 6087: Parsing / Unknown resolution %s for cube map
  * 6088: Parsing / Unsupported file extension %s
+ * 6089: Parsing / Unknown compression %s
  * 6090: SpoutOutput / Unknown spout output mapping: %s
+ * 6091: Multicast / Missing field address in multicast
+ * 6092: Multicast / Missing field port in multicast
+ * 6093: Capture / Unknown capture queue policy %s
  * 6100: SphericalMirror / Missing geometry paths
 
  * 7000s: Shader Handling
@@ -231,10 +263,23 @@ namespace sgct {
  * 9006: Image / Missing image data to save PNG
  * 9007: Image / Can't save %d bit
  * 9008: Image / Can't create PNG file '%s'
- * 9009: Image / Failed to create PNG struct
- * 9010: Image / Failed to create PNG info struct
- * 9011: Image / One of the called PNG functions failed
  * 9012: Image / Invalid image size %i x %i %i channels
+ * 9013: Image / Failed to compress PNG file '%s'
+ * 9014: Image / Failed to write PNG file '%s'
+ * 9015: Image / Missing image data to save EXR
+ * 9016: Image / Failed to compress EXR file '%s'
+ * 9017: Image / Can't create EXR file '%s'
+ * 9018: Image / Failed to write EXR file '%s'
+ * 9019: Image / Can't save floating point image '%s' as %s
+ * 9100: RawCapture / Could not open raw capture file '%s': %s
+ * 9101: RawCapture / Could not resize raw capture file '%s' to %i bytes: %s
+ * 9102: RawCapture / Could not map raw capture file '%s': %s
+ * 9103: RawCapture / File '%s' is not a raw capture file
+ * 9104: RawCapture / Unsupported raw capture version %i in '%s'
+ * 9200: FrameTrace / Could not create frame trace file '%s'
+ * 9201: FrameTrace / Could not open frame trace file '%s'
+ * 9202: FrameTrace / File '%s' is not a frame trace file
+ * 9203: FrameTrace / Unsupported frame trace version %i in '%s'
 
  OBS:  When adding a new error code, don't forget to update docs/errors.md accordingly
  */
@@ -245,6 +290,7 @@ struct Error : public std::runtime_error {
         CorrectionMesh,
         DomeProjection,
         Engine,
+        FrameTrace,
         Image,
         MPCDI,
         MPCDIMesh,
@@ -252,6 +298,7 @@ struct Error : public std::runtime_error {
         OBJ,
         PaulBourke,
         Pfm,
+        RawCapture,
         ReadConfig,
         Scalable,
         SCISS,
@@ -0,0 +1,75 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__FRAMESIGNAL__H__
+#define __SGCT__FRAMESIGNAL__H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif // __linux__
+
+namespace sgct {
+
+/// Tells the CPU that we are in a spin loop so that it can save power and does not
+/// penalize the loop exit with a memory order violation
+void cpuRelax();
+
+/**
+ * Wakes up the threads that wait for the frame lock whenever the network state changes.
+ * Every call to notify increments a generation counter, and a thread only goes to sleep
+ * if the generation is still the one it has read before checking the network state, so
+ * no notification can get lost between the check and the wait. On Linux the waiting is
+ * done with a futex on the counter, other platforms use a condition variable.
+ *
+ * As putting a thread to sleep and waking it up again costs tens of microseconds, the
+ * wait can optionally busy-poll the counter for a short time before blocking, which pays
+ * off when the notification is expected to arrive almost immediately.
+ *
+ * The typical usage is:
+ *     uint32_t generation = signal.generation();
+ *     while (!isDone()) {
+ *         signal.wait(generation, timeout);
+ *         generation = signal.generation();
+ *     }
+ */
+class FrameSignal {
+public:
+    /// \return the current generation, which has to be read before checking the state
+    uint32_t generation() const;
+
+    /// Increments the generation and wakes up all threads that are currently waiting
+    void notify();
+
+    /**
+     * Blocks until the generation differs from \p generation or until the \p timeout
+     * has passed. For the first \p spinTime of the timeout the generation is polled
+     * without giving up the CPU before the thread is put to sleep.
+     *
+     * \return false if the timeout has passed without a notification
+     */
+    bool wait(uint32_t generation, std::chrono::microseconds timeout,
+        std::chrono::microseconds spinTime = std::chrono::microseconds(0));
+
+private:
+    std::atomic<uint32_t> _generation = 0;
+#ifdef __linux__
+    std::atomic_int _nWaiters = 0;
+#else // __linux__
+    std::mutex _mutex;
+    std::condition_variable _cond;
+#endif // __linux__
+};
+
+} // namespace sgct
+
+#endif // __SGCT__FRAMESIGNAL__H__
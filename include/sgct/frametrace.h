@@ -0,0 +1,103 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__FRAMETRACE__H__
+#define __SGCT__FRAMETRACE__H__
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * A frame trace contains the timing information of every frame that was rendered on one
+ * node, so that stutters during a show can be analyzed afterwards without the need for a
+ * profiler to be connected. Every node writes its own file and the files of all nodes
+ * are combined with the frametracemerge application.
+ *
+ * The file starts with a FileHeader and is followed by one Record per frame. All values
+ * are stored in little-endian byte order.
+ */
+namespace frametrace {
+    constexpr std::array<char, 8> Magic = { 'S', 'G', 'C', 'T', 'F', 'T', 'R', '\0' };
+    constexpr uint32_t Version = 1;
+
+    struct Record {
+        int32_t frame = -1;
+        /// The size of the shared data in bytes that was encoded on the master
+        uint32_t encodeSize = 0;
+        /// The size of the shared data in bytes that was decoded on a client
+        uint32_t decodeSize = 0;
+        uint32_t reserved = 0;
+
+        // Durations in seconds
+        double frameTime = 0.0;
+        /// The time the GPU took to render the frame or a negative value if unknown
+        double drawTime = -1.0;
+        double syncTime = 0.0;
+        double loopTimeMin = 0.0;
+        double loopTimeMax = 0.0;
+
+        // Points in time in seconds of the cluster timebase, see FrameTimestamps
+        double encode = 0.0;
+        double send = 0.0;
+        double receive = 0.0;
+        double decode = 0.0;
+        double draw = 0.0;
+        double ack = 0.0;
+        double swapBegin = 0.0;
+        double swapEnd = 0.0;
+
+        double clockOffset = 0.0;
+        double roundTripTime = 0.0;
+    };
+
+    struct FileHeader {
+        std::array<char, 8> magic = Magic;
+        uint32_t version = Version;
+        uint32_t recordSize = sizeof(Record);
+        int32_t nodeIndex = -1;
+        uint32_t isMaster = 0;
+        std::array<char, 64> nodeAddress = {};
+    };
+} // namespace frametrace
+
+/// Appends the records of the frames that are rendered on this node to a trace file
+class FrameTraceWriter {
+public:
+    FrameTraceWriter(const std::string& path, int nodeIndex, bool isMaster,
+        const std::string& nodeAddress);
+
+    void write(const frametrace::Record& record);
+
+    const std::string& path() const;
+
+private:
+    std::string _path;
+    std::ofstream _file;
+};
+
+/// Reads all records of a trace file that has been written by the FrameTraceWriter
+class FrameTraceReader {
+public:
+    explicit FrameTraceReader(const std::string& path);
+
+    const frametrace::FileHeader& header() const;
+    const std::vector<frametrace::Record>& records() const;
+
+private:
+    frametrace::FileHeader _header;
+    std::vector<frametrace::Record> _records;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__FRAMETRACE__H__
@@ -16,17 +16,31 @@ namespace sgct {
 
 class Image {
 public:
-    enum class FormatType { PNG = 0, JPEG, TGA, Unknown };
+    enum class FormatType { PNG = 0, JPEG, TGA, EXR, Unknown };
+
+    /// Trades file size for encoding speed, only used for PNG and EXR images
+    enum class Compression { Default, Fast };
 
     Image() = default;
+    Image(Image&& rhs) noexcept;
+    Image& operator=(Image&& rhs) noexcept;
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
     ~Image();
 
     void allocateOrResizeData();
+
+    /**
+     * Loads the image and converts it into the layout that is used by OpenGL textures,
+     * that is BGR(A) with the bottom row first. 8-bit PNG images are decoded directly
+     * into that layout, all other images are decoded with stb_image and converted.
+     */
     void load(const std::string& filename);
-    void load(unsigned char* data, int length);
+    void load(const unsigned char* data, int length);
 
     /// Save the buffer to file. Type is automatically set by filename suffix.
-    void save(const std::string& filename);
+    void save(const std::string& filename,
+        Compression compression = Compression::Default);
 
     unsigned char* data();
     const unsigned char* data() const;
@@ -38,20 +52,45 @@ public:
     void setChannels(int channels);
     void setBytesPerChannel(int bpc);
 
+    /**
+     * Marks channels with 2 or 4 bytes as half or single precision floating point values
+     * rather than unsigned integers. Floating point images can only be saved as EXR.
+     */
+    void setFloatingPoint(bool isFloatingPoint);
+    bool isFloatingPoint() const;
+
 private:
+    /// Frees the pixel data and resets the image to be empty
+    void reset();
+
+    /// \return false if the data is no 8-bit PNG image or can't be decoded
+    bool loadPNG(const unsigned char* data, size_t length);
+
     /**
+     * Large images are split into horizontal strips that are compressed in parallel and
+     * written as consecutive IDAT chunks of a single deflate stream.
+     *
      * Compression levels 1-9.
      *   -1 = Default compression
      *    0 = No compression
      *    1 = Best speed
      *    9 = Best compression
      */
-    void savePNG(std::string filename, int compressionLevel = -1);
+    void savePNG(const std::string& filename, int compressionLevel = -1);
+
+    /**
+     * Writes a scanline OpenEXR file with ZIP compression, whose blocks of 16 lines are
+     * compressed in parallel. Floating point channels are stored with their precision,
+     * integer channels are normalized and stored as half floats (32 bit integers as
+     * floats).
+     */
+    void saveEXR(const std::string& filename, int compressionLevel = -1);
 
     int _nChannels = 0;
     ivec2 _size = ivec2{ 0, 0 };
     unsigned int _dataSize = 0;
     int _bytesPerChannel = 1;
+    bool _isFloatingPoint = false;
     unsigned char* _data = nullptr;
 };
 
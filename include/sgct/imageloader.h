@@ -0,0 +1,106 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__IMAGELOADER__H__
+#define __SGCT__IMAGELOADER__H__
+
+#include <sgct/image.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * Decodes image files on a pool of worker threads, so that all textures that are needed
+ * at the same time, for example the masks of all viewports, can be decoded concurrently
+ * instead of one after another.
+ *
+ * If a texture cache path is set in the Settings, the decoded pixels are additionally
+ * stored in that folder under a hash of the file contents. Loading an unchanged file
+ * again, for example on the next start of the application, then only reads the pixels
+ * from the cache instead of decoding the file.
+ */
+class ImageLoader {
+public:
+    /**
+     * Creates the loader on first use with the values currently stored in the Settings.
+     * This function can be called from any thread
+     */
+    static ImageLoader& instance();
+
+    /// Deletes the loader, which must no longer be in use by any other thread
+    static void destroy();
+
+    /**
+     * Starts loading the image \p filename on one of the worker threads. Errors that
+     * occur while loading the image are rethrown by the returned future.
+     */
+    std::future<Image> load(std::string filename);
+
+    /**
+     * Starts decoding the encoded image \p data, for example the contents of an image
+     * file that was received over the network, on one of the worker threads. Errors that
+     * occur while decoding the image are rethrown by the returned future.
+     */
+    std::future<Image> decode(std::vector<unsigned char> data);
+
+    /**
+     * Runs the \p task on one of the worker threads. This is used for other work that is
+     * done while the windows are created, like generating the correction meshes, so that
+     * it shares the workers with the image decoding instead of starting its own threads.
+     * The \p task must not wait for other tasks of the loader. Exceptions that the task
+     * throws are rethrown by the returned future.
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> run(F task);
+
+    /// \return the number of worker threads
+    int numberOfThreads() const;
+
+private:
+    ImageLoader(int nThreads, std::string cachePath);
+    ~ImageLoader();
+
+    void worker();
+    void addTask(std::packaged_task<void()> task);
+
+    /**
+     * Loads the image from the cache or decodes the encoded image \p data and adds it to
+     * the cache. The \p name is only used for messages
+     */
+    Image loadImage(const std::vector<unsigned char>& data,
+        const std::string& name) const;
+
+    static ImageLoader* _instance;
+
+    const std::string _cachePath;
+
+    std::mutex _mutex;
+    std::condition_variable _taskAdded;
+    std::deque<std::packaged_task<void()>> _tasks;
+    bool _isRunning = true;
+    std::vector<std::thread> _workers;
+};
+
+template <typename F>
+std::future<std::invoke_result_t<F>> ImageLoader::run(F task) {
+    std::packaged_task<std::invoke_result_t<F>()> t(std::move(task));
+    std::future<std::invoke_result_t<F>> res = t.get_future();
+    addTask(std::packaged_task<void()>(std::move(t)));
+    return res;
+}
+
+} // namespace sgct
+
+#endif // __SGCT__IMAGELOADER__H__
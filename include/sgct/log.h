@@ -9,20 +9,58 @@
 #ifndef __SGCT__LOGGER__H__
 #define __SGCT__LOGGER__H__
 
+#include <sgct/framesignal.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace sgct {
 
+/**
+ * The messages are not written by the thread that logs them. Instead, every message is
+ * added as a record to a bounded lock-free ring buffer, from which a background thread
+ * takes them in batches and writes them to the console, the log file, and the callback.
+ * Logging a message therefore never waits for the console or the file, which would
+ * otherwise stall the render thread whenever another thread is logging at the same time.
+ *
+ * If the ring buffer is full, the overflow policy determines whether the caller waits
+ * for space or whether the message is discarded. Errors are never discarded, always wait
+ * for space, and are written before the call returns, so that they are not lost if the
+ * application crashes right afterwards. If writing an error takes longer than half a
+ * second, for example because the callback waits for a lock that the caller holds, the
+ * caller continues without waiting for it. All messages that are still in the buffer
+ * are written when the Log is destroyed or when the application exits. The Log is not
+ * created again after it has been destroyed, messages that are logged afterwards are
+ * written to the console directly.
+ */
 class Log {
 public:
     /// Different notify levels for messages
     enum class Level { Error = 3, Warning = 2, Info = 1, Debug = 0 };
 
+    /// Determines what happens to a message that is logged while the buffer is full
+    enum class OverflowPolicy {
+        /// The caller waits until the background thread has made space for the message
+        Block,
+        /// The message is discarded and the number of discarded messages is reported
+        Discard
+    };
+
+    /**
+     * Creates the Log on first use. This function can be called from any thread, but
+     * throws a std::logic_error if the Log has already been destroyed
+     */
     static Log& instance();
+
+    /// Writes the remaining messages and deletes the Log, which can't be created again
     static void destroy();
 
     static void Debug(std::string_view message);
@@ -42,27 +80,91 @@ public:
     /// Set if log to console should be enabled. It is enabled on default
     void setLogToConsole(bool state);
 
+    /// Set whether the id of the thread that logged the message should be displayed
+    void setShowThreadId(bool state);
+
+    /// Set the file to which all messages are appended. An empty filename disables it
+    void setLogFile(const std::string& filename);
+
     /// Set the callback that gets invoked for each log. If you want to disable logging to
-    /// the callback, pass a null function as a parameter
+    /// the callback, pass a null function as a parameter. The callback is invoked from
+    /// the thread that writes the messages, not the thread that has logged the message.
+    /// As errors and, with the Block policy, all messages wait for space in a full
+    /// buffer, the callback must not wait for a lock that is held while logging. Errors
+    /// also wait until they have been written, but at most for half a second
     void setLogCallback(std::function<void(Level, std::string_view)> fn);
 
+    /// Set what happens to Debug, Info, and Warning messages when the buffer is full
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    /// Blocks until all messages that have been logged so far have been written
+    void flush();
+
 private:
+    struct Record {
+        Level level = Level::Info;
+        std::chrono::system_clock::time_point time;
+        std::thread::id threadId;
+        std::string message;
+    };
+
     Log();
+    ~Log();
 
+    /// \return the instance, which is nullptr once it has been destroyed
+    static Log* createInstance();
+    static void print(Level level, std::string_view message);
     void printv(Level level, std::string message);
 
-    static Log* _instance;
+    /// \return false if the record has been discarded, otherwise \p position is set
+    bool push(Record& record, bool wait, size_t& position);
+    bool tryPush(Record& record, size_t& position);
+    bool tryPop(Record& record);
+    /// \return false if the record was not written before the \p deadline
+    bool waitUntilWritten(size_t position,
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::time_point::max());
+    void worker();
+    void write(const std::vector<Record>& records);
+
+    static std::atomic<Log*> _instance;
 
     std::vector<char> _parseBuffer;
 
-    Level _level = Level::Info;
+    std::atomic<Level> _level = Level::Info;
     bool _showTime = false;
     bool _showLevel = true;
+    bool _showThreadId = false;
     bool _logToConsole = true;
+    std::atomic<OverflowPolicy> _overflowPolicy = OverflowPolicy::Discard;
 
+    // Protects the settings above and the outputs against concurrent changes while the
+    // background thread is writing
     std::mutex _mutex;
 
+    std::ofstream _file;
     std::function<void(Level, std::string_view)> _messageCallback;
+
+    struct Cell {
+        std::atomic_size_t sequence;
+        Record record;
+    };
+    std::unique_ptr<Cell[]> _cells;
+    const size_t _mask;
+
+    // Producers and the background thread each touch only their own position, so they
+    // live on separate cache lines. Only the background thread reads records
+    alignas(64) std::atomic_size_t _enqueuePosition = 0;
+    alignas(64) size_t _dequeuePosition = 0;
+    // The number of records that have been written, which is the position of the next
+    // record that the background thread is going to write
+    alignas(64) std::atomic_size_t _writtenPosition = 0;
+    std::atomic_size_t _nDiscarded = 0;
+
+    std::atomic_bool _isRunning = true;
+    FrameSignal _recordAdded;
+    FrameSignal _recordWritten;
+    std::thread _worker;
 };
 
 } // namespace sgct
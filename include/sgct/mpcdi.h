@@ -10,7 +10,10 @@
 #define __SGCT__MPCDI__H__
 
 #include <sgct/config.h>
+#include <sgct/image.h>
 #include <sgct/math.h>
+#include <sgct/correction/buffer.h>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -22,15 +25,27 @@ struct ReturnValue {
     struct ViewportInfo {
         /// The configuration struct for the individual viewports
         config::MpcdiProjection proj;
-        /// The warping mesh for each viewport as included inthe MPCDI file
-        std::vector<char> meshData;
+        /// The warping mesh of the region or an empty buffer if it has none
+        correction::Buffer mesh;
+        /// The blend mask of the region from its alpha map or an empty image
+        Image alphaMap;
+        /// The black level mask of the region from its beta map or an empty image
+        Image betaMap;
     };
     /// The list of all viewports in the MPCDI
     std::vector<ViewportInfo> viewports;
 };
 
-// throws std::runtime_error if the parsing fails
-ReturnValue parseMpcdiConfiguration(const std::string& filename);
+/**
+ * Parses the MPCDI file \p filename. The geometry warp files, alpha maps, and beta maps
+ * of all regions are decompressed and decoded in parallel, each directly from the
+ * archive. If the file describes more than one buffer, \p buffer has to contain the id
+ * of the buffer whose regions are returned.
+ *
+ * throws std::runtime_error if the parsing fails
+ */
+ReturnValue parseMpcdiConfiguration(const std::string& filename,
+    const std::optional<std::string>& buffer = std::nullopt);
 
 } //namespace sgct::mpcdi
 
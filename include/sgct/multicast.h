@@ -0,0 +1,205 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__MULTICAST__H__
+#define __SGCT__MULTICAST__H__
+
+#include <sgct/network.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sgct {
+
+/// The multicast group that the master uses to send the synchronization data
+struct MulticastGroup {
+    std::string address;
+    int port = 0;
+    int ttl = 1;
+    /// The address of the local interface; if empty, the operating system picks one
+    std::string interfaceAddress;
+};
+
+/**
+ * Each frame that is sent through the multicast group is split into fragments that fit
+ * into a single UDP datagram. Every datagram starts with a header that contains the type
+ * of the block (Network::DataId or Network::DeltaDataId), the sequence number of the
+ * frame, the total size of the frame, the index of the fragment, and the number of
+ * fragments.
+ */
+namespace multicast {
+    constexpr const int HeaderSize = 13;
+    constexpr const int MaxDatagramSize = 1472; // 1500 byte MTU - IPv4 and UDP headers
+    constexpr const int FragmentSize = MaxDatagramSize - HeaderSize;
+    constexpr const int MaxFragments = 65535;
+
+    /// The number of frames that are kept around to answer repair requests
+    constexpr const uint32_t HistorySize = 16;
+
+    /// \return the number of fragments a frame of size \p length is split into
+    int fragmentCount(int length);
+
+    /**
+     * Reassembles the frames of a MulticastSender from the fragments that arrive through
+     * the multicast group and from the repair messages that arrive through TCP. The last
+     * HistorySize frames are kept. This class is not thread-safe.
+     */
+    class Reassembler {
+    public:
+        /**
+         * Stores the fragment that is contained in the UDP \p datagram.
+         *
+         * \return true if the fragment completed its frame
+         */
+        bool addDatagram(const char* datagram, int length);
+
+        /**
+         * Stores the fragments of a repair message that was received through TCP.
+         *
+         * \return true if the repair completed the frame
+         */
+        bool applyRepair(uint32_t sequence, const char* data, int length);
+
+        /// \return true if all fragments of frame \p sequence have been received
+        bool isComplete(uint32_t sequence) const;
+
+        /**
+         * \return the payload of a NACK message containing the indices of all fragments
+         *         of frame \p sequence that have not been received yet. The result is
+         *         empty if nothing at all is known about the frame
+         */
+        std::vector<char> createNack(uint32_t sequence) const;
+
+        /**
+         * Copies the payload of frame \p sequence into \p result if all of its
+         * fragments have been received.
+         *
+         * \return false if the frame is not complete
+         */
+        bool takeFrame(uint32_t sequence, char& blockId, std::vector<char>& result) const;
+
+    private:
+        struct Frame {
+            uint32_t sequence = 0;
+            char blockId = 0;
+            uint16_t nFragments = 0;
+            uint16_t nReceived = 0;
+            std::vector<char> data;
+            std::vector<bool> isReceived;
+        };
+
+        Frame* frame(uint32_t sequence, char blockId, uint32_t size, uint16_t nFragments);
+        bool storeFragment(Frame& f, uint16_t index, const char* data, int length);
+
+        std::array<Frame, HistorySize> _frames;
+    };
+} // namespace multicast
+
+/**
+ * Sends the synchronization data of each frame once to a UDP multicast group instead of
+ * sending it to every client individually. The last frames are kept so that fragments
+ * that did not reach a client can be resent through the TCP connection of that client.
+ */
+class MulticastSender {
+public:
+    explicit MulticastSender(const MulticastGroup& group);
+    ~MulticastSender();
+
+    /// \return true if a frame of \p length bytes can be sent through the multicast group
+    static bool canSend(int length);
+
+    /**
+     * Sends the \p data as the next frame to the multicast group.
+     *
+     * \param blockId The type of the data, either Network::DataId or Network::DeltaDataId
+     * \return the sequence number of the frame
+     */
+    uint32_t send(char blockId, const void* data, int length);
+
+    /**
+     * Creates the payload of a repair message for frame \p sequence that contains the
+     * fragments whose indices are listed in the \p nack message. An empty list requests
+     * all fragments of the frame.
+     *
+     * \return false if the frame is no longer available
+     */
+    bool createRepair(uint32_t sequence, const char* nack, int nackLength,
+        std::vector<char>& result) const;
+
+private:
+    struct Frame {
+        uint32_t sequence = 0;
+        char blockId = 0;
+        std::vector<char> data;
+    };
+
+    SGCT_SOCKET _socket;
+    uint32_t _groupAddress = 0;
+    uint16_t _groupPort = 0;
+    uint32_t _sequence = 0;
+
+    mutable std::mutex _historyMutex;
+    std::array<Frame, multicast::HistorySize> _history;
+};
+
+/**
+ * Receives the frames that the MulticastSender sends to the multicast group on a
+ * background thread and reassembles them from their fragments. Nothing in this class
+ * blocks the caller while waiting for a frame; instead, the \p onUpdate function that is
+ * passed to the constructor is called from a background thread whenever a frame has been
+ * completed and when the delay passed to wakeAfter has elapsed.
+ */
+class MulticastReceiver {
+public:
+    MulticastReceiver(const MulticastGroup& group, std::function<void()> onUpdate);
+    ~MulticastReceiver();
+
+    /// Calls the update function once after \p delay unless wakeAfter is called again
+    void wakeAfter(std::chrono::microseconds delay);
+
+    /// \see multicast::Reassembler::isComplete
+    bool isComplete(uint32_t sequence) const;
+
+    /// \see multicast::Reassembler::createNack
+    std::vector<char> createNack(uint32_t sequence) const;
+
+    /// \see multicast::Reassembler::applyRepair
+    void applyRepair(uint32_t sequence, const char* data, int length);
+
+    /// \see multicast::Reassembler::takeFrame
+    bool takeFrame(uint32_t sequence, char& blockId, std::vector<char>& result) const;
+
+private:
+    void receiveLoop();
+    void timerLoop();
+
+    SGCT_SOCKET _socket;
+    const std::function<void()> _onUpdate;
+    std::atomic_bool _shouldTerminate = false;
+    std::thread _thread;
+
+    std::mutex _timerMutex;
+    std::condition_variable _timerCond;
+    std::optional<std::chrono::steady_clock::time_point> _wakeTime;
+    std::thread _timerThread;
+
+    mutable std::mutex _mutex;
+    multicast::Reassembler _frames;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__MULTICAST__H__
@@ -9,13 +9,19 @@
 #ifndef __SGCT__NETWORK__H__
 #define __SGCT__NETWORK__H__
 
+#include <sgct/clocksync.h>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #ifdef WIN32
@@ -26,6 +32,18 @@
 
 namespace sgct {
 
+struct MulticastGroup;
+class MulticastReceiver;
+class NetworkReactor;
+
+/**
+ * The compression that is applied to the payload of outgoing sync and data transfer
+ * messages. Both codecs produce zlib streams, so the receiving side can decompress any
+ * message without knowing which codec the sender has picked. Fast favors throughput and
+ * is the better choice for links that are faster than the compressor
+ */
+enum class NetworkCompression { None, Fast, High };
+
 /// Network manages peer-to-peer tcp connections.
 class Network {
 public:
@@ -35,10 +53,38 @@ public:
     static constexpr const char DataId = 17;
     static constexpr const char ConnectedId = 18;
     static constexpr const char DisconnectId = 19;
+    static constexpr const char DeltaDataId = 20;
+    static constexpr const char MulticastFrameId = 21;
+    static constexpr const char NackId = 22;
+    static constexpr const char RepairId = 23;
+    static constexpr const char TimeRequestId = 24;
+    static constexpr const char TimeResponseId = 25;
+    static constexpr const char FrameTimestampsId = 26;
+    static constexpr const char DataBeginId = 27;
+    static constexpr const char DataChunkId = 28;
 
     enum class ConnectionType { SyncConnection, ExternalConnection, DataTransfer };
 
+    using Compression = NetworkCompression;
+
+    struct CompressionStatistics {
+        /// Number of outgoing payload bytes that were passed to the compressor
+        uint64_t uncompressedBytes = 0;
+        /// Number of bytes that the compressor produced from the uncompressedBytes
+        uint64_t compressedBytes = 0;
+        /// Number of outgoing messages that were sent compressed
+        uint64_t nCompressedMessages = 0;
+        /// Number of incoming messages that had to be decompressed
+        uint64_t nDecompressedMessages = 0;
+        /// Accumulated time in seconds spent compressing outgoing messages
+        double compressionTime = 0.0;
+        /// Accumulated time in seconds spent decompressing incoming messages
+        double decompressionTime = 0.0;
+    };
+
     static const size_t HeaderSize = 13;
+    /// The number of frame timestamp reports kept per client if nobody collects them
+    static const size_t MaxRemoteFrameTimestamps = 256;
 
     /**
      * \param port is the network port (TCP)
@@ -49,16 +95,44 @@ public:
     Network(int port, std::string address, bool isServer, ConnectionType type);
     ~Network();
 
-    void initialize();
+    /**
+     * Starts receiving messages on this connection. Without a \p reactor the connection
+     * creates its own threads for establishing the connection and receiving messages,
+     * otherwise its socket is made non-blocking and serviced by the \p reactor.
+     */
+    void initialize(NetworkReactor* reactor = nullptr);
     void closeNetwork(bool forced);
     void initShutdown();
 
     void setDecodeFunction(std::function<void(const char*, int)> fn);
+    void setDeltaDecodeFunction(std::function<void(const char*, int)> fn);
     void setPackageDecodeFunction(std::function<void(void*, int, int, int)> fn);
     void setUpdateFunction(std::function<void(Network*)> fn);
     void setConnectedFunction(std::function<void (void)> fn);
     void setAcknowledgeFunction(std::function<void(int, int)> fn);
 
+    /**
+     * Sets the function that is called on the server when a client reports fragments of
+     * a multicast frame as missing. The parameters are the connection, the sequence
+     * number of the frame, and the list of missing fragment indices
+     */
+    void setNackFunction(std::function<void(Network*, uint32_t, const char*, int)> fn);
+
+    /**
+     * Makes this client connection receive the sync data through the multicast \p group.
+     * The server then only sends a small token through TCP for each frame, and the
+     * fragments that get lost on the way are requested again through TCP
+     */
+    void enableMulticast(const MulticastGroup& group);
+
+    /**
+     * Creates the header of a sync or data transfer message, where the value is either
+     * the frame number or the package id. The uncompressed size is 0 for messages whose
+     * payload is not compressed
+     */
+    static std::array<char, HeaderSize> createHeader(char id, int32_t value, int size,
+        int uncompressedSize);
+
     void setConnectedStatus(bool state);
     void setOptions(SGCT_SOCKET* socketPtr);
     void closeSocket(SGCT_SOCKET lSocket);
@@ -68,6 +142,44 @@ public:
     bool isServer() const;
     bool isConnected() const;
 
+    /**
+     * \return true if the next sync message sent through this connection has to contain
+     *         the full data block rather than a delta, which is the case for new or
+     *         re-established connections. On a client, this is true until the first full
+     *         data block has been received and all deltas are dropped until then
+     */
+    bool needsKeyframe() const;
+    void setNeedsKeyframe(bool state);
+
+    /**
+     * Clears the keyframe request of this connection and returns whether it was set. The
+     * request is read and cleared in one step, so that a reconnect that happens while a
+     * sync message is being prepared is not lost.
+     */
+    bool takeKeyframeRequest();
+
+    /**
+     * Sets the compression used for messages sent through this connection. Messages whose
+     * payload is smaller than \p threshold bytes are always sent uncompressed
+     */
+    void setCompression(Compression compression, int threshold);
+    Compression compression() const;
+
+    /// \return the accumulated compression counters of this connection
+    CompressionStatistics compressionStatistics() const;
+
+    /**
+     * Compresses the \p payload using the compression of this connection and writes the
+     * compressed bytes into \p result. When sending the result, the original \p length
+     * has to be stored as the uncompressed size in the message header.
+     *
+     * \return false if the payload was not compressed, either because compression is
+     *         disabled, the payload is below the threshold, or the compressed payload
+     *         would not have been smaller. In that case the content of \p result is
+     *         unspecified and the original payload should be sent instead
+     */
+    bool compressPayload(const void* payload, int length, std::vector<char>& result);
+
     int sendFrameCurrent() const;
     int sendFramePrevious() const;
     int recvFrameCurrent() const;
@@ -80,13 +192,91 @@ public:
      * This function compares the received frame number with the sent frame number. The
      * server starts by sending a frame sync number to the client. The client receives the
      * sync frame number and sends it back after drawing when ready for buffer swap. When
-     * the server gets a frame sync number equal to the sent number it swaps buffers.
+     * the server gets a frame sync number equal to the sent number it swaps buffers. With
+     * more than one frame in flight, the server only requires the client to have sent
+     * back one of the last frame numbers, and a client is updated as soon as it has
+     * buffered the sync data of a frame.
      *
      * \return true if updates has been received
      */
     bool isUpdated() const;
+
+    /**
+     * Sets the number of frames whose sync data can be in flight at the same time. With
+     * 1, the server waits for the client to acknowledge a frame before it swaps buffers.
+     * With more frames, the server can send the data of the next frame while the client
+     * is still rendering the current one, and the client buffers the data it receives
+     * until applySyncFrame is called at the start of the frame the data belongs to
+     */
+    void setMaxFramesInFlight(int frames);
+
+    /**
+     * Decodes the oldest sync data that has been buffered by a client connection with
+     * more than one frame in flight. Does nothing for other connections, as those decode
+     * the sync data as soon as it arrives.
+     */
+    void applySyncFrame();
+
+    /**
+     * Sends a clock synchronization request to the server. The server answers with its
+     * own time, which is used to update the estimate returned by clockSync.
+     */
+    void requestClockSync();
+
+    /// \return the offset of the local clock to the server clock of a client connection
+    const ClockSync& clockSync() const;
+
+    /// \return the local time at which the sync data of the latest frame was received
+    double syncReceiveTime() const;
+
+    /// \return the local time at which the sync data of the latest frame was decoded
+    double syncDecodeTime() const;
+
+    /// Sends the timestamps of the latest frame of a client to the server
+    void sendFrameTimestamps(const FrameTimestamps& timestamps);
+
+    /**
+     * \return the timestamps that the client has sent through this connection since the
+     *         last call, oldest first. At most MaxRemoteFrameTimestamps reports are kept
+     */
+    std::vector<FrameTimestamps> takeRemoteFrameTimestamps();
+
+    /**
+     * \return the local time at which the sender thread finished writing the latest
+     *         sync data to the socket, or 0 if that data is still queued
+     */
+    double syncSendTime() const;
     void sendData(const void* data, int length);
 
+    /**
+     * Sends the \p header followed by the \p data as one message without first copying
+     * them into a contiguous buffer. The \p data can be shared between connections as it
+     * is never modified.
+     */
+    void sendData(const void* header, int headerLength, const void* data, int length);
+
+    /**
+     * Hands the \p header and \p data to the sender thread of this connection and returns
+     * immediately. Messages are sent in the order in which they were queued. The \p data
+     * is not copied and has to stay valid and unmodified until waitForSendQueue returns.
+     * Only server-side sync connections have a sender thread, all other connections
+     * send the message before returning.
+     */
+    void queueData(const std::array<char, HeaderSize>& header, const void* data,
+        int length);
+
+    /// Same as the other queueData, but the connection takes ownership of the \p data
+    void queueData(const std::array<char, HeaderSize>& header, std::vector<char> data);
+
+    /// Blocks until all messages that were passed to queueData have been sent
+    void waitForSendQueue();
+
+    /**
+     * \return the time in seconds between queueing the most recent message and the
+     *         message being completely handed to the operating system
+     */
+    double sendLatency() const;
+
     /// \return last error code
     static int lastError();
     static int receiveData(SGCT_SOCKET& lsocket, char* buffer, int length, int flags);
@@ -103,17 +293,54 @@ public:
     std::condition_variable& startConnectionConditionVar();
 
 private:
+    friend class NetworkReactor;
+
     void setRecvFrame(int i);
     void updateBuffer(std::vector<char>& buffer, uint32_t reqSize, uint32_t& currSize);
     int readSyncMessage(char* header, int32_t& syncFrame, uint32_t& dataSize,
-        uint32_t& uncompressedDataSize);
+        uint32_t& uncompressedDataSize, uint32_t& sequence);
     int readDataTransferMessage(char* header, int32_t& packageId, uint32_t& dataSize,
         uint32_t& uncompressedDataSize);
     int readExternalMessage();
+    void parseSyncHeader(const char* header, int32_t& syncFrame, uint32_t& dataSize,
+        uint32_t& uncompressedDataSize, uint32_t& sequence);
+    void parseDataTransferHeader(const char* header, int32_t& packageId,
+        uint32_t& dataSize, uint32_t& uncompressedDataSize);
+
+    /// \return false if the connection has to be closed after this message
+    bool handleMessage(const char* header, int32_t value, uint32_t dataSize,
+        uint32_t uncompressedDataSize, uint32_t sequence);
+    bool handleExternalMessage(const char* data, int length);
+    void completePackage(int32_t packageId);
+    void sendAcknowledge(int32_t packageId);
+
+    void startConnection();
+    void endConnection();
+
+    // Non-blocking counterparts used by the NetworkReactor
+    bool acceptConnection();
+    /// \return false if the connection was closed
+    bool receiveAvailable();
+    char* decompressPayload(uint32_t& dataSize, uint32_t uncompressedDataSize);
+    /// Has to be called with _multicastMutex held; never waits for missing fragments
+    void processMulticastFrames();
+
+    /// \return true if the sync data is buffered until applySyncFrame is called
+    bool isBufferingSyncFrames() const;
+    void bufferSyncFrame(int32_t frame, char blockId, const char* data, int length);
+    void decodeSyncFrame(char blockId, const char* data, int length);
+
+    /**
+     * Has to be called for every sync message in the order in which they are received.
+     * \return false if \p blockId is a delta that has to be dropped, since no full data
+     *         block it could be based on has been received on this connection yet
+     */
+    bool acceptSyncBlock(char blockId);
 
     /// function to decode messages
     void communicationHandler();
     void connectionHandler();
+    void sendHandler();
 
     SGCT_SOCKET _socket;
     SGCT_SOCKET _listenSocket;
@@ -122,6 +349,7 @@ private:
     std::atomic_bool _isServer;
     std::atomic_bool _isConnected = false;
     std::atomic_bool _isUpdated = false;
+    std::atomic_bool _needsKeyframe = true;
     std::atomic<int32_t> _currentSendFrame = 0;
     std::atomic<int32_t> _previousSendFrame = 0;
     std::atomic<int32_t> _currentRecvFrame = 0;
@@ -131,6 +359,24 @@ private:
     mutable std::mutex _connectionMutex;
     std::unique_ptr<std::thread> _commThread;
     std::unique_ptr<std::thread> _mainThread;
+    std::unique_ptr<std::thread> _sendThread;
+
+    struct SendRequest {
+        std::array<char, HeaderSize> header;
+        const void* data = nullptr;
+        int length = 0;
+        double queueTime = 0.0;
+        std::vector<char> buffer; // only used if the request owns its data
+    };
+    std::mutex _sendMutex;
+    std::condition_variable _sendCond;
+    std::deque<SendRequest> _sendQueue;
+    int _nPendingSends = 0;
+    bool _stopSending = false;
+    std::atomic<double> _sendLatency = 0.0;
+    // Held for the whole of every sendData call so that the sender thread and direct
+    // callers (external replies, the disconnect message) never interleave their bytes
+    std::mutex _sendDataMutex;
 
     double _timeStampSend = 0.0;
     std::atomic<double> _timeStampTotal = 0.0;
@@ -142,15 +388,73 @@ private:
 
     std::vector<char> _recvBuffer;
     std::vector<char> _uncompressBuffer;
+    std::string _extBuffer; // for external communication
+
+    // The partially received message of a connection serviced by a NetworkReactor
+    struct ReceiveState {
+        std::array<char, HeaderSize> header;
+        uint32_t nBytes = 0;
+        bool isReadingPayload = false;
+        int32_t value = -1;
+        uint32_t dataSize = 0;
+        uint32_t uncompressedDataSize = 0;
+        uint32_t sequence = 0;
+    };
+    ReceiveState _receiveState;
+
+    std::atomic<Compression> _compression = Compression::None;
+    std::atomic_int _compressionThreshold = 0;
+    mutable std::mutex _compressionStatisticsMutex;
+    CompressionStatistics _compressionStatistics;
     char _headerId = 0;
 
+    // Multicast frames whose token has arrived as pairs of frame and sequence number.
+    // They are processed both by the receiving thread of this connection and by the
+    // threads of the MulticastReceiver, so this block is guarded by _multicastMutex
+    std::mutex _multicastMutex;
+    std::unique_ptr<MulticastReceiver> _multicastReceiver;
+    std::deque<std::pair<int32_t, uint32_t>> _pendingMulticastFrames;
+    std::vector<char> _multicastBuffer;
+    bool _isAwaitingMulticastFrame = false;
+    std::chrono::steady_clock::time_point _multicastDeadline;
+    uint32_t _nackedSequence = 0;
+    uint32_t _lostSequence = 0;
+
+    // The sync data that a client has received ahead of the frame it belongs to
+    struct SyncFrame {
+        int32_t frame = 0;
+        char blockId = DefaultId;
+        double receiveTime = 0.0;
+        std::vector<char> data;
+    };
+    std::atomic_int _maxFramesInFlight = 1;
+    mutable std::mutex _syncFrameMutex;
+    std::deque<SyncFrame> _pendingSyncFrames;
+    std::vector<std::vector<char>> _unusedSyncFrameBuffers;
+
+    // The data transfer packages that are received in chunks, indexed by package id
+    struct PartialPackage {
+        uint32_t size = 0;
+        std::vector<char> data;
+    };
+    std::map<int32_t, PartialPackage> _partialPackages;
+
+    ClockSync _clockSync;
+    std::atomic<double> _syncReceiveTime = 0.0;
+    std::atomic<double> _syncDecodeTime = 0.0;
+    std::atomic<double> _syncSendTime = 0.0;
+    std::mutex _remoteTimestampsMutex;
+    std::deque<FrameTimestamps> _remoteTimestamps;
+
     std::condition_variable _startConnectionCond;
 
     std::function<void(const char*, int)> decoderCallback;
+    std::function<void(const char*, int)> _deltaDecoderCallback;
     std::function<void(void*, int, int, int)> _packageDecoderCallback;
     std::function<void(Network*)> _updateCallback;
     std::function<void(void)> _connectedCallback;
     std::function<void(int, int)> _acknowledgeCallback;
+    std::function<void(Network*, uint32_t, const char*, int)> _nackCallback;
 };
 
 } // namespace sgct
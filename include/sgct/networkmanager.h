@@ -9,10 +9,13 @@
 #ifndef __SGCT__NETWORKMANAGER__H__
 #define __SGCT__NETWORKMANAGER__H__
 
+#include <sgct/framesignal.h>
 #include <sgct/network.h>
+#include <array>
 #include <atomic>
-#include <condition_variable>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -20,7 +23,10 @@
 
 namespace sgct {
 
+class DataTransferQueue;
+class MulticastSender;
 class Network;
+class NetworkReactor;
 
 /// The network manager manages all network connections for SGCT.
 class NetworkManager {
@@ -34,10 +40,12 @@ public:
         std::function<void(bool)> externalStatus,
         std::function<void(void*, int, int, int)> dataTransferDecode,
         std::function<void(bool, int)> dataTransferStatus,
-        std::function<void(int, int)> dataTransferAcknowledge);
+        std::function<void(int, int)> dataTransferAcknowledge,
+        std::function<void(int, int, float)> dataTransferProgress = nullptr);
     static void destroy();
 
-    static std::condition_variable cond;
+    /// Notified whenever a connection has received a message or changed its state
+    static FrameSignal frameSignal;
 
     ~NetworkManager();
 
@@ -48,10 +56,17 @@ public:
      * \param if this application is server/master in cluster then set to true
      * \return min-max pair of the looping time to all connections if data was sent to the
      *         clients. If it was the acknowledge data call or no connections are
-     *         available, a nullopt is returned
+     *         available, a nullopt is returned. When sending data to the clients, this
+     *         function returns as soon as the data is queued for every connection
      */
     std::optional<std::pair<double, double>> sync(SyncMode sm);
 
+    /**
+     * Blocks until the data that was queued by the last call to sync has been sent to all
+     * clients. The shared data must not be encoded again before this function returned
+     */
+    void waitForPendingSends();
+
     /**
      * Compare if the last frame and current frames are different -> data update
      * And if send frame == recieved frame
@@ -68,25 +83,67 @@ public:
     void transferData(const void* data, int length, int packageId);
     void transferData(const void* data, int length, int packageId, Network& connection);
 
+    /**
+     * Queues the \p data to be sent as package \p packageId to all data transfer
+     * connections and returns immediately. The package is sent in chunks to all nodes
+     * concurrently. The progress is reported through the dataTransferProgress callback
+     * and the dataTransferAcknowledge callback is called once a node has received the
+     * whole package. The package ids of all packages in flight have to be unique.
+     */
+    void transferDataAsync(std::shared_ptr<const std::vector<char>> data, int packageId);
+
+    /// Same as the other transferDataAsync, but takes ownership of the \p data
+    void transferDataAsync(std::vector<char> data, int packageId);
+
+    /// \return the number of package transfers that have not been sent completely yet
+    int nPendingDataTransfers() const;
+
     unsigned int activeConnectionsCount() const;
     int connectionsCount() const;
     int syncConnectionsCount() const;
     const Network& connection(int index) const;
     const Network& syncConnection(int index) const;
 
+    /**
+     * \return the time in seconds that has to be added to the local clock to get the
+     *         time of the master. This is always 0 on the master
+     */
+    double clockOffset() const;
+
+    /// \return the round trip time of the clock synchronization with the master
+    double clockRoundTripTime() const;
+
+    /// Sends the timestamps of the latest frame of a client to the master
+    void sendFrameTimestamps(const FrameTimestamps& timestamps);
+
+    /**
+     * \return the timestamps the clients have sent since the last call, indexed by sync
+     *         connection and ordered by frame
+     */
+    std::vector<std::vector<FrameTimestamps>> takeClientFrameTimestamps();
+
+    /**
+     * \return the latest local time at which the sync data of the current frame was
+     *         written to the socket of a client, or 0 if it is still being sent to at
+     *         least one of the clients
+     */
+    double syncSendTime() const;
+
 private:
     NetworkManager(NetworkMode nm, std::function<void(const char*, int)> externalDecode,
         std::function<void(bool)> externalStatus,
         std::function<void(void*, int, int, int)> dataTransferDecode,
         std::function<void(bool, int)> dataTransferStatus,
-        std::function<void(int, int)> dataTransferAcknowledge);
+        std::function<void(int, int)> dataTransferAcknowledge,
+        std::function<void(int, int, float)> dataTransferProgress);
 
     void addConnection(int port, std::string address,
         Network::ConnectionType connectionType = Network::ConnectionType::SyncConnection);
     void updateConnectionStatus(Network* connection);
     void setAllNodesConnected();
-    void prepareTransferData(const void* data, std::vector<char>& buffer, int& length,
-        int packageId);
+    bool syncMulticast();
+    void sendRepair(Network* connection, uint32_t sequence, const char* nack,
+        int nackLength);
 
     static NetworkManager* _instance;
 
@@ -112,6 +169,20 @@ private:
     unsigned int _nActiveConnections = 0;
     unsigned int _nActiveSyncConnections = 0;
     unsigned int _nActiveDataTransferConnections = 0;
+    int _nFramesSinceKeyframe = 0;
+    double _lastClockSyncTime = -std::numeric_limits<double>::max();
+
+    // Compressed versions of the shared data block and its delta, indexed by the codec
+    std::array<std::vector<char>, 3> _compressedDataBlocks;
+    std::array<std::vector<char>, 3> _compressedDeltaBlocks;
+
+    // Only exists on the server if the sync data is sent through a multicast group
+    std::unique_ptr<MulticastSender> _multicastSender;
+
+    // Only exists if all connections are serviced by a single thread
+    std::unique_ptr<NetworkReactor> _reactor;
+
+    std::unique_ptr<DataTransferQueue> _dataTransferQueue;
 };
 
 } // namespace sgct
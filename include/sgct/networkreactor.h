@@ -0,0 +1,54 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__NETWORKREACTOR__H__
+#define __SGCT__NETWORKREACTOR__H__
+
+#include <atomic>
+#include <thread>
+
+namespace sgct {
+
+class Network;
+
+/**
+ * Services the receiving side of any number of connections from a single thread instead
+ * of the two threads that each Network otherwise creates for itself. The sockets of the
+ * connections are switched to non-blocking mode and are watched using epoll, so this
+ * class is only available on Linux.
+ */
+class NetworkReactor {
+public:
+    /// \return true if the reactor is supported on this platform
+    static bool isSupported();
+
+    NetworkReactor();
+    ~NetworkReactor();
+
+    /**
+     * Starts watching the \p connection. A server connection starts listening for its
+     * client, a client connection is considered established right away. The connection
+     * has to outlive this reactor.
+     */
+    void add(Network& connection);
+
+private:
+    void run();
+    void service(Network& connection);
+    void watch(int socket, Network* connection, unsigned int events);
+    void unwatch(int socket);
+
+    int _epoll = -1;
+    int _wakeup = -1;
+    std::atomic_bool _shouldTerminate = false;
+    std::thread _thread;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__NETWORKREACTOR__H__
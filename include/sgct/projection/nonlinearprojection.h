@@ -40,6 +40,12 @@ public:
     virtual void renderCubemap(Window& window, Frustum::Mode frustumMode) = 0;
     virtual void update(vec2 size) = 0;
 
+    /**
+     * Starts reading the meshes that the projection needs on background threads, so that
+     * initialize only has to upload them. Projections without meshes don't do anything.
+     */
+    virtual void prepareMeshes();
+
     virtual void updateFrustums(Frustum::Mode mode, float nearClip, float farClip);
 
     /**
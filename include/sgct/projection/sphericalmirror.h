@@ -24,6 +24,9 @@ public:
 
     void update(vec2 size) override;
 
+    /// Starts reading the four meshes of the mirror in the background
+    void prepareMeshes() override;
+
     /// Render the non linear projection to currently bounded FBO
     void render(const Window& window, const BaseViewport& viewport,
         Frustum::Mode frustumMode) override;
@@ -0,0 +1,148 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__RAWCAPTURE__H__
+#define __SGCT__RAWCAPTURE__H__
+
+#include <sgct/math.h>
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sgct {
+
+/**
+ * The raw capture format stores an entire sequence of uncompressed screenshots in a
+ * single file so that a capture session is written as one sequential stream instead of
+ * one compressed file per frame. The frames are converted into image files offline, for
+ * example with the rawcaptureconverter application.
+ *
+ * The file starts with a FileHeader that is padded to HeaderSize bytes, followed by the
+ * frames, each of which starts on a multiple of FrameAlignment bytes. A frame consists of
+ * the pixels as they were read back from the GPU (BGR(A), little-endian, bottom row
+ * first, without any row padding) and a FrameFooter directly behind the pixels. All
+ * values are stored in little-endian byte order.
+ */
+namespace rawcapture {
+    constexpr std::array<char, 8> Magic = { 'S', 'G', 'C', 'T', 'R', 'A', 'W', '\0' };
+    constexpr uint32_t Version = 1;
+    constexpr uint64_t HeaderSize = 4096;
+    constexpr uint64_t FrameAlignment = 4096;
+    constexpr uint32_t FrameMagic = 0x52464753; // 'SGFR'
+    /// The file is grown and mapped in pieces of about this size
+    constexpr uint64_t SegmentSize = 256 * 1024 * 1024;
+
+    struct FileHeader {
+        std::array<char, 8> magic = Magic;
+        uint32_t version = Version;
+        uint32_t headerSize = static_cast<uint32_t>(HeaderSize);
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t nChannels = 0;
+        int32_t bytesPerChannel = 0;
+        uint64_t frameStride = 0;
+        uint64_t nFrames = 0;
+        // 1 if channels with 2 or 4 bytes are half or single precision floats
+        uint32_t isFloatingPoint = 0;
+    };
+
+    struct FrameFooter {
+        uint64_t frameNumber = 0;
+        // Only set once all pixels have been written, frames without it were dropped
+        uint32_t magic = 0;
+        uint32_t reserved = 0;
+    };
+
+    class MappedFile;
+    struct MappedRegion;
+} // namespace rawcapture
+
+/**
+ * Writes frames into a raw capture file (see rawcapture). The file is grown in large
+ * preallocated segments that are memory-mapped, so writing a frame is a single copy and
+ * the operating system is responsible for flushing the pages to disk. Once half of a
+ * segment is in use, the next one is allocated in the background, so reserveFrame does
+ * not have to wait for the file system.
+ *
+ * The frame slots are reserved in the order in which the screenshots are taken, but the
+ * frames can be written from any thread and in any order afterwards.
+ */
+class RawCaptureWriter {
+public:
+    RawCaptureWriter(std::string path, ivec2 size, int nChannels, int bytesPerChannel,
+        bool isFloatingPoint = false, uint64_t segmentSize = rawcapture::SegmentSize);
+
+    /// Stores the final number of frames in the header and trims the preallocated space
+    ~RawCaptureWriter();
+
+    /// \return the index of the next free frame slot, which has to be passed to write
+    uint64_t reserveFrame();
+
+    /**
+     * Copies the pixels of a frame into the slot \p index that has been returned by
+     * reserveFrame. \p data has to point to frameSize bytes.
+     */
+    void writeFrame(uint64_t index, uint64_t frameNumber, const unsigned char* data);
+
+    /// \return the number of bytes of the pixels of a single frame
+    uint64_t frameSize() const;
+
+    const std::string& path() const;
+
+private:
+    struct Segment;
+
+    /// Grows the file by a segment and maps it; can be called from any thread
+    std::shared_ptr<Segment> createSegment(uint64_t segment);
+
+    std::string _path;
+    rawcapture::FileHeader _header;
+    uint64_t _frameSize = 0;
+    uint64_t _framesPerSegment = 0;
+    std::unique_ptr<rawcapture::MappedFile> _file;
+    std::unique_ptr<rawcapture::MappedRegion> _headerRegion;
+
+    std::mutex _mutex;
+    uint64_t _nFrames = 0;
+    std::vector<std::shared_ptr<Segment>> _segments;
+    // The segment after the last one in _segments while it is being created
+    std::future<std::shared_ptr<Segment>> _nextSegment;
+};
+
+/// Provides read access to the frames of a raw capture file by mapping the whole file
+class RawCaptureReader {
+public:
+    explicit RawCaptureReader(const std::string& path);
+    ~RawCaptureReader();
+
+    const rawcapture::FileHeader& header() const;
+
+    /// \return the number of frame slots in the file, including dropped frames
+    uint64_t numberOfFrames() const;
+
+    /// \return the pixels of frame \p index or nullptr if the frame was never written
+    const unsigned char* frame(uint64_t index) const;
+
+    /// \return the screenshot number of frame \p index
+    uint64_t frameNumber(uint64_t index) const;
+
+private:
+    rawcapture::FileHeader _header;
+    std::unique_ptr<rawcapture::MappedFile> _file;
+    std::unique_ptr<rawcapture::MappedRegion> _region;
+    uint64_t _frameSize = 0;
+    uint64_t _nFrames = 0;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__RAWCAPTURE__H__
@@ -10,39 +10,46 @@
 #define __SGCT__SCREENCAPTURE__H__
 
 #include <sgct/math.h>
-#include <functional>
+#include <array>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace sgct {
 
 class Image;
-
-/// This class is used internally by SGCT and is called when taking screenshots
+class RawCaptureWriter;
+
+/**
+ * This class is used internally by SGCT and is called when taking screenshots. The
+ * images are written to disk by the CaptureThreadPool that is shared by all windows and
+ * are handed back to this class afterwards, so that their memory can be reused.
+ *
+ * The pixels are read back asynchronously into a ring of pixel buffer objects. Each
+ * readback is guarded by a fence and the buffer is only mapped once the GPU has signaled
+ * the fence or when the buffer is needed again for a later screenshot, so that the copy
+ * overlaps with the rendering of the following frames instead of stalling the pipeline.
+ *
+ * With the Raw format, all screenshots are written into a single raw capture file that
+ * is named after the first screenshot and that is closed when the resolution changes.
+ */
 class ScreenCapture {
 public:
     /// The different file formats supported
-    enum class CaptureFormat { PNG, TGA, JPEG };
+    enum class CaptureFormat { PNG, TGA, JPEG, EXR, Raw };
     enum class CaptureSource { Texture, BackBuffer, LeftBackBuffer, RightBackBuffer };
     enum class EyeIndex { Mono, StereoLeft, StereoRight };
 
-    struct ScreenCaptureThreadInfo {
-        std::string filename;
-        std::unique_ptr<Image> frameBufferImage;
-        std::unique_ptr<std::thread> captureThread;
-        std::mutex* mutex = nullptr;
-        bool isRunning = false; // needed for test if running without join
-    };
-
     ScreenCapture();
     ~ScreenCapture();
 
     void initialize(int windowIndex, EyeIndex ei);
 
     /**
-     * Initializes the PBO or re-sizes it if the frame buffer size have changed.
+     * Initializes the PBOs or re-sizes them if the frame buffer size have changed. All
+     * readbacks that are still in flight are finished first.
      *
      * \param resolution the  pixel resolution of the frame buffer
      * \param channels the number of color channels
@@ -68,17 +75,56 @@ public:
     void saveScreenCapture(unsigned int textureId,
         CaptureSource capSrc = CaptureSource::Texture);
 
+    /**
+     * Hands all readbacks for which the GPU has already finished to the capture threads
+     * without waiting for those that are still in progress. This function should be
+     * called once per frame so that screenshots are written even if no further
+     * screenshots are taken.
+     */
+    void update();
+
 private:
+    /// The number of screenshots that can be read back from the GPU at the same time
+    static constexpr int NumberOfPBOs = 3;
+
+    struct Readback {
+        unsigned int pbo = 0;
+        void* fence = nullptr; // GLsync
+        std::string filename;
+        uint64_t frameNumber = 0;
+    };
+
+    /// Copies the pixels of \p readback to an image and passes it to the capture threads
+    void finishReadback(Readback& readback);
+
+    /// Finishes all readbacks that are in flight, waiting for the GPU if necessary
+    void finishAllReadbacks();
+
     std::string createFilename(uint64_t frameNumber);
-    int availableCaptureThread();
+
+    /// The format in which the screenshots are written, which is EXR for floating point
+    /// framebuffers that can't be stored in the selected 8 or 16 bit format
+    CaptureFormat effectiveFormat();
     void checkImageBuffer(CaptureSource captureSource);
-    Image* prepareImage(int index, std::string file);
+
+    /// Returns an image of the current size, reusing one from a finished job if possible
+    std::unique_ptr<Image> acquireImage();
+
+    /// Called by the capture threads when the \p image has been written or dropped
+    void finishJob(std::unique_ptr<Image> image);
 
     std::mutex _mutex;
-    std::vector<ScreenCaptureThreadInfo> _captureInfos;
+    std::condition_variable _jobFinished;
+    std::vector<std::unique_ptr<Image>> _freeImages;
+    int _nPendingJobs = 0;
+
+    /// Shared with the capture jobs so that the file is closed once the last one is done
+    std::shared_ptr<RawCaptureWriter> _rawWriter;
+
+    std::array<Readback, NumberOfPBOs> _readbacks;
+    int _firstReadback = 0; // the oldest readback that is in flight
+    int _nReadbacks = 0; // the number of readbacks that are in flight
 
-    unsigned int _nThreads;
-    unsigned int _pbo = 0;
     unsigned int _downloadFormat = 0x80E1; // GL_BGRA;
     unsigned int _downloadType = 0x1401; // GL_UNSIGNED_BYTE;
     unsigned int _downloadTypeSetByUser = _downloadType;
@@ -86,9 +132,11 @@ private:
     ivec2 _resolution = ivec2{ 0, 0 };
     int _nChannels = 0;
     int _bytesPerColor = 1;
+    bool _isFloatingPoint = false;
 
     EyeIndex _eyeIndex = EyeIndex::Mono;
     CaptureFormat _format = CaptureFormat::PNG;
+    bool _hasLoggedFormatChange = false;
     int _windowIndex = 0;
 };
 
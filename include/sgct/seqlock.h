@@ -0,0 +1,99 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#ifndef __SGCT__SEQLOCK__H__
+#define __SGCT__SEQLOCK__H__
+
+#include <sgct/framesignal.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace sgct {
+
+/**
+ * Publishes a value from a writer to any number of readers without the readers ever
+ * blocking the writer or each other. A reader that overlaps with a write retries until it
+ * has read a consistent copy of the value, so reading is cheap as long as writes are
+ * short and infrequent compared to the reads.
+ *
+ * Concurrent calls to store have to be serialized by the caller. The value is copied
+ * word by word through atomics, which is why T has to be trivially copyable.
+ */
+template <typename T>
+class SeqLock {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+    SeqLock() : SeqLock(T()) {}
+    explicit SeqLock(const T& value) {
+        for (std::atomic_uint64_t& word : _words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+        store(value);
+    }
+
+    void store(const T& value) {
+        std::array<uint64_t, NumberOfWords> words = {};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        // An odd sequence number marks a write that is in progress
+        const uint64_t sequence = _sequence.load(std::memory_order_relaxed);
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < NumberOfWords; i++) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        std::array<uint64_t, NumberOfWords> words;
+        for (int attempt = 0; true; attempt++) {
+            if (attempt >= MaxSpins) {
+                // The writer has probably been preempted in the middle of a store and
+                // can only finish it if we give up our time slice
+                std::this_thread::yield();
+            }
+            else if (attempt > 0) {
+                cpuRelax();
+            }
+
+            const uint64_t sequence = _sequence.load(std::memory_order_acquire);
+            if (sequence % 2 == 1) {
+                continue;
+            }
+            for (size_t i = 0; i < NumberOfWords; i++) {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr int MaxSpins = 64;
+    static constexpr size_t NumberOfWords =
+        (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic_uint64_t _sequence = 0;
+    std::array<std::atomic_uint64_t, NumberOfWords> _words;
+};
+
+} // namespace sgct
+
+#endif // __SGCT__SEQLOCK__H__
@@ -24,7 +24,8 @@ namespace config {
 /// This singleton class will hold global SGCT settings.
 class Settings {
 public:
-    enum class CaptureFormat { PNG, TGA, JPG };
+    enum class CaptureFormat { PNG, TGA, JPG, EXR, Raw };
+    enum class CaptureQueuePolicy { Block, DropOldest, DropNewest };
 
     enum class DrawBufferType {
         Diffuse,
@@ -75,6 +76,15 @@ public:
     /// Set the number of capture threads used by SGCT (multi-threaded screenshots)
     void setNumberOfCaptureThreads(int count);
 
+    /// Set the number of screenshots that can wait for a free capture thread
+    void setCaptureQueueSize(int size);
+
+    /// Set what happens to a new screenshot if the capture queue is full
+    void setCaptureQueuePolicy(CaptureQueuePolicy policy);
+
+    /// Set to true if screenshots should be compressed faster at the cost of file size
+    void setCaptureFastEncoding(bool state);
+
     /**
      * Set capture/screenshot path used by SGCT.
      *
@@ -103,6 +113,38 @@ public:
     /// If set to true, the window name is added to screenshots
     void setAddWindowNameToScreenshot(bool state);
 
+    /**
+     * Set the folder in which decoded images are cached between runs. An empty path
+     * disables the cache.
+     */
+    void setTextureCachePath(std::string path);
+
+    /**
+     * Set the maximum number of bytes of texture data that are uploaded per frame for
+     * textures that are loaded asynchronously.
+     */
+    void setTextureUploadBudget(int bytes);
+
+    /**
+     * Set the folder into which each node writes a trace with the timings of every frame.
+     * An empty path disables the trace.
+     */
+    void setFrameTracePath(std::string path);
+
+    /**
+     * Set the folder in which the warping meshes are cached between runs. An empty path
+     * disables the cache.
+     */
+    void setMeshCachePath(std::string path);
+
+    /**
+     * Enables the optimization of warping meshes after they have been loaded. Flat
+     * regions of a mesh are simplified as long as no position, texture coordinate, or
+     * color changes by more than \p maxError. If \p maxError is 0, the meshes are only
+     * reordered for rendering.
+     */
+    void setMeshSimplificationError(float maxError);
+
     /// Get the capture/screenshot path.
     const std::string& capturePath() const;
 
@@ -149,6 +191,18 @@ public:
     /// Get the number of capture threads (for screenshot recording)
     int numberCaptureThreads() const;
 
+    /**
+     * Get the number of screenshots that can wait for a free capture thread. If no size
+     * was set, the queue holds twice as many screenshots as there are capture threads.
+     */
+    int captureQueueSize() const;
+
+    /// Get what happens to a new screenshot if the capture queue is full
+    CaptureQueuePolicy captureQueuePolicy() const;
+
+    /// Get whether screenshots are compressed faster at the cost of file size
+    bool captureFastEncoding() const;
+
     /// Returns whether screenshots should contain the node name
     bool addNodeNameToScreenshot() const;
 
@@ -158,6 +212,22 @@ public:
     /// Returns the prefix that is used for all screenshots
     const std::string& prefixScreenshot() const;
 
+    /// Returns the folder in which decoded images are cached or an empty string
+    const std::string& textureCachePath() const;
+
+    /// Returns the number of bytes of asynchronously loaded textures uploaded per frame
+    int textureUploadBudget() const;
+
+    /// Returns the folder for the frame traces or an empty string if they are disabled
+    const std::string& frameTracePath() const;
+
+    /// Returns the folder in which warping meshes are cached or an empty string
+    const std::string& meshCachePath() const;
+
+    /// Returns the maximum error for the simplification of warping meshes or an empty
+    /// optional if the meshes are used as they are loaded
+    std::optional<float> meshSimplificationError() const;
+
     /// Returns true if the screenshots written out should be limited based on the begin
     /// and end ranges
     bool hasScreenshotLimit() const;
@@ -183,11 +253,14 @@ private:
     int _swapInterval = 1;
     int _refreshRate = 0;
     int _nCaptureThreads = std::max(std::thread::hardware_concurrency() - 1, 0u);
+    std::optional<int> _captureQueueSize;
+    CaptureQueuePolicy _captureQueuePolicy = CaptureQueuePolicy::Block;
 
     bool _useDepthTexture = false;
     bool _useNormalTexture = false;
     bool _usePositionTexture = false;
     bool _captureBackBuffer = false;
+    bool _captureFastEncoding = false;
     bool _exportWarpingMeshes = false;
     
     struct Capture {
@@ -204,6 +277,11 @@ private:
 
     };
     Capture _screenshot;
+    std::string _textureCachePath;
+    int _textureUploadBudget = 16 * 1024 * 1024;
+    std::string _frameTracePath;
+    std::string _meshCachePath;
+    std::optional<float> _meshSimplificationError;
 
     BufferFloatPrecision _bufferFloatPrecision = BufferFloatPrecision::Float32Bit;
 };
@@ -29,6 +29,15 @@ public:
     static void destroy();
 
     void setEncodeFunction(std::function<std::vector<std::byte>()> function);
+
+    /**
+     * Sets a function that serializes the shared data directly into the provided buffer.
+     * The buffer is empty when the function is called, but it keeps its capacity between
+     * frames, so that no allocations are necessary once the size of the shared data has
+     * settled. If this function is set, the function passed to setEncodeFunction is not
+     * called.
+     */
+    void setEncodeToBufferFunction(std::function<void(std::vector<std::byte>&)> function);
     void setDecodeFunction(
         std::function<void(const std::vector<std::byte>&, unsigned int)> function);
 
@@ -38,20 +47,45 @@ public:
     /// This function is called internally by SGCT and shouldn't be used by the user.
     void decode(const char* receivedData, int receivedLength);
 
-    unsigned char* dataBlock();
-    int dataSize();
-    int bufferSize();
+    /**
+     * Reconstructs the full data block by applying the received delta to the previously
+     * decoded data block and then calls the decode callback with the result. This
+     * function is called internally by SGCT and shouldn't be used by the user.
+     */
+    void decodeDelta(const char* receivedData, int receivedLength);
+
+    /// \return the encoded shared data of the current frame without any network header
+    const unsigned char* dataBlock() const;
+    int dataSize() const;
+    int bufferSize() const;
+
+    /**
+     * \return the block containing the difference between the current and the previous
+     *         data block without any network header. Only valid if deltaSize() is bigger
+     *         than 0
+     */
+    const unsigned char* deltaBlock() const;
+
+    /**
+     * \return the size of the delta block. Returns 0 if delta synchronization is
+     *         disabled, if there was no previous frame, or if the delta would not have
+     *         been smaller than the full data block
+     */
+    int deltaSize() const;
 
 private:
     SharedData();
 
     // function pointers
     std::function<std::vector<std::byte>()> _encodeFn;
+    std::function<void(std::vector<std::byte>&)> _encodeToBufferFn;
     std::function<void(const std::vector<std::byte>&, unsigned int)> _decodeFn;
 
     static SharedData* _instance;
     std::vector<std::byte> _dataBlock;
-    std::array<std::byte, Network::HeaderSize> _headerSpace;
+    std::vector<std::byte> _previousDataBlock;
+    std::vector<std::byte> _deltaBlock;
+    bool _hasEncoded = false;
 };
 
 template <typename T>
@@ -9,6 +9,9 @@
 #ifndef __SGCT__TEXTUREMANAGER__H__
 #define __SGCT__TEXTUREMANAGER__H__
 
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -19,10 +22,19 @@ class Image;
 /**
  * The TextureManager loads and handles textures. It is a singleton and can be accessed
  * anywhere using its static instance. Currently only PNG textures are supported.
+ *
+ * Textures can either be loaded synchronously with loadTexture or in the background with
+ * loadTextureAsync. For the latter, the image is decoded on the ImageLoader threads and
+ * the pixels are streamed into the texture through a pixel buffer object once per frame
+ * in the shared context, but never more than the texture upload budget of the Settings
+ * per frame so that loading large images does not cause hitches in the rendering.
  */
 class TextureManager {
 public:
+    /// Creates the manager on first use. This function can be called from any thread
     static TextureManager& instance();
+
+    /// Deletes the manager, which must no longer be in use by any other thread
     static void destroy();
 
     /**
@@ -53,6 +65,51 @@ public:
     unsigned int loadTexture(Image img, bool interpolate = true,
         float anisotropicFilterSize = 1.f, int mipmapLevels = 8);
 
+    /**
+     * Starts loading a texture in the background and returns immediately. The image is
+     * decoded on a worker thread and uploaded over the course of one or more of the
+     * following frames. This function can be called from any thread.
+     *
+     * \param filename the filename or path to the texture
+     * \param interpolate set to true for using interpolation (bi-linear filtering)
+     * \param anisotropicFilterSize The filter size that is used for the anisotropic
+     *        filtering. If this value is 1.f, only bilinear filtering is used
+     * \param mipmapLevels is the number of mipmap levels that will be generated, setting
+              this value to 1 or less disables mipmaps
+     * \return A future that becomes ready with the OpenGL name for the texture as soon
+     *         as the texture can be used for rendering. If the image could not be loaded,
+     *         the future rethrows the error instead
+     */
+    std::shared_future<unsigned int> loadTextureAsync(std::string filename,
+        bool interpolate = true, float anisotropicFilterSize = 1.f,
+        int mipmapLevels = 8);
+
+    /**
+     * Starts uploading the image that is produced by \p image in the background and
+     * returns immediately. This can be used together with ImageLoader::decode for images
+     * that are not stored in a file. This function can be called from any thread.
+     *
+     * \param image The future that provides the image with the texture data
+     * \param interpolate set to true for using interpolation (bi-linear filtering)
+     * \param anisotropicFilterSize The filter size that is used for the anisotropic
+     *        filtering. If this value is 1.f, only bilinear filtering is used
+     * \param mipmapLevels is the number of mipmap levels that will be generated, setting
+              this value to 1 or less disables mipmaps
+     * \return A future that becomes ready with the OpenGL name for the texture as soon
+     *         as the texture can be used for rendering. If the image could not be loaded,
+     *         the future rethrows the error instead
+     */
+    std::shared_future<unsigned int> loadTextureAsync(std::future<Image> image,
+        bool interpolate = true, float anisotropicFilterSize = 1.f,
+        int mipmapLevels = 8);
+
+    /**
+     * Continues the uploads of the textures that were requested with loadTextureAsync.
+     * This function is called once per frame by the Engine with the shared context being
+     * active and uploads at most the texture upload budget from the Settings.
+     */
+    void update();
+
     /**
      * Removes a previously generated OpenGL texture.
      *
@@ -62,9 +119,28 @@ public:
     void removeTexture(unsigned int textureId);
 
 private:
+    struct PendingUpload;
+
+    TextureManager();
     ~TextureManager();
+
+    std::shared_future<unsigned int> addUpload(std::future<Image> image,
+        std::string name, bool interpolate, float anisotropicFilterSize,
+        int mipmapLevels);
+
+    /// Uploads the next rows of \p pending and returns the number of bytes that were used
+    size_t upload(PendingUpload& pending, size_t budget);
+
     static TextureManager* _instance;
     std::vector<unsigned int> _textures;
+
+    // Requests that are added from other threads and picked up in the next update
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<PendingUpload>> _requests;
+
+    std::vector<std::unique_ptr<PendingUpload>> _uploads;
+    unsigned int _pixelBuffer = 0;
+    const size_t _uploadBudget;
 };
 
 } // namespace sgct
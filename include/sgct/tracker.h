@@ -10,7 +10,9 @@
 #define __SGCT__TRACKER__H__
 
 #include <sgct/math.h>
+#include <sgct/seqlock.h>
 #include <sgct/trackingdevice.h>
+#include <atomic>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -23,7 +25,7 @@ public:
     explicit Tracker(std::string name);
 
     void setEnabled(bool state);
-    void addDevice(std::string name, int index);
+    void addDevice(std::string name);
 
     const std::vector<std::unique_ptr<TrackingDevice>>& devices() const;
 
@@ -53,8 +55,10 @@ private:
 
     std::vector<std::unique_ptr<TrackingDevice>> _trackingDevices;
 
-    double _scale = 1.0;
-    mat4 _transform = mat4(1.f);
+    // The scale and transform are read by the sampling thread for every sample
+    std::atomic<double> _scale = 1.0;
+    SeqLock<mat4> _transform = SeqLock<mat4>(mat4(1.f));
+    // Only used to compute the transform, guarded by mutex::Tracking
     mat4 _orientation = mat4(1.f);
     vec3 _offset = vec3{ 0.f, 0.f, 0.f };
 };
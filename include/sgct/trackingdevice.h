@@ -10,16 +10,28 @@
 #define __SGCT__TRACKINGDEVICE__H__
 
 #include <sgct/math.h>
+#include <sgct/seqlock.h>
+#include <atomic>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace sgct {
 
-/// Helper class that holds tracking device/sensor data
+class Tracker;
+
+/**
+ * Helper class that holds tracking device/sensor data. The values are written by the
+ * thread that samples the tracker and are published without locks, so reading them from
+ * the render thread never has to wait for the sampling thread.
+ */
 class TrackingDevice {
 public:
+    /// The number of seconds that a pose is extrapolated past its newest sample at most
+    static constexpr double MaxPrediction = 0.1;
+
     /// Constructor
-    TrackingDevice(int parentIndex, std::string name);
+    TrackingDevice(const Tracker& parent, std::string name);
 
     /// Set if this device is enabled or not
     void setEnabled(bool state);
@@ -27,12 +39,20 @@ public:
     /// Set the id for this sensor
     void setSensorId(int id);
 
-    /// Set the number of digital buttons
+    /// Set the number of digital buttons. The buttons are read and written without locks,
+    /// so this has to happen before the device is sampled or read for the first time
     void setNumberOfButtons(int numOfButtons);
 
-    /// Set the number of analog axes
+    /// Set the number of analog axes. The axes are read and written without locks, so
+    /// this has to happen before the device is sampled or read for the first time
     void setNumberOfAxes(int numOfAxes);
     void setSensorTransform(vec3 vec, quat rot);
+
+    /**
+     * Set the position and rotation of the sensor that was sampled at \p timestamp. The
+     * samples of a device have to be set from a single thread with increasing timestamps.
+     */
+    void setSensorTransform(vec3 vec, quat rot, double timestamp);
     void setButtonValue(bool val, int index);
     void setAnalogValue(const double* array, int size);
 
@@ -48,6 +68,15 @@ public:
     /// Set the device transform matrix
     void setTransform(mat4 mat);
 
+    /**
+     * Enables the prediction of the pose of this device if \p latency has a value. The
+     * head transform of a user is then extrapolated to the point in time at which the
+     * frame is expected to be displayed, delayed by the additional \p latency in seconds
+     * of the display system.
+     */
+    void setPredictionLatency(std::optional<double> latency);
+    std::optional<double> predictionLatency() const;
+
     const std::string& name() const;
     int numberOfButtons() const;
     int numberOfAxes() const;
@@ -70,7 +99,7 @@ public:
     bool hasAnalogs() const;
 
     /// \return the id of this device/sensor
-    int sensorId();
+    int sensorId() const;
 
     /// \return the sensor's position in world coordinates
     vec3 position() const;
@@ -108,8 +137,16 @@ public:
     /// \return the raw sensor position vector
     vec3 sensorPositionPrevious() const;
 
-    double trackerTimeStamp();
-    double trackerTimeStampPrevious();
+    /**
+     * \return the sensor's transform matrix in world coordinates that is extrapolated
+     *         from the last two samples to \p time under the assumption that the sensor
+     *         moves with a constant linear and angular velocity. The extrapolation is
+     *         limited to MaxPrediction seconds past the last sample
+     */
+    mat4 predictedWorldTransform(double time) const;
+
+    double trackerTimeStamp() const;
+    double trackerTimeStampPrevious() const;
 
     double analogTimeStamp() const;
     double analogTimeStampPrevious() const;
@@ -121,43 +158,45 @@ public:
     double buttonDeltaTime(int index) const;
 
 private:
+    struct Sample {
+        vec3 position = vec3{ 0.f, 0.f, 0.f };
+        quat rotation = quat{ 0.f, 0.f, 0.f, 0.f };
+        mat4 worldTransform = mat4(1.f);
+        double timestamp = 0.0;
+    };
+    struct Sensor {
+        Sample current;
+        Sample previous;
+        uint64_t nSamples = 0;
+    };
+    template <typename T>
+    struct Value {
+        T current = T();
+        T previous = T();
+        double time = 0.0;
+        double timePrevious = 0.0;
+    };
+
+    mat4 worldTransform(vec3 position, quat rotation) const;
     void calculateTransform();
-    void setTrackerTimeStamp();
-    void setAnalogTimeStamp();
-    void setButtonTimeStamp(int index);
 
-    bool _isEnabled = true;
+    std::atomic_bool _isEnabled = true;
     const std::string _name;
-    const int _parentIndex; // the index of parent Tracker
+    const Tracker& _parent;
     int _nButtons = 0;
     int _nAxes = 0;
     int _sensorId = -1;
+    // Negative if the pose is not predicted
+    std::atomic<double> _predictionLatency = -1.0;
 
-    mat4 _deviceTransform = mat4(1.f);
-
-    mat4 _worldTransform = mat4(1.f);
-    mat4 _worldTransformPrevious = mat4(1.f);
-
-    quat _sensorRotation = quat{ 0.f, 0.f, 0.f, 0.f };
-    quat _sensorRotationPrevious = quat{ 0.f, 0.f, 0.f, 0.f };
-
-    vec3 _sensorPos = vec3{ 0.f, 0.f, 0.f };
-    vec3 _sensorPosPrevious = vec3{ 0.f, 0.f, 0.f };
+    SeqLock<mat4> _deviceTransform = SeqLock<mat4>(mat4(1.f));
+    // Only used to compute the device transform, guarded by mutex::Tracking
     quat _orientation = quat{ 0.f, 0.f, 0.f, 0.f };
     vec3 _offset = vec3{ 0.f, 0.f, 0.f };
 
-    double _trackerTime = 0.0;
-    double _trackerTimePrevious = 0.0;
-
-    double _analogTime = 0.0;
-    double _analogTimePrevious = 0.0;
-
-    std::vector<double> _buttonTime;
-    std::vector<double> _buttonTimePrevious;
-    std::vector<bool> _buttons;
-    std::vector<bool> _buttonsPrevious;
-    std::vector<double> _axes;
-    std::vector<double> _axesPrevious;
+    SeqLock<Sensor> _sensor;
+    std::vector<SeqLock<Value<bool>>> _buttons;
+    std::vector<SeqLock<Value<double>>> _axes;
 };
 
 } // namespace sgct
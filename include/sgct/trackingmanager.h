@@ -10,6 +10,7 @@
 #define __SGCT__TRACKINGMANAGER__H__
 
 #include <sgct/tracker.h>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string_view>
@@ -37,8 +38,12 @@ public:
 
     void startSampling();
 
-    /// Update the user position if headtracking is used. The engine calls this function
-    void updateTrackingDevices();
+    /**
+     * Update the user position if headtracking is used. The engine calls this function
+     * with the point in time at which the frame that is about to be rendered is expected
+     * to be displayed, which is used if the head device predicts its pose.
+     */
+    void updateTrackingDevices(double displayTime);
     void addTracker(std::string name);
 
     TrackingDevice* headDevice() const;
@@ -67,8 +72,8 @@ private:
     std::unique_ptr<std::thread> _samplingThread;
     std::vector<std::unique_ptr<Tracker>> _trackers;
     std::set<std::string> _addresses;
-    double _samplingTime = 0.0;
-    bool _isRunning = true;
+    std::atomic<double> _samplingTime = 0.0;
+    std::atomic_bool _isRunning = true;
 
     User* _headUser = nullptr;
     TrackingDevice* _head = nullptr;
@@ -12,6 +12,8 @@
 #include <sgct/baseviewport.h>
 
 #include <sgct/correctionmesh.h>
+#include <sgct/image.h>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,7 +44,26 @@ public:
 
     void applyViewport(const sgct::config::Viewport& viewport);
     void applySettings(const sgct::config::MpcdiProjection& mpcdi);
-    void setMpcdiWarpMesh(std::vector<char> data);
+    void setMpcdiWarpMesh(correction::Buffer mesh);
+
+    /**
+     * Uses the images that were decoded from the alpha and beta maps of an MPCDI region
+     * as the blend mask and black level mask of this viewport. Empty images are ignored.
+     */
+    void setMpcdiMasks(Image blendMask, Image blackLevelMask);
+
+    /**
+     * Starts decoding the overlay and mask images and generating the meshes of this
+     * viewport and its non-linear projection in the background. The meshes of the
+     * projection are uploaded by initialize, the rest by loadData.
+     */
+    void prepareData();
+
+    /**
+     * Uploads the overlay, the masks, and the meshes of this viewport. If prepareData has
+     * not been called before, they are loaded now. Has to be called on the thread that
+     * owns the OpenGL context.
+     */
     void loadData();
 
     /// Render the viewport mesh which the framebuffer texture is attached to
@@ -63,7 +84,6 @@ public:
     unsigned int blendMaskTextureIndex() const;
     unsigned int blackLevelMaskTextureIndex() const;
     NonLinearProjection* nonLinearProjection() const;
-    const std::vector<char>& mpcdiWarpMesh() const;
 
 private:
     void applyPlanarProjection(const config::PlanarProjection& proj);
@@ -74,6 +94,9 @@ private:
     void applyEquirectangularProjection(const config::EquirectangularProjection& proj);
     void applySphericalMirrorProjection(const config::SphericalMirrorProjection& proj);
 
+    void prepareImagesAndMesh();
+    std::string meshPath() const;
+
     CorrectionMesh _mesh;
     std::string _overlayFilename;
     std::string _blendMaskFilename;
@@ -84,10 +107,18 @@ private:
     unsigned int _blendMaskTextureIndex = 0;
     unsigned int _blackLevelMaskTextureIndex = 0;
 
+    bool _isDataPrepared = false;
+    std::future<Image> _overlayImage;
+    std::future<Image> _blendMaskImage;
+    std::future<Image> _blackLevelMaskImage;
+
     // @TODO (abock, 2020-01-06) This can be replace with a std::variant as we have a
     // fixed list of overloads and this would remove the virtual function calls
     std::unique_ptr<NonLinearProjection> _nonLinearProjection;
-    std::vector<char> _mpcdiWarpMesh;
+
+    // The mesh is handed over to _mesh when it is prepared, so only the flag remains
+    bool _hasMpcdiWarpMesh = false;
+    correction::Buffer _mpcdiWarpMesh;
 };
 
 } // namespace sgct
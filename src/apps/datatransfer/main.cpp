@@ -7,6 +7,7 @@
  ****************************************************************************************/
 
 #include <sgct/sgct.h>
+#include <sgct/imageloader.h>
 #include <sgct/opengl.h>
 #include <sgct/utils/box.h>
 #define GLFW_INCLUDE_NONE
@@ -15,14 +16,11 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <algorithm>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <mutex>
 
 namespace {
-    std::unique_ptr<std::thread> loadThread;
-    std::mutex imageMutex;
-    GLFWwindow* hiddenWindow;
-    GLFWwindow* sharedWindow;
-    std::unique_ptr<sgct::Image> transImg;
     unsigned int textureId = 0;
 
     bool stats = false;
@@ -30,13 +28,14 @@ namespace {
 
     int32_t currentPackage = -1;
     bool transfer = false;
-    bool serverUploadDone = false;
+    bool uploadPending = false;
     bool clientsUploadDone = false;
     std::vector<std::string> imagePaths;
-    std::vector<GLuint> texIds;
     double sendTimer = 0.0;
 
-    bool isRunning = true;
+    // The textures are added from the network thread on the clients
+    std::mutex textureMutex;
+    std::vector<std::shared_future<unsigned int>> textures;
 
     std::unique_ptr<sgct::utils::Box> box;
     GLint matrixLoc = -1;
@@ -73,17 +72,38 @@ namespace {
 
 using namespace sgct;
 
-void readImage(unsigned char* data, int len) {
-    std::unique_lock lk(imageMutex);
+void loadTexture(std::vector<unsigned char> data) {
+    // The image is decoded on the image loader threads and uploaded over the next frames
+    std::shared_future<unsigned int> tex = TextureManager::instance().loadTextureAsync(
+        ImageLoader::instance().decode(std::move(data)),
+        true
+    );
+
+    std::unique_lock lk(textureMutex);
+    textures.push_back(std::move(tex));
+}
 
-    transImg = std::make_unique<Image>();
+bool isUploadFinished(int index) {
+    std::unique_lock lk(textureMutex);
+    if (index < 0 || index >= static_cast<int>(textures.size())) {
+        return false;
+    }
+    const std::future_status s = textures[index].wait_for(std::chrono::seconds(0));
+    return s == std::future_status::ready;
+}
 
+unsigned int uploadedTexture(int index) {
+    if (!isUploadFinished(index)) {
+        return 0;
+    }
+
+    std::unique_lock lk(textureMutex);
     try {
-        transImg->load(data, len);
+        return textures[index].get();
     }
-    catch (const std::runtime_error& e) {
-        Log::Error(e.what());
-        transImg = nullptr;
+    catch (const std::exception&) {
+        // The image could not be loaded
+        return 0;
     }
 }
 
@@ -108,123 +128,16 @@ void startDataTransfer() {
     const std::streamsize size = file.tellg();
     file.seekg(0, std::ios::beg);
 
-    std::vector<char> buffer(size);
-    if (file.read(buffer.data(), size)) {
-        const int s = static_cast<int>(size);
-        NetworkManager::instance().transferData(buffer.data(), s, id);
-
-        // read the image on master
-        readImage(reinterpret_cast<unsigned char*>(buffer.data()), s);
-    }
-}
-
-void uploadTexture() {
-    std::unique_lock lk(imageMutex);
-
-    if (!transImg) {
-        // if invalid load
-        texIds.push_back(0);
-        return;
-    }
-
-    glfwMakeContextCurrent(hiddenWindow);
-
-    // create texture
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    GLenum internalformat;
-    GLenum type;
-
-    size_t bpc = transImg->bytesPerChannel();
-
-    switch (transImg->channels()) {
-    case 1:
-        internalformat = (bpc == 1 ? GL_R8 : GL_R16);
-        type = GL_RED;
-        break;
-    case 2:
-        internalformat = (bpc == 1 ? GL_RG8 : GL_RG16);
-        type = GL_RG;
-        break;
-    case 3:
-    default:
-        internalformat = (bpc == 1 ? GL_RGB8 : GL_RGB16);
-        type = GL_BGR;
-        break;
-    case 4:
-        internalformat = (bpc == 1 ? GL_RGBA8 : GL_RGBA16);
-        type = GL_BGRA;
-        break;
+    auto buffer = std::make_shared<std::vector<char>>(size);
+    std::vector<unsigned char> data;
+    if (file.read(buffer->data(), size)) {
+        // The package is sent in the background while the image is loaded on the master
+        NetworkManager::instance().transferDataAsync(buffer, id);
+        data.assign(buffer->begin(), buffer->end());
     }
 
-    int mipMapLevels = 8;
-    GLenum format = (bpc == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
-
-    glTexStorage2D(
-        GL_TEXTURE_2D,
-        mipMapLevels,
-        internalformat,
-        transImg->size().x,
-        transImg->size().y
-    );
-    glTexSubImage2D(
-        GL_TEXTURE_2D,
-        0,
-        0,
-        0,
-        transImg->size().x,
-        transImg->size().y,
-        type,
-        format,
-        transImg->data()
-    );
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipMapLevels - 1);
-
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    Log::Info(fmt::format(
-        "Texture id {} loaded ({}x{}x{}).",
-        tex, transImg->size().x, transImg->size().y, transImg->channels()
-    ));
-
-    texIds.push_back(tex);
-    transImg = nullptr;
-
-    glFinish();
-    glfwMakeContextCurrent(nullptr);
-}
-
-void threadWorker() {
-    while (isRunning) {
-        // runs only on master
-        if (transfer && !serverUploadDone && !clientsUploadDone) {
-            startDataTransfer();
-            transfer = false;
-
-            // load texture on master
-            uploadTexture();
-            serverUploadDone = true;
-
-            if (ClusterManager::instance().numberOfNodes() == 1) {
-                // no cluster
-                clientsUploadDone = true;
-            }
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    // An image that could not be read fails to load, but keeps the indices in sync
+    loadTexture(std::move(data));
 }
 
 void draw(const RenderData& data) {
@@ -250,12 +163,9 @@ void draw(const RenderData& data) {
 
     glActiveTexture(GL_TEXTURE0);
 
-    if (texIndex != -1) {
-        glBindTexture(GL_TEXTURE_2D, texIds[texIndex]);
-    }
-    else {
-        glBindTexture(GL_TEXTURE_2D, textureId);
-    }
+    // Until the transferred texture has been uploaded on this node, the box is used
+    const unsigned int tex = uploadedTexture(texIndex);
+    glBindTexture(GL_TEXTURE_2D, tex != 0 ? tex : textureId);
 
     ShaderManager::instance().shaderProgram("xform").bind();
     glUniformMatrix4fv(matrixLoc, 1, GL_FALSE, glm::value_ptr(mvp));
@@ -270,10 +180,26 @@ void preSync() {
     if (Engine::instance().isMaster()) {
         currentTime = Engine::getTime();
 
+        if (transfer && !uploadPending) {
+            transfer = false;
+            startDataTransfer();
+            uploadPending = true;
+
+            if (ClusterManager::instance().numberOfNodes() == 1) {
+                // no cluster
+                clientsUploadDone = true;
+            }
+        }
+
         // if texture is uploaded then iterate the index
-        if (serverUploadDone && clientsUploadDone) {
+        if (uploadPending && isUploadFinished(currentPackage) && clientsUploadDone) {
+            if (uploadedTexture(currentPackage) == 0) {
+                Log::Error(fmt::format(
+                    "Failed to load image '{}'", imagePaths[currentPackage]
+                ));
+            }
             texIndex++;
-            serverUploadDone = false;
+            uploadPending = false;
             clientsUploadDone = false;
         }
     }
@@ -283,22 +209,7 @@ void postSyncPreDraw() {
     Engine::instance().setStatsGraphVisibility(stats);
 }
 
-void initOGL(GLFWwindow* win) {
-    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-
-    sharedWindow = win;
-    hiddenWindow = glfwCreateWindow(1, 1, "Thread Window", nullptr, sharedWindow);
-
-    if (!hiddenWindow) {
-        Log::Info("Failed to create loader context");
-    }
-
-    glfwMakeContextCurrent(sharedWindow);
-
-    if (Engine::instance().isMaster()) {
-        loadThread = std::make_unique<std::thread>(threadWorker);
-    }
-
+void initOGL(GLFWwindow*) {
     textureId = TextureManager::instance().loadTexture("box.png", true, 8.f);
     box = std::make_unique<utils::Box>(2.f, utils::Box::TextureMappingMode::Regular);
 
@@ -331,17 +242,9 @@ void decode(const std::vector<std::byte>& data, unsigned int pos) {
 void cleanup() {
     box = nullptr;
 
-    for (size_t i = 0; i < texIds.size(); i++) {
-        GLuint tex = texIds[i];
-        if (tex) {
-            glDeleteTextures(1, &tex);
-        }
-    }
-    texIds.clear();
-
-    if (hiddenWindow) {
-        glfwDestroyWindow(hiddenWindow);
-    }
+    // The textures themselves are owned by the TextureManager
+    std::unique_lock lk(textureMutex);
+    textures.clear();
 }
 
 void keyboard(Key key, Modifier, Action action, int) {
@@ -366,9 +269,10 @@ void dataTransferDecoder(void* data, int length, int packageId, int clientIndex)
 
     currentPackage = packageId;
 
-    // read the image on master
-    readImage(reinterpret_cast<unsigned char*>(data), length);
-    uploadTexture();
+    // The acknowledgement is sent as soon as we return, so the texture might only become
+    // available a few frames after the master has switched to it
+    const unsigned char* d = reinterpret_cast<unsigned char*>(data);
+    loadTexture(std::vector<unsigned char>(d, d + length));
 }
 
 void dataTransferStatus(bool connected, int clientIndex) {
@@ -390,7 +294,7 @@ void dataTransferAcknowledge(int packageId, int clientIndex) {
             counter = 0;
 
             Log::Info(fmt::format(
-                "Time to distribute and upload textures on cluster: {} ms",
+                "Time to distribute textures on cluster: {} ms",
                 (Engine::getTime() - sendTimer) * 1000.0
             ));
         }
@@ -454,13 +358,6 @@ int main(int argc, char** argv) {
     }
 
     Engine::instance().render();
-
-    isRunning = false;
-    if (loadThread) {
-        loadThread->join();
-        loadThread = nullptr;
-    }
-
     Engine::destroy();
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,269 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/frametrace.h>
+#include <sgct/log.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Combines the frame traces of all nodes of a cluster into a single file. The timestamps
+// of all traces are already expressed in the cluster timebase, so the records of the
+// nodes only have to be aligned by their frame number. The output is either a CSV file
+// with one row per node and frame or a JSON file in the Chrome trace event format that
+// can be opened in chrome://tracing or https://ui.perfetto.dev
+//
+// Usage: frametracemerge <output (.csv or .json)> <trace files...>
+
+using namespace sgct;
+
+namespace {
+    struct Node {
+        frametrace::FileHeader header;
+        std::vector<frametrace::Record> records;
+    };
+
+    // All records of a single frame, indexed by the position of the node in the input
+    using Frame = std::vector<const frametrace::Record*>;
+
+    std::map<int, Frame> alignFrames(const std::vector<Node>& nodes) {
+        std::map<int, Frame> frames;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            for (const frametrace::Record& record : nodes[i].records) {
+                Frame& frame = frames[record.frame];
+                frame.resize(nodes.size(), nullptr);
+                frame[i] = &record;
+            }
+        }
+        return frames;
+    }
+
+    // Escapes the characters that are not allowed in a JSON string
+    std::string escapeJson(std::string_view value) {
+        std::string res;
+        res.reserve(value.size());
+        for (char c : value) {
+            switch (c) {
+                case '"':  res += "\\\""; break;
+                case '\\': res += "\\\\"; break;
+                case '\n': res += "\\n"; break;
+                case '\r': res += "\\r"; break;
+                case '\t': res += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        res += fmt::format("\\u{:04x}", static_cast<int>(c));
+                    }
+                    else {
+                        res += c;
+                    }
+            }
+        }
+        return res;
+    }
+
+    // The point in time at which the frame became visible on the slowest node
+    double latestSwap(const Frame& frame) {
+        double res = 0.0;
+        for (const frametrace::Record* record : frame) {
+            if (record) {
+                res = std::max(res, record->swapEnd);
+            }
+        }
+        return res;
+    }
+
+    void writeCsv(const std::string& path, const std::vector<Node>& nodes,
+                  const std::map<int, Frame>& frames)
+    {
+        std::ofstream file(path);
+        file << "frame,node,address,master,frameTime,drawTime,syncTime,loopTimeMin,"
+            "loopTimeMax,encodeSize,decodeSize,encode,send,receive,decode,draw,ack,"
+            "swapBegin,swapEnd,swapSkew,clockOffset,roundTripTime\n";
+
+        for (const auto& [number, frame] : frames) {
+            // The skew is measured against the first node that finished the swap
+            double firstSwap = std::numeric_limits<double>::max();
+            for (const frametrace::Record* record : frame) {
+                if (record) {
+                    firstSwap = std::min(firstSwap, record->swapEnd);
+                }
+            }
+
+            for (size_t i = 0; i < frame.size(); i++) {
+                const frametrace::Record* r = frame[i];
+                if (!r) {
+                    continue;
+                }
+
+                const frametrace::FileHeader& header = nodes[i].header;
+                file << fmt::format(
+                    "{},{},{},{},{:.9f},{:.9f},{:.9f},{:.9f},{:.9f},{},{},{:.9f},{:.9f},"
+                    "{:.9f},{:.9f},{:.9f},{:.9f},{:.9f},{:.9f},{:.9f},{:.9f},{:.9f}\n",
+                    number, header.nodeIndex, header.nodeAddress.data(), header.isMaster,
+                    r->frameTime, r->drawTime, r->syncTime, r->loopTimeMin,
+                    r->loopTimeMax, r->encodeSize, r->decodeSize, r->encode, r->send,
+                    r->receive, r->decode, r->draw, r->ack, r->swapBegin, r->swapEnd,
+                    r->swapEnd - firstSwap, r->clockOffset, r->roundTripTime
+                );
+            }
+        }
+    }
+
+    void writeChromeTrace(const std::string& path, const std::vector<Node>& nodes,
+                          const std::map<int, Frame>& frames)
+    {
+        // The trace event format expects microseconds and the viewers work best if the
+        // trace starts close to 0
+        double origin = std::numeric_limits<double>::max();
+        for (const Node& node : nodes) {
+            for (const frametrace::Record& record : node.records) {
+                for (double t : { record.encode, record.receive, record.swapBegin }) {
+                    if (t > 0.0) {
+                        origin = std::min(origin, t);
+                    }
+                }
+            }
+        }
+        auto us = [origin](double t) { return (t - origin) * 1e6; };
+
+        std::ofstream file(path);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool isFirst = true;
+        auto event = [&file, &isFirst](const std::string& e) {
+            file << (isFirst ? "" : ",\n") << e;
+            isFirst = false;
+        };
+        auto span = [&](const char* name, int pid, int frame, double begin, double end) {
+            if (begin <= 0.0 || end < begin) {
+                // One of the stages did not happen on this node
+                return;
+            }
+            event(fmt::format(
+                R"({{"name":"{}","ph":"X","pid":{},"tid":0,"ts":{:.3f},"dur":{:.3f},)"
+                R"("args":{{"frame":{}}}}})",
+                name, pid, us(begin), (end - begin) * 1e6, frame
+            ));
+        };
+
+        for (const Node& node : nodes) {
+            event(fmt::format(
+                R"({{"name":"process_name","ph":"M","pid":{},)"
+                R"("args":{{"name":"Node {} ({}){}"}}}})",
+                node.header.nodeIndex, node.header.nodeIndex,
+                escapeJson(node.header.nodeAddress.data()),
+                node.header.isMaster ? " master" : ""
+            ));
+        }
+
+        for (const auto& [number, frame] : frames) {
+            for (size_t i = 0; i < frame.size(); i++) {
+                const frametrace::Record* r = frame[i];
+                if (!r) {
+                    continue;
+                }
+                const int pid = nodes[i].header.nodeIndex;
+
+                // The master encodes and sends the shared data, the clients receive and
+                // decode it. On both, the synchronization ends with the acknowledgement
+                const bool isMaster = nodes[i].header.isMaster != 0;
+                const double syncBegin = isMaster ? r->encode : r->receive;
+                const double syncEnd = r->ack > 0.0 ? r->ack : r->decode;
+                span("Sync", pid, number, syncBegin, syncEnd);
+                span("Draw", pid, number, syncEnd > 0.0 ? syncEnd : syncBegin, r->draw);
+                span("Swap", pid, number, r->swapBegin, r->swapEnd);
+
+                event(fmt::format(
+                    R"({{"name":"Times in ms","ph":"C","pid":{},"ts":{:.3f},)"
+                    R"("args":{{"frame":{:.3f},"gpu":{:.3f},"sync":{:.3f}}}}})",
+                    pid, us(r->swapEnd), r->frameTime * 1e3,
+                    std::max(r->drawTime, 0.0) * 1e3, r->syncTime * 1e3
+                ));
+            }
+
+            // A cluster-wide marker makes it easy to see which swaps belong together
+            const double swap = latestSwap(frame);
+            if (swap > 0.0) {
+                event(fmt::format(
+                    R"({{"name":"Frame {}","ph":"i","s":"g","ts":{:.3f}}})",
+                    number, us(swap)
+                ));
+            }
+        }
+        file << "\n]}\n";
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        Log::Error("Usage: frametracemerge <output (.csv or .json)> <trace files...>");
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path output = argv[1];
+    const std::string extension = output.extension().string();
+    if (extension != ".csv" && extension != ".json") {
+        Log::Error(fmt::format("Unknown output format '{}'", extension));
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::vector<Node> nodes;
+        for (int i = 2; i < argc; i++) {
+            FrameTraceReader reader(argv[i]);
+            Log::Info(fmt::format(
+                "Read {} frames of node {} from '{}'",
+                reader.records().size(), reader.header().nodeIndex, argv[i]
+            ));
+            nodes.push_back({ reader.header(), reader.records() });
+        }
+        std::sort(
+            nodes.begin(),
+            nodes.end(),
+            [](const Node& lhs, const Node& rhs) {
+                return lhs.header.nodeIndex < rhs.header.nodeIndex;
+            }
+        );
+
+        const std::map<int, Frame> frames = alignFrames(nodes);
+        if (extension == ".csv") {
+            writeCsv(output.string(), nodes, frames);
+        }
+        else {
+            writeChromeTrace(output.string(), nodes, frames);
+        }
+
+        // Frames that were not rendered by every node point to a node that has dropped
+        // out of the cluster or to a trace that was cut off
+        const size_t nIncomplete = std::count_if(
+            frames.begin(),
+            frames.end(),
+            [](const std::pair<const int, Frame>& f) {
+                return std::find(f.second.begin(), f.second.end(), nullptr) !=
+                    f.second.end();
+            }
+        );
+        Log::Info(fmt::format(
+            "Merged {} frames of {} nodes into '{}' ({} incomplete)",
+            frames.size(), nodes.size(), output.string(), nIncomplete
+        ));
+    }
+    catch (const Error& e) {
+        Log::Error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
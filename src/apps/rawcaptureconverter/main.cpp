@@ -0,0 +1,154 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/fmt.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/rawcapture.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Converts a raw capture file, as it is written with the 'raw' capture format, into one
+// image file per frame. The frames are independent of each other and are converted by
+// as many threads as there are cores.
+//
+// Usage: rawcaptureconverter <file> [output folder] [format (png, jpg, tga, exr)]
+//                            [threads]
+
+using namespace sgct;
+
+namespace {
+    void convertFrames(const RawCaptureReader& reader, const std::string& basePath,
+                       const std::string& extension, std::atomic_uint64_t& nextFrame,
+                       std::atomic_uint64_t& nConverted)
+    {
+        const rawcapture::FileHeader& header = reader.header();
+
+        Image image;
+        image.setSize(ivec2{ header.width, header.height });
+        image.setChannels(header.nChannels);
+        image.setBytesPerChannel(header.bytesPerChannel);
+        image.setFloatingPoint(header.isFloatingPoint != 0);
+        image.allocateOrResizeData();
+        const size_t frameSize = static_cast<size_t>(header.width) * header.height *
+            header.nChannels * header.bytesPerChannel;
+
+        while (true) {
+            const uint64_t i = nextFrame++;
+            if (i >= reader.numberOfFrames()) {
+                break;
+            }
+
+            const unsigned char* data = reader.frame(i);
+            if (!data) {
+                Log::Warning(fmt::format("Skipping frame {} which was dropped", i));
+                continue;
+            }
+
+            std::memcpy(image.data(), data, frameSize);
+            const std::string file = fmt::format(
+                "{}_{:06}.{}", basePath, reader.frameNumber(i), extension
+            );
+            try {
+                image.save(file);
+                nConverted++;
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(e.what());
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        Log::Error(
+            "Usage: rawcaptureconverter <file> [output folder] "
+            "[format (png, jpg, tga, exr)] [threads]"
+        );
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const std::filesystem::path input = argv[1];
+        const std::filesystem::path folder = argc > 2 ? argv[2] : input.parent_path();
+        const std::string extension = argc > 3 ? argv[3] : "png";
+        if (extension != "png" && extension != "jpg" && extension != "tga" &&
+            extension != "exr")
+        {
+            Log::Error(fmt::format("Unknown image format '{}'", extension));
+            return EXIT_FAILURE;
+        }
+        const int nThreads = argc > 4 ?
+            std::max(std::stoi(argv[4]), 1) :
+            std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+        const RawCaptureReader reader(input.string());
+        const rawcapture::FileHeader& header = reader.header();
+        if (header.isFloatingPoint && extension != "exr") {
+            Log::Error("Floating point frames can only be converted to exr");
+            return EXIT_FAILURE;
+        }
+        Log::Info(fmt::format(
+            "Converting {} frames of {}x{}x{} with {} threads",
+            reader.numberOfFrames(), header.width, header.height, header.nChannels,
+            nThreads
+        ));
+
+        if (!folder.empty()) {
+            std::filesystem::create_directories(folder);
+        }
+        // The name of the raw file already ends with the number of the first frame, which
+        // is replaced with the number of each frame
+        std::string stem = input.stem().string();
+        const size_t separator = stem.find_last_of('_');
+        if (separator != std::string::npos &&
+            stem.find_first_not_of("0123456789", separator + 1) == std::string::npos)
+        {
+            stem.erase(separator);
+        }
+        const std::string basePath = (folder / stem).string();
+
+        std::atomic_uint64_t nextFrame = 0;
+        std::atomic_uint64_t nConverted = 0;
+        std::vector<std::thread> threads;
+        for (int i = 1; i < nThreads; i++) {
+            threads.emplace_back(
+                convertFrames,
+                std::cref(reader),
+                std::cref(basePath),
+                std::cref(extension),
+                std::ref(nextFrame),
+                std::ref(nConverted)
+            );
+        }
+        convertFrames(reader, basePath, extension, nextFrame, nConverted);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        Log::Info(fmt::format("Converted {} frames", nConverted.load()));
+    }
+    catch (const std::exception& e) {
+        // Besides the errors of the reader, an invalid thread count or a folder that
+        // can't be created end up here
+        Log::Error(e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
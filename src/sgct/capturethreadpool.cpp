@@ -0,0 +1,232 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/capturethreadpool.h>
+
+#include <sgct/fmt.h>
+#include <sgct/image.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <stdexcept>
+
+// The queue is the bounded multi-producer multi-consumer queue by Dmitry Vyukov. Every
+// cell carries a sequence number that tells a producer whether the cell is free for the
+// position it wants to write and a consumer whether the cell holds the job for the
+// position it wants to read, so that claiming a cell is a single compare-and-swap on the
+// respective position
+
+namespace {
+    // The workers check for the shutdown in this interval even if nobody notifies them
+    constexpr std::chrono::milliseconds WaitTimeout = std::chrono::milliseconds(100);
+
+    size_t nextPowerOfTwo(size_t value) {
+        size_t res = 1;
+        while (res < value) {
+            res <<= 1;
+        }
+        return res;
+    }
+} // namespace
+
+namespace sgct {
+
+CaptureThreadPool* CaptureThreadPool::_instance = nullptr;
+
+CaptureThreadPool& CaptureThreadPool::instance() {
+    if (!_instance) {
+        const Settings& s = Settings::instance();
+        _instance = new CaptureThreadPool(
+            s.numberCaptureThreads(),
+            s.captureQueueSize(),
+            s.captureQueuePolicy(),
+            s.captureFastEncoding()
+        );
+    }
+    return *_instance;
+}
+
+void CaptureThreadPool::destroy() {
+    delete _instance;
+    _instance = nullptr;
+}
+
+CaptureThreadPool::CaptureThreadPool(int nThreads, int queueSize, Policy policy,
+                                     bool fastEncoding)
+    : _mask(nextPowerOfTwo(static_cast<size_t>(std::max(queueSize, 1))) - 1)
+    , _policy(policy)
+    , _useFastEncoding(fastEncoding)
+{
+    ZoneScoped
+
+    _cells = std::make_unique<Cell[]>(_mask + 1);
+    for (size_t i = 0; i <= _mask; i++) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    nThreads = std::max(nThreads, 1);
+    _workers.reserve(nThreads);
+    for (int i = 0; i < nThreads; i++) {
+        _workers.emplace_back(&CaptureThreadPool::worker, this);
+    }
+
+    Log::Debug(fmt::format(
+        "Created {} screencapture threads with a queue of {} images", nThreads, _mask + 1
+    ));
+}
+
+CaptureThreadPool::~CaptureThreadPool() {
+    // The workers empty the queue before they check whether they should stop, so all
+    // screenshots that were requested are written to disk before we return
+    _isRunning = false;
+    _jobAdded.notify();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+bool CaptureThreadPool::push(Job job) {
+    ZoneScoped
+
+    while (true) {
+        const uint32_t generation = _jobRemoved.generation();
+        if (tryPush(job)) {
+            _jobAdded.notify();
+            return true;
+        }
+
+        switch (_policy) {
+            case Policy::Block:
+                _jobRemoved.wait(generation, WaitTimeout);
+                break;
+            case Policy::DropOldest:
+            {
+                Job oldest;
+                if (tryPop(oldest)) {
+                    Log::Warning(fmt::format(
+                        "Capture queue is full. Dropping screenshot {}", oldest.filename
+                    ));
+                    complete(oldest);
+                }
+                break;
+            }
+            case Policy::DropNewest:
+                Log::Warning(fmt::format(
+                    "Capture queue is full. Dropping screenshot {}", job.filename
+                ));
+                complete(job);
+                return false;
+            default:
+                throw std::logic_error("Unhandled case label");
+        }
+    }
+}
+
+int CaptureThreadPool::numberOfThreads() const {
+    return static_cast<int>(_workers.size());
+}
+
+int CaptureThreadPool::queueSize() const {
+    return static_cast<int>(_mask + 1);
+}
+
+bool CaptureThreadPool::tryPush(Job& job) {
+    size_t pos = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _cells[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (_enqueuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+               ))
+            {
+                cell.job = std::move(job);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell still holds the job from one round earlier, so the queue is full
+            return false;
+        }
+        else {
+            pos = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool CaptureThreadPool::tryPop(Job& job) {
+    size_t pos = _dequeuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _cells[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (_dequeuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+               ))
+            {
+                job = std::move(cell.job);
+                cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The producer has not written to this cell yet, so the queue is empty
+            return false;
+        }
+        else {
+            pos = _dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void CaptureThreadPool::worker() {
+    Job job;
+    while (true) {
+        const uint32_t generation = _jobAdded.generation();
+        if (tryPop(job)) {
+            _jobRemoved.notify();
+
+            try {
+                if (job.write) {
+                    job.write(*job.image);
+                }
+                else {
+                    using Compression = Image::Compression;
+                    job.image->save(
+                        job.filename,
+                        _useFastEncoding ? Compression::Fast : Compression::Default
+                    );
+                }
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(e.what());
+            }
+            complete(job);
+            continue;
+        }
+
+        if (!_isRunning) {
+            break;
+        }
+        _jobAdded.wait(generation, WaitTimeout);
+    }
+}
+
+void CaptureThreadPool::complete(Job& job) {
+    if (job.completion) {
+        job.completion(std::move(job.image));
+    }
+    job = Job();
+}
+
+} // namespace sgct
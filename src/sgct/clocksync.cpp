@@ -0,0 +1,83 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/clocksync.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sgct {
+
+void FrameTimestamps::serialize(char* buffer) const {
+    std::memcpy(buffer, &frame, sizeof(frame));
+    buffer += sizeof(frame);
+    for (double v : { encode, send, receive, decode, draw, ack, clockOffset,
+                      roundTripTime })
+    {
+        std::memcpy(buffer, &v, sizeof(v));
+        buffer += sizeof(v);
+    }
+}
+
+FrameTimestamps FrameTimestamps::deserialize(const char* buffer) {
+    FrameTimestamps ts;
+    std::memcpy(&ts.frame, buffer, sizeof(ts.frame));
+    buffer += sizeof(ts.frame);
+    for (double* v : { &ts.encode, &ts.send, &ts.receive, &ts.decode, &ts.draw, &ts.ack,
+                       &ts.clockOffset, &ts.roundTripTime })
+    {
+        std::memcpy(v, buffer, sizeof(double));
+        buffer += sizeof(double);
+    }
+    return ts;
+}
+
+void ClockSync::addSample(double t0, double t1, double t2, double t3) {
+    Sample sample;
+    sample.offset = ((t1 - t0) + (t2 - t3)) / 2.0;
+    sample.roundTripTime = std::max((t3 - t0) - (t2 - t1), 0.0);
+
+    std::unique_lock lock(_mutex);
+    _samples[_nextSample] = sample;
+    _nextSample = (_nextSample + 1) % NumberOfSamples;
+    _nSamples = std::min(_nSamples + 1, NumberOfSamples);
+
+    const auto best = std::min_element(
+        _samples.begin(),
+        _samples.begin() + _nSamples,
+        [](const Sample& lhs, const Sample& rhs) {
+            return lhs.roundTripTime < rhs.roundTripTime;
+        }
+    );
+    _offset = best->offset;
+    _roundTripTime = best->roundTripTime;
+    _hasEstimate = true;
+}
+
+bool ClockSync::hasEstimate() const {
+    return _hasEstimate;
+}
+
+double ClockSync::offset() const {
+    return _offset;
+}
+
+double ClockSync::roundTripTime() const {
+    return _roundTripTime;
+}
+
+void ClockSync::reset() {
+    std::unique_lock lock(_mutex);
+    _nSamples = 0;
+    _nextSample = 0;
+    _hasEstimate = false;
+    _offset = 0.0;
+    _roundTripTime = 0.0;
+}
+
+} // namespace sgct
@@ -11,6 +11,7 @@
 #include <sgct/config.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
+#include <sgct/network.h>
 #include <sgct/node.h>
 #include <sgct/profiling.h>
 #include <sgct/settings.h>
@@ -52,7 +53,10 @@ void ClusterManager::destroy() {
     _instance = nullptr;
 }
 
-ClusterManager::ClusterManager(int clusterID) : _thisNodeId(clusterID) {
+ClusterManager::ClusterManager(int clusterID)
+    : _thisNodeId(clusterID)
+    , _compression(NetworkCompression::None)
+{
     ZoneScoped
 
     _users.push_back(std::make_unique<User>("default"));
@@ -73,6 +77,49 @@ void ClusterManager::applyCluster(const config::Cluster& cluster) {
     if (cluster.firmSync) {
         setFirmFrameLockSyncStatus(*cluster.firmSync);
     }
+    if (cluster.deltaSync) {
+        setUseDeltaSync(*cluster.deltaSync);
+    }
+    if (cluster.deltaSyncKeyframeInterval) {
+        setDeltaSyncKeyframeInterval(*cluster.deltaSyncKeyframeInterval);
+    }
+    if (cluster.compression) {
+        switch (*cluster.compression) {
+            case config::Cluster::Compression::None:
+                setCompression(NetworkCompression::None);
+                break;
+            case config::Cluster::Compression::Fast:
+                setCompression(NetworkCompression::Fast);
+                break;
+            case config::Cluster::Compression::High:
+                setCompression(NetworkCompression::High);
+                break;
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+    if (cluster.compressionThreshold) {
+        setCompressionThreshold(*cluster.compressionThreshold);
+    }
+    if (cluster.networkReactor) {
+        setUseNetworkReactor(*cluster.networkReactor);
+    }
+    if (cluster.frameLockSpinTime) {
+        setFrameLockSpinTime(*cluster.frameLockSpinTime);
+    }
+    if (cluster.pipelinedSync) {
+        setPipelinedSync(*cluster.pipelinedSync);
+    }
+    if (cluster.frameTimestamps) {
+        setSendFrameTimestamps(*cluster.frameTimestamps);
+    }
+    if (cluster.multicast) {
+        MulticastGroup group;
+        group.address = cluster.multicast->address;
+        group.port = cluster.multicast->port;
+        group.ttl = cluster.multicast->ttl.value_or(group.ttl);
+        group.interfaceAddress = cluster.multicast->interfaceAddress.value_or("");
+        setMulticastGroup(std::move(group));
+    }
     if (cluster.scene) {
         const glm::mat4 translate = cluster.scene->offset ?
             glm::translate(
@@ -217,4 +264,76 @@ void ClusterManager::setFirmFrameLockSyncStatus(bool state) {
     _firmFrameLockSync = state;
 }
 
+bool ClusterManager::useDeltaSync() const {
+    return _useDeltaSync;
+}
+
+void ClusterManager::setUseDeltaSync(bool state) {
+    _useDeltaSync = state;
+}
+
+int ClusterManager::deltaSyncKeyframeInterval() const {
+    return _deltaSyncKeyframeInterval;
+}
+
+void ClusterManager::setDeltaSyncKeyframeInterval(int interval) {
+    _deltaSyncKeyframeInterval = interval;
+}
+
+NetworkCompression ClusterManager::compression() const {
+    return _compression;
+}
+
+void ClusterManager::setCompression(NetworkCompression compression) {
+    _compression = compression;
+}
+
+int ClusterManager::compressionThreshold() const {
+    return _compressionThreshold;
+}
+
+void ClusterManager::setCompressionThreshold(int threshold) {
+    _compressionThreshold = threshold;
+}
+
+bool ClusterManager::useNetworkReactor() const {
+    return _useNetworkReactor;
+}
+
+void ClusterManager::setUseNetworkReactor(bool state) {
+    _useNetworkReactor = state;
+}
+
+int ClusterManager::frameLockSpinTime() const {
+    return _frameLockSpinTime;
+}
+
+void ClusterManager::setFrameLockSpinTime(int microseconds) {
+    _frameLockSpinTime = microseconds;
+}
+
+bool ClusterManager::pipelinedSync() const {
+    return _pipelinedSync;
+}
+
+void ClusterManager::setPipelinedSync(bool state) {
+    _pipelinedSync = state;
+}
+
+bool ClusterManager::sendFrameTimestamps() const {
+    return _sendFrameTimestamps;
+}
+
+void ClusterManager::setSendFrameTimestamps(bool state) {
+    _sendFrameTimestamps = state;
+}
+
+const std::optional<MulticastGroup>& ClusterManager::multicastGroup() const {
+    return _multicastGroup;
+}
+
+void ClusterManager::setMulticastGroup(std::optional<MulticastGroup> group) {
+    _multicastGroup = std::move(group);
+}
+
 } // namespace sgct
@@ -73,6 +73,14 @@ Configuration parseArguments(std::vector<std::string>& arg) {
             config.captureFormat = Settings::CaptureFormat::JPG;
             arg.erase(arg.begin() + i);
         }
+        else if (arg[i] == "--capture-exr") {
+            config.captureFormat = Settings::CaptureFormat::EXR;
+            arg.erase(arg.begin() + i);
+        }
+        else if (arg[i] == "--capture-raw") {
+            config.captureFormat = Settings::CaptureFormat::Raw;
+            arg.erase(arg.begin() + i);
+        }
         else if (arg[i] == "--number-capture-threads" && arg.size() > (i + 1)) {
             config.nCaptureThreads = std::stoi(arg[i + 1]);
             arg.erase(arg.begin() + i, arg.begin() + i + 2);
@@ -144,6 +152,11 @@ Parameters:
     Use jpg images for screen capture
 --capture-tga
     Use tga images for screen capture
+--capture-exr
+    Use OpenEXR images for screen capture, which keeps the range of floating point
+    framebuffers
+--capture-raw
+    Write all screenshots uncompressed into a single raw capture file per window
 --export-correction-meshes
     Exports the correction warping meshes to OBJ files when loading them
 --screenshot-path
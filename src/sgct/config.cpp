@@ -58,10 +58,28 @@ void validateCapture(const Capture& c) {
             throw Error(1011, "Screenshot ranges beginning has to be before the end");
         }
     }
+
+    if (c.queueSize && *c.queueSize <= 0) {
+        throw Error(1012, "Capture queue size must be positive");
+    }
 }
 
 void validateScene(const Scene&) {}
 
+void validateMulticast(const Multicast& m) {
+    ZoneScoped
+
+    if (m.address.empty()) {
+        throw Error(1131, "Multicast address must not be empty");
+    }
+    if (m.port <= 0) {
+        throw Error(1132, "Multicast port must be positive");
+    }
+    if (m.ttl && (*m.ttl < 0 || *m.ttl > 255)) {
+        throw Error(1133, "Multicast TTL must be between 0 and 255");
+    }
+}
+
 void validateSettings(const Settings& s) {
     ZoneScoped
 
@@ -71,6 +89,12 @@ void validateSettings(const Settings& s) {
     if (s.display && s.display->refreshRate && *s.display->refreshRate < 0) {
         throw Error(1021, "Refresh rate must not be negative");
     }
+    if (s.textureUploadBudget && *s.textureUploadBudget <= 0) {
+        throw Error(1022, "Texture upload budget must be positive");
+    }
+    if (s.meshSimplificationError && *s.meshSimplificationError < 0.f) {
+        throw Error(1023, "Mesh simplification error must not be negative");
+    }
 }
 
 void validateDevice(const Device& d) {
@@ -92,6 +116,9 @@ void validateDevice(const Device& d) {
     if (!std::all_of(d.axes.begin(), d.axes.end(), validateAddress)) {
         throw Error(1033, "VRPN address for axes must not be empty");
     }
+    if (d.predictionLatency && *d.predictionLatency < 0.0) {
+        throw Error(1034, "Prediction latency must not be negative");
+    }
 }
 
 void validateTracker(const Tracker& t) {
@@ -360,12 +387,24 @@ void validateCluster(const Cluster& c) {
     if (c.externalControlPort && *c.externalControlPort <= 0) {
         throw Error(1121, "Cluster external control port must be non-negative");
     }
+    if (c.deltaSyncKeyframeInterval && *c.deltaSyncKeyframeInterval <= 0) {
+        throw Error(1129, "Delta sync keyframe interval must be positive");
+    }
+    if (c.compressionThreshold && *c.compressionThreshold < 0) {
+        throw Error(1130, "Compression threshold must be non-negative");
+    }
+    if (c.frameLockSpinTime && *c.frameLockSpinTime < 0) {
+        throw Error(1134, "Frame lock spin time must be non-negative");
+    }
     if (c.scene) {
         validateScene(*c.scene);
     }
     if (c.capture) {
         validateCapture(*c.capture);
     }
+    if (c.multicast) {
+        validateMulticast(*c.multicast);
+    }
     if (c.settings) {
         validateSettings(*c.settings);
     }
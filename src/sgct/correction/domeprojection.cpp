@@ -8,6 +8,7 @@
 
 #include <sgct/correction/domeprojection.h>
 
+#include <sgct/correction/textparser.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
@@ -23,10 +24,10 @@ Buffer generateDomeProjectionMesh(const std::string& path, const vec2& pos,
 {
     ZoneScoped
 
-    Log::Info(fmt::format("Reading DomeProjection mesh data from '{}', path"));
+    Log::Info(fmt::format("Reading DomeProjection mesh data from '{}'", path));
 
-    FILE* meshFile = fopen(path.c_str(), "r");
-    if (!meshFile) {
+    TextFile file(path);
+    if (!file.isOpen()) {
         throw Error(
             Error::Component::DomeProjection, 2010,
             fmt::format("Failed to open '{}'", path)
@@ -37,50 +38,49 @@ Buffer generateDomeProjectionMesh(const std::string& path, const vec2& pos,
 
     unsigned int nCols = 0;
     unsigned int nRows = 0;
-    while (!feof(meshFile)) {
-        constexpr const int MaxLineLength = 1024;
-        char lineBuf[MaxLineLength];
-        if (fgets(lineBuf, MaxLineLength, meshFile)) {
-            float x;
-            float y;
-            float u;
-            float v;
-            unsigned int col;
-            unsigned int row;
-
-            if (sscanf(lineBuf, "%f;%f;%f;%f;%u;%u", &x, &y, &u, &v, &col, &row) == 6) {
-                // init to max intensity (opaque white)
-                CorrectionMeshVertex vertex;
-                vertex.r = 1.f;
-                vertex.g = 1.f;
-                vertex.b = 1.f;
-                vertex.a = 1.f;
-
-                // find dimensions of meshdata
-                nCols = std::max(nCols, col);
-                nRows = std::max(nRows, row);
-
-                x = std::clamp(x, 0.f, 1.f);
-                y = std::clamp(y, 0.f, 1.f);
-
-                // convert to [-1, 1]
-                vertex.x = 2.f * (pos.x + x * size.x) - 1.f;
-
-                // (abock, 2019-08-30); I'm not sure why the y inversion happens
-                // here. It seems like a mistake, but who knows
-                vertex.y = 2.f * (pos.y + (1.f - y) * size.y) - 1.f;
-
-                // scale to viewport coordinates
-                vertex.s = pos.x + u * size.x;
-                vertex.t = pos.y + (1.f - v) * size.y;
-
-                buf.vertices.push_back(std::move(vertex));
-            }
+    std::string_view line;
+    while (file.nextLine(line)) {
+        float x;
+        float y;
+        float u;
+        float v;
+        unsigned int col;
+        unsigned int row;
+
+        Scanner s(line);
+        if (s.number(x) && s.character(';') && s.number(y) && s.character(';') &&
+            s.number(u) && s.character(';') && s.number(v) && s.character(';') &&
+            s.number(col) && s.character(';') && s.number(row))
+        {
+            // init to max intensity (opaque white)
+            CorrectionMeshVertex vertex;
+            vertex.r = 1.f;
+            vertex.g = 1.f;
+            vertex.b = 1.f;
+            vertex.a = 1.f;
+
+            // find dimensions of meshdata
+            nCols = std::max(nCols, col);
+            nRows = std::max(nRows, row);
+
+            x = std::clamp(x, 0.f, 1.f);
+            y = std::clamp(y, 0.f, 1.f);
+
+            // convert to [-1, 1]
+            vertex.x = 2.f * (pos.x + x * size.x) - 1.f;
+
+            // (abock, 2019-08-30); I'm not sure why the y inversion happens
+            // here. It seems like a mistake, but who knows
+            vertex.y = 2.f * (pos.y + (1.f - y) * size.y) - 1.f;
+
+            // scale to viewport coordinates
+            vertex.s = pos.x + u * size.x;
+            vertex.t = pos.y + (1.f - v) * size.y;
+
+            buf.vertices.push_back(std::move(vertex));
         }
     }
 
-    fclose(meshFile);
-
     nCols++;
     nRows++;
 
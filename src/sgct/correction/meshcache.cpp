@@ -0,0 +1,190 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/correction/meshcache.h>
+
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <zlib.h>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace {
+    // The cache files are identified by this and have to be discarded whenever the way
+    // in which any of the meshes are generated changes
+    constexpr std::array<char, 8> CacheMagic = {
+        'S', 'G', 'C', 'T', 'M', 'S', 'H', '\0'
+    };
+    constexpr uint32_t CacheVersion = 1;
+
+    struct CacheHeader {
+        std::array<char, 8> magic = CacheMagic;
+        uint32_t version = CacheVersion;
+        uint32_t geometryType = 0;
+        uint64_t nVertices = 0;
+        uint64_t nIndices = 0;
+        uint32_t keySize = 0;
+        uint32_t hasUserPosition = 0;
+        uint32_t hasViewPlane = 0;
+        uint32_t hasProjectionPlaneOffset = 0;
+        sgct::vec3 userPosition = sgct::vec3{ 0.f, 0.f, 0.f };
+        sgct::vec3 projectionPlaneOffset = sgct::vec3{ 0.f, 0.f, 0.f };
+        sgct::correction::Buffer::ViewPlane viewPlane;
+    };
+} // namespace
+
+namespace sgct::correction {
+
+std::string meshCacheKey(const std::string& path, const vec2& pos, const vec2& size,
+                         float aspectRatio, std::optional<float> maxError)
+{
+    // Every call overwrites the error code, so each one has to be checked on its own
+    std::error_code ec;
+    const std::filesystem::path file = std::filesystem::absolute(path, ec);
+    if (ec) {
+        return "";
+    }
+    const auto time = std::filesystem::last_write_time(file, ec);
+    if (ec) {
+        return "";
+    }
+    const uintmax_t fileSize = std::filesystem::file_size(file, ec);
+    if (ec) {
+        return "";
+    }
+    return fmt::format(
+        "{}|{}|{}|{},{}|{},{}|{}|{}",
+        file.string(), time.time_since_epoch().count(), fileSize, pos.x, pos.y, size.x,
+        size.y, aspectRatio, maxError ? *maxError : -1.f
+    );
+}
+
+std::string meshCacheName(const std::string& key) {
+    const Bytef* data = reinterpret_cast<const Bytef*>(key.data());
+    const uInt size = static_cast<uInt>(key.size());
+    const uLong crc = crc32(crc32(0, nullptr, 0), data, size);
+    const uLong adler = adler32(adler32(0, nullptr, 0), data, size);
+    return fmt::format("{:08x}{:08x}.sgctmesh", crc, adler);
+}
+
+std::optional<Buffer> readMeshCache(const std::filesystem::path& path,
+                                    const std::string& key)
+{
+    ZoneScoped
+
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        return std::nullopt;
+    }
+
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+    if (!file.good() || header.magic != CacheMagic || header.version != CacheVersion ||
+        header.keySize != key.size())
+    {
+        return std::nullopt;
+    }
+
+    // Check the size before allocating anything in case the file is damaged
+    const uint64_t vertexSize = header.nVertices * sizeof(CorrectionMeshVertex);
+    const uint64_t indexSize = header.nIndices * sizeof(unsigned int);
+    if (fileSize != sizeof(CacheHeader) + header.keySize + vertexSize + indexSize) {
+        return std::nullopt;
+    }
+
+    std::string k(header.keySize, '\0');
+    file.read(k.data(), k.size());
+    if (!file.good() || k != key) {
+        return std::nullopt;
+    }
+
+    Buffer buf;
+    buf.geometryType = header.geometryType;
+    buf.vertices.resize(header.nVertices);
+    file.read(reinterpret_cast<char*>(buf.vertices.data()), vertexSize);
+    buf.indices.resize(header.nIndices);
+    file.read(reinterpret_cast<char*>(buf.indices.data()), indexSize);
+    if (!file.good()) {
+        return std::nullopt;
+    }
+
+    if (header.hasUserPosition) {
+        buf.userPosition = header.userPosition;
+    }
+    if (header.hasViewPlane) {
+        buf.viewPlane = header.viewPlane;
+    }
+    if (header.hasProjectionPlaneOffset) {
+        buf.projectionPlaneOffset = header.projectionPlaneOffset;
+    }
+    return buf;
+}
+
+void writeMeshCache(const std::filesystem::path& path, const std::string& key,
+                    const Buffer& buffer)
+{
+    ZoneScoped
+
+    CacheHeader header;
+    header.geometryType = buffer.geometryType;
+    header.nVertices = buffer.vertices.size();
+    header.nIndices = buffer.indices.size();
+    header.keySize = static_cast<uint32_t>(key.size());
+    header.hasUserPosition = buffer.userPosition.has_value();
+    header.userPosition = buffer.userPosition.value_or(header.userPosition);
+    header.hasViewPlane = buffer.viewPlane.has_value();
+    header.viewPlane = buffer.viewPlane.value_or(header.viewPlane);
+    header.hasProjectionPlaneOffset = buffer.projectionPlaneOffset.has_value();
+    header.projectionPlaneOffset =
+        buffer.projectionPlaneOffset.value_or(header.projectionPlaneOffset);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // The file is written under a temporary name and renamed once it is complete, so
+    // that other threads and processes never see a partially written cache file
+    const size_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+    std::filesystem::path tmp = path;
+    tmp += fmt::format(".{:x}.tmp", id);
+    {
+        std::ofstream file(tmp, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+        file.write(key.data(), key.size());
+        file.write(
+            reinterpret_cast<const char*>(buffer.vertices.data()),
+            buffer.vertices.size() * sizeof(CorrectionMeshVertex)
+        );
+        file.write(
+            reinterpret_cast<const char*>(buffer.indices.data()),
+            buffer.indices.size() * sizeof(unsigned int)
+        );
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tmp, ec);
+            Log::Warning(fmt::format("Could not write mesh cache '{}'", path.string()));
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        Log::Warning(fmt::format("Could not write mesh cache '{}'", path.string()));
+    }
+}
+
+} // namespace sgct::correction
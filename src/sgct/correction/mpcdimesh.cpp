@@ -12,36 +12,44 @@
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
-#include <sgct/viewport.h>
+#include <algorithm>
 #include <cstring>
 
 #define Error(code, msg) sgct::Error(sgct::Error::Component::MPCDIMesh, code, msg)
 
 namespace sgct::correction {
 
-Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh) {
+namespace {
+    bool readFully(const ReadFunction& read, char* dst, size_t size) {
+        while (size > 0) {
+            const size_t n = read(dst, size);
+            if (n == 0) {
+                return false;
+            }
+            dst += n;
+            size -= n;
+        }
+        return true;
+    }
+} // namespace
+
+Buffer generateMpcdiMesh(const ReadFunction& read) {
     ZoneScoped
 
     Buffer buf;
 
-    Log::Info("Reading MPCDI mesh (PFM format) from buffer");
-
-    const char* srcBuff = mpcdiMesh.data();
-    size_t srcSizeBytes = mpcdiMesh.size();
+    Log::Info("Reading MPCDI mesh (PFM format)");
 
     constexpr const int MaxHeaderLineLength = 100;
-    char headerBuffer[MaxHeaderLineLength];
-    unsigned int srcIdx = 0;
+    char headerBuffer[MaxHeaderLineLength] = {};
     int index = 0;
     int nNewlines = 0;
     do {
         char headerChar = 0;
-
-        if (srcIdx == srcSizeBytes) {
+        if (index == MaxHeaderLineLength - 1 || !readFully(read, &headerChar, 1)) {
             throw Error(2021, "Error reading from file. Could not find lines");
         }
 
-        headerChar = srcBuff[srcIdx++];
         headerBuffer[index++] = headerChar;
         if (headerChar == '\n') {
             nNewlines++;
@@ -52,7 +60,7 @@ Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh) {
     unsigned int nCols = 0;
     unsigned int nRows = 0;
     const int res = sscanf(headerBuffer, "%2c %u %u", fileFormatHeader, &nCols, &nRows);
-    if (res != 3) {
+    if (res != 3 || nCols < 2 || nRows < 2) {
         throw Error(2022, "Invalid header information in MPCDI mesh");
     }
 
@@ -60,59 +68,52 @@ Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh) {
         //The 'Pf' header is invalid because PFM grayscale type is not supported.
         throw Error(2023, "Incorrect file type. Unknown header type");
     }
-    const unsigned int nCorrectionValues = nCols * nRows;
-    std::vector<vec2> corrGrid(nCorrectionValues);
-    for (unsigned int i = 0; i < nCorrectionValues; ++i) {
-        float x;
-        std::memcpy(&x, &srcBuff[srcIdx], sizeof(float));
-        srcIdx += sizeof(float);
-        corrGrid[i].x = x;
-
-        float y;
-        std::memcpy(&y, &srcBuff[srcIdx], sizeof(float));
-        srcIdx += sizeof(float);
-        corrGrid[i].y = y;
-
-        // error position; we skip those here
-        srcIdx += sizeof(float);
-    }
-
-    std::vector<vec2> smoothPos(nCorrectionValues);
-    std::vector<vec2> warpedPos(nCorrectionValues);
-    for (unsigned int i = 0; i < nCorrectionValues; ++i) {
-        const float gridIdxCol = static_cast<float>(i % nCols);
-        const float gridIdxRow = static_cast<float>(i / nCols);
-        // Compute XY positions for each point based on a normalized 0,0 to 1,1 grid,
-        // add the correction offsets to each warp point
-        smoothPos[i].x = gridIdxCol / static_cast<float>(nCols - 1);
-        // Reverse the y position as the values from the PFM file are given in raster-scan
-        // order, which is left to right but starts at upper-left rather than lower-left.
-        smoothPos[i].y = 1.f - (gridIdxRow / static_cast<float>(nRows - 1));
-        warpedPos[i].x = smoothPos[i].x + corrGrid[i].x;
-        warpedPos[i].y = smoothPos[i].y + corrGrid[i].y;
-    }
-
-    corrGrid.clear();
 
+    // Every value consists of the x and y correction offsets and an error position that
+    // is skipped here. Only a single row of values is kept in memory at a time
+    constexpr size_t ValueSize = 3 * sizeof(float);
+    std::vector<char> row(nCols * ValueSize);
+    const unsigned int nCorrectionValues = nCols * nRows;
     buf.vertices.reserve(nCorrectionValues);
-    for (unsigned int i = 0; i < nCorrectionValues; ++i) {
-        CorrectionMeshVertex vertex;
-        // init to max intensity (opaque white)
-        vertex.r = 1.f;
-        vertex.g = 1.f;
-        vertex.b = 1.f;
-        vertex.a = 1.f;
-
-        vertex.s = smoothPos[i].x;
-        vertex.t = smoothPos[i].y;
-
-        // scale to viewport coordinates
-        vertex.x = 2.f * warpedPos[i].x - 1.f;
-        vertex.y = 2.f * warpedPos[i].y - 1.f;
-        buf.vertices.push_back(vertex);
+    for (unsigned int r = 0; r < nRows; ++r) {
+        if (!readFully(read, row.data(), row.size())) {
+            throw Error(2024, "Error reading correction values in MPCDI mesh");
+        }
+
+        for (unsigned int c = 0; c < nCols; ++c) {
+            vec2 corr;
+            std::memcpy(&corr.x, &row[c * ValueSize], sizeof(float));
+            std::memcpy(&corr.y, &row[c * ValueSize + sizeof(float)], sizeof(float));
+
+            // Compute XY positions for each point based on a normalized 0,0 to 1,1
+            // grid, add the correction offsets to each warp point. The y position is
+            // reversed as the values from the PFM file are given in raster-scan order,
+            // which is left to right but starts at upper-left rather than lower-left.
+            const vec2 smoothPos = vec2{
+                static_cast<float>(c) / static_cast<float>(nCols - 1),
+                1.f - (static_cast<float>(r) / static_cast<float>(nRows - 1))
+            };
+            const vec2 warpedPos = vec2{
+                smoothPos.x + corr.x,
+                smoothPos.y + corr.y
+            };
+
+            CorrectionMeshVertex vertex;
+            // init to max intensity (opaque white)
+            vertex.r = 1.f;
+            vertex.g = 1.f;
+            vertex.b = 1.f;
+            vertex.a = 1.f;
+
+            vertex.s = smoothPos.x;
+            vertex.t = smoothPos.y;
+
+            // scale to viewport coordinates
+            vertex.x = 2.f * warpedPos.x - 1.f;
+            vertex.y = 2.f * warpedPos.y - 1.f;
+            buf.vertices.push_back(vertex);
+        }
     }
-    warpedPos.clear();
-    smoothPos.clear();
 
     buf.indices.reserve(6 * static_cast<size_t>(nCorrectionValues));
     for (unsigned int c = 0; c < (nCols - 1); ++c) {
@@ -138,4 +139,16 @@ Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh) {
     return buf;
 }
 
+Buffer generateMpcdiMesh(const std::vector<char>& mpcdiMesh) {
+    size_t offset = 0;
+    return generateMpcdiMesh(
+        [&mpcdiMesh, &offset](char* dst, size_t size) {
+            const size_t n = std::min(size, mpcdiMesh.size() - offset);
+            std::memcpy(dst, mpcdiMesh.data() + offset, n);
+            offset += n;
+            return n;
+        }
+    );
+}
+
 } // namespace sgct::correction
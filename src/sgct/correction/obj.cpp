@@ -6,15 +6,16 @@
  * For conditions of distribution and use, see copyright notice in LICENSE.md            *
  ****************************************************************************************/
 
-#include <sgct/correction/skyskan.h>
+#include <sgct/correction/obj.h>
 
+#include <sgct/correction/textparser.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
+#include <algorithm>
 #include <cassert>
-#include <fstream>
 
 namespace {
     struct Position {
@@ -30,6 +31,13 @@ namespace {
         int f2 = 0;
         int f3 = 0;
     };
+
+    // The face description might just consist of the vertex index or it might also
+    // contain the texture and normal indices that are separated by '/'
+    bool parseFaceIndex(sgct::correction::Scanner& scanner, int& index) {
+        sgct::correction::Scanner vertex(scanner.token());
+        return vertex.number(index);
+    }
 } // namespace
 
 namespace sgct::correction {
@@ -39,8 +47,8 @@ Buffer generateOBJMesh(const std::string& path) {
 
     Log::Info(fmt::format("Reading Wavefront OBJ mesh data from '{}'", path));
 
-    std::ifstream file(path);
-    if (!file.good()) {
+    TextFile file(path);
+    if (!file.isOpen()) {
         throw Error(
             Error::Component::OBJ, 2030, fmt::format("Failed to open '{}'", path)
         );
@@ -52,71 +60,48 @@ Buffer generateOBJMesh(const std::string& path) {
 
     std::vector<std::string> reported;
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) {
+    auto parseError = [&file, &path]() {
+        return Error(
+            Error::Component::OBJ, 2034,
+            fmt::format("Error parsing line {} in mesh '{}'", file.lineNumber(), path)
+        );
+    };
+
+    std::string_view line;
+    while (file.nextLine(line)) {
+        Scanner scanner(line);
+        const std::string_view first = scanner.token();
+        if (first.empty()) {
             continue;
         }
 
-        std::string_view v = line;
-        size_t separator = v.find(' ');
-        std::string_view first = v.substr(0, separator);
-        std::string_view rest = v.substr(separator + 1);
-
         if (first == "v") {
-            size_t sep = rest.find(' ');
-            std::string_view v1 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view v2 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            std::string_view v3 = rest;
-            float z = std::stof(std::string(v3));
+            Position p;
+            float z = 0.f;
+            if (!scanner.number(p.x) || !scanner.number(p.y) || !scanner.number(z)) {
+                throw parseError();
+            }
             if (z != 0.f) {
                 Log::Warning(fmt::format(
                     "Vertex in '{}' was using z coordinate which is not supported", path
                 ));
             }
-
-            Position p;
-            p.x = std::stof(std::string(v1));
-            p.y = std::stof(std::string(v2));
             positions.push_back(p);
         }
         else if (first == "vt") {
-            size_t sep = rest.find(' ');
-            std::string_view v1 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view v2 = rest.substr(0, sep);
-
             Texture t;
-            t.s = std::stof(std::string(v1));
-            t.t = std::stof(std::string(v2));
+            if (!scanner.number(t.s) || !scanner.number(t.t)) {
+                throw parseError();
+            }
             texCoords.push_back(t);
         }
         else if (first == "f") {
-            size_t sep = rest.find(' ');
-            std::string_view f1 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view f2 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view f3 = rest.substr(0, sep);
-
-            // The face description might just consist of a single value, in which case
-            // the f.find method will return npos, which tells substr to "extract" the
-            // entire string -> et voila; it still works
             Face f;
-            f.f1 = std::stoi(std::string(f1.substr(0, f1.find('/'))));
-            f.f2 = std::stoi(std::string(f2.substr(0, f2.find('/'))));
-            f.f3 = std::stoi(std::string(f3.substr(0, f3.find('/'))));
+            if (!parseFaceIndex(scanner, f.f1) || !parseFaceIndex(scanner, f.f2) ||
+                !parseFaceIndex(scanner, f.f3))
+            {
+                throw parseError();
+            }
             faces.push_back(f);
         }
         else if (first == "vn") {
@@ -0,0 +1,745 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/correction/optimize.h>
+
+#include <sgct/opengl.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    using sgct::correction::Buffer;
+    using sgct::correction::CorrectionMeshVertex;
+    using Triangle = std::array<uint32_t, 3>;
+
+    // Collapses may not create triangles that are thinner than this, unless the triangle
+    // was already thinner before. Slivers are expensive to rasterize and nearly collinear
+    // vertices make it ambiguous which triangle covers a point
+    constexpr double MinQuality = 0.05;
+
+    // The attributes that the simplification has to preserve besides the position
+    constexpr float CorrectionMeshVertex::* Attributes[] = {
+        &CorrectionMeshVertex::s, &CorrectionMeshVertex::t, &CorrectionMeshVertex::r,
+        &CorrectionMeshVertex::g, &CorrectionMeshVertex::b, &CorrectionMeshVertex::a
+    };
+
+    struct Point {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    Point operator-(const Point& lhs, const Point& rhs) {
+        return Point{ lhs.x - rhs.x, lhs.y - rhs.y };
+    }
+
+    double dot(const Point& lhs, const Point& rhs) {
+        return lhs.x * rhs.x + lhs.y * rhs.y;
+    }
+
+    Point position(const CorrectionMeshVertex& v) {
+        return Point{ v.x, v.y };
+    }
+
+    // Twice the signed area of the triangle, which is positive for counter-clockwise ones
+    double signedArea(const Point& a, const Point& b, const Point& c) {
+        return (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    }
+
+    // The area relative to the longest edge, which is 0 for degenerate triangles and 0.5
+    // for the triangles of a regular grid
+    double quality(const Point& a, const Point& b, const Point& c) {
+        const double longest = std::max({ dot(b - a, b - a), dot(c - b, c - b),
+            dot(a - c, a - c) });
+        return longest > 0.0 ? std::abs(signedArea(a, b, c)) / longest : 0.0;
+    }
+
+    struct Barycentric {
+        double a = 0.0;
+        double b = 0.0;
+        double c = 0.0;
+    };
+
+    // The point on triangle abc that is closest to p, see Ericson, "Real-Time Collision
+    // Detection", 5.1.5
+    Barycentric closestPoint(const Point& p, const Point& a, const Point& b,
+                             const Point& c)
+    {
+        const Point ab = b - a;
+        const Point ac = c - a;
+        const Point ap = p - a;
+        const double d1 = dot(ab, ap);
+        const double d2 = dot(ac, ap);
+        if (d1 <= 0.0 && d2 <= 0.0) {
+            return Barycentric{ 1.0, 0.0, 0.0 };
+        }
+
+        const Point bp = p - b;
+        const double d3 = dot(ab, bp);
+        const double d4 = dot(ac, bp);
+        if (d3 >= 0.0 && d4 <= d3) {
+            return Barycentric{ 0.0, 1.0, 0.0 };
+        }
+
+        const double vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+            const double v = d1 / (d1 - d3);
+            return Barycentric{ 1.0 - v, v, 0.0 };
+        }
+
+        const Point cp = p - c;
+        const double d5 = dot(ab, cp);
+        const double d6 = dot(ac, cp);
+        if (d6 >= 0.0 && d5 <= d6) {
+            return Barycentric{ 0.0, 0.0, 1.0 };
+        }
+
+        const double vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+            const double w = d2 / (d2 - d6);
+            return Barycentric{ 1.0 - w, 0.0, w };
+        }
+
+        const double va = d3 * d6 - d5 * d4;
+        if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+            const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            return Barycentric{ 0.0, 1.0 - w, w };
+        }
+
+        const double denom = 1.0 / (va + vb + vc);
+        const double v = vb * denom;
+        const double w = vc * denom;
+        return Barycentric{ 1.0 - v - w, v, w };
+    }
+
+    /**
+     * Removes vertices with a sequence of half-edge collapses. Every removed vertex is
+     * remembered by the triangle that covers it, so the error of a collapse can be
+     * measured against all of the original vertices that are affected by it. The
+     * midpoints of the original edges are remembered the same way, as the simplified mesh
+     * can deviate the most between the original vertices where the edges cross.
+     */
+    class Simplifier {
+    public:
+        Simplifier(const Buffer& buffer, double maxError);
+
+        void run();
+        std::vector<unsigned int> indices() const;
+
+    private:
+        struct Edge {
+            uint32_t vertex = 0;
+            int nTriangles = 0;
+        };
+
+        // One of the triangles around a vertex as it would be after a collapse
+        struct FanTriangle {
+            uint32_t triangle = 0;
+            std::array<const CorrectionMeshVertex*, 3> vertices;
+            std::array<Point, 3> corners;
+            double area = 0.0;
+        };
+
+        struct Target {
+            uint32_t triangle = 0;
+            double error = 0.0;
+        };
+
+        std::vector<Edge> edges(uint32_t vertex) const;
+        bool contains(uint32_t triangle, uint32_t vertex) const;
+        std::vector<FanTriangle> fan(uint32_t from, uint32_t to) const;
+
+        // The samples around the vertex and the triangles that cover them after a
+        // collapse, which are computed when the error of the collapse is measured
+        using Assignment = std::vector<std::pair<uint32_t, uint32_t>>;
+
+        double collapseError(uint32_t from, uint32_t to, double limit,
+            Assignment& assignment) const;
+        Target locate(uint32_t sample, const std::vector<FanTriangle>& fan) const;
+        void collapse(uint32_t from, uint32_t to, const Assignment& assignment);
+
+        const std::vector<CorrectionMeshVertex>& _vertices;
+        const double _maxError;
+
+        std::vector<Triangle> _triangles;
+        std::vector<bool> _isTriangleRemoved;
+        std::vector<std::vector<uint32_t>> _vertexTriangles;
+
+        // The original vertices followed by the midpoints of the original edges
+        std::vector<CorrectionMeshVertex> _samples;
+        std::vector<std::vector<uint32_t>> _coveredSamples;
+    };
+
+    Simplifier::Simplifier(const Buffer& buffer, double maxError)
+        : _vertices(buffer.vertices)
+        , _maxError(maxError)
+    {
+        const size_t nTriangles = buffer.indices.size() / 3;
+        _triangles.resize(nTriangles);
+        _isTriangleRemoved.resize(nTriangles, false);
+        _vertexTriangles.resize(buffer.vertices.size());
+        _coveredSamples.resize(nTriangles);
+        for (size_t i = 0; i < nTriangles; i++) {
+            const uint32_t t = static_cast<uint32_t>(i);
+            for (int j = 0; j < 3; j++) {
+                _triangles[i][j] = buffer.indices[3 * i + j];
+                _vertexTriangles[_triangles[i][j]].push_back(t);
+            }
+        }
+
+        _samples = buffer.vertices;
+        std::unordered_set<uint64_t> edges;
+        edges.reserve(3 * nTriangles);
+        for (size_t i = 0; i < nTriangles; i++) {
+            for (int j = 0; j < 3; j++) {
+                const uint32_t a = _triangles[i][j];
+                const uint32_t b = _triangles[i][(j + 1) % 3];
+                const uint64_t edge =
+                    (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+                if (!edges.insert(edge).second) {
+                    continue;
+                }
+
+                const CorrectionMeshVertex& va = _vertices[a];
+                const CorrectionMeshVertex& vb = _vertices[b];
+                CorrectionMeshVertex mid;
+                mid.x = 0.5f * (va.x + vb.x);
+                mid.y = 0.5f * (va.y + vb.y);
+                for (float CorrectionMeshVertex::* attr : Attributes) {
+                    mid.*attr = 0.5f * (va.*attr + vb.*attr);
+                }
+                _coveredSamples[i].push_back(static_cast<uint32_t>(_samples.size()));
+                _samples.push_back(mid);
+            }
+        }
+    }
+
+    void Simplifier::run() {
+        // Vertices next to a collapse are not touched again in the same pass, which
+        // spreads the collapses evenly over the mesh instead of sweeping all vertices of
+        // a flat region into a single fan of slivers. A vertex that can't be removed is
+        // only tried again after one of its triangles has changed
+        std::vector<bool> isDirty(_vertices.size(), true);
+        Assignment assignment;
+        bool hasChanged = true;
+        while (hasChanged) {
+            hasChanged = false;
+            std::vector<bool> isLocked(_vertices.size(), false);
+            for (uint32_t from = 0; from < _vertices.size(); from++) {
+                if (!isDirty[from] || isLocked[from] || _vertexTriangles[from].empty()) {
+                    continue;
+                }
+
+                // The vertex is moved onto the closest neighbor that it can merge with
+                std::vector<Edge> candidates = edges(from);
+                const Point p = position(_vertices[from]);
+                std::sort(
+                    candidates.begin(), candidates.end(),
+                    [this, &p](const Edge& lhs, const Edge& rhs) {
+                        const Point l = position(_vertices[lhs.vertex]) - p;
+                        const Point r = position(_vertices[rhs.vertex]) - p;
+                        return dot(l, l) < dot(r, r);
+                    }
+                );
+                auto it = std::find_if(
+                    candidates.begin(), candidates.end(),
+                    [&](const Edge& e) {
+                        const double error =
+                            collapseError(from, e.vertex, _maxError, assignment);
+                        return error <= _maxError;
+                    }
+                );
+                if (it == candidates.end()) {
+                    isDirty[from] = false;
+                    continue;
+                }
+
+                const uint32_t to = it->vertex;
+                collapse(from, to, assignment);
+                hasChanged = true;
+                for (uint32_t t : _vertexTriangles[to]) {
+                    for (uint32_t v : _triangles[t]) {
+                        isLocked[v] = true;
+                        isDirty[v] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<unsigned int> Simplifier::indices() const {
+        std::vector<unsigned int> res;
+        for (size_t i = 0; i < _triangles.size(); i++) {
+            if (!_isTriangleRemoved[i]) {
+                res.insert(res.end(), _triangles[i].begin(), _triangles[i].end());
+            }
+        }
+        return res;
+    }
+
+    std::vector<Simplifier::Edge> Simplifier::edges(uint32_t vertex) const {
+        std::vector<Edge> res;
+        for (uint32_t t : _vertexTriangles[vertex]) {
+            for (uint32_t v : _triangles[t]) {
+                if (v == vertex) {
+                    continue;
+                }
+                auto it = std::find_if(
+                    res.begin(), res.end(),
+                    [v](const Edge& e) { return e.vertex == v; }
+                );
+                if (it == res.end()) {
+                    res.push_back({ v, 1 });
+                }
+                else {
+                    it->nTriangles++;
+                }
+            }
+        }
+        return res;
+    }
+
+    bool Simplifier::contains(uint32_t triangle, uint32_t vertex) const {
+        const Triangle& t = _triangles[triangle];
+        return t[0] == vertex || t[1] == vertex || t[2] == vertex;
+    }
+
+    std::vector<Simplifier::FanTriangle> Simplifier::fan(uint32_t from,
+                                                         uint32_t to) const
+    {
+        std::vector<FanTriangle> res;
+        for (uint32_t t : _vertexTriangles[from]) {
+            if (contains(t, to)) {
+                continue;
+            }
+
+            FanTriangle f;
+            f.triangle = t;
+            for (int i = 0; i < 3; i++) {
+                const uint32_t v = _triangles[t][i] == from ? to : _triangles[t][i];
+                f.vertices[i] = &_vertices[v];
+                f.corners[i] = position(_vertices[v]);
+            }
+            f.area = signedArea(f.corners[0], f.corners[1], f.corners[2]);
+            res.push_back(f);
+        }
+        return res;
+    }
+
+    double Simplifier::collapseError(uint32_t from, uint32_t to, double limit,
+                                     Assignment& assignment) const
+    {
+        constexpr double Invalid = std::numeric_limits<double>::max();
+
+        // Edges that are shared by more than two triangles can't be collapsed safely, and
+        // a vertex on the outline of the mesh may only move along the outline
+        const std::vector<Edge> fromEdges = edges(from);
+        bool isBoundary = false;
+        int nShared = 0;
+        for (const Edge& e : fromEdges) {
+            if (e.nTriangles > 2) {
+                return Invalid;
+            }
+            isBoundary |= e.nTriangles == 1;
+            if (e.vertex == to) {
+                nShared = e.nTriangles;
+            }
+        }
+        if (isBoundary && nShared != 1) {
+            return Invalid;
+        }
+
+        // The only vertices that both ends of the edge may have in common are the ones
+        // of the triangles that are removed, otherwise the mesh would fold onto itself
+        const std::vector<Edge> toEdges = edges(to);
+        for (const Edge& e : fromEdges) {
+            if (e.vertex == to) {
+                continue;
+            }
+            const bool isShared = std::any_of(
+                toEdges.begin(), toEdges.end(),
+                [&e](const Edge& f) { return f.vertex == e.vertex; }
+            );
+            if (!isShared) {
+                continue;
+            }
+            const bool isOpposite = std::any_of(
+                _vertexTriangles[from].begin(), _vertexTriangles[from].end(),
+                [&](uint32_t t) { return contains(t, to) && contains(t, e.vertex); }
+            );
+            if (!isOpposite) {
+                return Invalid;
+            }
+        }
+
+        // None of the remaining triangles may flip or become a sliver
+        const std::vector<FanTriangle> after = fan(from, to);
+        if (after.empty()) {
+            return Invalid;
+        }
+        for (const FanTriangle& f : after) {
+            const Triangle& tri = _triangles[f.triangle];
+            const Point a = position(_vertices[tri[0]]);
+            const Point b = position(_vertices[tri[1]]);
+            const Point c = position(_vertices[tri[2]]);
+            const double before = signedArea(a, b, c);
+            const double minQuality = std::min(quality(a, b, c), MinQuality);
+            if (before == 0.0 || (before > 0.0) != (f.area > 0.0) ||
+                quality(f.corners[0], f.corners[1], f.corners[2]) < minQuality)
+            {
+                return Invalid;
+            }
+        }
+
+        assignment.clear();
+        double error = 0.0;
+        for (uint32_t t : _vertexTriangles[from]) {
+            for (uint32_t s : _coveredSamples[t]) {
+                const Target target = locate(s, after);
+                error = std::max(error, target.error);
+                if (error > limit) {
+                    return error;
+                }
+                assignment.emplace_back(s, target.triangle);
+            }
+        }
+        // The removed vertex becomes a sample itself
+        const Target target = locate(from, after);
+        assignment.emplace_back(from, target.triangle);
+        return std::max(error, target.error);
+    }
+
+    Simplifier::Target Simplifier::locate(uint32_t sample,
+                                          const std::vector<FanTriangle>& fan) const
+    {
+        const CorrectionMeshVertex& p = _samples[sample];
+        const Point pos = position(p);
+
+        auto target = [&p](const FanTriangle& f, const Barycentric& w, double distance) {
+            Target res;
+            res.triangle = f.triangle;
+            res.error = distance;
+            for (float CorrectionMeshVertex::* attr : Attributes) {
+                const double value = w.a * f.vertices[0]->*attr +
+                    w.b * f.vertices[1]->*attr + w.c * f.vertices[2]->*attr;
+                res.error = std::max(res.error, std::abs(value - p.*attr));
+            }
+            return res;
+        };
+
+        // Most samples lie inside one of the triangles
+        for (const FanTriangle& f : fan) {
+            const std::array<Point, 3>& c = f.corners;
+            const Barycentric w = {
+                signedArea(pos, c[1], c[2]) / f.area,
+                signedArea(c[0], pos, c[2]) / f.area,
+                signedArea(c[0], c[1], pos) / f.area
+            };
+            if (w.a >= 0.0 && w.b >= 0.0 && w.c >= 0.0) {
+                return target(f, w, 0.0);
+            }
+        }
+
+        // If the sample falls outside of the mesh or onto an edge, the closest point on
+        // any of the triangles is used and the distance to it counts as error
+        Target res;
+        double bestDistance = std::numeric_limits<double>::max();
+        for (const FanTriangle& f : fan) {
+            const std::array<Point, 3>& c = f.corners;
+            const Barycentric w = closestPoint(pos, c[0], c[1], c[2]);
+            const Point q = Point{
+                w.a * c[0].x + w.b * c[1].x + w.c * c[2].x,
+                w.a * c[0].y + w.b * c[1].y + w.c * c[2].y
+            };
+            const double distance = std::sqrt(dot(pos - q, pos - q));
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                res = target(f, w, distance);
+            }
+        }
+        return res;
+    }
+
+    void Simplifier::collapse(uint32_t from, uint32_t to,
+                              const Assignment& assignment)
+    {
+        for (uint32_t t : _vertexTriangles[from]) {
+            // The samples are moved to the triangles that cover them after the collapse
+            _coveredSamples[t].clear();
+
+            if (contains(t, to)) {
+                _isTriangleRemoved[t] = true;
+                for (uint32_t v : _triangles[t]) {
+                    if (v == from) {
+                        continue;
+                    }
+                    std::vector<uint32_t>& list = _vertexTriangles[v];
+                    list.erase(std::find(list.begin(), list.end(), t));
+                }
+            }
+            else {
+                std::replace(_triangles[t].begin(), _triangles[t].end(), from, to);
+                _vertexTriangles[to].push_back(t);
+            }
+        }
+        _vertexTriangles[from].clear();
+
+        for (const auto& [sample, triangle] : assignment) {
+            _coveredSamples[triangle].push_back(sample);
+        }
+    }
+
+    // Renumbers the vertices in the order in which they are first used by the indices and
+    // removes all vertices that are not used at all
+    void reorderVertices(Buffer& buffer) {
+        constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> remap(buffer.vertices.size(), Unused);
+        std::vector<CorrectionMeshVertex> vertices;
+        vertices.reserve(buffer.vertices.size());
+        for (unsigned int& i : buffer.indices) {
+            if (remap[i] == Unused) {
+                remap[i] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(buffer.vertices[i]);
+            }
+            i = remap[i];
+        }
+        buffer.vertices = std::move(vertices);
+    }
+
+    // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+    constexpr int CacheSize = 32;
+
+    float vertexScore(int cachePosition, int nRemainingTriangles) {
+        if (nRemainingTriangles == 0) {
+            return -1.f;
+        }
+
+        float score = 0.f;
+        if (cachePosition >= 3) {
+            const float s = 1.f - static_cast<float>(cachePosition - 3) / (CacheSize - 3);
+            score = std::pow(s, 1.5f);
+        }
+        else if (cachePosition >= 0) {
+            // The vertices of the last triangle get a fixed score so that it is not
+            // always beneficial to continue with a neighboring triangle
+            score = 0.75f;
+        }
+        return score + 2.f / std::sqrt(static_cast<float>(nRemainingTriangles));
+    }
+} // namespace
+
+namespace sgct::correction {
+
+void convertToTriangleList(Buffer& buffer) {
+    ZoneScoped
+
+    if (buffer.geometryType != GL_TRIANGLE_STRIP) {
+        return;
+    }
+
+    std::vector<unsigned int> indices;
+    indices.reserve(buffer.indices.size() > 2 ? 3 * (buffer.indices.size() - 2) : 0);
+    for (size_t i = 2; i < buffer.indices.size(); i++) {
+        // Every other triangle in a strip has the opposite order of its vertices
+        unsigned int a = buffer.indices[i - 2];
+        unsigned int b = buffer.indices[i - 1];
+        const unsigned int c = buffer.indices[i];
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        if (i % 2 == 1) {
+            std::swap(a, b);
+        }
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    }
+    buffer.indices = std::move(indices);
+    buffer.geometryType = GL_TRIANGLES;
+}
+
+void mergeVertices(Buffer& buffer) {
+    ZoneScoped
+
+    struct Hash {
+        size_t operator()(const CorrectionMeshVertex& v) const {
+            // 64 bit FNV-1a over the bytes of the vertex
+            uint64_t res = 14695981039346656037ull;
+            const unsigned char* d = reinterpret_cast<const unsigned char*>(&v);
+            for (size_t i = 0; i < sizeof(CorrectionMeshVertex); i++) {
+                res = (res ^ d[i]) * 1099511628211ull;
+            }
+            return static_cast<size_t>(res);
+        }
+    };
+    struct Equal {
+        bool operator()(const CorrectionMeshVertex& lhs,
+                        const CorrectionMeshVertex& rhs) const
+        {
+            return std::memcmp(&lhs, &rhs, sizeof(CorrectionMeshVertex)) == 0;
+        }
+    };
+
+    std::unordered_map<CorrectionMeshVertex, unsigned int, Hash, Equal> unique;
+    unique.reserve(buffer.vertices.size());
+    std::vector<unsigned int> remap(buffer.vertices.size());
+    std::vector<CorrectionMeshVertex> vertices;
+    vertices.reserve(buffer.vertices.size());
+    for (size_t i = 0; i < buffer.vertices.size(); i++) {
+        const unsigned int next = static_cast<unsigned int>(vertices.size());
+        const auto [it, isNew] = unique.emplace(buffer.vertices[i], next);
+        if (isNew) {
+            vertices.push_back(buffer.vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    if (vertices.size() == buffer.vertices.size()) {
+        return;
+    }
+    for (unsigned int& i : buffer.indices) {
+        i = remap[i];
+    }
+    buffer.vertices = std::move(vertices);
+}
+
+void simplifyMesh(Buffer& buffer, float maxError) {
+    ZoneScoped
+
+    if (buffer.geometryType != GL_TRIANGLES || maxError <= 0.f) {
+        return;
+    }
+
+    Simplifier simplifier(buffer, maxError);
+    simplifier.run();
+    buffer.indices = simplifier.indices();
+    reorderVertices(buffer);
+}
+
+void optimizeVertexCache(Buffer& buffer) {
+    ZoneScoped
+
+    if (buffer.geometryType != GL_TRIANGLES) {
+        return;
+    }
+
+    const size_t nTriangles = buffer.indices.size() / 3;
+    const size_t nVertices = buffer.vertices.size();
+
+    // The triangles that use each vertex and have not been emitted yet. The first
+    // nRemaining[v] entries starting at offsets[v] are the ones that are left
+    std::vector<uint32_t> offsets(nVertices + 1, 0);
+    std::vector<int> nRemaining(nVertices, 0);
+    for (unsigned int i : buffer.indices) {
+        nRemaining[i]++;
+    }
+    for (size_t i = 0; i < nVertices; i++) {
+        offsets[i + 1] = offsets[i] + nRemaining[i];
+    }
+    std::vector<uint32_t> vertexTriangles(buffer.indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < buffer.indices.size(); i++) {
+            vertexTriangles[fill[buffer.indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<float> score(nVertices);
+    for (size_t i = 0; i < nVertices; i++) {
+        score[i] = vertexScore(-1, nRemaining[i]);
+    }
+    std::vector<bool> isEmitted(nTriangles, false);
+
+    std::vector<unsigned int> indices;
+    indices.reserve(buffer.indices.size());
+    std::vector<uint32_t> cache;
+    cache.reserve(CacheSize + 3);
+    std::vector<uint32_t> nextCache;
+    nextCache.reserve(CacheSize + 3);
+
+    int64_t best = -1;
+    size_t cursor = 0;
+    for (size_t n = 0; n < nTriangles; n++) {
+        if (best < 0) {
+            // None of the triangles around the cached vertices are left, so we continue
+            // with the next triangle in the original order
+            while (isEmitted[cursor]) {
+                cursor++;
+            }
+            best = static_cast<int64_t>(cursor);
+        }
+
+        const size_t t = static_cast<size_t>(best);
+        isEmitted[t] = true;
+        const unsigned int* tri = &buffer.indices[3 * t];
+        nextCache.assign(tri, tri + 3);
+        for (int i = 0; i < 3; i++) {
+            indices.push_back(tri[i]);
+
+            // Remove the triangle from the list of remaining triangles of the vertex
+            uint32_t* begin = &vertexTriangles[offsets[tri[i]]];
+            uint32_t* end = begin + nRemaining[tri[i]];
+            *std::find(begin, end, static_cast<uint32_t>(t)) = *(end - 1);
+            nRemaining[tri[i]]--;
+        }
+        for (uint32_t v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        std::swap(cache, nextCache);
+
+        // Update the scores of all vertices that were in the cache. The ones that were
+        // pushed out of the cache are still updated once to reset their position
+        for (size_t i = 0; i < cache.size(); i++) {
+            const int position = i < CacheSize ? static_cast<int>(i) : -1;
+            score[cache[i]] = vertexScore(position, nRemaining[cache[i]]);
+        }
+
+        best = -1;
+        float bestScore = -1.f;
+        for (uint32_t v : cache) {
+            const uint32_t* begin = &vertexTriangles[offsets[v]];
+            for (const uint32_t* it = begin; it != begin + nRemaining[v]; it++) {
+                const unsigned int* other = &buffer.indices[3 * *it];
+                const float s = score[other[0]] + score[other[1]] + score[other[2]];
+                if (s > bestScore) {
+                    bestScore = s;
+                    best = static_cast<int64_t>(*it);
+                }
+            }
+        }
+        if (cache.size() > CacheSize) {
+            cache.resize(CacheSize);
+        }
+    }
+
+    buffer.indices = std::move(indices);
+    reorderVertices(buffer);
+}
+
+void optimizeMesh(Buffer& buffer, float maxError) {
+    ZoneScoped
+
+    if (buffer.geometryType != GL_TRIANGLES && buffer.geometryType != GL_TRIANGLE_STRIP) {
+        return;
+    }
+
+    convertToTriangleList(buffer);
+    mergeVertices(buffer);
+    simplifyMesh(buffer, maxError);
+    optimizeVertexCache(buffer);
+}
+
+} // namespace sgct::correction
@@ -8,6 +8,7 @@
 
 #include <sgct/correction/paulbourke.h>
 
+#include <sgct/correction/textparser.h>
 #include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
@@ -28,23 +29,19 @@ Buffer generatePaulBourkeMesh(const std::string& path, const vec2& pos, const ve
 
     Log::Info(fmt::format("Reading Paul Bourke spherical mirror mesh from '{}'", path));
 
-    FILE* meshFile = fopen(path.c_str(), "r");
-    if (meshFile == nullptr) {
+    TextFile file(path);
+    if (!file.isOpen()) {
         throw Error(
             Error::Component::PaulBourke, 2040,
             fmt::format("Failed to open '{}'", path)
         );
     }
 
-    constexpr const int MaxLineLength = 1024;
-    char lineBuffer[MaxLineLength];
-
     // get the fist line containing the mapping type _id
     int mappingType = -1;
-    if (fgets(lineBuffer, MaxLineLength, meshFile)) {
-        int r = sscanf(lineBuffer, "%d", &mappingType);
-        if (r != 1) {
-            fclose(meshFile);
+    std::string_view line;
+    if (file.nextLine(line)) {
+        if (!Scanner(line).number(mappingType)) {
             throw Error(
                 Error::Component::PaulBourke, 2041,
                 fmt::format("Error reading mapping type in file '{}'", path)
@@ -54,9 +51,10 @@ Buffer generatePaulBourkeMesh(const std::string& path, const vec2& pos, const ve
 
     // get the mesh dimensions
     std::optional<glm::ivec2> meshSize;
-    if (fgets(lineBuffer, MaxLineLength, meshFile)) {
+    if (file.nextLine(line)) {
+        Scanner scanner(line);
         glm::ivec2 val;
-        if (sscanf(lineBuffer, "%d %d", &val[0], &val[1]) == 2) {
+        if (scanner.number(val[0]) && scanner.number(val[1])) {
             const size_t s = static_cast<size_t>(val.x) * static_cast<size_t>(val.y);
             buf.vertices.reserve(s);
             meshSize = std::move(val);
@@ -65,7 +63,6 @@ Buffer generatePaulBourkeMesh(const std::string& path, const vec2& pos, const ve
 
     // check if everyting useful is set
     if (mappingType == -1 || !meshSize.has_value()) {
-        fclose(meshFile);
         throw Error(
             Error::Component::PaulBourke, 2042,
             fmt::format("Invalid data in file '{}'", path)
@@ -73,23 +70,24 @@ Buffer generatePaulBourkeMesh(const std::string& path, const vec2& pos, const ve
     }
 
     // get all data
-    float x, y, s, t, intensity;
-    while (!feof(meshFile)) {
-        if (fgets(lineBuffer, MaxLineLength, meshFile)) {
-            if (sscanf(lineBuffer, "%f %f %f %f %f", &x, &y, &s, &t, &intensity) == 5) {
-                CorrectionMeshVertex vertex;
-                vertex.x = x;
-                vertex.y = y;
-                vertex.s = s;
-                vertex.t = t;
-
-                vertex.r = intensity;
-                vertex.g = intensity;
-                vertex.b = intensity;
-                vertex.a = 1.f;
-
-                buf.vertices.push_back(vertex);
-            }
+    while (file.nextLine(line)) {
+        Scanner scanner(line);
+        float x, y, s, t, intensity;
+        if (scanner.number(x) && scanner.number(y) && scanner.number(s) &&
+            scanner.number(t) && scanner.number(intensity))
+        {
+            CorrectionMeshVertex vertex;
+            vertex.x = x;
+            vertex.y = y;
+            vertex.s = s;
+            vertex.t = t;
+
+            vertex.r = intensity;
+            vertex.g = intensity;
+            vertex.b = intensity;
+            vertex.a = 1.f;
+
+            buf.vertices.push_back(vertex);
         }
     }
 
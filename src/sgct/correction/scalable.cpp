@@ -9,17 +9,15 @@
 #include <sgct/correction/scalable.h>
 
 #include <sgct/baseviewport.h>
-#include <sgct/engine.h>
+#include <sgct/correction/textparser.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
-#include <sgct/user.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <fstream>
 
 namespace {
     template <typename From, typename To>
@@ -103,29 +101,50 @@ namespace {
 
 namespace sgct::correction {
 
-Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
+Buffer generateScalableMesh(const std::string& path, const BaseViewport& parent) {
     ZoneScoped
 
     Log::Info(fmt::format("Reading scalable mesh data from '{}'", path));
 
-    std::ifstream file(path);
-    if (!file.good()) {
+    TextFile file(path);
+    if (!file.isOpen()) {
         throw Error(
             Error::Component::Scalable, 2060, fmt::format("Failed to open '{}'", path)
         );
     }
 
+    auto parseError = [&file, &path]() {
+        return Error(
+            Error::Component::Scalable, 2062,
+            fmt::format("Error parsing line {} in mesh '{}'", file.lineNumber(), path)
+        );
+    };
+    // Each value is parsed from the beginning of the token, ignoring anything after the
+    // number
+    auto toFloat = [&parseError](std::string_view text) {
+        float value;
+        if (!Scanner(text).number(value)) {
+            throw parseError();
+        }
+        return value;
+    };
+    auto toInt = [&parseError](std::string_view text) {
+        int value;
+        if (!Scanner(text).number(value)) {
+            throw parseError();
+        }
+        return value;
+    };
+
     Data data;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) {
+    std::string_view line;
+    while (file.nextLine(line)) {
+        Scanner scanner(line);
+        const std::string_view first = scanner.token();
+        if (first.empty()) {
             continue;
         }
-
-        std::string_view v = line;
-        size_t separator = v.find(' ');
-        std::string_view first = v.substr(0, separator);
-        std::string_view rest = v.substr(separator + 1);
+        const std::string_view rest = scanner.rest();
 
         if (first == "OPENMESH") {
             if (rest != "Version 1.1") {
@@ -136,11 +155,11 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "VERTICES") {
-            data.nVertices = std::stoi(std::string(rest));
+            data.nVertices = toInt(rest);
             data.vertices.reserve(data.nVertices);
         }
         else if (first == "FACES") {
-            data.nFaces = std::stoi(std::string(rest));
+            data.nFaces = toInt(rest);
             data.faces.reserve(data.nFaces);
         }
         else if (first == "MAPPING") {
@@ -168,62 +187,62 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "ORTHO_LEFT") {
-            data.ortho.left = std::stof(std::string(rest));
+            data.ortho.left = toFloat(rest);
         }
         else if (first == "ORTHO_RIGHT") {
-            data.ortho.right = std::stof(std::string(rest));
+            data.ortho.right = toFloat(rest);
         }
         else if (first == "ORTHO_TOP") {
-            data.ortho.top = std::stof(std::string(rest));
+            data.ortho.top = toFloat(rest);
         }
         else if (first == "ORTHO_BOTTOM") {
-            data.ortho.bottom = std::stof(std::string(rest));
+            data.ortho.bottom = toFloat(rest);
         }
         else if (first == "PERSPECTIVE_XOFFSET") {
-            data.perspective.offset.x = std::stof(std::string(rest));
+            data.perspective.offset.x = toFloat(rest);
             data.perspective.hasOffset = true;
         }
         else if (first == "PERSPECTIVE_YOFFSET") {
-            data.perspective.offset.y = std::stof(std::string(rest));
+            data.perspective.offset.y = toFloat(rest);
             data.perspective.hasOffset = true;
         }
         else if (first == "PERSPECTIVE_ZOFFSET") {
-            data.perspective.offset.z = std::stof(std::string(rest));
+            data.perspective.offset.z = toFloat(rest);
             data.perspective.hasOffset = true;
         }
         else if (first == "PERSPECTIVE_ROLL") {
-            data.perspective.direction.roll = std::stof(std::string(rest));
+            data.perspective.direction.roll = toFloat(rest);
         }
         else if (first == "PERSPECTIVE_PITCH") {
-            data.perspective.direction.pitch = std::stof(std::string(rest));
+            data.perspective.direction.pitch = toFloat(rest);
         }
         else if (first == "PERSPECTIVE_YAW") {
-            data.perspective.direction.yaw = std::stof(std::string(rest));
+            data.perspective.direction.yaw = toFloat(rest);
         }
         else if (first == "PERSPECTIVE_LEFT") {
-            data.perspective.fov.left = std::stof(std::string(rest));
+            data.perspective.fov.left = toFloat(rest);
             data.perspective.hasFov = true;
         }
         else if (first == "PERSPECTIVE_RIGHT") {
-            data.perspective.fov.right = std::stof(std::string(rest));
+            data.perspective.fov.right = toFloat(rest);
             data.perspective.hasFov = true;
         }
         else if (first == "PERSPECTIVE_TOP") {
-            data.perspective.fov.top = std::stof(std::string(rest));
+            data.perspective.fov.top = toFloat(rest);
             data.perspective.hasFov = true;
         }
         else if (first == "PERSPECTIVE_BOTTOM") {
-            data.perspective.fov.bottom = std::stof(std::string(rest));
+            data.perspective.fov.bottom = toFloat(rest);
             data.perspective.hasFov = true;
         }
         else if (first == "NATIVEXRES") {
-            data.resolution.x = std::stoi(std::string(rest));
+            data.resolution.x = toInt(rest);
         }
         else if (first == "NATIVEYRES") {
-            data.resolution.y = std::stoi(std::string(rest));
+            data.resolution.y = toInt(rest);
         }
         else if (first == "SUBVERSION") {
-            int version = std::stoi(std::string(rest));
+            int version = toInt(rest);
             if (version != 5) {
                 Log::Warning(fmt::format(
                     "Found subversion {} in mesh '{}' but only version 5 is tested",
@@ -232,7 +251,7 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "GAMMA") {
-            float gamma = std::stof(std::string(rest));
+            float gamma = toFloat(rest);
             if (gamma != data.gamma) {
                 data.gamma = gamma;
                 Log::Warning(fmt::format(
@@ -242,10 +261,10 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "DO_NO_WARP") {
-            data.doNotWarp = std::stoi(std::string(rest)) != 0;
+            data.doNotWarp = toInt(rest) != 0;
         }
         else if (first == "USE_SPHERE_SAMPLE_COORDINATE_SYSTEM") {
-            bool useSphereSampling = std::stoi(std::string(rest)) != 0;
+            bool useSphereSampling = toInt(rest) != 0;
             if (useSphereSampling) {
                 Log::Warning(fmt::format(
                     "Found request to use Sphere Sample Coordinate System in mesh '{}' "
@@ -254,7 +273,7 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "FRUSTUM_EULER_ANGLES") {
-            data.frustumEulerAngles.useAngles = std::stoi(std::string(rest)) != 0;
+            data.frustumEulerAngles.useAngles = toInt(rest) != 0;
             if (data.frustumEulerAngles.useAngles) {
                 Log::Warning(fmt::format(
                     "Enabled frustum euler angles in mesh '{}' but we don't know how "
@@ -263,19 +282,19 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "FRUSTUM_EULER_YAW") {
-            data.frustumEulerAngles.yaw = std::stof(std::string(rest));
+            data.frustumEulerAngles.yaw = toFloat(rest);
         }
         else if (first == "FRUSTUM_EULER_PITCH") {
-            data.frustumEulerAngles.pitch = std::stof(std::string(rest));
+            data.frustumEulerAngles.pitch = toFloat(rest);
         }
         else if (first == "FRUSTUM_EULER_ROLL") {
-            data.frustumEulerAngles.roll = std::stof(std::string(rest));
+            data.frustumEulerAngles.roll = toFloat(rest);
         }
         else if (first == "LABEL") {
             data.label = std::string(rest);
         }
         else if (first == "APPLY_MASK") {
-            data.applyMask = std::stoi(std::string(rest));
+            data.applyMask = toInt(rest);
             if (data.applyMask) {
                 Log::Warning(fmt::format(
                     "Mesh '{}' requested to apply a mask. Currently this is handled "
@@ -285,7 +304,7 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "APPLY_BLACK_LEVEL") {
-            data.applyBlackLevel = std::stoi(std::string(rest));
+            data.applyBlackLevel = toInt(rest);
             if (data.applyBlackLevel) {
                 Log::Warning(fmt::format(
                     "Mesh '{}' requested to apply a blacklevel image. Currently this is "
@@ -295,7 +314,7 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             }
         }
         else if (first == "APPLY_COLOR") {
-            data.applyColor = std::stoi(std::string(rest));
+            data.applyColor = toInt(rest);
             if (data.applyBlackLevel) {
                 Log::Warning(fmt::format(
                     "Mesh '{}' requested to apply an overlay image. Currently this is "
@@ -306,31 +325,18 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
         }
         else if (first == "[") {
             // Face
-            size_t sep = rest.find(' ');
-            std::string_view f1 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view f2 = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view f3 = rest.substr(0, sep);
-
             Data::Face f;
-            f.f1 = static_cast<unsigned int>(std::stoi(std::string(f1)));
-            f.f2 = static_cast<unsigned int>(std::stoi(std::string(f2)));
-            f.f3 = static_cast<unsigned int>(std::stoi(std::string(f3)));
+            f.f1 = static_cast<unsigned int>(toInt(scanner.token()));
+            f.f2 = static_cast<unsigned int>(toInt(scanner.token()));
+            f.f3 = static_cast<unsigned int>(toInt(scanner.token()));
             data.faces.push_back(f);
         }
         else {
-            // Nothing matched previously, so it has to be a vertex or an unknown key now
-            try {
-                // We try to convert the first value into a float.  If it succeeds, we
-                // have reached the vertices.  Otherwise we have found an unknown key
-                [[ maybe_unused ]] float dummy = std::stof(std::string(first));
-            }
-            catch (const std::invalid_argument&) {
+            // Nothing matched previously, so it has to be a vertex or an unknown key now.
+            // We try to convert the first value into a float.  If it succeeds, we have
+            // reached the vertices.  Otherwise we have found an unknown key
+            Data::Vertex vertex;
+            if (!Scanner(first).number(vertex.x)) {
                 Log::Warning(fmt::format(
                     "Unknown key {} found in scalable mesh '{}'. Please report usage of "
                     "this key, preferably with an example, to the SGCT developers",
@@ -339,35 +345,15 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
                 continue;
             }
 
-
-            std::string_view x = first;
-
-            size_t sep = rest.find(' ');
-            std::string_view y = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view intensity = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view s = rest.substr(0, sep);
-            rest = rest.substr(sep + 1);
-
-            sep = rest.find(' ');
-            std::string_view t = rest.substr(0, sep);
-
-            Data::Vertex vertex;
-            vertex.x = std::stof(std::string(x));
-            vertex.y = std::stof(std::string(y));
-            vertex.intensity = std::stoi(std::string(intensity));
-            vertex.s = std::stof(std::string(s));
-            vertex.t = std::stof(std::string(t));
+            vertex.y = toFloat(scanner.token());
+            vertex.intensity = toInt(scanner.token());
+            vertex.s = toFloat(scanner.token());
+            vertex.t = toFloat(scanner.token());
             data.vertices.push_back(vertex);
         }
     }
 
-
+    Buffer buf;
     if (data.perspective.hasFov) {
         // pitch, yaw, roll.  degrees -> radians
         // if we don't have a direction, all these values will be 0 anyway
@@ -377,23 +363,20 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
             glm::radians(data.perspective.direction.roll)
         ));
 
-        parent.setViewPlaneCoordsUsingFOVs(
+        buf.viewPlane = Buffer::ViewPlane{
             data.perspective.fov.top,
             data.perspective.fov.bottom,
             data.perspective.fov.left,
             data.perspective.fov.right,
             fromGLM<glm::quat, quat>(q)
-        );
-        Engine::instance().updateFrustums();
+        };
     }
     if (data.perspective.hasOffset) {
-        parent.projectionPlane().offset(
-            vec3{
-                data.perspective.offset.x,
-                data.perspective.offset.y,
-                data.perspective.offset.z
-            }
-        );
+        buf.projectionPlaneOffset = vec3{
+            data.perspective.offset.x,
+            data.perspective.offset.y,
+            data.perspective.offset.z
+        };
     }
     if (data.nVertices != static_cast<int>(data.vertices.size()) ||
         data.nFaces != static_cast<int>(data.faces.size()))
@@ -404,7 +387,6 @@ Buffer generateScalableMesh(const std::string& path, BaseViewport& parent) {
         );
     }
 
-    Buffer buf;
     buf.geometryType = GL_TRIANGLES;
     buf.vertices.reserve(data.vertices.size());
     for (const Data::Vertex& vertex : data.vertices) {
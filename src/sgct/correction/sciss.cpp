@@ -8,14 +8,12 @@
 
 #include <sgct/correction/sciss.h>
 
-#include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
 #include <sgct/viewport.h>
-#include <sgct/user.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
@@ -52,7 +50,7 @@ namespace {
 
 namespace sgct::correction {
 
-Buffer generateScissMesh(const std::string& path, BaseViewport& parent) {
+Buffer generateScissMesh(const std::string& path, const BaseViewport& parent) {
     ZoneScoped
 
     Buffer buf;
@@ -180,16 +178,14 @@ Buffer generateScissMesh(const std::string& path, BaseViewport& parent) {
 
     fclose(file);
 
-    parent.user().setPos(vec3{ viewData.x, viewData.y, viewData.z });
-    parent.setViewPlaneCoordsUsingFOVs(
+    buf.userPosition = vec3{ viewData.x, viewData.y, viewData.z };
+    buf.viewPlane = Buffer::ViewPlane{
         viewData.fovUp,
         viewData.fovDown,
         viewData.fovLeft,
         viewData.fovRight,
         quat{ viewData.qx, viewData.qy, viewData.qz, viewData.qw }
-    );
-
-    Engine::instance().updateFrustums();
+    };
 
     buf.vertices.resize(nVertices);
     for (unsigned int i = 0; i < nVertices; i++) {
@@ -8,6 +8,7 @@
 
 #include <sgct/correction/simcad.h>
 
+#include <sgct/correction/textparser.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
@@ -16,24 +17,27 @@
 #include <sgct/tinyxml.h>
 #include <sgct/viewport.h>
 #include <glm/glm.hpp>
-#include <sstream>
 
 #define Error(code, msg) Error(Error::Component::SimCAD, code, msg)
 
+namespace sgct::correction {
+
 namespace {
-    std::vector<std::string> split(std::string str, char delimiter) {
-        std::vector<std::string> res;
-        std::stringstream ss(std::move(str));
-        std::string part;
-        while (std::getline(ss, part, delimiter)) {
-            res.push_back(part);
+    void parseCorrections(const char* text, float range, std::vector<float>& res) {
+        Scanner scanner(text ? text : "");
+        while (!scanner.isEmpty()) {
+            float value;
+            if (!scanner.number(value)) {
+                throw Error(
+                    2085,
+                    fmt::format("Error parsing correction value '{}'", scanner.token())
+                );
+            }
+            res.push_back(value / range);
         }
-        return res;
     }
 } // namespace
 
-namespace sgct::correction {
-
 Buffer generateSimCADMesh(const std::string& path, const vec2& pos, const vec2& size) {
     ZoneScoped
 
@@ -77,21 +81,13 @@ Buffer generateSimCADMesh(const std::string& path, const vec2& pos, const vec2&
         if (childVal == "X-FlatParameters") {
             float xrange = 1.f;
             if (child->QueryFloatAttribute("range", &xrange) == XML_SUCCESS) {
-                std::string xcoordstr(child->GetText());
-                std::vector<std::string> xcoords = split(xcoordstr, ' ');
-                for (const std::string& x : xcoords) {
-                    xcorrections.push_back(std::stof(x) / xrange);
-                }
+                parseCorrections(child->GetText(), xrange, xcorrections);
             }
         }
         else if (childVal == "Y-FlatParameters") {
             float yrange = 1.f;
             if (child->QueryFloatAttribute("range", &yrange) == XML_SUCCESS) {
-                std::string ycoordstr(child->GetText());
-                std::vector<std::string> ycoords = split(ycoordstr, ' ');
-                for (const std::string& y : ycoords) {
-                    ycorrections.push_back(std::stof(y) / yrange);
-                }
+                parseCorrections(child->GetText(), yrange, ycorrections);
             }
         }
 
@@ -8,14 +8,13 @@
 
 #include <sgct/correction/skyskan.h>
 
-#include <sgct/engine.h>
+#include <sgct/correction/textparser.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
 #include <sgct/viewport.h>
-#include <sgct/user.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -34,15 +33,15 @@ namespace {
 
 namespace sgct::correction {
 
-Buffer generateSkySkanMesh(const std::string& path, BaseViewport& parent) {
+Buffer generateSkySkanMesh(const std::string& path, const BaseViewport& parent) {
     ZoneScoped
 
     Buffer buf;
 
     Log::Info(fmt::format("Reading SkySkan mesh data from '{}'", path));
 
-    FILE* meshFile = fopen(path.c_str(), "r");
-    if (meshFile == nullptr) {
+    TextFile file(path);
+    if (!file.isOpen()) {
         throw Error(2090, fmt::format("Failed to open file '{}'", path));
     }
 
@@ -58,36 +57,41 @@ Buffer generateSkySkanMesh(const std::string& path, BaseViewport& parent) {
     unsigned int sizeY = 0;
     unsigned int counter = 0;
 
-    while (!feof(meshFile)) {
-        constexpr const int MaxLineLength = 1024;
-        char lineBuffer[MaxLineLength];
-        char* res = fgets(lineBuffer, MaxLineLength, meshFile);
-        if (res == nullptr) {
-            continue;
-        }
+    std::string_view line;
+    while (file.nextLine(line)) {
+        // Parses lines of the form "<key>=<value>"
+        auto keyValue = [line](std::string_view key, float& value) {
+            Scanner scanner(line);
+            return scanner.literal(key) && scanner.character('=') &&
+                   scanner.number(value);
+        };
+        auto numbers = [line](auto&... values) {
+            Scanner scanner(line);
+            return (scanner.number(values) && ...);
+        };
 
         float x, y, u, v;
-        if (sscanf(lineBuffer, "Dome Azimuth=%f", &v) == 1) {
+        if (keyValue("Dome Azimuth", v)) {
             azimuth = v;
         }
-        else if (sscanf(lineBuffer, "Dome Elevation=%f", &v) == 1) {
+        else if (keyValue("Dome Elevation", v)) {
             elevation = v;
         }
-        else if (sscanf(lineBuffer, "Horizontal FOV=%f", &v) == 1) {
+        else if (keyValue("Horizontal FOV", v)) {
             hFov = v;
         }
-        else if (sscanf(lineBuffer, "Vertical FOV=%f", &v) == 1) {
+        else if (keyValue("Vertical FOV", v)) {
             vFov = v;
         }
-        else if (sscanf(lineBuffer, "Horizontal Tweak=%f", &fovTweaks.x) == 1) {}
-        else if (sscanf(lineBuffer, "Vertical Tweak=%f", &fovTweaks.y) == 1) {}
-        else if (sscanf(lineBuffer, "U Tweak=%f", &uvTweaks.x) == 1) {}
-        else if (sscanf(lineBuffer, "V Tweak=%f", &uvTweaks.y) == 1) {}
-        else if (!areDimsSet && sscanf(lineBuffer, "%u %u", &sizeX, &sizeY) == 2) {
+        else if (keyValue("Horizontal Tweak", fovTweaks.x)) {}
+        else if (keyValue("Vertical Tweak", fovTweaks.y)) {}
+        else if (keyValue("U Tweak", uvTweaks.x)) {}
+        else if (keyValue("V Tweak", uvTweaks.y)) {}
+        else if (!areDimsSet && numbers(sizeX, sizeY)) {
             areDimsSet = true;
             buf.vertices.resize(static_cast<size_t>(sizeX) * static_cast<size_t>(sizeY));
         }
-        else if (areDimsSet && sscanf(lineBuffer, "%f %f %f %f", &x, &y, &u, &v) == 4) {
+        else if (areDimsSet && counter < buf.vertices.size() && numbers(x, y, u, v)) {
             if (uvTweaks.x > -1.f) {
                 u *= uvTweaks.x;
             }
@@ -109,8 +113,6 @@ Buffer generateSkySkanMesh(const std::string& path, BaseViewport& parent) {
         }
     }
 
-    fclose(meshFile);
-
     if (!areDimsSet || !azimuth.has_value() || !elevation.has_value() ||
         !hFov.has_value() || *hFov <= 0.f)
     {
@@ -139,17 +141,16 @@ Buffer generateSkySkanMesh(const std::string& path, BaseViewport& parent) {
     rotQuat = glm::rotate(rotQuat, glm::radians(-*azimuth), glm::vec3(0.f, 1.f, 0.f));
     rotQuat = glm::rotate(rotQuat, glm::radians(*elevation), glm::vec3(1.f, 0.f, 0.f));
 
-    parent.user().setPos(vec3{ 0.f, 0.f, 0.f });
+    buf.userPosition = vec3{ 0.f, 0.f, 0.f };
     const float vHalf = *vFov / 2.f;
     const float hHalf = *hFov / 2.f;
-    parent.setViewPlaneCoordsUsingFOVs(
+    buf.viewPlane = Buffer::ViewPlane{
         vHalf,
         -vHalf,
         -hHalf,
         hHalf,
         fromGLM<glm::quat, quat>(rotQuat)
-    );
-    Engine::instance().updateFrustums();
+    };
 
     for (unsigned int c = 0; c < (sizeX - 1); c++) {
         for (unsigned int r = 0; r < (sizeY - 1); r++) {
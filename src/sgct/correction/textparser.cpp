@@ -0,0 +1,258 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/correction/textparser.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <system_error>
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <Windows.h>
+#else // WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    bool isWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    // Removes the '+' that std::from_chars does not accept but the C functions do
+    std::string_view withoutPlus(std::string_view text) {
+        if (text.size() > 1 && text[0] == '+' && text[1] != '-') {
+            text.remove_prefix(1);
+        }
+        return text;
+    }
+
+    template <typename T>
+    bool parseInteger(std::string_view& text, T& value) {
+        const std::string_view t = withoutPlus(text);
+        const char* end = t.data() + t.size();
+        const std::from_chars_result res = std::from_chars(t.data(), end, value);
+        if (res.ec != std::errc()) {
+            return false;
+        }
+        text.remove_prefix(res.ptr - text.data());
+        return true;
+    }
+
+    bool parseFloat(std::string_view& text, float& value) {
+        const std::string_view t = withoutPlus(text);
+#ifdef __cpp_lib_to_chars
+        const char* end = t.data() + t.size();
+        const std::from_chars_result res = std::from_chars(t.data(), end, value);
+        if (res.ec != std::errc()) {
+            return false;
+        }
+        text.remove_prefix(res.ptr - text.data());
+        return true;
+#else // __cpp_lib_to_chars
+        // Standard libraries without floating point support in std::from_chars get the
+        // number copied into a terminated buffer for std::strtof instead
+        constexpr size_t MaxLength = 64;
+        char buffer[MaxLength + 1];
+        const size_t length = std::min(t.size(), MaxLength);
+        std::copy(t.begin(), t.begin() + length, buffer);
+        buffer[length] = '\0';
+        if (length == 0 || isWhitespace(buffer[0])) {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtof(buffer, &end);
+        if (end == buffer) {
+            return false;
+        }
+        text.remove_prefix((t.data() - text.data()) + (end - buffer));
+        return true;
+#endif // __cpp_lib_to_chars
+    }
+} // namespace
+
+namespace sgct::correction {
+
+TextFile::TextFile(const std::string& path) {
+#ifdef WIN32
+    HANDLE handle = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    _handle = handle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        return;
+    }
+    if (size.QuadPart == 0) {
+        // Empty files can't be mapped, but they are still valid files
+        _isOpen = true;
+        return;
+    }
+
+    _mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+        return;
+    }
+    _base = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (_base == nullptr) {
+        return;
+    }
+    const size_t length = static_cast<size_t>(size.QuadPart);
+#else // WIN32
+    _handle = open(path.c_str(), O_RDONLY);
+    if (_handle == -1) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(_handle, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return;
+    }
+    if (info.st_size == 0) {
+        // Empty files can't be mapped, but they are still valid files
+        _isOpen = true;
+        return;
+    }
+
+    const size_t length = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, _handle, 0);
+    if (base == MAP_FAILED) {
+        return;
+    }
+    _base = base;
+#ifdef MADV_SEQUENTIAL
+    madvise(_base, length, MADV_SEQUENTIAL);
+#endif // MADV_SEQUENTIAL
+#endif // WIN32
+
+    _contents = std::string_view(static_cast<const char*>(_base), length);
+    _isOpen = true;
+}
+
+TextFile::~TextFile() {
+#ifdef WIN32
+    if (_base) {
+        UnmapViewOfFile(_base);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+    }
+    if (_handle) {
+        CloseHandle(_handle);
+    }
+#else // WIN32
+    if (_base) {
+        munmap(_base, _contents.size());
+    }
+    if (_handle != -1) {
+        close(_handle);
+    }
+#endif // WIN32
+}
+
+bool TextFile::isOpen() const {
+    return _isOpen;
+}
+
+std::string_view TextFile::contents() const {
+    return _contents;
+}
+
+bool TextFile::nextLine(std::string_view& line) {
+    if (_position >= _contents.size()) {
+        return false;
+    }
+
+    const size_t end = std::min(_contents.find('\n', _position), _contents.size());
+    line = _contents.substr(_position, end - _position);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    _position = end + 1;
+    _lineNumber++;
+    return true;
+}
+
+int TextFile::lineNumber() const {
+    return _lineNumber;
+}
+
+Scanner::Scanner(std::string_view text) : _text(text) {}
+
+std::string_view Scanner::token() {
+    skipWhitespace();
+    const auto end = std::find_if(_text.begin(), _text.end(), isWhitespace);
+    const size_t length = static_cast<size_t>(std::distance(_text.begin(), end));
+    const std::string_view res = _text.substr(0, length);
+    _text.remove_prefix(length);
+    return res;
+}
+
+bool Scanner::number(float& value) {
+    skipWhitespace();
+    return parseFloat(_text, value);
+}
+
+bool Scanner::number(int& value) {
+    skipWhitespace();
+    return parseInteger(_text, value);
+}
+
+bool Scanner::number(unsigned int& value) {
+    skipWhitespace();
+    return parseInteger(_text, value);
+}
+
+bool Scanner::character(char c) {
+    if (_text.empty() || _text.front() != c) {
+        return false;
+    }
+    _text.remove_prefix(1);
+    return true;
+}
+
+bool Scanner::literal(std::string_view prefix) {
+    if (_text.substr(0, prefix.size()) != prefix) {
+        return false;
+    }
+    _text.remove_prefix(prefix.size());
+    return true;
+}
+
+std::string_view Scanner::rest() {
+    skipWhitespace();
+    return _text;
+}
+
+bool Scanner::isEmpty() {
+    skipWhitespace();
+    return _text.empty();
+}
+
+void Scanner::skipWhitespace() {
+    const auto begin = std::find_if_not(_text.begin(), _text.end(), isWhitespace);
+    _text.remove_prefix(static_cast<size_t>(std::distance(_text.begin(), begin)));
+}
+
+} // namespace sgct::correction
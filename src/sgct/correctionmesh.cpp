@@ -8,18 +8,22 @@
 
 #include <sgct/correctionmesh.h>
 
+#include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
+#include <sgct/imageloader.h>
 #include <sgct/log.h>
 #include <sgct/math.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
 #include <sgct/settings.h>
+#include <sgct/user.h>
 #include <sgct/viewport.h>
 #include <sgct/window.h>
 #include <sgct/correction/domeprojection.h>
-#include <sgct/correction/mpcdimesh.h>
+#include <sgct/correction/meshcache.h>
 #include <sgct/correction/obj.h>
+#include <sgct/correction/optimize.h>
 #include <sgct/correction/paulbourke.h>
 #include <sgct/correction/pfm.h>
 #include <sgct/correction/scalable.h>
@@ -28,14 +32,63 @@
 #include <sgct/correction/skyskan.h>
 #include <sgct/projection/fisheye.h>
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <optional>
 
 #define Error(c, msg) sgct::Error(sgct::Error::Component::CorrectionMesh, c, msg)
 
 namespace sgct {
 
 namespace {
+correction::Buffer generateMesh(const std::string& path, const std::string& ext,
+                                const BaseViewport& parent)
+{
+    using namespace correction;
+    const vec2& parentPos = parent.position();
+    const vec2& parentSize = parent.size();
+
+    // find a suitable format
+    if (ext == "sgc") {
+        return generateScissMesh(path, parent);
+    }
+    else if (ext == "ol") {
+        return generateScalableMesh(path, parent);
+    }
+    else if (ext == "skyskan") {
+        return generateSkySkanMesh(path, parent);
+    }
+    else if (ext == "txt") {
+        return generateSkySkanMesh(path, parent);
+    }
+    else if (ext == "csv") {
+        return generateDomeProjectionMesh(path, parentPos, parentSize);
+    }
+    else if (ext == "data") {
+        const float aspectRatio = parent.window().aspectRatio();
+        return generatePaulBourkeMesh(path, parentPos, parentSize, aspectRatio);
+    }
+    else if (ext == "obj") {
+        return generateOBJMesh(path);
+    }
+    else if (ext == "pfm") {
+        return generatePerEyeMeshFromPFMImage(path, parentPos, parentSize);
+    }
+    else if (ext == "mpcdi") {
+        // The meshes of MPCDI files are generated while the file is read and are passed
+        // to prepareMesh, so a viewport that ends up here has no MPCDI mesh
+        throw Error(2020, "Configuration error. Trying load MPCDI to wrong viewport");
+    }
+    else if (ext == "simcad") {
+        return generateSimCADMesh(path, parentPos, parentSize);
+    }
+    else {
+        throw Error(2002, "Could not determine format for warping mesh");
+    }
+}
+
 correction::Buffer setupMaskMesh(const vec2& pos, const vec2& size) {
     correction::Buffer buff;
     buff.geometryType = GL_TRIANGLE_STRIP;
@@ -173,8 +226,10 @@ CorrectionMesh::CorrectionMeshGeometry::~CorrectionMeshGeometry() {
     }
 }
 
-void CorrectionMesh::loadMesh(std::string path, BaseViewport& parent,
-                              bool needsMaskGeometry)
+CorrectionMesh::Buffers CorrectionMesh::generateBuffers(const std::string& path,
+                                                        const BaseViewport& parent,
+                                                        bool needsMaskGeometry,
+                                                   std::optional<correction::Buffer> warp)
 {
     ZoneScoped
 
@@ -182,52 +237,128 @@ void CorrectionMesh::loadMesh(std::string path, BaseViewport& parent,
     const vec2& parentPos = parent.position();
     const vec2& parentSize = parent.size();
 
+    Buffers res;
+
     // generate unwarped mask
     {
         ZoneScopedN("Create simple mask")
-        Buffer buf = setupSimpleMesh(parentPos, parentSize);
-        createMesh(_quadGeometry, buf);
+        res.quad = setupSimpleMesh(parentPos, parentSize);
     }
 
     // generate unwarped mesh for mask
     if (needsMaskGeometry) {
         ZoneScopedN("Create unwarped mask")
         Log::Debug("CorrectionMesh: Creating mask mesh");
-
-        Buffer buf = setupMaskMesh(parentPos, parentSize);
-        createMesh(_maskGeometry, buf);
+        res.mask = setupMaskMesh(parentPos, parentSize);
     }
 
     // fallback if no mesh is provided
     if (path.empty()) {
-        Buffer buf = setupSimpleMesh(parentPos, parentSize);
-        createMesh(_warpGeometry, buf);
-        return;
+        res.warp = setupSimpleMesh(parentPos, parentSize);
+        return res;
     }
 
-    Buffer buf;
+    const std::string ext = path.substr(path.rfind('.') + 1);
 
-    std::string ext = path.substr(path.rfind('.') + 1);
-    // find a suitable format
-    if (ext == "sgc") {
-        buf = generateScissMesh(path, parent);
+    // Meshes that were passed in, like the ones of MPCDI files, are not cached as they
+    // have already been read with the configuration
+    const std::string& cachePath = Settings::instance().meshCachePath();
+    const std::optional<float> maxError = Settings::instance().meshSimplificationError();
+    std::string key;
+    if (!cachePath.empty() && !warp) {
+        const float aspectRatio = ext == "data" ? parent.window().aspectRatio() : 0.f;
+        key = meshCacheKey(path, parentPos, parentSize, aspectRatio, maxError);
     }
-    else if (ext == "ol") {
-        buf = generateScalableMesh(path, parent);
+    const std::filesystem::path cacheFile =
+        key.empty() ? "" : std::filesystem::path(cachePath) / meshCacheName(key);
+
+    std::optional<Buffer> cached;
+    if (!cacheFile.empty()) {
+        cached = readMeshCache(cacheFile, key);
     }
-    else if (ext == "skyskan") {
-        buf = generateSkySkanMesh(path, parent);
+    if (cached) {
+        Log::Debug(fmt::format("Loaded mesh '{}' from the mesh cache", path));
+        res.warp = std::move(*cached);
     }
-    else if (ext == "txt") {
-        buf = generateSkySkanMesh(path, parent);
+    else {
+        res.warp = warp ? std::move(*warp) : generateMesh(path, ext, parent);
+        if (maxError) {
+            const size_t nVertices = res.warp.vertices.size();
+            const size_t nIndices = res.warp.indices.size();
+            optimizeMesh(res.warp, *maxError);
+            Log::Debug(fmt::format(
+                "Optimized mesh '{}' from {} vertices and {} indices to {} and {}",
+                path, nVertices, nIndices, res.warp.vertices.size(),
+                res.warp.indices.size()
+            ));
+        }
+        if (!cacheFile.empty()) {
+            writeMeshCache(cacheFile, key, res.warp);
+        }
     }
-    else if (ext == "csv") {
-        buf = generateDomeProjectionMesh(path, parentPos, parentSize);
+    return res;
+}
+
+void CorrectionMesh::prepareMesh(std::string path, const BaseViewport& parent,
+                                 bool needsMaskGeometry)
+{
+    // The meshes of all viewports are generated on the image loader threads, which
+    // bounds the number of threads no matter how many viewports there are
+    _preparedPath = path;
+    _preparedBuffers = ImageLoader::instance().run(
+        [path = std::move(path), &parent, needsMaskGeometry]() {
+            return generateBuffers(path, parent, needsMaskGeometry, std::nullopt);
+        }
+    );
+}
+
+void CorrectionMesh::prepareMesh(std::string path, correction::Buffer warp,
+                                 const BaseViewport& parent, bool needsMaskGeometry)
+{
+    _preparedPath = path;
+    _preparedBuffers = ImageLoader::instance().run(
+        [path = std::move(path), warp = std::move(warp), &parent,
+         needsMaskGeometry]() mutable
+        {
+            return generateBuffers(path, parent, needsMaskGeometry, std::move(warp));
+        }
+    );
+}
+
+void CorrectionMesh::loadMesh(std::string path, BaseViewport& parent,
+                              bool needsMaskGeometry)
+{
+    ZoneScoped
+
+    using namespace correction;
+
+    Buffers buffers;
+    if (_preparedBuffers.valid() && _preparedPath == path) {
+        ZoneScopedN("Wait for prepared mesh")
+        buffers = _preparedBuffers.get();
+    }
+    else {
+        // Discard meshes that were prepared for a different file
+        _preparedBuffers = std::future<Buffers>();
+        buffers = generateBuffers(path, parent, needsMaskGeometry, std::nullopt);
+    }
+    if (needsMaskGeometry && !buffers.mask) {
+        buffers.mask = setupMaskMesh(parent.position(), parent.size());
+    }
+
+    createMesh(_quadGeometry, buffers.quad);
+    if (needsMaskGeometry) {
+        createMesh(_maskGeometry, *buffers.mask);
     }
-    else if (ext == "data") {
-        const float aspectRatio = parent.window().aspectRatio();
-        buf = generatePaulBourkeMesh(path, parentPos, parentSize, aspectRatio);
 
+    const Buffer& buf = buffers.warp;
+    if (path.empty()) {
+        createMesh(_warpGeometry, buf);
+        return;
+    }
+
+    const std::string ext = path.substr(path.rfind('.') + 1);
+    if (ext == "data") {
         // force regeneration of dome render quad
         if (Viewport* vp = dynamic_cast<Viewport*>(&parent); vp) {
             auto fishPrj = dynamic_cast<FisheyeProjection*>(vp->nonLinearProjection());
@@ -237,24 +368,21 @@ void CorrectionMesh::loadMesh(std::string path, BaseViewport& parent,
             }
         }
     }
-    else if (ext == "obj") {
-        buf = generateOBJMesh(path);
+
+    if (buf.userPosition) {
+        parent.user().setPos(*buf.userPosition);
     }
-    else if (ext == "pfm") {
-        buf = generatePerEyeMeshFromPFMImage(path, parentPos, parentSize);
+    if (buf.viewPlane) {
+        const Buffer::ViewPlane& vp = *buf.viewPlane;
+        parent.setViewPlaneCoordsUsingFOVs(
+            vp.up, vp.down, vp.left, vp.right, vp.orientation
+        );
     }
-    else if (ext == "mpcdi") {
-        const Viewport* vp = dynamic_cast<const Viewport*>(&parent);
-        if (vp == nullptr) {
-            throw Error(2020, "Configuration error. Trying load MPCDI to wrong viewport");
-        }
-        buf = generateMpcdiMesh(vp->mpcdiWarpMesh());
+    if (buf.projectionPlaneOffset) {
+        parent.projectionPlane().offset(*buf.projectionPlaneOffset);
     }
-    else if (ext == "simcad") {
-        buf = generateSimCADMesh(path, parentPos, parentSize);
-    }
-    else {
-        throw Error(2002, "Could not determine format for warping mesh");
+    if (buf.userPosition || buf.viewPlane || buf.projectionPlaneOffset) {
+        Engine::instance().updateFrustums();
     }
 
     createMesh(_warpGeometry, buf);
@@ -275,7 +403,12 @@ void CorrectionMesh::renderQuadMesh() const {
     TracyGpuZone("Render Quad mesh")
 
     glBindVertexArray(_quadGeometry.vao);
-    glDrawElements(_quadGeometry.type, _quadGeometry.nIndices, GL_UNSIGNED_INT, nullptr);
+    glDrawElements(
+        _quadGeometry.type,
+        _quadGeometry.nIndices,
+        _quadGeometry.indexType,
+        nullptr
+    );
     glBindVertexArray(0);
 }
 
@@ -283,7 +416,12 @@ void CorrectionMesh::renderWarpMesh() const {
     TracyGpuZone("Render Warp mesh")
 
     glBindVertexArray(_warpGeometry.vao);
-    glDrawElements(_warpGeometry.type, _warpGeometry.nIndices, GL_UNSIGNED_INT, nullptr);
+    glDrawElements(
+        _warpGeometry.type,
+        _warpGeometry.nIndices,
+        _warpGeometry.indexType,
+        nullptr
+    );
     glBindVertexArray(0);
 }
 
@@ -291,7 +429,12 @@ void CorrectionMesh::renderMaskMesh() const {
     TracyGpuZone("Render Mask mesh")
 
     glBindVertexArray(_maskGeometry.vao);
-    glDrawElements(_maskGeometry.type, _maskGeometry.nIndices, GL_UNSIGNED_INT, nullptr);
+    glDrawElements(
+        _maskGeometry.type,
+        _maskGeometry.nIndices,
+        _maskGeometry.indexType,
+        nullptr
+    );
     glBindVertexArray(0);
 }
 
@@ -325,12 +468,27 @@ void CorrectionMesh::createMesh(CorrectionMeshGeometry& geom,
 
     glGenBuffers(1, &geom.ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geom.ibo);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        buffer.indices.size() * sizeof(unsigned int),
-        buffer.indices.data(),
-        GL_STATIC_DRAW
-    );
+    // 16 bit indices halve the index data that is read every time the mesh is drawn
+    constexpr size_t MaxShortIndexVertices = std::numeric_limits<uint16_t>::max() + 1;
+    if (buffer.vertices.size() <= MaxShortIndexVertices) {
+        const std::vector<uint16_t> indices(buffer.indices.begin(), buffer.indices.end());
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER,
+            indices.size() * sizeof(uint16_t),
+            indices.data(),
+            GL_STATIC_DRAW
+        );
+        geom.indexType = GL_UNSIGNED_SHORT;
+    }
+    else {
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER,
+            buffer.indices.size() * sizeof(unsigned int),
+            buffer.indices.data(),
+            GL_STATIC_DRAW
+        );
+        geom.indexType = GL_UNSIGNED_INT;
+    }
     glBindVertexArray(0);
 
     geom.nVertices = static_cast<int>(buffer.vertices.size());
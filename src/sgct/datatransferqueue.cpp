@@ -0,0 +1,231 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/datatransferqueue.h>
+
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/network.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace sgct {
+
+struct DataTransferQueue::Package {
+    std::shared_ptr<const std::vector<char>> data;
+    int id = -1;
+    int nChunks = 1;
+
+    // The compressed chunks, indexed by the codec. A nullptr means that the chunk has
+    // not been compressed yet, an empty vector that it does not get smaller when
+    // compressed. If two connections compress the same chunk at the same time, the
+    // first result is kept
+    std::mutex mutex;
+    std::array<std::vector<std::shared_ptr<const std::vector<char>>>, 3> compressed;
+};
+
+DataTransferQueue::DataTransferQueue(std::function<void(int, int, float)> progress)
+    : _progress(std::move(progress))
+{}
+
+DataTransferQueue::~DataTransferQueue() {
+    {
+        std::unique_lock lock(_mutex);
+        _shouldTerminate = true;
+    }
+    _cond.notify_all();
+    _emptyCond.notify_all();
+
+    for (std::unique_ptr<Worker>& w : _workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+}
+
+void DataTransferQueue::push(std::shared_ptr<const std::vector<char>> data,
+                             int packageId, const std::vector<Network*>& connections)
+{
+    ZoneScoped
+
+    auto package = std::make_shared<Package>();
+    package->data = std::move(data);
+    package->id = packageId;
+    const int size = static_cast<int>(package->data->size());
+    package->nChunks = std::max((size + ChunkSize - 1) / ChunkSize, 1);
+    for (std::vector<std::shared_ptr<const std::vector<char>>>& c : package->compressed) {
+        c.resize(package->nChunks);
+    }
+
+    {
+        std::unique_lock lock(_mutex);
+        for (Network* connection : connections) {
+            if (!connection->isConnected()) {
+                continue;
+            }
+            worker(*connection).transfers.push_back({ package, 0 });
+            _nPendingTransfers++;
+        }
+    }
+    _cond.notify_all();
+}
+
+int DataTransferQueue::nPendingTransfers() const {
+    std::unique_lock lock(_mutex);
+    return _nPendingTransfers;
+}
+
+void DataTransferQueue::waitUntilEmpty() {
+    std::unique_lock lock(_mutex);
+    _emptyCond.wait(
+        lock,
+        [this]() { return _shouldTerminate || _nPendingTransfers == 0; }
+    );
+}
+
+DataTransferQueue::Worker& DataTransferQueue::worker(Network& connection) {
+    // Has to be called with the mutex locked
+    auto it = std::find_if(
+        _workers.begin(),
+        _workers.end(),
+        [&connection](const std::unique_ptr<Worker>& w) {
+            return w->connection == &connection;
+        }
+    );
+    if (it != _workers.end()) {
+        return **it;
+    }
+
+    auto w = std::make_unique<Worker>();
+    w->connection = &connection;
+    Worker& res = *w;
+    w->thread = std::thread([this, &res]() { sendLoop(res); });
+    _workers.push_back(std::move(w));
+    return res;
+}
+
+void DataTransferQueue::sendLoop(Worker& worker) {
+    Network& connection = *worker.connection;
+
+    while (true) {
+        Transfer transfer;
+        {
+            std::unique_lock lock(_mutex);
+            _cond.wait(
+                lock,
+                [this, &worker]() {
+                    return _shouldTerminate || !worker.transfers.empty();
+                }
+            );
+            if (_shouldTerminate) {
+                return;
+            }
+            transfer = std::move(worker.transfers.front());
+            worker.transfers.pop_front();
+        }
+
+        bool isFailed = !connection.isConnected();
+        if (!isFailed) {
+            try {
+                sendChunk(connection, transfer);
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(fmt::format(
+                    "Failed to send package {} to connection {}: {}",
+                    transfer.package->id, connection.id(), e.what()
+                ));
+                isFailed = true;
+            }
+        }
+
+        std::unique_lock lock(_mutex);
+        if (isFailed) {
+            // Nothing else can be sent through this connection, so all of its transfers
+            // are dropped to release everyone who is waiting for the queue to drain
+            _nPendingTransfers -= 1 + static_cast<int>(worker.transfers.size());
+            worker.transfers.clear();
+            _emptyCond.notify_all();
+        }
+        else if (transfer.nextChunk >= transfer.package->nChunks) {
+            _nPendingTransfers--;
+            _emptyCond.notify_all();
+        }
+        else {
+            // The next chunk of this package is sent after one chunk of all other
+            // packages that are queued for this connection
+            worker.transfers.push_back(std::move(transfer));
+        }
+    }
+}
+
+void DataTransferQueue::sendChunk(Network& connection, Transfer& transfer) {
+    ZoneScopedN("Send data transfer chunk")
+
+    Package& package = *transfer.package;
+    const int size = static_cast<int>(package.data->size());
+    if (transfer.nextChunk == 0) {
+        const std::array<char, Network::HeaderSize> header =
+            Network::createHeader(Network::DataBeginId, package.id, 0, size);
+        connection.sendData(header.data(), Network::HeaderSize);
+    }
+
+    const int offset = transfer.nextChunk * ChunkSize;
+    const int length = std::min(ChunkSize, size - offset);
+    if (length > 0) {
+        const char* chunk = package.data->data() + offset;
+        std::shared_ptr<const std::vector<char>> compressed;
+        if (connection.compression() != Network::Compression::None) {
+            const size_t codec = static_cast<size_t>(connection.compression());
+            {
+                std::unique_lock lock(package.mutex);
+                compressed = package.compressed[codec][transfer.nextChunk];
+            }
+            if (!compressed) {
+                auto buffer = std::make_shared<std::vector<char>>();
+                if (!connection.compressPayload(chunk, length, *buffer)) {
+                    buffer->clear();
+                }
+                std::unique_lock lock(package.mutex);
+                auto& slot = package.compressed[codec][transfer.nextChunk];
+                if (!slot) {
+                    slot = std::move(buffer);
+                }
+                compressed = slot;
+            }
+        }
+
+        if (compressed && !compressed->empty()) {
+            const int s = static_cast<int>(compressed->size());
+            const std::array<char, Network::HeaderSize> header =
+                Network::createHeader(Network::DataChunkId, package.id, s, length);
+            connection.sendData(
+                header.data(),
+                Network::HeaderSize,
+                compressed->data(),
+                s
+            );
+        }
+        else {
+            const std::array<char, Network::HeaderSize> header =
+                Network::createHeader(Network::DataChunkId, package.id, length, 0);
+            connection.sendData(header.data(), Network::HeaderSize, chunk, length);
+        }
+    }
+    transfer.nextChunk++;
+
+    if (_progress) {
+        const float progress = size > 0 ?
+            static_cast<float>(std::min(offset + length, size)) / size :
+            1.f;
+        _progress(package.id, connection.id(), progress);
+    }
+}
+
+} // namespace sgct
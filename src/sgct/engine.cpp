@@ -7,14 +7,18 @@
  ****************************************************************************************/
 
 #include <sgct/engine.h>
+#include <sgct/capturethreadpool.h>
 #include <sgct/clustermanager.h>
 #include <sgct/commandline.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/font.h>
 #include <sgct/fontmanager.h>
+#include <sgct/frametrace.h>
 #include <sgct/freetype.h>
+#include <sgct/imageloader.h>
 #include <sgct/internalshaders.h>
+#include <sgct/mutexes.h>
 #include <sgct/networkmanager.h>
 #include <sgct/node.h>
 #include <sgct/offscreenbuffer.h>
@@ -32,7 +36,9 @@
 #include <sgct/version.h>
 #include <sgct/projection/nonlinearprojection.h>
 #include <cassert>
+#include <filesystem>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <cmath>
 
@@ -50,17 +56,34 @@
 namespace sgct {
 
 namespace {
-    constexpr const bool RunFrameLockCheckThread = true;
+    // The longest time the frame lock waits without a network notification, so that the
+    // waiting message can be printed and the sync timeout can be detected
     constexpr const std::chrono::milliseconds FrameLockTimeout(100);
 
+    // The busy-waiting budget of the frame lock is shared by all waits within one frame,
+    // so that a series of notifications that do not complete the sync do not make the
+    // render thread spin for longer than configured
+    class FrameLockSpin {
+    public:
+        explicit FrameLockSpin(int us)
+            : _end(std::chrono::steady_clock::now() + std::chrono::microseconds(us))
+        {}
+
+        std::chrono::microseconds remaining() const {
+            using namespace std::chrono;
+            const auto r = duration_cast<microseconds>(_end - steady_clock::now());
+            return std::max(r, microseconds(0));
+        }
+
+    private:
+        const std::chrono::steady_clock::time_point _end;
+    };
+
     constexpr const float FxaaSubPixTrim = 1.f / 4.f;
     constexpr const float FxaaSubPixOffset = 1.f / 2.f;
 
     enum class BufferMode { BackBufferBlack, RenderToTexture };
 
-    bool sRunUpdateFrameLockLoop = true;
-    std::mutex FrameSync;
-
     // Callback wrappers for GLFW
     std::function<void(Key, Modifier, Action, int)> gKeyboardCallback = nullptr;
     std::function<void(unsigned int, int)> gCharCallback = nullptr;
@@ -69,25 +92,6 @@ namespace {
     std::function<void(double, double)> gMouseScrollCallback = nullptr;
     std::function<void(int, const char**)> gDropCallback = nullptr;
 
-    // For feedback: breaks a frame lock wait condition every time interval
-    // (FrameLockTimeout) in order to print waiting message.
-    void updateFrameLockLoop(void*) {
-        bool run = true;
-
-        while (run) {
-            FrameSync.lock();
-            run = sRunUpdateFrameLockLoop;
-            FrameSync.unlock();
-            NetworkManager::cond.notify_all();
-            std::this_thread::sleep_for(FrameLockTimeout);
-        }
-    }
-
-    void addValue(std::array<double, Engine::Statistics::HistoryLength>& a, double v) {
-        std::rotate(std::rbegin(a), std::rbegin(a) + 1, std::rend(a));
-        a[0] = v;
-    }
-
     void setAndClearBuffer(Window& window, BufferMode buffer, Frustum::Mode frustum) {
         ZoneScoped
 
@@ -189,6 +193,31 @@ namespace {
     }
 } // namespace
 
+void Engine::Statistics::History::add(double value) {
+    _newest = (_newest + HistoryLength - 1) % HistoryLength;
+    _values[_newest] = value;
+}
+
+double Engine::Statistics::History::operator[](size_t i) const {
+    return _values[(_newest + i) % HistoryLength];
+}
+
+double Engine::Statistics::History::front() const {
+    return _values[_newest];
+}
+
+std::array<double, Engine::Statistics::HistoryLength>::const_iterator
+Engine::Statistics::History::begin() const
+{
+    return _values.begin();
+}
+
+std::array<double, Engine::Statistics::HistoryLength>::const_iterator
+Engine::Statistics::History::end() const
+{
+    return _values.end();
+}
+
 double Engine::Statistics::dt() const {
     return frametimes.front();
 }
@@ -196,8 +225,8 @@ double Engine::Statistics::dt() const {
 double Engine::Statistics::avgDt(unsigned int frameCounter) const {
     const double accFT = std::accumulate(frametimes.begin(), frametimes.end(), 0.0);
     const int nValues = static_cast<int>(std::count_if(
-        frametimes.cbegin(),
-        frametimes.cend(),
+        frametimes.begin(),
+        frametimes.end(),
         [](double d) { return d != 0.0; }
     ));
     // We must take the frame counter into account as the history might not be filled yet
@@ -213,6 +242,29 @@ double Engine::Statistics::Statistics::maxDt() const {
     return *std::max_element(frametimes.begin(), frametimes.end());
 }
 
+void Engine::Statistics::WaitHistogram::add(double seconds) {
+    const double microseconds = seconds * 1e6;
+    int index = 0;
+    if (microseconds >= 1.0) {
+        index = std::min(
+            static_cast<int>(std::log2(microseconds)) + 1,
+            NumberOfBuckets - 1
+        );
+    }
+    buckets[index]++;
+}
+
+uint64_t Engine::Statistics::WaitHistogram::count() const {
+    return std::accumulate(buckets.begin(), buckets.end(), uint64_t(0));
+}
+
+double Engine::Statistics::WaitHistogram::bucketLimit(int index) {
+    if (index >= NumberOfBuckets - 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::ldexp(1.0, index) * 1e-6;
+}
+
 Engine* Engine::_instance = nullptr;
 
 Engine& Engine::instance() {
@@ -315,6 +367,7 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
     ZoneScoped
 
     SharedData::instance().setEncodeFunction(std::move(callbacks.encode));
+    SharedData::instance().setEncodeToBufferFunction(std::move(callbacks.encodeToBuffer));
     SharedData::instance().setDecodeFunction(std::move(callbacks.decode));
 
     gKeyboardCallback = std::move(callbacks.keyboard);
@@ -398,7 +451,8 @@ Engine::Engine(config::Cluster cluster, Callbacks callbacks, const Configuration
         std::move(callbacks.externalStatus),
         std::move(callbacks.dataTransferDecode),
         std::move(callbacks.dataTransferStatus),
-        std::move(callbacks.dataTransferAcknowledge)
+        std::move(callbacks.dataTransferAcknowledge),
+        std::move(callbacks.dataTransferProgress)
     );
 #ifdef SGCT_HAS_VRPN
     for (const config::Tracker& tracker : cluster.trackers) {
@@ -553,6 +607,13 @@ void Engine::initialize() {
 
     Window::makeSharedContextCurrent();
 
+    // The meshes and masks of all viewports are read concurrently while the windows are
+    // initialized, which only have to upload them to the context afterwards
+    for (const std::unique_ptr<Window>& win : wins) {
+        const std::vector<std::unique_ptr<Viewport>>& vps = win->viewports();
+        std::for_each(vps.cbegin(), vps.cend(), std::mem_fn(&Viewport::prepareData));
+    }
+
     //
     // Load Shaders
     bool needsFxaa = std::any_of(wins.begin(), wins.end(), std::mem_fn(&Window::useFXAA));
@@ -641,6 +702,28 @@ void Engine::initialize() {
 
     std::for_each(wins.begin(), wins.end(), std::mem_fn(&Window::initContextSpecificOGL));
 
+    if (const std::string& path = Settings::instance().frameTracePath(); !path.empty()) {
+        const ClusterManager& cm = ClusterManager::instance();
+        std::error_code ec;
+        std::filesystem::create_directories(path, ec);
+        const std::filesystem::path file =
+            std::filesystem::path(path) /
+            fmt::format("frametrace-node{}.sgcttrace", cm.thisNodeId());
+        try {
+            _frameTrace = std::make_unique<FrameTraceWriter>(
+                file.string(),
+                cm.thisNodeId(),
+                isMaster(),
+                thisNode.address()
+            );
+            Log::Info(fmt::format("Writing frame trace to '{}'", file.string()));
+        }
+        catch (const Error& e) {
+            // A missing trace should not prevent the show from running
+            Log::Error(e.what());
+        }
+    }
+
 #ifdef SGCT_HAS_VRPN
     // start sampling tracking data
     if (isMaster()) {
@@ -672,19 +755,6 @@ Engine::~Engine() {
     gMouseScrollCallback = nullptr;
     gDropCallback = nullptr;
 
-    // kill thread
-    if (_thread) {
-        Log::Debug("Waiting for frameLock thread to finish");
-
-        FrameSync.lock();
-        sRunUpdateFrameLockLoop = false;
-        FrameSync.unlock();
-
-        _thread->join();
-        _thread = nullptr;
-        Log::Debug("Done");
-    }
-
     // de-init window and unbind swapgroups
     // There might not be any thisNode as its creation might have failed
     if (hasNode) {
@@ -692,6 +762,13 @@ Engine::~Engine() {
         std::for_each(windows.cbegin(), windows.cend(), std::mem_fn(&Window::close));
     }
 
+    // The windows have waited for their screenshots, so the capture threads are idle
+    Log::Debug("Destroying capture thread pool");
+    CaptureThreadPool::destroy();
+
+    Log::Debug("Destroying image loader");
+    ImageLoader::destroy();
+
     // close TCP connections
     Log::Debug("Destroying network manager");
     NetworkManager::destroy();
@@ -783,12 +860,6 @@ void Engine::initWindows(int majorVersion, int minorVersion) {
     // clear directly otherwise junk will be displayed on some OSs (OS X Yosemite)
     glClearColor(0.f, 0.f, 0.f, 0.f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    if (RunFrameLockCheckThread) {
-        if (ClusterManager::instance().numberOfNodes() > 1) {
-            _thread = std::make_unique<std::thread>(updateFrameLockLoop, nullptr);
-        }
-    }
 }
 
 void Engine::terminate() {
@@ -805,11 +876,16 @@ void Engine::frameLockPreStage() {
     using P = std::pair<double, double>;
     std::optional<P> minMax = nm.sync(NetworkManager::SyncMode::SendDataToClients);
     if (minMax) {
-        addValue(_statistics.loopTimeMin, minMax->first);
-        addValue(_statistics.loopTimeMax, minMax->second);
+        _statistics.loopTimeMin.add(minMax->first);
+        _statistics.loopTimeMax.add(minMax->second);
     }
     if (nm.isComputerServer()) {
-        addValue(_statistics.syncTimes, static_cast<float>(glfwGetTime() - ts));
+        _statistics.syncTimes.add(static_cast<float>(glfwGetTime() - ts));
+
+        _statistics.sendLatencies.resize(nm.syncConnectionsCount());
+        for (int i = 0; i < nm.syncConnectionsCount(); ++i) {
+            _statistics.sendLatencies[i].add(nm.syncConnection(i).sendLatency());
+        }
     }
 
     // run only on clients
@@ -819,9 +895,11 @@ void Engine::frameLockPreStage() {
 
     // not server
     const double t0 = glfwGetTime();
+    const FrameLockSpin spin(ClusterManager::instance().frameLockSpinTime());
+    uint32_t generation = NetworkManager::frameSignal.generation();
     while (nm.isRunning() && !nm.isSyncComplete()) {
-        std::unique_lock lk(FrameSync);
-        NetworkManager::cond.wait(lk);
+        NetworkManager::frameSignal.wait(generation, FrameLockTimeout, spin.remaining());
+        generation = NetworkManager::frameSignal.generation();
 
         if (glfwGetTime() - t0 <= 1.0) {
             continue;
@@ -846,11 +924,21 @@ void Engine::frameLockPreStage() {
         }
     }
 
+    _statistics.frameLockWaits.add(glfwGetTime() - t0);
+
     // A this point all data needed for rendering a frame is received.
     // Let's signal that back to the master/server.
     nm.sync(NetworkManager::SyncMode::Acknowledge);
     if (!nm.isComputerServer()) {
-        addValue(_statistics.syncTimes, glfwGetTime() - t0);
+        _statistics.syncTimes.add(glfwGetTime() - t0);
+
+        if (nm.syncConnectionsCount() > 0) {
+            const Network& c = nm.syncConnection(0);
+            const double offset = nm.clockOffset();
+            _frameTimestamps.receive = c.syncReceiveTime() + offset;
+            _frameTimestamps.decode = c.syncDecodeTime() + offset;
+        }
+        _frameTimestamps.ack = clusterTime();
     }
 }
 
@@ -864,9 +952,11 @@ void Engine::frameLockPostStage() {
     }
 
     const double t0 = glfwGetTime();
+    const FrameLockSpin spin(ClusterManager::instance().frameLockSpinTime());
+    uint32_t generation = NetworkManager::frameSignal.generation();
     while (nm.isRunning() && nm.activeConnectionsCount() > 0 && !nm.isSyncComplete()) {
-        std::unique_lock lk(FrameSync);
-        NetworkManager::cond.wait(lk);
+        NetworkManager::frameSignal.wait(generation, FrameLockTimeout, spin.remaining());
+        generation = NetworkManager::frameSignal.generation();
 
         if (glfwGetTime() - t0 <= 1.0) {
             continue;
@@ -892,25 +982,98 @@ void Engine::frameLockPostStage() {
         }
     }
 
-    addValue(_statistics.syncTimes, glfwGetTime() - t0);
+    const double t1 = glfwGetTime();
+    _statistics.frameLockWaits.add(t1 - t0);
+    _statistics.syncTimes.add(t1 - t0);
+    _frameTimestamps.ack = clusterTime();
+}
+
+void Engine::finishFrameTimestamps() {
+    NetworkManager& nm = NetworkManager::instance();
+    _frameTimestamps.frame = static_cast<int32_t>(_frameCounter);
+    if (nm.isComputerServer()) {
+        // The sender threads write the data in the background, so the time is only known
+        // once they are done. The master's clock is the cluster timebase
+        _frameTimestamps.send = nm.syncSendTime();
+    }
+    _frameTimestamps.clockOffset = nm.clockOffset();
+    _frameTimestamps.roundTripTime = nm.clockRoundTripTime();
+    _lastFrameTimestamps = _frameTimestamps;
+    _frameTimestamps = FrameTimestamps();
+
+    if (!nm.isComputerServer() && ClusterManager::instance().sendFrameTimestamps()) {
+        nm.sendFrameTimestamps(_lastFrameTimestamps);
+    }
+}
+
+void Engine::writeFrameTrace(double swapBegin, double swapEnd) {
+    ZoneScoped
+
+    frametrace::Record record;
+    record.frame = _lastFrameTimestamps.frame;
+    if (isMaster()) {
+        record.encodeSize = static_cast<uint32_t>(SharedData::instance().dataSize());
+    }
+    else {
+        // The next frame might already be decoded in the background
+        std::unique_lock lock(mutex::DataSync);
+        record.decodeSize = static_cast<uint32_t>(SharedData::instance().dataSize());
+    }
+    record.frameTime = _statistics.frametimes.front();
+    record.syncTime = _statistics.syncTimes.front();
+    record.loopTimeMin = _statistics.loopTimeMin.front();
+    record.loopTimeMax = _statistics.loopTimeMax.front();
+    record.encode = _lastFrameTimestamps.encode;
+    record.send = _lastFrameTimestamps.send;
+    record.receive = _lastFrameTimestamps.receive;
+    record.decode = _lastFrameTimestamps.decode;
+    record.draw = _lastFrameTimestamps.draw;
+    record.ack = _lastFrameTimestamps.ack;
+    record.swapBegin = swapBegin;
+    record.swapEnd = swapEnd;
+    record.clockOffset = _lastFrameTimestamps.clockOffset;
+    record.roundTripTime = _lastFrameTimestamps.roundTripTime;
+
+    // The GPU time is only known once the frame has finished on the GPU, so the record
+    // of each frame is held back until the end of the next frame
+    if (_pendingTraceRecord) {
+        _frameTrace->write(*_pendingTraceRecord);
+    }
+    _pendingTraceRecord = record;
 }
 
 void Engine::render() {
     Window::makeSharedContextCurrent();
 
-    unsigned int timeQueryBegin = 0;
-    glGenQueries(1, &timeQueryBegin);
-    unsigned int timeQueryEnd = 0;
-    glGenQueries(1, &timeQueryEnd);
+    // The queries alternate between two sets so that the frame trace can read the GPU
+    // time of the previous frame without waiting for the current one
+    std::array<unsigned int, 2> timeQueryBegin;
+    glGenQueries(2, timeQueryBegin.data());
+    std::array<unsigned int, 2> timeQueryEnd;
+    glGenQueries(2, timeQueryEnd.data());
+    std::array<bool, 2> hasTimeQuery = { false, false };
+    auto queryDuration = [&](size_t i) {
+        GLuint64 timerStart;
+        glGetQueryObjectui64v(timeQueryBegin[i], GL_QUERY_RESULT, &timerStart);
+        GLuint64 timerEnd;
+        glGetQueryObjectui64v(timeQueryEnd[i], GL_QUERY_RESULT, &timerEnd);
+        return static_cast<double>(timerEnd - timerStart) / 1000000000.0;
+    };
 
     Node& thisNode = ClusterManager::instance().thisNode();
     const std::vector<std::unique_ptr<Window>>& windows = thisNode.windows();
     while (!(_shouldTerminate || thisNode.closeAllWindows() ||
            !NetworkManager::instance().isRunning()))
     {
+        const size_t query = _frameCounter % 2;
+
 #ifdef SGCT_HAS_VRPN
         if (isMaster()) {
-            TrackingManager::instance().updateTrackingDevices();
+            // The frame becomes visible with the next buffer swap, which is expected to
+            // happen about one frame time from now
+            TrackingManager::instance().updateTrackingDevices(
+                getTime() + _statistics.frametimes.front()
+            );
         }
 #endif
         
@@ -927,7 +1090,10 @@ void Engine::render() {
         }
 
         if (NetworkManager::instance().isComputerServer()) {
+            // The data of the previous frame might still be in flight to some clients
+            NetworkManager::instance().waitForPendingSends();
             SharedData::instance().encode();
+            _frameTimestamps.encode = clusterTime();
         }
         else if (!NetworkManager::instance().isRunning()) {
             // exit if not running
@@ -939,6 +1105,9 @@ void Engine::render() {
         std::for_each(windows.cbegin(), windows.cend(), std::mem_fn(&Window::update));
         Window::makeSharedContextCurrent();
 
+        // Continue the asynchronous texture uploads before the application uses them
+        TextureManager::instance().update();
+
         if (_postSyncPreDrawFn) {
             ZoneScopedN("[SGCT] PostSyncPreDraw");
             _postSyncPreDrawFn();
@@ -948,11 +1117,12 @@ void Engine::render() {
             ZoneScopedN("Statistics update")
             const double startFrameTime = glfwGetTime();
             const double ft = static_cast<float>(startFrameTime - _statsPrevTimestamp);
-            addValue(_statistics.frametimes, ft);
+            _statistics.frametimes.add(ft);
             _statsPrevTimestamp = startFrameTime;
 
-            if (_statisticsRenderer) {
-                glQueryCounter(timeQueryBegin, GL_TIMESTAMP);
+            hasTimeQuery[query] = _statisticsRenderer || _frameTrace;
+            if (hasTimeQuery[query]) {
+                glQueryCounter(timeQueryBegin[query], GL_TIMESTAMP);
             }
         }
 
@@ -1044,38 +1214,39 @@ void Engine::render() {
         }
         Window::makeSharedContextCurrent();
 
-        if (_statisticsRenderer) {
+        if (hasTimeQuery[query]) {
             ZoneScopedN("glQueryCounter")
-            glQueryCounter(timeQueryEnd, GL_TIMESTAMP);
+            glQueryCounter(timeQueryEnd[query], GL_TIMESTAMP);
         }
 
         if (_postDrawFn) {
             ZoneScopedN("[SGCT] PostDraw");
             _postDrawFn();
         }
+        _frameTimestamps.draw = clusterTime();
 
         if (_statisticsRenderer) {
             ZoneScopedN("Statistics Update")
             // wait until the query results are available
             GLint done = GL_FALSE;
             while (!done) {
-                glGetQueryObjectiv(timeQueryEnd, GL_QUERY_RESULT_AVAILABLE, &done);
+                glGetQueryObjectiv(
+                    timeQueryEnd[query],
+                    GL_QUERY_RESULT_AVAILABLE,
+                    &done
+                );
             }
 
             // get the query results
-            GLuint64 timerStart;
-            glGetQueryObjectui64v(timeQueryBegin, GL_QUERY_RESULT, &timerStart);
-            GLuint64 timerEnd;
-            glGetQueryObjectui64v(timeQueryEnd, GL_QUERY_RESULT, &timerEnd);
-
-            const double t = static_cast<double>(timerEnd - timerStart) / 1000000000.0;
-            addValue(_statistics.drawTimes, t);
+            _statistics.drawTimes.add(queryDuration(query));
 
             _statisticsRenderer->update();
         }
 
         // master will wait for nodes render before swapping
         frameLockPostStage();
+        finishFrameTimestamps();
+        const double swapBegin = _frameTrace ? clusterTime() : 0.0;
         // Swap front and back rendering buffers
         for (const std::unique_ptr<Window>& window : windows) {
             bool shouldTakeScreenshot = _takeScreenshot;
@@ -1097,6 +1268,14 @@ void Engine::render() {
             window->swap(shouldTakeScreenshot);
         }
 
+        if (_frameTrace) {
+            // The previous frame has been swapped, so its queries are available by now
+            if (_pendingTraceRecord && hasTimeQuery[1 - query]) {
+                _pendingTraceRecord->drawTime = queryDuration(1 - query);
+            }
+            writeFrameTrace(swapBegin, clusterTime());
+        }
+
         TracyGpuCollect;
         FrameMark;
 
@@ -1114,8 +1293,16 @@ void Engine::render() {
     }
 
     Window::makeSharedContextCurrent();
-    glDeleteQueries(1, &timeQueryBegin);
-    glDeleteQueries(1, &timeQueryEnd);
+    if (_frameTrace && _pendingTraceRecord) {
+        const size_t query = _frameCounter % 2;
+        if (hasTimeQuery[1 - query]) {
+            _pendingTraceRecord->drawTime = queryDuration(1 - query);
+        }
+        _frameTrace->write(*_pendingTraceRecord);
+        _pendingTraceRecord = std::nullopt;
+    }
+    glDeleteQueries(2, timeQueryBegin.data());
+    glDeleteQueries(2, timeQueryEnd.data());
 }
 
 void Engine::drawOverlays(const Window& window, Frustum::Mode frustum) {
@@ -1655,6 +1842,14 @@ void Engine::setupViewport(const Window& window, const BaseViewport& viewport,
     glScissor(vpCoordinates.x, vpCoordinates.y, vpCoordinates.z, vpCoordinates.w);
 }
 
+const FrameTimestamps& Engine::frameTimestamps() const {
+    return _lastFrameTimestamps;
+}
+
+std::vector<std::vector<FrameTimestamps>> Engine::takeClientFrameTimestamps() {
+    return NetworkManager::instance().takeClientFrameTimestamps();
+}
+
 const Engine::Statistics& Engine::statistics() const {
     return _statistics;
 }
@@ -1734,6 +1929,10 @@ double Engine::getTime() {
     return glfwGetTime();
 }
 
+double Engine::clusterTime() const {
+    return getTime() + NetworkManager::instance().clockOffset();
+}
+
 void Engine::setSyncParameters(bool printMessage, float timeout) {
     _printSyncMessage = printMessage;
     _syncTimeout = timeout;
@@ -17,6 +17,7 @@ namespace {
             case sgct::Error::Component::CorrectionMesh: return "CorrectionMesh";
             case sgct::Error::Component::DomeProjection: return "DomeProjection";
             case sgct::Error::Component::Engine: return "Engine";
+            case sgct::Error::Component::FrameTrace: return "FrameTrace";
             case sgct::Error::Component::Image: return "Image";
             case sgct::Error::Component::MPCDI: return "MPCDI";
             case sgct::Error::Component::MPCDIMesh: return "MPCDIMesh";
@@ -24,6 +25,7 @@ namespace {
             case sgct::Error::Component::OBJ: return "OBJ";
             case sgct::Error::Component::PaulBourke: return "PaulBourke";
             case sgct::Error::Component::Pfm: return "Pfm";
+            case sgct::Error::Component::RawCapture: return "RawCapture";
             case sgct::Error::Component::ReadConfig: return "ReadConfig";
             case sgct::Error::Component::Scalable: return "Scalable";
             case sgct::Error::Component::SCISS: return "SCISS";
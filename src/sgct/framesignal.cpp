@@ -0,0 +1,164 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/framesignal.h>
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif // _MSC_VER
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <climits>
+#endif // __linux__
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Polls the value until it differs from `generation` or until `end` has passed.
+    // Returns true if the value has changed
+    bool spin(const std::atomic<uint32_t>& value, uint32_t generation,
+              Clock::time_point end)
+    {
+        // Reading the clock is much more expensive than reading the value, so the clock
+        // is only checked every couple of iterations
+        constexpr int ClockInterval = 64;
+        while (true) {
+            for (int i = 0; i < ClockInterval; ++i) {
+                if (value.load(std::memory_order_acquire) != generation) {
+                    return true;
+                }
+                sgct::cpuRelax();
+            }
+            if (Clock::now() >= end) {
+                return value != generation;
+            }
+        }
+    }
+
+#ifdef __linux__
+    static_assert(
+        sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+        "The futex is placed directly on the generation counter"
+    );
+
+    uint32_t* futexAddress(std::atomic<uint32_t>& value) {
+        return reinterpret_cast<uint32_t*>(&value);
+    }
+#endif // __linux__
+} // namespace
+
+namespace sgct {
+
+void cpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+uint32_t FrameSignal::generation() const {
+    return _generation.load();
+}
+
+#ifdef __linux__
+
+void FrameSignal::notify() {
+    _generation++;
+    // The syscall is only necessary if someone is sleeping, which is never the case for
+    // the notifications that arrive while the render thread is busy with the frame
+    if (_nWaiters > 0) {
+        syscall(
+            SYS_futex,
+            futexAddress(_generation),
+            FUTEX_WAKE_PRIVATE,
+            INT_MAX,
+            nullptr,
+            nullptr,
+            0
+        );
+    }
+}
+
+bool FrameSignal::wait(uint32_t generation, std::chrono::microseconds timeout,
+                       std::chrono::microseconds spinTime)
+{
+    using namespace std::chrono;
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + timeout;
+    const Clock::time_point spinEnd = start + std::min(spinTime, timeout);
+    if (spinTime.count() > 0 && spin(_generation, generation, spinEnd)) {
+        return true;
+    }
+
+    _nWaiters++;
+    while (_generation == generation) {
+        const microseconds remaining =
+            duration_cast<microseconds>(end - Clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(remaining.count() / 1000000);
+        ts.tv_nsec = static_cast<long>((remaining.count() % 1000000) * 1000);
+        // The kernel only puts the thread to sleep if the generation is unchanged, which
+        // closes the window between the check above and the wait
+        syscall(
+            SYS_futex,
+            futexAddress(_generation),
+            FUTEX_WAIT_PRIVATE,
+            generation,
+            &ts,
+            nullptr,
+            0
+        );
+    }
+    _nWaiters--;
+    return _generation != generation;
+}
+
+#else // __linux__
+
+void FrameSignal::notify() {
+    {
+        std::unique_lock lock(_mutex);
+        _generation++;
+    }
+    _cond.notify_all();
+}
+
+bool FrameSignal::wait(uint32_t generation, std::chrono::microseconds timeout,
+                       std::chrono::microseconds spinTime)
+{
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point spinEnd = start + std::min(spinTime, timeout);
+    if (spinTime.count() > 0 && spin(_generation, generation, spinEnd)) {
+        return true;
+    }
+
+    std::unique_lock lock(_mutex);
+    return _cond.wait_until(
+        lock,
+        start + timeout,
+        [this, generation]() { return _generation != generation; }
+    );
+}
+
+#endif // __linux__
+
+} // namespace sgct
@@ -0,0 +1,97 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/frametrace.h>
+
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+
+#define Err(code, msg) Error(Error::Component::FrameTrace, code, msg)
+
+namespace {
+    static_assert(
+        sizeof(sgct::frametrace::Record) == 4 * sizeof(uint32_t) + 15 * sizeof(double),
+        "The record must not contain padding as it is written to disk as is"
+    );
+} // namespace
+
+namespace sgct {
+
+FrameTraceWriter::FrameTraceWriter(const std::string& path, int nodeIndex, bool isMaster,
+                                   const std::string& nodeAddress)
+    : _path(path)
+    , _file(path, std::ios::binary | std::ios::trunc)
+{
+    ZoneScoped
+
+    if (!_file.good()) {
+        throw Err(9200, fmt::format("Could not create frame trace file '{}'", path));
+    }
+
+    frametrace::FileHeader header;
+    header.nodeIndex = nodeIndex;
+    header.isMaster = isMaster ? 1 : 0;
+    std::copy_n(
+        nodeAddress.begin(),
+        std::min(nodeAddress.size(), header.nodeAddress.size() - 1),
+        header.nodeAddress.begin()
+    );
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(frametrace::FileHeader));
+}
+
+void FrameTraceWriter::write(const frametrace::Record& record) {
+    // The stream buffers the records, so they only reach the disk every couple of frames
+    _file.write(reinterpret_cast<const char*>(&record), sizeof(frametrace::Record));
+}
+
+const std::string& FrameTraceWriter::path() const {
+    return _path;
+}
+
+FrameTraceReader::FrameTraceReader(const std::string& path) {
+    ZoneScoped
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        throw Err(9201, fmt::format("Could not open frame trace file '{}'", path));
+    }
+
+    file.read(reinterpret_cast<char*>(&_header), sizeof(frametrace::FileHeader));
+    if (!file.good() || _header.magic != frametrace::Magic) {
+        throw Err(9202, fmt::format("File '{}' is not a frame trace file", path));
+    }
+    if (_header.version != frametrace::Version ||
+        _header.recordSize != sizeof(frametrace::Record))
+    {
+        throw Err(
+            9203,
+            fmt::format(
+                "Unsupported frame trace version {} in '{}'", _header.version, path
+            )
+        );
+    }
+    _header.nodeAddress.back() = '\0';
+
+    // A trace of an application that has crashed might end with a partial record
+    frametrace::Record record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(frametrace::Record))) {
+        _records.push_back(record);
+    }
+}
+
+const frametrace::FileHeader& FrameTraceReader::header() const {
+    return _header;
+}
+
+const std::vector<frametrace::Record>& FrameTraceReader::records() const {
+    return _records;
+}
+
+} // namespace sgct
@@ -13,9 +13,29 @@
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <png.h>
-#include <pngpriv.h>
+#include <zlib.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SGCT_HAS_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define SGCT_HAS_SSSE3
+#include <tmmintrin.h>
+#endif
 
 #ifdef WIN32
 #include <CodeAnalysis/warnings.h>
@@ -52,6 +72,8 @@
 #ifdef WIN32
 #pragma warning(pop)
 #pragma warning(push)
+// Interaction between setjmp and C++ object destruction, which libpng's error handling
+// in loadPNG relies on
 #pragma warning(disable : 4611)
 #endif // WIN32
 
@@ -78,16 +100,503 @@ namespace {
         if (filename.find(".tga") != std::string::npos) {
             return sgct::Image::FormatType::TGA;
         }
+        if (filename.find(".exr") != std::string::npos) {
+            return sgct::Image::FormatType::EXR;
+        }
         return sgct::Image::FormatType::Unknown;
     }
+
+    // Images are split into strips of roughly this many bytes for the PNG compression
+    constexpr size_t PNGStripSize = 4 * 1024 * 1024;
+
+    // The number of threads that may be started to compress images in addition to the
+    // threads that are saving them. The budget is shared between all images, so several
+    // capture threads that save at the same time do not start one thread per core each
+    std::atomic_int nFreeHelperThreads =
+        static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+
+    /**
+     * Calls \p task for every index in [0, nTasks) on the calling thread and on at most
+     * \p maxThreads - 1 helper threads, as many as are left in the shared budget
+     */
+    void runInParallel(size_t nTasks, size_t maxThreads,
+                       const std::function<void(size_t)>& task)
+    {
+        const int nWanted = static_cast<int>(std::min(nTasks, maxThreads)) - 1;
+        int nFree = nFreeHelperThreads;
+        int nHelpers = 0;
+        do {
+            nHelpers = std::clamp(nWanted, 0, std::max(nFree, 0));
+        } while (!nFreeHelperThreads.compare_exchange_weak(nFree, nFree - nHelpers));
+
+        std::atomic_size_t next = 0;
+        auto work = [&]() {
+            for (size_t i = next++; i < nTasks; i = next++) {
+                task(i);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nHelpers; i++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        nFreeHelperThreads += nHelpers;
+    }
+
+    /**
+     * Converts \p nPixels 8-bit pixels between BGR(A) and RGB(A) by swapping the first
+     * and third channel. \p src and \p dst may point to the same memory.
+     */
+    void swapRedBlue(const unsigned char* src, unsigned char* dst, size_t nPixels,
+                     int nChannels)
+    {
+        size_t i = 0;
+        if (nChannels == 4) {
+#ifdef SGCT_HAS_SSE2
+            // Red and blue are the low bytes of the two 16-bit halves of every pixel, so
+            // masking out green and alpha and swapping the halves moves them into place
+            const __m128i rb = _mm_set1_epi32(0x00FF00FF);
+            const __m128i ga = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+            for (; i + 4 <= nPixels; i += 4) {
+                const __m128i p = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + 4 * i)
+                );
+                __m128i swapped = _mm_and_si128(p, rb);
+                swapped = _mm_shufflelo_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1));
+                swapped = _mm_shufflehi_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1));
+                swapped = _mm_or_si128(swapped, _mm_and_si128(p, ga));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * i), swapped);
+            }
+#endif // SGCT_HAS_SSE2
+            for (; i < nPixels; i++) {
+                const unsigned char b = src[4 * i];
+                const unsigned char r = src[4 * i + 2];
+                dst[4 * i] = r;
+                dst[4 * i + 1] = src[4 * i + 1];
+                dst[4 * i + 2] = b;
+                dst[4 * i + 3] = src[4 * i + 3];
+            }
+        }
+        else {
+#ifdef SGCT_HAS_SSSE3
+            // Every iteration converts 5 pixels but loads and stores 16 bytes, so the
+            // last byte is written back unchanged and we must stop one pixel early
+            const __m128i mask = _mm_setr_epi8(
+                2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15
+            );
+            for (; i + 6 <= nPixels; i += 5) {
+                const __m128i p = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + 3 * i)
+                );
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dst + 3 * i),
+                    _mm_shuffle_epi8(p, mask)
+                );
+            }
+#endif // SGCT_HAS_SSSE3
+            for (; i < nPixels; i++) {
+                const unsigned char b = src[3 * i];
+                const unsigned char r = src[3 * i + 2];
+                dst[3 * i] = r;
+                dst[3 * i + 1] = src[3 * i + 1];
+                dst[3 * i + 2] = b;
+            }
+        }
+    }
+
+    /**
+     * Converts a row of \p width pixels from the BGR(A) little-endian layout of the
+     * framebuffer into the RGB(A) big-endian layout that PNG expects.
+     */
+    void convertRow(const unsigned char* src, unsigned char* dst, int width,
+                    int nChannels, int bytesPerChannel)
+    {
+        if (bytesPerChannel == 1) {
+            if (nChannels >= 3) {
+                swapRedBlue(src, dst, width, nChannels);
+            }
+            else {
+                std::memcpy(dst, src, static_cast<size_t>(width) * nChannels);
+            }
+            return;
+        }
+
+        for (int i = 0; i < width * nChannels; i += nChannels) {
+            for (int c = 0; c < nChannels; c++) {
+                const int sc = (nChannels >= 3 && c < 3) ? 2 - c : c;
+                dst[2 * (i + c)] = src[2 * (i + sc) + 1];
+                dst[2 * (i + c) + 1] = src[2 * (i + sc)];
+            }
+        }
+    }
+
+    /**
+     * Calls deflate until all input has been consumed, growing \p buffer if it runs out
+     * of space. \return false if zlib reported an error
+     */
+    bool deflateInto(z_stream& stream, std::vector<unsigned char>& buffer, size_t offset,
+                     int flush)
+    {
+        while (true) {
+            if (stream.avail_out == 0) {
+                const size_t used = offset + stream.total_out;
+                buffer.resize(buffer.size() * 2);
+                stream.next_out = buffer.data() + used;
+                stream.avail_out = static_cast<uInt>(buffer.size() - used);
+            }
+            const int res = deflate(&stream, flush);
+            if (res == Z_STREAM_ERROR || (res == Z_BUF_ERROR && stream.avail_out > 0)) {
+                return false;
+            }
+            if (flush == Z_FINISH) {
+                if (res == Z_STREAM_END) {
+                    return true;
+                }
+            }
+            else if (stream.avail_in == 0 && stream.avail_out > 0) {
+                return true;
+            }
+        }
+    }
+
+    struct PNGStrip {
+        int firstRow = 0; // in PNG order, which is flipped compared to OpenGL
+        int nRows = 0;
+        size_t offset = 0; // space reserved in front of the compressed data
+        std::vector<unsigned char> data;
+        uLong adler = 0;
+        uLong uncompressedSize = 0;
+        bool success = false;
+    };
+
+    /**
+     * Compresses the rows of \p strip into a raw deflate stream. All but the last strip
+     * end with a full flush, so the strips can be concatenated into a single stream
+     * without any references across them.
+     */
+    void compressStrip(PNGStrip& strip, const unsigned char* image, sgct::ivec2 size,
+                       int nChannels, int bytesPerChannel, int level, bool isLast)
+    {
+        const size_t rowSize = static_cast<size_t>(size.x) * nChannels * bytesPerChannel;
+        std::vector<unsigned char> row(rowSize + 1);
+        row[0] = 0; // filter type 'None'
+
+        z_stream stream = {};
+        const int res = deflateInit2(
+            &stream,
+            level,
+            Z_DEFLATED,
+            -15, // raw deflate without zlib header and checksum
+            8,
+            Z_DEFAULT_STRATEGY
+        );
+        if (res != Z_OK) {
+            return;
+        }
+
+        const uLong bound = deflateBound(&stream, strip.nRows * (rowSize + 1));
+        strip.data.resize(strip.offset + bound + 64);
+        stream.next_out = strip.data.data() + strip.offset;
+        stream.avail_out = static_cast<uInt>(strip.data.size() - strip.offset);
+
+        strip.adler = adler32(0, nullptr, 0);
+        bool success = true;
+        for (int r = strip.firstRow; r < strip.firstRow + strip.nRows && success; r++) {
+            const size_t y = static_cast<size_t>(size.y) - 1 - r;
+            convertRow(image + y * rowSize, row.data() + 1, size.x, nChannels,
+                bytesPerChannel);
+            strip.adler = adler32(strip.adler, row.data(), static_cast<uInt>(row.size()));
+
+            stream.next_in = row.data();
+            stream.avail_in = static_cast<uInt>(row.size());
+            success = deflateInto(stream, strip.data, strip.offset, Z_NO_FLUSH);
+        }
+        if (success) {
+            const int flush = isLast ? Z_FINISH : Z_FULL_FLUSH;
+            success = deflateInto(stream, strip.data, strip.offset, flush);
+        }
+
+        strip.data.resize(strip.offset + stream.total_out);
+        strip.uncompressedSize = stream.total_in;
+        strip.success = success;
+        deflateEnd(&stream);
+    }
+
+    void writeUint32(unsigned char* dst, uint32_t value) {
+        dst[0] = static_cast<unsigned char>(value >> 24);
+        dst[1] = static_cast<unsigned char>(value >> 16);
+        dst[2] = static_cast<unsigned char>(value >> 8);
+        dst[3] = static_cast<unsigned char>(value);
+    }
+
+    bool writeChunk(FILE* fp, const char* type, const unsigned char* data, size_t size) {
+        std::array<unsigned char, 8> header;
+        writeUint32(header.data(), static_cast<uint32_t>(size));
+        std::memcpy(header.data() + 4, type, 4);
+
+        // zlib treats a nullptr as a request for the initial value instead of no data
+        uLong crc = crc32(0, header.data() + 4, 4);
+        if (size > 0) {
+            crc = crc32(crc, data, static_cast<uInt>(size));
+        }
+        std::array<unsigned char, 4> footer;
+        writeUint32(footer.data(), static_cast<uint32_t>(crc));
+
+        return
+            fwrite(header.data(), 1, header.size(), fp) == header.size() &&
+            (size == 0 || fwrite(data, 1, size, fp) == size) &&
+            fwrite(footer.data(), 1, footer.size(), fp) == footer.size();
+    }
+
+    struct PNGReadState {
+        const unsigned char* data;
+        size_t length;
+        size_t offset;
+    };
+
+    void readPNGData(png_structp png, png_bytep out, png_size_t count) {
+        PNGReadState* state = reinterpret_cast<PNGReadState*>(png_get_io_ptr(png));
+        if (state->offset + count > state->length) {
+            png_error(png, "Unexpected end of PNG data");
+        }
+        std::memcpy(out, state->data + state->offset, count);
+        state->offset += count;
+    }
+
+    void handlePNGError(png_structp png, png_const_charp message) {
+        sgct::Log::Debug(fmt::format("Error decoding PNG: {}", message));
+        png_longjmp(png, 1);
+    }
+
+    void handlePNGWarning(png_structp, png_const_charp message) {
+        sgct::Log::Debug(fmt::format("Warning decoding PNG: {}", message));
+    }
+
+    // The number of lines that are compressed together is fixed for ZIP compression
+    constexpr int EXRLinesPerBlock = 16;
+
+    // Images are compressed by as many threads as it takes to give each this many bytes
+    constexpr size_t EXRBytesPerThread = 4 * 1024 * 1024;
+
+    struct EXRChannel {
+        const char* name;
+        int offset; // of the channel within a pixel of the image
+    };
+
+    /// \return the channels in the alphabetical order in which EXR stores them
+    std::vector<EXRChannel> exrChannels(int nChannels) {
+        // The pixels are stored as BGR(A), single channels are treated as luminance
+        // and two channels as luminance with alpha, just like in PNG files
+        switch (nChannels) {
+            case 1: return { { "Y", 0 } };
+            case 2: return { { "A", 1 }, { "Y", 0 } };
+            case 3: return { { "B", 0 }, { "G", 1 }, { "R", 2 } };
+            case 4: return { { "A", 3 }, { "B", 0 }, { "G", 1 }, { "R", 2 } };
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }
+
+    uint16_t floatToHalf(float value) {
+        uint32_t f;
+        std::memcpy(&f, &value, sizeof(float));
+        const uint32_t sign = (f >> 16) & 0x8000;
+        const int exponent = static_cast<int>((f >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = f & 0x7FFFFF;
+
+        if (exponent == 128 + 15) {
+            // Infinity stays infinity, NaN stays NaN
+            return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+        }
+        if (exponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7C00);
+        }
+        if (exponent <= 0) {
+            // Denormalized half or too small to be represented at all
+            if (exponent < -10) {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000;
+            const int shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+            const uint32_t rest = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1))) {
+                half++;
+            }
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        const uint32_t rest = mantissa & 0x1FFF;
+        // Round to nearest even; a carry into the exponent is the correct result
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    void appendLittleEndian(std::vector<unsigned char>& buffer, uint64_t value,
+                            int nBytes)
+    {
+        for (int i = 0; i < nBytes; i++) {
+            buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+        }
+    }
+
+    void appendAttribute(std::vector<unsigned char>& header, std::string_view name,
+                         std::string_view type, const std::vector<unsigned char>& value)
+    {
+        header.insert(header.end(), name.begin(), name.end());
+        header.push_back('\0');
+        header.insert(header.end(), type.begin(), type.end());
+        header.push_back('\0');
+        appendLittleEndian(header, value.size(), 4);
+        header.insert(header.end(), value.begin(), value.end());
+    }
+
+    struct EXRBlock {
+        int firstLine = 0; // in EXR order, which is flipped compared to OpenGL
+        int nLines = 0;
+        std::vector<unsigned char> data; // including the line number and size
+        bool success = false;
+    };
+
+    /**
+     * Converts the lines of \p block into the layout of an EXR block, in which each line
+     * stores all values of one channel after another, and compresses them the way the
+     * ZIP compression expects: the even and odd bytes are separated, delta-encoded and
+     * then compressed with zlib. Blocks that don't get smaller are stored uncompressed.
+     */
+    void compressEXRBlock(EXRBlock& block, const unsigned char* image, sgct::ivec2 size,
+                          int nChannels, int bytesPerChannel, bool isFloatingPoint,
+                          int level)
+    {
+        // 8 bit integers only have 256 possible values, so they are converted once
+        static const std::array<uint16_t, 256> ByteToHalf = []() {
+            std::array<uint16_t, 256> res;
+            for (int i = 0; i < 256; i++) {
+                res[i] = floatToHalf(static_cast<float>(i) / 255.f);
+            }
+            return res;
+        }();
+
+        const std::vector<EXRChannel> channels = exrChannels(nChannels);
+        const int outSize = bytesPerChannel == 4 ? 4 : 2;
+        const size_t srcRowSize =
+            static_cast<size_t>(size.x) * nChannels * bytesPerChannel;
+        const size_t rawSize = static_cast<size_t>(size.x) * nChannels * outSize *
+            block.nLines;
+
+        std::vector<unsigned char> raw(rawSize);
+        unsigned char* dst = raw.data();
+        for (int l = block.firstLine; l < block.firstLine + block.nLines; l++) {
+            const unsigned char* row = image + (size.y - 1 - l) * srcRowSize;
+            for (const EXRChannel& c : channels) {
+                const unsigned char* src = row + c.offset * bytesPerChannel;
+                const size_t stride = static_cast<size_t>(nChannels) * bytesPerChannel;
+                for (int x = 0; x < size.x; x++, src += stride, dst += outSize) {
+                    if (isFloatingPoint) {
+                        std::memcpy(dst, src, outSize);
+                    }
+                    else if (bytesPerChannel == 1) {
+                        std::memcpy(dst, &ByteToHalf[*src], sizeof(uint16_t));
+                    }
+                    else if (bytesPerChannel == 2) {
+                        uint16_t v;
+                        std::memcpy(&v, src, sizeof(uint16_t));
+                        const uint16_t h = floatToHalf(static_cast<float>(v) / 65535.f);
+                        std::memcpy(dst, &h, sizeof(uint16_t));
+                    }
+                    else {
+                        uint32_t v;
+                        std::memcpy(&v, src, sizeof(uint32_t));
+                        const float f = static_cast<float>(v / 4294967295.0);
+                        std::memcpy(dst, &f, sizeof(float));
+                    }
+                }
+            }
+        }
+
+        std::vector<unsigned char> predicted(rawSize);
+        const size_t half = (rawSize + 1) / 2;
+        for (size_t i = 0; i < rawSize; i++) {
+            predicted[(i % 2 == 0) ? i / 2 : half + i / 2] = raw[i];
+        }
+        unsigned char previous = predicted[0];
+        for (size_t i = 1; i < rawSize; i++) {
+            const unsigned char current = predicted[i];
+            predicted[i] = static_cast<unsigned char>(current - previous + 128);
+            previous = current;
+        }
+
+        uLongf compressedSize = compressBound(static_cast<uLong>(rawSize));
+        block.data.resize(8 + compressedSize);
+        const int res = compress2(
+            block.data.data() + 8,
+            &compressedSize,
+            predicted.data(),
+            static_cast<uLong>(rawSize),
+            level
+        );
+        if (res != Z_OK) {
+            return;
+        }
+        if (compressedSize >= rawSize) {
+            std::memcpy(block.data.data() + 8, raw.data(), rawSize);
+            compressedSize = static_cast<uLongf>(rawSize);
+        }
+        block.data.resize(8 + compressedSize);
+
+        std::vector<unsigned char> header;
+        appendLittleEndian(header, static_cast<uint32_t>(block.firstLine), 4);
+        appendLittleEndian(header, static_cast<uint32_t>(compressedSize), 4);
+        std::copy(header.begin(), header.end(), block.data.begin());
+        block.success = true;
+    }
 } // namespace
 
 namespace sgct {
 
+Image::Image(Image&& rhs) noexcept
+    : _nChannels(rhs._nChannels)
+    , _size(rhs._size)
+    , _dataSize(rhs._dataSize)
+    , _bytesPerChannel(rhs._bytesPerChannel)
+    , _isFloatingPoint(rhs._isFloatingPoint)
+    , _data(rhs._data)
+{
+    rhs._data = nullptr;
+    rhs._dataSize = 0;
+}
+
+Image& Image::operator=(Image&& rhs) noexcept {
+    if (this != &rhs) {
+        reset();
+        _nChannels = rhs._nChannels;
+        _size = rhs._size;
+        _dataSize = rhs._dataSize;
+        _bytesPerChannel = rhs._bytesPerChannel;
+        _isFloatingPoint = rhs._isFloatingPoint;
+        _data = rhs._data;
+        rhs._data = nullptr;
+        rhs._dataSize = 0;
+    }
+    return *this;
+}
+
 Image::~Image() {
+    reset();
+}
+
+void Image::reset() {
     if (_data) {
         stbi_image_free(_data);
     }
+    _data = nullptr;
+    _dataSize = 0;
 }
 
 void Image::load(const std::string& filename) {
@@ -95,39 +604,111 @@ void Image::load(const std::string& filename) {
         throw Err(9000, "Cannot load empty filepath");
     }
 
-    stbi_set_flip_vertically_on_load(1);
-    _data = stbi_load(filename.c_str(), &_size.x, &_size.y, &_nChannels, 0);
-    if (_data == nullptr) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    std::vector<unsigned char> buffer;
+    if (file.good()) {
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    }
+    if (!file.good() || buffer.empty()) {
         throw Err(
             9001, fmt::format("Could not open file '{}' for loading image", filename)
         );
     }
-    _bytesPerChannel = 1;
-    _dataSize = _size.x * _size.y * _nChannels * _bytesPerChannel;
 
-    // Convert BGR to RGB
-    if (_nChannels >= 3) {
-        for (size_t i = 0; i < _dataSize; i += _nChannels) {
-            std::swap(_data[i], _data[i + 2]);
-        }
+    load(buffer.data(), static_cast<int>(buffer.size()));
+    if (_data == nullptr) {
+        throw Err(
+            9001, fmt::format("Could not open file '{}' for loading image", filename)
+        );
     }
 }
 
-void Image::load(unsigned char* data, int length) {
+void Image::load(const unsigned char* data, int length) {
+    reset();
+    _bytesPerChannel = 1;
+    _isFloatingPoint = false;
+    if (loadPNG(data, static_cast<size_t>(length))) {
+        return;
+    }
+
     stbi_set_flip_vertically_on_load(1);
     _data = stbi_load_from_memory(data, length, &_size.x, &_size.y, &_nChannels, 0);
-    _bytesPerChannel = 1;
+    if (_data == nullptr) {
+        return;
+    }
     _dataSize = _size.x * _size.y * _nChannels * _bytesPerChannel;
 
     // Convert BGR to RGB
     if (_nChannels >= 3) {
-        for (size_t i = 0; i < _dataSize; i += _nChannels) {
-            std::swap(_data[i], _data[i + 2]);
-        }
+        swapRedBlue(_data, _data, _dataSize / _nChannels, _nChannels);
+    }
+}
+
+bool Image::loadPNG(const unsigned char* data, size_t length) {
+    if (length < 8 || png_sig_cmp(data, 0, 8) != 0) {
+        return false;
+    }
+
+    png_structp png = png_create_read_struct(
+        PNG_LIBPNG_VER_STRING,
+        nullptr,
+        handlePNGError,
+        handlePNGWarning
+    );
+    if (!png) {
+        return false;
+    }
+    png_infop info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_read_struct(&png, nullptr, nullptr);
+        return false;
+    }
+
+    PNGReadState state = { data, length, 0 };
+    std::vector<png_bytep> rows;
+    if (setjmp(png_jmpbuf(png))) {
+        // libpng jumps back here if the image is corrupt
+        png_destroy_read_struct(&png, &info, nullptr);
+        reset();
+        return false;
+    }
+
+    png_set_read_fn(png, &state, readPNGData);
+    png_read_info(png, info);
+    // 16-bit images are left to stb_image, which keeps their high byte just like
+    // png_set_strip_16 would, to have a single code path for them
+    if (png_get_bit_depth(png, info) > 8) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
     }
+    // Expand palettes and low bit depths to 8 bits and transparency to alpha and let
+    // libpng write the channels and rows in the order that we need
+    png_set_expand(png);
+    png_set_bgr(png);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+
+    _size = ivec2{
+        static_cast<int>(png_get_image_width(png, info)),
+        static_cast<int>(png_get_image_height(png, info))
+    };
+    _nChannels = png_get_channels(png, info);
+    allocateOrResizeData();
+
+    const size_t rowSize = static_cast<size_t>(_size.x) * _nChannels;
+    rows.resize(_size.y);
+    for (int y = 0; y < _size.y; y++) {
+        rows[y] = _data + (_size.y - 1 - y) * rowSize;
+    }
+    png_read_image(png, rows.data());
+    png_read_end(png, nullptr);
+    png_destroy_read_struct(&png, &info, nullptr);
+    return true;
 }
 
-void Image::save(const std::string& file) {
+void Image::save(const std::string& file, Compression compression) {
     if (file.empty()) {
         throw Err(9002, "Filename not set for saving image");
     }
@@ -136,17 +717,27 @@ void Image::save(const std::string& file) {
     if (type == FormatType::Unknown) {
         throw Err(9003, fmt::format("Cannot save file '{}'", file));
     }
+    if (type == FormatType::EXR) {
+        saveEXR(file, compression == Compression::Fast ? Z_BEST_SPEED : -1);
+        return;
+    }
+    if (_isFloatingPoint) {
+        const char* format = type == FormatType::PNG ? "PNG" :
+            (type == FormatType::JPEG ? "JPG" : "TGA");
+        throw Err(
+            9019,
+            fmt::format("Can't save floating point image '{}' as {}", file, format)
+        );
+    }
     if (type == FormatType::PNG) {
-        // We use libPNG instead of stb as libPNG is faster and we care about how fast
-        // PNGs are written to disk in production
-        savePNG(file);
+        // We use our own PNG writer instead of stb as it compresses large images in
+        // parallel and we care about how fast PNGs are written to disk in production
+        savePNG(file, compression == Compression::Fast ? Z_BEST_SPEED : -1);
         return;
     }
 
-    if (_nChannels >= 3) {
-        for (size_t i = 0; i < _dataSize; i += _nChannels) {
-            std::swap(_data[i], _data[i + 2]);
-        }
+    if (_nChannels >= 3 && _bytesPerChannel == 1) {
+        swapRedBlue(_data, _data, _dataSize / _nChannels, _nChannels);
     }
 
     stbi_flip_vertically_on_write(1);
@@ -169,7 +760,7 @@ void Image::save(const std::string& file) {
     throw std::logic_error("We should never get here");
 }
 
-void Image::savePNG(std::string filename, int compressionLevel) {
+void Image::savePNG(const std::string& filename, int compressionLevel) {
     if (_data == nullptr) {
         throw Err(9006, "Missing image data to save PNG");
     }
@@ -180,90 +771,210 @@ void Image::savePNG(std::string filename, int compressionLevel) {
 
     double t0 = Engine::getTime();
 
+    const unsigned char colorType = [](int channels) -> unsigned char {
+        switch (channels) {
+            case 1: return 0; // Grayscale
+            case 2: return 4; // Grayscale with alpha
+            case 3: return 2; // RGB
+            case 4: return 6; // RGB with alpha
+            default: throw std::logic_error("Unhandled case label");
+        }
+    }(_nChannels);
+
+    // Split the image into strips that are compressed in parallel. The first strip
+    // reserves space for the zlib header, the checksum is appended to the last one
+    const size_t rowSize =
+        static_cast<size_t>(_size.x) * _nChannels * _bytesPerChannel + 1;
+    const size_t nMaxStrips = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t nStrips = std::clamp<size_t>(
+        rowSize * _size.y / PNGStripSize,
+        1,
+        std::min<size_t>(nMaxStrips, _size.y)
+    );
+    const int rowsPerStrip = static_cast<int>((_size.y + nStrips - 1) / nStrips);
+
+    std::vector<PNGStrip> strips;
+    for (int row = 0; row < _size.y; row += rowsPerStrip) {
+        PNGStrip strip;
+        strip.firstRow = row;
+        strip.nRows = std::min(rowsPerStrip, _size.y - row);
+        strip.offset = strips.empty() ? 2 : 0;
+        strips.push_back(std::move(strip));
+    }
+
+    runInParallel(
+        strips.size(),
+        strips.size(),
+        [&](size_t i) {
+            compressStrip(
+                strips[i],
+                _data,
+                _size,
+                _nChannels,
+                _bytesPerChannel,
+                compressionLevel,
+                i == strips.size() - 1
+            );
+        }
+    );
+
+    uLong adler = adler32(0, nullptr, 0);
+    for (const PNGStrip& strip : strips) {
+        if (!strip.success) {
+            throw Err(9013, fmt::format("Failed to compress PNG file '{}'", filename));
+        }
+        adler = adler32_combine(adler, strip.adler, strip.uncompressedSize);
+    }
+    // zlib header for a deflate stream with a 32K window and no preset dictionary
+    strips.front().data[0] = 0x78;
+    strips.front().data[1] = 0x9C;
+    std::vector<unsigned char>& last = strips.back().data;
+    last.resize(last.size() + 4);
+    writeUint32(last.data() + last.size() - 4, static_cast<uint32_t>(adler));
+
+    std::array<unsigned char, 13> header;
+    writeUint32(header.data(), static_cast<uint32_t>(_size.x));
+    writeUint32(header.data() + 4, static_cast<uint32_t>(_size.y));
+    header[8] = static_cast<unsigned char>(_bytesPerChannel * 8);
+    header[9] = colorType;
+    header[10] = 0; // deflate compression
+    header[11] = 0; // adaptive filtering
+    header[12] = 0; // no interlacing
+
     FILE* fp = fopen(filename.c_str(), "wb");
     if (fp == nullptr) {
         throw Err(9008, fmt::format("Can't create PNG file '{}'", filename));
     }
 
-    // initialize stuff
-    png_structp png_ptr = png_create_write_struct(
-        PNG_LIBPNG_VER_STRING,
-        nullptr,
-        nullptr,
-        nullptr
-    );
-    if (!png_ptr) {
-        throw Err(9009, "Failed to create PNG struct");
+    constexpr std::array<unsigned char, 8> Signature = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'
+    };
+    bool success = fwrite(Signature.data(), 1, Signature.size(), fp) == Signature.size();
+    success = success && writeChunk(fp, "IHDR", header.data(), header.size());
+    for (const PNGStrip& strip : strips) {
+        success = success && writeChunk(fp, "IDAT", strip.data.data(), strip.data.size());
+    }
+    success = success && writeChunk(fp, "IEND", nullptr, 0);
+    fclose(fp);
+    if (!success) {
+        throw Err(9014, fmt::format("Failed to write PNG file '{}'", filename));
     }
 
-    // set compression
-    png_set_compression_level(png_ptr, compressionLevel);
-    png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
-    png_set_compression_mem_level(png_ptr, 8);
-    png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
-    png_set_compression_window_bits(png_ptr, 15);
-    png_set_compression_method(png_ptr, 8);
-    png_set_compression_buffer_size(png_ptr, 8192);
+    const double time = (Engine::getTime() - t0) * 1000.0;
+    Log::Debug(fmt::format(
+        "'{}' was saved successfully ({:.2f} ms, {} strips)",
+        filename, time, strips.size()
+    ));
+}
 
-    png_infop info_ptr = png_create_info_struct(png_ptr);
-    if (!info_ptr) {
-        throw Err(9010, "Failed to create PNG info struct");
+void Image::saveEXR(const std::string& filename, int compressionLevel) {
+    if (_data == nullptr) {
+        throw Err(9015, "Missing image data to save EXR");
     }
 
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        throw Err(9011, "One of the called PNG functions failed");
-    }
+    double t0 = Engine::getTime();
 
-    png_init_io(png_ptr, fp);
+    std::vector<EXRBlock> blocks;
+    for (int line = 0; line < _size.y; line += EXRLinesPerBlock) {
+        EXRBlock block;
+        block.firstLine = line;
+        block.nLines = std::min(EXRLinesPerBlock, _size.y - line);
+        blocks.push_back(std::move(block));
+    }
 
-    const int colorType = [](int channels) {
-        switch (channels) {
-            case 1: return PNG_COLOR_TYPE_GRAY;
-            case 2: return PNG_COLOR_TYPE_GRAY_ALPHA;
-            case 3: return PNG_COLOR_TYPE_RGB;
-            case 4: return PNG_COLOR_TYPE_RGB_ALPHA;
-            default: throw std::logic_error("Unhandled case label");
+    const size_t nMaxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t nThreads = std::clamp<size_t>(
+        _dataSize / EXRBytesPerThread,
+        1,
+        std::min(nMaxThreads, blocks.size())
+    );
+    // The blocks are small, so the threads take the next free one instead of getting a
+    // fixed range to even out the differences in how well the blocks compress
+    runInParallel(
+        blocks.size(),
+        nThreads,
+        [&](size_t i) {
+            compressEXRBlock(
+                blocks[i],
+                _data,
+                _size,
+                _nChannels,
+                _bytesPerChannel,
+                _isFloatingPoint,
+                compressionLevel
+            );
         }
-    }(_nChannels);
-
-    // write header
-    png_set_IHDR(
-        png_ptr,
-        info_ptr,
-        _size.x,
-        _size.y,
-        _bytesPerChannel * 8,
-        colorType,
-        PNG_INTERLACE_NONE,
-        PNG_COMPRESSION_TYPE_BASE,
-        PNG_FILTER_TYPE_BASE
     );
 
-    if (colorType == PNG_COLOR_TYPE_RGB || colorType == PNG_COLOR_TYPE_RGB_ALPHA) {
-        png_set_bgr(png_ptr);
+    for (const EXRBlock& block : blocks) {
+        if (!block.success) {
+            throw Err(9016, fmt::format("Failed to compress EXR file '{}'", filename));
+        }
     }
-    png_write_info(png_ptr, info_ptr);
 
-    // swap big-endian to little endian
-    if (_bytesPerChannel == 2) {
-        png_set_swap(png_ptr);
+    // Magic number and version 2 of a single-part scanline file
+    std::vector<unsigned char> header = { 0x76, 0x2F, 0x31, 0x01, 2, 0, 0, 0 };
+    {
+        const int pixelType = _bytesPerChannel == 4 ? 2 : 1; // FLOAT : HALF
+        std::vector<unsigned char> channels;
+        for (const EXRChannel& c : exrChannels(_nChannels)) {
+            channels.insert(channels.end(), c.name, c.name + std::strlen(c.name) + 1);
+            appendLittleEndian(channels, pixelType, 4);
+            appendLittleEndian(channels, 0, 4); // pLinear and reserved
+            appendLittleEndian(channels, 1, 4); // xSampling
+            appendLittleEndian(channels, 1, 4); // ySampling
+        }
+        channels.push_back('\0');
+        appendAttribute(header, "channels", "chlist", channels);
+    }
+    appendAttribute(header, "compression", "compression", { 3 }); // ZIP_COMPRESSION
+    {
+        std::vector<unsigned char> window;
+        appendLittleEndian(window, 0, 4);
+        appendLittleEndian(window, 0, 4);
+        appendLittleEndian(window, static_cast<uint32_t>(_size.x - 1), 4);
+        appendLittleEndian(window, static_cast<uint32_t>(_size.y - 1), 4);
+        appendAttribute(header, "dataWindow", "box2i", window);
+        appendAttribute(header, "displayWindow", "box2i", window);
+    }
+    appendAttribute(header, "lineOrder", "lineOrder", { 0 }); // INCREASING_Y
+    {
+        constexpr float One = 1.f;
+        uint32_t one;
+        std::memcpy(&one, &One, sizeof(float));
+        std::vector<unsigned char> value;
+        appendLittleEndian(value, one, 4);
+        appendAttribute(header, "pixelAspectRatio", "float", value);
+        appendAttribute(header, "screenWindowWidth", "float", value);
     }
+    appendAttribute(header, "screenWindowCenter", "v2f", std::vector<unsigned char>(8));
+    header.push_back('\0');
 
-    std::vector<png_bytep> rowPtrs(_size.y);
-    for (int y = 0; y < _size.y; y++) {
-        const size_t idx = static_cast<size_t>(_size.y) - 1 - static_cast<size_t>(y);
-        rowPtrs[idx] = &_data[y * _size.x * _nChannels * _bytesPerChannel];
+    // The header is followed by a table with the file offset of every block
+    uint64_t offset = header.size() + blocks.size() * sizeof(uint64_t);
+    for (const EXRBlock& block : blocks) {
+        appendLittleEndian(header, offset, 8);
+        offset += block.data.size();
     }
-    png_write_image(png_ptr, rowPtrs.data());
-    rowPtrs.clear();
 
-    png_write_end(png_ptr, nullptr);
-    png_destroy_write_struct(&png_ptr, &info_ptr);
+    FILE* fp = fopen(filename.c_str(), "wb");
+    if (fp == nullptr) {
+        throw Err(9017, fmt::format("Can't create EXR file '{}'", filename));
+    }
+    bool success = fwrite(header.data(), 1, header.size(), fp) == header.size();
+    for (const EXRBlock& block : blocks) {
+        success = success &&
+            fwrite(block.data.data(), 1, block.data.size(), fp) == block.data.size();
+    }
     fclose(fp);
+    if (!success) {
+        throw Err(9018, fmt::format("Failed to write EXR file '{}'", filename));
+    }
 
     const double time = (Engine::getTime() - t0) * 1000.0;
-    Log::Debug(fmt::format("'{}' was saved successfully ({:.2f} ms)", filename, time));
+    Log::Debug(fmt::format(
+        "'{}' was saved successfully ({:.2f} ms, {} threads)", filename, time, nThreads
+    ));
 }
 
 unsigned char* Image::data() {
@@ -298,6 +1009,14 @@ void Image::setBytesPerChannel(int bpc) {
     _bytesPerChannel = bpc;
 }
 
+void Image::setFloatingPoint(bool isFloatingPoint) {
+    _isFloatingPoint = isFloatingPoint;
+}
+
+bool Image::isFloatingPoint() const {
+    return _isFloatingPoint;
+}
+
 void Image::allocateOrResizeData() {
     double t0 = Engine::getTime();
 
@@ -311,13 +1030,14 @@ void Image::allocateOrResizeData() {
 
     if (_data && _dataSize != dataSize) {
         // re-allocate if needed
-        delete[] _data;
+        stbi_image_free(_data);
         _data = nullptr;
         _dataSize = 0;
     }
 
     if (!_data) {
-        _data = new unsigned char[dataSize];
+        // Allocated with malloc as the destructor frees the memory through stb_image
+        _data = static_cast<unsigned char*>(std::malloc(dataSize));
         _dataSize = dataSize;
 
         Log::Debug(fmt::format(
@@ -0,0 +1,278 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/imageloader.h>
+
+#include <sgct/engine.h>
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <sgct/settings.h>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Image, code, msg)
+
+namespace {
+    // Guards the creation of the instance, which can be requested from any thread
+    std::mutex instanceMutex;
+
+    // The cache files are identified by this and have to be discarded whenever the way
+    // in which images are decoded changes
+    constexpr std::array<char, 8> CacheMagic = {
+        'S', 'G', 'C', 'T', 'T', 'E', 'X', '\0'
+    };
+    constexpr uint32_t CacheVersion = 1;
+
+    struct CacheHeader {
+        std::array<char, 8> magic = CacheMagic;
+        uint32_t version = CacheVersion;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t nChannels = 0;
+        int32_t bytesPerChannel = 0;
+        uint32_t reserved = 0;
+        uint64_t dataSize = 0;
+    };
+
+    std::vector<unsigned char> readFile(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        std::vector<unsigned char> buffer;
+        if (file.good()) {
+            buffer.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        }
+        if (!file.good() || buffer.empty()) {
+            throw Err(
+                9001, fmt::format("Could not open file '{}' for loading image", filename)
+            );
+        }
+        return buffer;
+    }
+
+    /// \return a name for the cache file that only depends on the contents of \p data
+    std::string cacheName(const std::vector<unsigned char>& data) {
+        // Two independent 32-bit checksums and the size make accidental collisions
+        // practically impossible while zlib computes both faster than we can decode
+        uLong crc = crc32(0, nullptr, 0);
+        uLong adler = adler32(0, nullptr, 0);
+        constexpr size_t ChunkSize = 1 << 30;
+        for (size_t i = 0; i < data.size(); i += ChunkSize) {
+            const uInt n = static_cast<uInt>(std::min(ChunkSize, data.size() - i));
+            crc = crc32(crc, data.data() + i, n);
+            adler = adler32(adler, data.data() + i, n);
+        }
+        return fmt::format("{:08x}{:08x}{:x}.sgcttex", crc, adler, data.size());
+    }
+
+    bool readCache(const std::filesystem::path& path, sgct::Image& image) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.good()) {
+            return false;
+        }
+
+        CacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader));
+        if (!file.good() || header.magic != CacheMagic ||
+            header.version != CacheVersion)
+        {
+            return false;
+        }
+
+        image.setSize(sgct::ivec2{ header.width, header.height });
+        image.setChannels(header.nChannels);
+        image.setBytesPerChannel(header.bytesPerChannel);
+        const uint64_t dataSize = static_cast<uint64_t>(header.width) * header.height *
+            header.nChannels * header.bytesPerChannel;
+        if (dataSize == 0 || dataSize != header.dataSize) {
+            return false;
+        }
+        image.allocateOrResizeData();
+        file.read(reinterpret_cast<char*>(image.data()), dataSize);
+        return file.good();
+    }
+
+    void writeCache(const std::filesystem::path& path, const sgct::Image& image) {
+        CacheHeader header;
+        header.width = image.size().x;
+        header.height = image.size().y;
+        header.nChannels = image.channels();
+        header.bytesPerChannel = image.bytesPerChannel();
+        header.dataSize = static_cast<uint64_t>(header.width) * header.height *
+            header.nChannels * header.bytesPerChannel;
+
+        // The file is written under a temporary name and renamed once it is complete, so
+        // that other threads and processes never see a partially written cache file
+        const size_t id = std::hash<std::thread::id>()(std::this_thread::get_id());
+        std::filesystem::path tmp = path;
+        tmp += fmt::format(".{:x}.tmp", id);
+        {
+            std::ofstream file(tmp, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+            file.write(reinterpret_cast<const char*>(image.data()), header.dataSize);
+            if (!file.good()) {
+                file.close();
+                std::error_code ec;
+                std::filesystem::remove(tmp, ec);
+                sgct::Log::Warning(fmt::format(
+                    "Could not write texture cache file '{}'", path.string()
+                ));
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            sgct::Log::Warning(fmt::format(
+                "Could not write texture cache file '{}'", path.string()
+            ));
+        }
+    }
+} // namespace
+
+namespace sgct {
+
+ImageLoader* ImageLoader::_instance = nullptr;
+
+ImageLoader& ImageLoader::instance() {
+    std::lock_guard lock(instanceMutex);
+    if (!_instance) {
+        const int nThreads = static_cast<int>(std::thread::hardware_concurrency());
+        _instance = new ImageLoader(nThreads, Settings::instance().textureCachePath());
+    }
+    return *_instance;
+}
+
+void ImageLoader::destroy() {
+    // The workers are joined outside of the lock in case one of them needs the instance
+    ImageLoader* instance = nullptr;
+    {
+        std::lock_guard lock(instanceMutex);
+        std::swap(instance, _instance);
+    }
+    delete instance;
+}
+
+ImageLoader::ImageLoader(int nThreads, std::string cachePath)
+    : _cachePath(std::move(cachePath))
+{
+    ZoneScoped
+
+    if (!_cachePath.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(_cachePath, ec);
+        if (ec) {
+            Log::Warning(fmt::format(
+                "Could not create texture cache folder '{}': {}", _cachePath, ec.message()
+            ));
+        }
+    }
+
+    nThreads = std::max(nThreads, 1);
+    _workers.reserve(nThreads);
+    for (int i = 0; i < nThreads; i++) {
+        _workers.emplace_back(&ImageLoader::worker, this);
+    }
+}
+
+ImageLoader::~ImageLoader() {
+    {
+        std::unique_lock lock(_mutex);
+        _isRunning = false;
+    }
+    _taskAdded.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+std::future<Image> ImageLoader::load(std::string filename) {
+    return run([this, filename = std::move(filename)]() {
+        return loadImage(readFile(filename), filename);
+    });
+}
+
+std::future<Image> ImageLoader::decode(std::vector<unsigned char> data) {
+    return run([this, data = std::move(data)]() { return loadImage(data, "<memory>"); });
+}
+
+void ImageLoader::addTask(std::packaged_task<void()> task) {
+    {
+        std::unique_lock lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _taskAdded.notify_one();
+}
+
+int ImageLoader::numberOfThreads() const {
+    return static_cast<int>(_workers.size());
+}
+
+void ImageLoader::worker() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock lock(_mutex);
+            _taskAdded.wait(lock, [this]() { return !_tasks.empty() || !_isRunning; });
+            if (_tasks.empty()) {
+                // We only stop once all images that were requested have been loaded
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+Image ImageLoader::loadImage(const std::vector<unsigned char>& data,
+                              const std::string& name) const
+{
+    ZoneScoped
+
+    const double t0 = Engine::getTime();
+
+    std::filesystem::path cacheFile;
+    Image image;
+    if (!_cachePath.empty()) {
+        cacheFile = std::filesystem::path(_cachePath) / cacheName(data);
+        if (readCache(cacheFile, image)) {
+            Log::Debug(fmt::format(
+                "Loaded '{}' from texture cache ({:.2f} ms)",
+                name, (Engine::getTime() - t0) * 1000.0
+            ));
+            return image;
+        }
+    }
+
+    image.load(data.data(), static_cast<int>(data.size()));
+    if (image.data() == nullptr) {
+        throw Err(
+            9001, fmt::format("Could not open file '{}' for loading image", name)
+        );
+    }
+    Log::Debug(fmt::format(
+        "Decoded '{}' ({:.2f} ms)", name, (Engine::getTime() - t0) * 1000.0
+    ));
+
+    if (!cacheFile.empty()) {
+        writeCache(cacheFile, image);
+    }
+    return image;
+}
+
+} // namespace sgct
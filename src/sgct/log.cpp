@@ -11,10 +11,12 @@
 #include <sgct/fmt.h>
 #include <sgct/networkmanager.h>
 #include <sgct/mutexes.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <cstdarg>
+#include <cstdlib>
 
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -25,6 +27,26 @@
 #include <cstdarg> // va_copy
 
 namespace {
+    // The number of records that fit into the ring buffer, which has to be a power of two
+    constexpr size_t BufferSize = 4096;
+
+    // The maximum number of records that are written to the outputs at once
+    constexpr size_t BatchSize = 256;
+
+    // The background thread checks for the shutdown in this interval even if nobody
+    // notifies it and callers waiting for space or for a flush do the same
+    constexpr std::chrono::milliseconds WaitTimeout = std::chrono::milliseconds(100);
+
+    // The longest time an error waits to be written. The callback might need a lock that
+    // the thread logging the error holds, in which case the error is written after the
+    // caller has continued
+    constexpr std::chrono::milliseconds ErrorTimeout = std::chrono::milliseconds(500);
+
+    // The messages below this level are not written once the Log has been destroyed
+    constexpr sgct::Log::Level DestroyedLevel = sgct::Log::Level::Info;
+
+    std::once_flag instanceFlag;
+
     std::string_view levelToString(sgct::Log::Level level) {
         switch (level) {
             case sgct::Log::Level::Debug: return "Debug";
@@ -38,77 +60,296 @@ namespace {
 
 namespace sgct {
 
-Log* Log::_instance = nullptr;
+std::atomic<Log*> Log::_instance = nullptr;
 
-Log& Log::instance() {
-    if (!_instance) {
+Log* Log::createInstance() {
+    std::call_once(instanceFlag, []() {
         _instance = new Log;
+
+        // Messages that are still in the buffer when the application exits without
+        // destroying the Engine are written before the process ends
+        std::atexit([]() { Log::destroy(); });
+    });
+    return _instance;
+}
+
+Log& Log::instance() {
+    Log* log = createInstance();
+    if (!log) {
+        throw std::logic_error("The Log is accessed after it has been destroyed");
     }
-    return *_instance;
+    return *log;
 }
 
 void Log::destroy() {
-    delete _instance;
-    _instance = nullptr;
+    // The background thread writes all messages that are left before it is joined
+    delete _instance.exchange(nullptr);
 }
 
-Log::Log() {
+void Log::print(Level level, std::string_view message) {
+    Log* log = createInstance();
+    if (!log) {
+        // The Log is not created again once it has been destroyed as nothing would join
+        // its background thread. The few messages that are logged during the shutdown
+        // are written to the console directly instead
+        if (level >= DestroyedLevel) {
+            std::cout << fmt::format("({}) {}\n", levelToString(level), message);
+        }
+        return;
+    }
+
+    if (log->_level <= level) {
+        log->printv(level, std::string(message));
+    }
+}
+
+Log::Log()
+    : _mask(BufferSize - 1)
+{
     _parseBuffer.resize(128);
+
+    _cells = std::make_unique<Cell[]>(BufferSize);
+    for (size_t i = 0; i < BufferSize; i++) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _worker = std::thread(&Log::worker, this);
+}
+
+Log::~Log() {
+    // The background thread empties the buffer before it checks whether it should stop
+    _isRunning = false;
+    _recordAdded.notify();
+    _worker.join();
 }
 
 void Log::printv(Level level, std::string message) {
-    if (_showTime) {
-        constexpr int TimeBufferSize = 9;
-        char TimeBuffer[TimeBufferSize];
-        time_t now = time(nullptr);
-        tm* timeInfoPtr;
-        timeInfoPtr = localtime(&now);
-        strftime(TimeBuffer, TimeBufferSize, "%X", timeInfoPtr);
-
-        message = fmt::format("{} | {}", TimeBuffer, message);
-    }
-    if (_showLevel) {
-        message = fmt::format("({}) {}", levelToString(level), message);
-    }
-
-    if (_logToConsole) {
-        // We need an endl here to make sure that any application listening to our log
-        // messages (looking at you C-Troll) is actually getting the messages immediately.
-        // If the `flush` doesn't happen here, all of the messages stack up in the buffer
-        // and are only sent once the application is finished, which is no bueno
-        std::cout << message << std::endl;
+    Record record;
+    record.level = level;
+    record.time = std::chrono::system_clock::now();
+    record.threadId = std::this_thread::get_id();
+    record.message = std::move(message);
+
+    // Errors are never discarded and are written before the caller continues, so that
+    // they are not lost if the application crashes or terminates right afterwards
+    const bool isError = level == Level::Error;
+    const bool wait = isError || _overflowPolicy == OverflowPolicy::Block;
+    size_t position = 0;
+    if (push(record, wait, position) && isError) {
+        waitUntilWritten(position, std::chrono::steady_clock::now() + ErrorTimeout);
+    }
+}
+
+bool Log::push(Record& record, bool wait, size_t& position) {
+    // The background thread would wait for itself if it logged into a full buffer
+    const bool isWorker = std::this_thread::get_id() == _worker.get_id();
+    while (true) {
+        const uint32_t generation = _recordWritten.generation();
+        if (tryPush(record, position)) {
+            _recordAdded.notify();
+            return true;
+        }
+
+        if (!wait || isWorker) {
+            _nDiscarded++;
+            return false;
+        }
+        _recordWritten.wait(generation, WaitTimeout);
+    }
+}
+
+bool Log::tryPush(Record& record, size_t& position) {
+    // This is the same bounded queue as in the CaptureThreadPool, but as there is only a
+    // single consumer, only the producers have to compete for a cell
+    size_t pos = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _cells[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (_enqueuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+               ))
+            {
+                cell.record = std::move(record);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                position = pos;
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell still holds the record from one round earlier, so the buffer is
+            // full
+            return false;
+        }
+        else {
+            pos = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Log::tryPop(Record& record) {
+    Cell& cell = _cells[_dequeuePosition & _mask];
+    const size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if (seq != _dequeuePosition + 1) {
+        // The producer has not finished writing to this cell yet
+        return false;
+    }
+
+    record = std::move(cell.record);
+    cell.sequence.store(_dequeuePosition + _mask + 1, std::memory_order_release);
+    _dequeuePosition++;
+    return true;
+}
+
+bool Log::waitUntilWritten(size_t position,
+                           std::chrono::steady_clock::time_point deadline)
+{
+    if (std::this_thread::get_id() == _worker.get_id()) {
+        return false;
+    }
+
+    uint32_t generation = _recordWritten.generation();
+    while (_writtenPosition.load(std::memory_order_acquire) <= position) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        const auto timeout = std::min<std::chrono::steady_clock::duration>(
+            WaitTimeout,
+            deadline - now
+        );
+        _recordWritten.wait(
+            generation,
+            std::chrono::duration_cast<std::chrono::microseconds>(timeout)
+        );
+        generation = _recordWritten.generation();
+    }
+    return true;
+}
+
+void Log::flush() {
+    const size_t end = _enqueuePosition.load(std::memory_order_acquire);
+    if (end > 0) {
+        waitUntilWritten(end - 1);
+    }
+}
+
+void Log::worker() {
+    std::vector<Record> batch;
+    batch.reserve(BatchSize);
+    while (true) {
+        const uint32_t generation = _recordAdded.generation();
+
+        Record record;
+        while (batch.size() < BatchSize && tryPop(record)) {
+            batch.push_back(std::move(record));
+        }
+
+        if (const size_t nDiscarded = _nDiscarded.exchange(0); nDiscarded > 0) {
+            Record r;
+            r.level = Level::Warning;
+            r.time = std::chrono::system_clock::now();
+            r.threadId = std::this_thread::get_id();
+            r.message = fmt::format(
+                "Discarded {} log messages as the log buffer was full", nDiscarded
+            );
+            batch.push_back(std::move(r));
+        }
+
+        if (!batch.empty()) {
+            write(batch);
+            batch.clear();
+            _writtenPosition.store(_dequeuePosition, std::memory_order_release);
+            _recordWritten.notify();
+            continue;
+        }
+
+        if (!_isRunning) {
+            break;
+        }
+        _recordAdded.wait(generation, WaitTimeout);
+    }
+}
+
+void Log::write(const std::vector<Record>& records) {
+    std::vector<std::string> messages;
+    messages.reserve(records.size());
+    std::function<void(Level, std::string_view)> callback;
+    {
+        std::unique_lock lock(_mutex);
+
+        std::string console;
+        for (const Record& record : records) {
+            std::string message = record.message;
+            if (_showThreadId) {
+                std::ostringstream id;
+                id << record.threadId;
+                message = fmt::format("[{}] {}", id.str(), message);
+            }
+            if (_showTime) {
+                constexpr int TimeBufferSize = 9;
+                char TimeBuffer[TimeBufferSize];
+                const time_t time = std::chrono::system_clock::to_time_t(record.time);
+                tm* timeInfoPtr;
+                timeInfoPtr = localtime(&time);
+                strftime(TimeBuffer, TimeBufferSize, "%X", timeInfoPtr);
+
+                message = fmt::format("{} | {}", TimeBuffer, message);
+            }
+            if (_showLevel) {
+                message = fmt::format("({}) {}", levelToString(record.level), message);
+            }
+
+            if (_logToConsole) {
+                console += message;
+                console += '\n';
 #ifdef WIN32
-        OutputDebugStringA((message + '\n').c_str());
+                OutputDebugStringA((message + '\n').c_str());
 #endif // WIN32
+            }
+            if (_file.is_open()) {
+                _file << message << '\n';
+            }
+            messages.push_back(std::move(message));
+        }
+
+        if (!console.empty()) {
+            // We need to flush here to make sure that any application listening to our
+            // log messages (looking at you C-Troll) is actually getting the messages
+            // immediately. Otherwise all of the messages stack up in the buffer and are
+            // only sent once the application is finished, which is no bueno. Flushing
+            // once per batch instead of once per message keeps this cheap
+            std::cout << console << std::flush;
+        }
+        if (_file.is_open()) {
+            _file.flush();
+        }
+        callback = _messageCallback;
     }
 
-    if (_messageCallback) {
-        _messageCallback(level, message);
+    // The callback is called without holding the lock so that it can change the settings
+    if (callback) {
+        for (size_t i = 0; i < records.size(); i++) {
+            callback(records[i].level, messages[i]);
+        }
     }
 }
 
 void Log::Debug(std::string_view message) {
-    if (instance()._level <= Level::Debug) {
-        instance().printv(Level::Debug, std::string(message));
-    }
+    print(Level::Debug, message);
 }
 
 void Log::Info(std::string_view message) {
-    if (instance()._level <= Level::Info) {
-        instance().printv(Level::Info, std::string(message));
-    }
+    print(Level::Info, message);
 }
 
 void Log::Warning(std::string_view message) {
-    if (instance()._level <= Level::Warning) {
-        instance().printv(Level::Warning, std::string(message));
-    }
+    print(Level::Warning, message);
 }
 
 void Log::Error(std::string_view message) {
-    if (instance()._level <= Level::Error) {
-        instance().printv(Level::Error, std::string(message));
-    }
+    print(Level::Error, message);
 }
 
 void Log::setNotifyLevel(Level nl) {
@@ -116,19 +357,52 @@ void Log::setNotifyLevel(Level nl) {
 }
 
 void Log::setShowTime(bool state) {
+    std::unique_lock lock(_mutex);
     _showTime = state;
 }
 
 void Log::setShowLogLevel(bool state) {
+    std::unique_lock lock(_mutex);
     _showLevel = state;
 }
 
+void Log::setShowThreadId(bool state) {
+    std::unique_lock lock(_mutex);
+    _showThreadId = state;
+}
+
 void Log::setLogToConsole(bool state) {
+    std::unique_lock lock(_mutex);
     _logToConsole = state;
 }
 
+void Log::setLogFile(const std::string& filename) {
+    bool success = true;
+    {
+        std::unique_lock lock(_mutex);
+        if (_file.is_open()) {
+            _file.close();
+        }
+        if (!filename.empty()) {
+            _file.clear();
+            _file.open(filename, std::ios::out | std::ios::app);
+            success = _file.good();
+        }
+    }
+
+    // Logging might wait for the background thread, which needs the lock
+    if (!success) {
+        Warning(fmt::format("Could not open log file '{}'", filename));
+    }
+}
+
 void Log::setLogCallback(std::function<void(Level, std::string_view)> fn) {
+    std::unique_lock lock(_mutex);
     _messageCallback = std::move(fn);
 }
 
+void Log::setOverflowPolicy(OverflowPolicy policy) {
+    _overflowPolicy = policy;
+}
+
 } // namespace sgct
@@ -12,12 +12,18 @@
 #include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/math.h>
+#include <sgct/profiling.h>
 #include <sgct/tinyxml.h>
+#include <sgct/correction/mpcdimesh.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <unzip.h>
 #include <algorithm>
+#include <climits>
+#include <cstring>
+#include <future>
+#include <map>
 #include <string_view>
 
 #define Error(code, msg) Error(Error::Component::MPCDI, code, msg)
@@ -32,11 +38,124 @@ namespace {
         return r;
     }
 
-    struct SubFile {
-        std::string fileName;
-        std::vector<char> buffer;
+    /// A file inside the MPCDI archive
+    struct Entry {
+        std::string name;
+        unz_file_pos position;
+        size_t size = 0;
     };
 
+    /// The paths of the files in the archive that belong to a single region
+    struct RegionFiles {
+        std::string geometryWarpFile;
+        std::string alphaMap;
+        std::string betaMap;
+    };
+
+    /**
+     * A single file of the MPCDI archive that is opened with its own handle of the
+     * archive, so that several files can be decompressed at the same time on different
+     * threads. The file is decompressed while it is read.
+     */
+    class ArchiveFile {
+    public:
+        ArchiveFile(const std::string& archive, const Entry& entry)
+            : _name(entry.name)
+        {
+            _zip = unzOpen(archive.c_str());
+            if (_zip == nullptr) {
+                throw Error(
+                    4019, fmt::format("Unable to open zip archive file {}", archive)
+                );
+            }
+            unz_file_pos pos = entry.position;
+            if (unzGoToFilePos(_zip, &pos) != UNZ_OK ||
+                unzOpenCurrentFile(_zip) != UNZ_OK)
+            {
+                unzClose(_zip);
+                throw Error(4024, fmt::format("Unable to open {}", _name));
+            }
+        }
+
+        ~ArchiveFile() {
+            unzCloseCurrentFile(_zip);
+            unzClose(_zip);
+        }
+
+        ArchiveFile(const ArchiveFile&) = delete;
+        ArchiveFile& operator=(const ArchiveFile&) = delete;
+
+        size_t read(char* dst, size_t size) {
+            const unsigned int s = static_cast<unsigned int>(
+                std::min<size_t>(size, INT_MAX)
+            );
+            const int n = unzReadCurrentFile(_zip, dst, s);
+            if (n < 0) {
+                throw Error(4025, fmt::format("Read from {} failed", _name));
+            }
+            return static_cast<size_t>(n);
+        }
+
+    private:
+        const std::string _name;
+        unzFile _zip = nullptr;
+    };
+
+    correction::Buffer readMesh(const std::string& archive, const Entry& entry) {
+        ZoneScoped
+
+        ArchiveFile file(archive, entry);
+        return correction::generateMpcdiMesh(
+            [&file](char* dst, size_t size) { return file.read(dst, size); }
+        );
+    }
+
+    Image readImage(const std::string& archive, const Entry& entry) {
+        ZoneScoped
+
+        // The compressed image has to be complete before it can be decoded, but it is
+        // released as soon as the pixels are available
+        Image img;
+        {
+            std::vector<unsigned char> data(entry.size);
+            ArchiveFile file(archive, entry);
+            size_t offset = 0;
+            while (offset < data.size()) {
+                char* dst = reinterpret_cast<char*>(data.data() + offset);
+                const size_t n = file.read(dst, data.size() - offset);
+                if (n == 0) {
+                    throw Error(4025, fmt::format("Read from {} failed", entry.name));
+                }
+                offset += n;
+            }
+            img.load(data.data(), static_cast<int>(data.size()));
+        }
+        if (img.data() == nullptr) {
+            throw Error(4029, fmt::format("Unable to decode image {}", entry.name));
+        }
+        if (img.channels() != 1) {
+            return img;
+        }
+
+        // Alpha and beta maps are usually grayscale images, but the masks are applied to
+        // each color channel separately
+        Image rgb;
+        rgb.setSize(img.size());
+        rgb.setChannels(3);
+        rgb.setBytesPerChannel(img.bytesPerChannel());
+        rgb.allocateOrResizeData();
+        const size_t bpc = img.bytesPerChannel();
+        const size_t nPixels = static_cast<size_t>(img.size().x) * img.size().y;
+        for (size_t i = 0; i < nPixels; i++) {
+            const unsigned char* src = img.data() + i * bpc;
+            unsigned char* dst = rgb.data() + 3 * i * bpc;
+            std::memcpy(dst, src, bpc);
+            std::memcpy(dst + bpc, src, bpc);
+            std::memcpy(dst + 2 * bpc, src, bpc);
+        }
+        return rgb;
+    }
+
     [[nodiscard]] config::MpcdiProjection parseRegion(const tinyxml2::XMLElement& elem) {
         config::MpcdiProjection proj;
         if (const char* a = elem.Attribute("id"); a) {
@@ -132,22 +251,49 @@ namespace {
 
             ReturnValue::ViewportInfo v;
             v.proj = parseRegion(*region);
-            res.viewports.push_back(v);
+            res.viewports.push_back(std::move(v));
             region = region->NextSiblingElement("region");
         }
     }
 
-    void parseDisplay(const tinyxml2::XMLElement& element, ReturnValue& res) {
+    void parseDisplay(const tinyxml2::XMLElement& element,
+                      const std::optional<std::string>& bufferId, ReturnValue& res)
+    {
         const tinyxml2::XMLElement* buffer = element.FirstChildElement("buffer");
-        if (buffer->NextSiblingElement("buffer")) {
-            throw Error(4007, "Multiple 'buffer' elements not supported");
+        if (bufferId) {
+            while (buffer) {
+                const char* id = buffer->Attribute("id");
+                if (id && *bufferId == id) {
+                    break;
+                }
+                buffer = buffer->NextSiblingElement("buffer");
+            }
+            if (buffer == nullptr) {
+                throw Error(
+                    4028, fmt::format("Missing 'buffer' element with id '{}'", *bufferId)
+                );
+            }
+        }
+        else {
+            if (buffer == nullptr) {
+                throw Error(4028, "Missing 'buffer' element");
+            }
+            if (buffer->NextSiblingElement("buffer")) {
+                throw Error(4007, "Multiple 'buffer' elements require selecting one");
+            }
         }
         parseBuffer(*buffer, res);
     }
 
-    void parseGeoWarpFile(const tinyxml2::XMLElement& element, const std::string& region,
-                          const SubFile& pfmFile, ReturnValue& res)
-    {
+    std::string parsePath(const tinyxml2::XMLElement& element) {
+        const tinyxml2::XMLElement* path = element.FirstChildElement("path");
+        if (path == nullptr || path->GetText() == nullptr) {
+            throw Error(4010, fmt::format("{} requires path", element.Value()));
+        }
+        return path->GetText();
+    }
+
+    std::string parseGeoWarpFile(const tinyxml2::XMLElement& element) {
         const tinyxml2::XMLElement* interp = element.FirstChildElement("interpolation");
         if (interp == nullptr) {
             throw Error(4008, "GeometryWarpFile requires interpolation");
@@ -155,69 +301,55 @@ namespace {
         if (std::string_view(interp->GetText()) != "linear") {
             throw Error(4009, "Only linear interpolation is supported");
         }
-
-        const tinyxml2::XMLElement* path = element.FirstChildElement("path");
-        if (path == nullptr) {
-            throw Error(4010, "GeometryWarpFile requires path");
-        }
-        std::string_view pathWarpFile(path->GetText());
-
-        // Look for matching MPCDI region (SGCT viewport) to pass the warp field data to
-        bool foundMatchingPfmBuffer = false;
-        for (ReturnValue::ViewportInfo& vpInfo : res.viewports) {
-            const std::string& viewportId = *vpInfo.proj.id;
-            if (viewportId == region && pathWarpFile == pfmFile.fileName) {
-                vpInfo.meshData = pfmFile.buffer;
-                foundMatchingPfmBuffer = true;
-            }
-        }
-        if (!foundMatchingPfmBuffer) {
-            throw Error(4011, "No matching geometryWarpFile found");
-        }
+        return parsePath(element);
     }
 
-    void parseFiles(const tinyxml2::XMLElement& e, const SubFile& pfm, ReturnValue& res) {
-        std::string fileRegion;
+    std::map<std::string, RegionFiles> parseFiles(const tinyxml2::XMLElement& e) {
+        std::map<std::string, RegionFiles> res;
 
         const tinyxml2::XMLElement* child = e.FirstChildElement("fileset");
         while (child) {
-            // @TODO (abock, 2019-12-06) This layout will mean that subsequent 'fileset'
-            // children will overwrite the fileRegion. I'm not sure if this is desired or
-            // not, but it's how it is
-            if (const char* a = child->Attribute("region"); a) {
-                fileRegion = a;
+            // Every fileset has to name its region, as it would otherwise replace the
+            // files of another region
+            const char* fileRegion = child->Attribute("region");
+            if (fileRegion == nullptr) {
+                throw Error(4030, "No 'region' attribute provided for fileset");
             }
+            RegionFiles& files = res[fileRegion];
 
-            const tinyxml2::XMLElement* c = child->FirstChildElement("geometryWarpFile");
-            while (c) {
-                if (c->FirstChildElement("alphaMap")) {
-                    Log::Warning("Unsupported feature: alphaMap");
-                }
-                if (c->FirstChildElement("betaMap")) {
-                    Log::Warning("Unsupported feature: betaMap");
-                }
-                if (c->FirstChildElement("distortionMap")) {
-                    Log::Warning("Unsupported feature: distortionMap");
-                }
-                if (c->FirstChildElement("decodeLUT")) {
-                    Log::Warning("Unsupported feature: decodeLUT");
-                }
-                if (c->FirstChildElement("correctLUT")) {
-                    Log::Warning("Unsupported feature: correctLUT");
-                }
-                if (child->FirstChildElement("encodeLUT")) {
-                    Log::Warning("Unsupported feature: encodeLUT");
-                }
-
-                parseGeoWarpFile(*c, fileRegion, pfm, res);
+            if (child->FirstChildElement("distortionMap")) {
+                Log::Warning("Unsupported feature: distortionMap");
+            }
+            if (child->FirstChildElement("decodeLUT")) {
+                Log::Warning("Unsupported feature: decodeLUT");
+            }
+            if (child->FirstChildElement("correctLUT")) {
+                Log::Warning("Unsupported feature: correctLUT");
+            }
+            if (child->FirstChildElement("encodeLUT")) {
+                Log::Warning("Unsupported feature: encodeLUT");
+            }
 
-                c = c->NextSiblingElement("geometryWarpFile");
+            const tinyxml2::XMLElement* c = child->FirstChildElement("geometryWarpFile");
+            if (c) {
+                files.geometryWarpFile = parseGeoWarpFile(*c);
+            }
+            if (const tinyxml2::XMLElement* m = child->FirstChildElement("alphaMap"); m) {
+                files.alphaMap = parsePath(*m);
+            }
+            if (const tinyxml2::XMLElement* m = child->FirstChildElement("betaMap"); m) {
+                files.betaMap = parsePath(*m);
             }
+
             child = child->NextSiblingElement("fileset");
         }
+        return res;
     }
 
-    ReturnValue parseMpcdi(const tinyxml2::XMLDocument& doc, const SubFile& pfmFile) {
+    ReturnValue parseMpcdi(const tinyxml2::XMLDocument& doc,
+                           const std::optional<std::string>& buffer,
+                           std::map<std::string, RegionFiles>& files)
+    {
         const tinyxml2::XMLElement* rootNode = doc.FirstChildElement("MPCDI");
         if (rootNode == nullptr) {
             throw Error(4012, "Cannot find XML root");
@@ -247,14 +379,14 @@ namespace {
         if (displayElement->NextSiblingElement("display") != nullptr) {
             throw Error(4017, "Multiple 'display' elements not supported");
         }
-        parseDisplay(*displayElement, res);
+        parseDisplay(*displayElement, buffer, res);
 
         // Parse the files subtree
         const tinyxml2::XMLElement* filesElement = root.FirstChildElement("files");
         if (filesElement == nullptr) {
             throw Error(4018, "Missing 'files' element");
         }
-        parseFiles(*filesElement, pfmFile, res);
+        files = parseFiles(*filesElement);
 
         // Check for unsupported features that we might want to warn about
         const tinyxml2::XMLElement* extSetElem = root.FirstChildElement("extensionSet");
@@ -266,7 +398,9 @@ namespace {
     }
 } // namespace
 
-ReturnValue parseMpcdiConfiguration(const std::string& filename) {
+ReturnValue parseMpcdiConfiguration(const std::string& filename,
+                                    const std::optional<std::string>& buffer)
+{
     unzFile zip = unzOpen(filename.c_str());
     if (zip == nullptr) {
         throw Error(4019, fmt::format("Unable to open zip archive file {}", filename));
@@ -281,9 +415,11 @@ ReturnValue parseMpcdiConfiguration(const std::string& filename) {
         );
     }
 
-    // Search for required files inside mpcdi archive file
+    // Only the XML file is uncompressed right away. For all other files we remember
+    // where they are located so that they can be read once we know which of them belong
+    // to the regions of the requested buffer
     std::vector<char> xmlBuffer;
-    SubFile pfmComponent;
+    std::map<std::string, Entry> entries;
     try {
         for (unsigned int i = 0; i < globalInfo.number_entry; ++i) {
             unz_file_info info;
@@ -311,32 +447,25 @@ ReturnValue parseMpcdiConfiguration(const std::string& filename) {
                 }
                 xmlBuffer.resize(uncompSize);
                 const int size = unzReadCurrentFile(zip, xmlBuffer.data(), uncompSize);
+                unzCloseCurrentFile(zip);
                 if (size < 0) {
                     throw Error(4023, fmt::format("Read from {} failed", fileName));
                 }
             }
-            else if (endsWith(fileName, "pfm")) {
-                // Uncompress the PFM file
-                if (!pfmComponent.buffer.empty()) {
+            else {
+                if (entries.find(fileName) != entries.end()) {
                     Log::Warning(
                         fmt::format("Duplicate file {} found in MPCDI", fileName)
                     );
                 }
 
-                const int openCurrentFile = unzOpenCurrentFile(zip);
-                if (openCurrentFile != UNZ_OK) {
-                    throw Error(4024, fmt::format("Unable to open {}", fileName));
+                Entry entry;
+                entry.name = fileName;
+                entry.size = uncompSize;
+                if (unzGetFilePos(zip, &entry.position) != UNZ_OK) {
+                    throw Error(4021, fmt::format("Unable to get info on file {}", i));
                 }
-                std::vector<char> buffer(uncompSize);
-                const int size = unzReadCurrentFile(zip, buffer.data(), uncompSize);
-                if (size < 0) {
-                    throw Error(4025, fmt::format("Read from {} failed", fileName));
-                }
-                pfmComponent.fileName = fileName;
-                pfmComponent.buffer = std::move(buffer);
-            }
-            else {
-                Log::Warning(fmt::format("Ignoring extension {}", fileName));
+                entries[fileName] = std::move(entry);
             }
 
             if (i < globalInfo.number_entry - 1) {
@@ -353,10 +482,8 @@ ReturnValue parseMpcdiConfiguration(const std::string& filename) {
     }
 
     unzClose(zip);
-    if (xmlBuffer.empty() || pfmComponent.buffer.empty()) {
-        throw Error(
-            4026, fmt::format("{} does not contain the XML and/or PFM file", filename)
-        );
+    if (xmlBuffer.empty()) {
+        throw Error(4026, fmt::format("{} does not contain the XML file", filename));
     }
 
     tinyxml2::XMLDocument xmlDoc;
@@ -368,7 +495,74 @@ ReturnValue parseMpcdiConfiguration(const std::string& filename) {
         ));
     }
 
-    ReturnValue res = parseMpcdi(xmlDoc, pfmComponent);
+    std::map<std::string, RegionFiles> files;
+    ReturnValue res = parseMpcdi(xmlDoc, buffer, files);
+
+    auto entry = [&entries, &filename](const std::string& path,
+                                       const std::string& region) -> const Entry&
+    {
+        const auto it = entries.find(path);
+        if (it == entries.end()) {
+            throw Error(4011, fmt::format(
+                "File {} of region {} not found in {}", path, region, filename
+            ));
+        }
+        return it->second;
+    };
+
+    // Every file is decompressed and decoded by its own task, so that the files of all
+    // regions are read concurrently and only the resulting mesh and images are kept
+    struct Tasks {
+        std::future<correction::Buffer> mesh;
+        std::future<Image> alphaMap;
+        std::future<Image> betaMap;
+    };
+    std::vector<Tasks> tasks(res.viewports.size());
+    for (size_t i = 0; i < res.viewports.size(); i++) {
+        const std::string& region = *res.viewports[i].proj.id;
+        const auto it = files.find(region);
+        if (it == files.end()) {
+            continue;
+        }
+
+        const RegionFiles& f = it->second;
+        if (!f.geometryWarpFile.empty()) {
+            tasks[i].mesh = std::async(
+                std::launch::async,
+                readMesh,
+                std::cref(filename),
+                std::cref(entry(f.geometryWarpFile, region))
+            );
+        }
+        if (!f.alphaMap.empty()) {
+            tasks[i].alphaMap = std::async(
+                std::launch::async,
+                readImage,
+                std::cref(filename),
+                std::cref(entry(f.alphaMap, region))
+            );
+        }
+        if (!f.betaMap.empty()) {
+            tasks[i].betaMap = std::async(
+                std::launch::async,
+                readImage,
+                std::cref(filename),
+                std::cref(entry(f.betaMap, region))
+            );
+        }
+    }
+
+    for (size_t i = 0; i < res.viewports.size(); i++) {
+        if (tasks[i].mesh.valid()) {
+            res.viewports[i].mesh = tasks[i].mesh.get();
+        }
+        if (tasks[i].alphaMap.valid()) {
+            res.viewports[i].alphaMap = tasks[i].alphaMap.get();
+        }
+        if (tasks[i].betaMap.valid()) {
+            res.viewports[i].betaMap = tasks[i].betaMap.get();
+        }
+    }
     return res;
 }
 
@@ -0,0 +1,583 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/multicast.h>
+
+#ifdef WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define VC_EXTRALEAN
+    #define NOMINMAX
+    #include <Windows.h>
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #define SGCT_ERRNO WSAGetLastError()
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/uio.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <errno.h>
+    #include <unistd.h>
+    #define SOCKET_ERROR (-1)
+    #define INVALID_SOCKET (~0)
+    #define SGCT_ERRNO errno
+#endif
+
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
+
+namespace {
+    // The repair message starts with the block id, the size of the frame, and the number
+    // of fragments, followed by the index and the content of each repaired fragment
+    constexpr const int RepairHeaderSize = 1 + sizeof(uint32_t) + sizeof(uint16_t);
+
+    int fragmentLength(uint32_t size, uint16_t index) {
+        using namespace sgct::multicast;
+        const uint32_t offset = index * static_cast<uint32_t>(FragmentSize);
+        return static_cast<int>(
+            std::min<uint32_t>(size - offset, FragmentSize)
+        );
+    }
+
+    void closeSocket(SGCT_SOCKET s) {
+#ifdef WIN32
+        closesocket(s);
+#else // WIN32
+        close(s);
+#endif // WIN32
+    }
+
+    in_addr parseAddress(const std::string& address) {
+        in_addr res;
+        if (inet_pton(AF_INET, address.c_str(), &res) != 1) {
+            throw Err(5032, fmt::format("Invalid multicast address {}", address));
+        }
+        return res;
+    }
+} // namespace
+
+namespace sgct {
+
+namespace multicast {
+
+int fragmentCount(int length) {
+    return std::max(1, (length + FragmentSize - 1) / FragmentSize);
+}
+
+bool Reassembler::addDatagram(const char* datagram, int length) {
+    if (length < HeaderSize) {
+        // Timeout, error, or a package that was not sent by SGCT
+        return false;
+    }
+
+    const char blockId = datagram[0];
+    uint32_t sequence;
+    std::memcpy(&sequence, datagram + 1, sizeof(sequence));
+    uint32_t size;
+    std::memcpy(&size, datagram + 5, sizeof(size));
+    uint16_t index;
+    std::memcpy(&index, datagram + 9, sizeof(index));
+    uint16_t nFragments;
+    std::memcpy(&nFragments, datagram + 11, sizeof(nFragments));
+
+    Frame* f = frame(sequence, blockId, size, nFragments);
+    if (!f || index >= nFragments) {
+        return false;
+    }
+    return storeFragment(*f, index, datagram + HeaderSize, length - HeaderSize);
+}
+
+bool Reassembler::applyRepair(uint32_t sequence, const char* data, int length) {
+    if (length < RepairHeaderSize) {
+        return false;
+    }
+
+    const char blockId = data[0];
+    uint32_t size;
+    std::memcpy(&size, data + 1, sizeof(size));
+    uint16_t nFragments;
+    std::memcpy(&nFragments, data + 5, sizeof(nFragments));
+
+    Frame* f = frame(sequence, blockId, size, nFragments);
+    if (!f) {
+        return false;
+    }
+
+    bool isCompleted = false;
+    int pos = RepairHeaderSize;
+    while (length - pos >= static_cast<int>(sizeof(uint16_t))) {
+        uint16_t index;
+        std::memcpy(&index, data + pos, sizeof(index));
+        pos += sizeof(index);
+        if (index >= nFragments) {
+            break;
+        }
+
+        const int fragmentSize = size > 0 ? fragmentLength(size, index) : 0;
+        if (length - pos < fragmentSize) {
+            break;
+        }
+        isCompleted |= storeFragment(*f, index, data + pos, fragmentSize);
+        pos += fragmentSize;
+    }
+    return isCompleted;
+}
+
+bool Reassembler::isComplete(uint32_t sequence) const {
+    const Frame& f = _frames[sequence % HistorySize];
+    return f.sequence == sequence && f.nFragments > 0 && f.nReceived == f.nFragments;
+}
+
+std::vector<char> Reassembler::createNack(uint32_t sequence) const {
+    const Frame& f = _frames[sequence % HistorySize];
+    if (f.sequence != sequence) {
+        return std::vector<char>();
+    }
+
+    std::vector<char> result;
+    for (uint16_t i = 0; i < f.nFragments; i++) {
+        if (!f.isReceived[i]) {
+            const size_t pos = result.size();
+            result.resize(pos + sizeof(i));
+            std::memcpy(result.data() + pos, &i, sizeof(i));
+        }
+    }
+    return result;
+}
+
+bool Reassembler::takeFrame(uint32_t sequence, char& blockId,
+                            std::vector<char>& result) const
+{
+    if (!isComplete(sequence)) {
+        return false;
+    }
+
+    const Frame& f = _frames[sequence % HistorySize];
+    blockId = f.blockId;
+    result.assign(f.data.begin(), f.data.end());
+    return true;
+}
+
+Reassembler::Frame* Reassembler::frame(uint32_t sequence, char blockId, uint32_t size,
+                                       uint16_t nFragments)
+{
+    if (nFragments != fragmentCount(static_cast<int>(size))) {
+        return nullptr;
+    }
+
+    Frame& f = _frames[sequence % HistorySize];
+    if (f.sequence == sequence) {
+        return (f.blockId == blockId && f.data.size() == size) ? &f : nullptr;
+    }
+    if (f.sequence > sequence) {
+        // Fragment of a frame that is older than what we are already holding
+        return nullptr;
+    }
+
+    f.sequence = sequence;
+    f.blockId = blockId;
+    f.nFragments = nFragments;
+    f.nReceived = 0;
+    f.data.resize(size);
+    f.isReceived.assign(nFragments, false);
+    return &f;
+}
+
+bool Reassembler::storeFragment(Frame& f, uint16_t index, const char* data, int length) {
+    const int expected = f.data.empty() ?
+        0 :
+        fragmentLength(static_cast<uint32_t>(f.data.size()), index);
+    if (f.isReceived[index] || length != expected) {
+        return false;
+    }
+
+    if (length > 0) {
+        std::memcpy(f.data.data() + index * FragmentSize, data, length);
+    }
+    f.isReceived[index] = true;
+    f.nReceived++;
+    return f.nReceived == f.nFragments;
+}
+
+} // namespace multicast
+
+MulticastSender::MulticastSender(const MulticastGroup& group) {
+    ZoneScoped
+
+    const in_addr address = parseAddress(group.address);
+    _groupAddress = address.s_addr;
+    _groupPort = htons(static_cast<uint16_t>(group.port));
+
+    _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_socket == INVALID_SOCKET) {
+        throw Err(5030, fmt::format("Failed to create multicast socket: {}", SGCT_ERRNO));
+    }
+
+    // Looping the packages back to the sending host makes it possible to run the master
+    // and the clients on the same machine
+#ifdef WIN32
+    const DWORD ttl = static_cast<DWORD>(group.ttl);
+    const DWORD loop = 1;
+#else // WIN32
+    const unsigned char ttl = static_cast<unsigned char>(group.ttl);
+    const unsigned char loop = 1;
+#endif // WIN32
+    const char* t = reinterpret_cast<const char*>(&ttl);
+    const char* l = reinterpret_cast<const char*>(&loop);
+    if (setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_TTL, t, sizeof(ttl)) ||
+        setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_LOOP, l, sizeof(loop)))
+    {
+        closeSocket(_socket);
+        throw Err(
+            5034,
+            fmt::format("Failed to configure multicast socket: {}", SGCT_ERRNO)
+        );
+    }
+
+    if (!group.interfaceAddress.empty()) {
+        const in_addr interfaceAddress = parseAddress(group.interfaceAddress);
+        const int res = setsockopt(
+            _socket,
+            IPPROTO_IP,
+            IP_MULTICAST_IF,
+            reinterpret_cast<const char*>(&interfaceAddress),
+            sizeof(interfaceAddress)
+        );
+        if (res) {
+            closeSocket(_socket);
+            throw Err(
+                5034,
+                fmt::format("Failed to configure multicast socket: {}", SGCT_ERRNO)
+            );
+        }
+    }
+
+    Log::Info(fmt::format(
+        "Sending sync data to multicast group {}:{}", group.address, group.port
+    ));
+}
+
+MulticastSender::~MulticastSender() {
+    closeSocket(_socket);
+}
+
+bool MulticastSender::canSend(int length) {
+    return multicast::fragmentCount(length) <= multicast::MaxFragments;
+}
+
+uint32_t MulticastSender::send(char blockId, const void* data, int length) {
+    ZoneScoped
+
+    _sequence++;
+    const uint32_t sequence = _sequence;
+    const uint32_t size = static_cast<uint32_t>(length);
+    const uint16_t nFragments = static_cast<uint16_t>(multicast::fragmentCount(length));
+
+    std::unique_lock lock(_historyMutex);
+    // A copy of the frame has to be kept anyway in case a client misses a fragment, so
+    // the fragments are sent from that copy
+    Frame& frame = _history[sequence % multicast::HistorySize];
+    frame.sequence = sequence;
+    frame.blockId = blockId;
+    frame.data.assign(
+        reinterpret_cast<const char*>(data),
+        reinterpret_cast<const char*>(data) + length
+    );
+
+    sockaddr_in destination = {};
+    destination.sin_family = AF_INET;
+    destination.sin_addr.s_addr = _groupAddress;
+    destination.sin_port = _groupPort;
+
+    for (uint16_t i = 0; i < nFragments; i++) {
+        std::array<char, multicast::HeaderSize> header;
+        header[0] = blockId;
+        std::memcpy(header.data() + 1, &sequence, sizeof(sequence));
+        std::memcpy(header.data() + 5, &size, sizeof(size));
+        std::memcpy(header.data() + 9, &i, sizeof(i));
+        std::memcpy(header.data() + 11, &nFragments, sizeof(nFragments));
+
+        char* fragment = frame.data.data() + i * multicast::FragmentSize;
+        const int fragmentSize = length > 0 ? fragmentLength(size, i) : 0;
+
+#ifdef WIN32
+        WSABUF buffers[2];
+        buffers[0].buf = header.data();
+        buffers[0].len = static_cast<ULONG>(header.size());
+        buffers[1].buf = fragment;
+        buffers[1].len = static_cast<ULONG>(fragmentSize);
+        DWORD sent = 0;
+        const int res = WSASendTo(
+            _socket,
+            buffers,
+            2,
+            &sent,
+            0,
+            reinterpret_cast<const sockaddr*>(&destination),
+            sizeof(destination),
+            nullptr,
+            nullptr
+        );
+#else // WIN32
+        iovec buffers[2];
+        buffers[0].iov_base = header.data();
+        buffers[0].iov_len = header.size();
+        buffers[1].iov_base = fragment;
+        buffers[1].iov_len = static_cast<size_t>(fragmentSize);
+
+        msghdr message = {};
+        message.msg_name = &destination;
+        message.msg_namelen = sizeof(destination);
+        message.msg_iov = buffers;
+        message.msg_iovlen = 2;
+        const ssize_t res = sendmsg(_socket, &message, 0);
+#endif // WIN32
+
+        if (res == SOCKET_ERROR) {
+            // Not fatal, the clients will request the missing fragment through TCP
+            Log::Debug(fmt::format(
+                "Failed to send fragment {} of multicast frame {}: {}",
+                i, sequence, SGCT_ERRNO
+            ));
+        }
+    }
+
+    return sequence;
+}
+
+bool MulticastSender::createRepair(uint32_t sequence, const char* nack, int nackLength,
+                                   std::vector<char>& result) const
+{
+    ZoneScoped
+
+    std::unique_lock lock(_historyMutex);
+    const Frame& frame = _history[sequence % multicast::HistorySize];
+    if (frame.sequence != sequence) {
+        return false;
+    }
+
+    const uint32_t size = static_cast<uint32_t>(frame.data.size());
+    const int count = multicast::fragmentCount(static_cast<int>(size));
+    const uint16_t nFragments = static_cast<uint16_t>(count);
+
+    std::vector<uint16_t> indices(nackLength / sizeof(uint16_t));
+    if (!indices.empty()) {
+        std::memcpy(indices.data(), nack, indices.size() * sizeof(uint16_t));
+    }
+    else {
+        indices.resize(nFragments);
+        for (uint16_t i = 0; i < nFragments; i++) {
+            indices[i] = i;
+        }
+    }
+
+    result.resize(RepairHeaderSize);
+    result[0] = frame.blockId;
+    std::memcpy(result.data() + 1, &size, sizeof(size));
+    std::memcpy(result.data() + 5, &nFragments, sizeof(nFragments));
+    for (uint16_t index : indices) {
+        if (index >= nFragments) {
+            continue;
+        }
+
+        const int length = size > 0 ? fragmentLength(size, index) : 0;
+        const size_t pos = result.size();
+        result.resize(pos + sizeof(index) + length);
+        std::memcpy(result.data() + pos, &index, sizeof(index));
+        if (length > 0) {
+            std::memcpy(
+                result.data() + pos + sizeof(index),
+                frame.data.data() + index * multicast::FragmentSize,
+                length
+            );
+        }
+    }
+    return true;
+}
+
+MulticastReceiver::MulticastReceiver(const MulticastGroup& group,
+                                     std::function<void()> onUpdate)
+    : _onUpdate(std::move(onUpdate))
+{
+    ZoneScoped
+
+    ip_mreq request;
+    request.imr_multiaddr = parseAddress(group.address);
+    if (group.interfaceAddress.empty()) {
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+    }
+    else {
+        request.imr_interface = parseAddress(group.interfaceAddress);
+    }
+
+    _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_socket == INVALID_SOCKET) {
+        throw Err(5030, fmt::format("Failed to create multicast socket: {}", SGCT_ERRNO));
+    }
+
+    // Multiple clients on the same machine have to be able to share the port
+    const int reuse = 1;
+    const char* r = reinterpret_cast<const char*>(&reuse);
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, r, sizeof(reuse));
+#ifdef SO_REUSEPORT
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEPORT, r, sizeof(reuse));
+#endif // SO_REUSEPORT
+
+    // A large receive buffer reduces the number of fragments that have to be repaired
+    const int bufferSize = 4 * 1024 * 1024;
+    const char* b = reinterpret_cast<const char*>(&bufferSize);
+    setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, b, sizeof(bufferSize));
+
+    // The timeout makes sure that the receive thread can terminate
+#ifdef WIN32
+    const DWORD timeout = 100;
+#else // WIN32
+    timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 100000;
+#endif // WIN32
+    const char* t = reinterpret_cast<const char*>(&timeout);
+    setsockopt(_socket, SOL_SOCKET, SO_RCVTIMEO, t, sizeof(timeout));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(group.port));
+    if (bind(_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) {
+        closeSocket(_socket);
+        throw Err(
+            5031,
+            fmt::format(
+                "Failed to bind multicast socket to port {}: {}", group.port, SGCT_ERRNO
+            )
+        );
+    }
+
+    const int res = setsockopt(
+        _socket,
+        IPPROTO_IP,
+        IP_ADD_MEMBERSHIP,
+        reinterpret_cast<const char*>(&request),
+        sizeof(request)
+    );
+    if (res) {
+        closeSocket(_socket);
+        throw Err(
+            5033,
+            fmt::format(
+                "Failed to join multicast group {}: {}", group.address, SGCT_ERRNO
+            )
+        );
+    }
+
+    Log::Info(fmt::format(
+        "Receiving sync data from multicast group {}:{}", group.address, group.port
+    ));
+
+    _thread = std::thread([this]() { receiveLoop(); });
+    _timerThread = std::thread([this]() { timerLoop(); });
+}
+
+MulticastReceiver::~MulticastReceiver() {
+    {
+        std::unique_lock lock(_timerMutex);
+        _shouldTerminate = true;
+    }
+    _timerCond.notify_all();
+    if (_timerThread.joinable()) {
+        _timerThread.join();
+    }
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    closeSocket(_socket);
+}
+
+void MulticastReceiver::receiveLoop() {
+    std::vector<char> buffer(multicast::MaxDatagramSize);
+    while (!_shouldTerminate) {
+        const int length = static_cast<int>(
+            recv(_socket, buffer.data(), static_cast<int>(buffer.size()), 0)
+        );
+
+        bool isCompleted = false;
+        {
+            std::unique_lock lock(_mutex);
+            isCompleted = _frames.addDatagram(buffer.data(), length);
+        }
+        if (isCompleted && _onUpdate) {
+            _onUpdate();
+        }
+    }
+}
+
+void MulticastReceiver::timerLoop() {
+    std::unique_lock lock(_timerMutex);
+    while (!_shouldTerminate) {
+        if (!_wakeTime.has_value()) {
+            _timerCond.wait(lock);
+            continue;
+        }
+
+        const std::chrono::steady_clock::time_point wakeTime = *_wakeTime;
+        _timerCond.wait_until(lock, wakeTime);
+        if (_wakeTime != wakeTime || std::chrono::steady_clock::now() < wakeTime) {
+            // Rescheduled, spurious wakeup, or terminating
+            continue;
+        }
+
+        _wakeTime.reset();
+        lock.unlock();
+        if (_onUpdate) {
+            _onUpdate();
+        }
+        lock.lock();
+    }
+}
+
+void MulticastReceiver::wakeAfter(std::chrono::microseconds delay) {
+    {
+        std::unique_lock lock(_timerMutex);
+        _wakeTime = std::chrono::steady_clock::now() + delay;
+    }
+    _timerCond.notify_all();
+}
+
+bool MulticastReceiver::isComplete(uint32_t sequence) const {
+    std::unique_lock lock(_mutex);
+    return _frames.isComplete(sequence);
+}
+
+std::vector<char> MulticastReceiver::createNack(uint32_t sequence) const {
+    std::unique_lock lock(_mutex);
+    return _frames.createNack(sequence);
+}
+
+void MulticastReceiver::applyRepair(uint32_t sequence, const char* data, int length) {
+    ZoneScoped
+
+    std::unique_lock lock(_mutex);
+    _frames.applyRepair(sequence, data, length);
+}
+
+bool MulticastReceiver::takeFrame(uint32_t sequence, char& blockId,
+                                  std::vector<char>& result) const
+{
+    std::unique_lock lock(_mutex);
+    return _frames.takeFrame(sequence, blockId, result);
+}
+
+} // namespace sgct
@@ -19,11 +19,14 @@
 #else
     #include <sys/types.h>
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
     #include <netinet/tcp.h>
     #include <arpa/inet.h>
     #include <errno.h>
+    #include <fcntl.h>
     #include <netdb.h>
+    #include <poll.h>
     #include <unistd.h>
     #define SOCKET_ERROR (-1)
     #define INVALID_SOCKET (~0)
@@ -36,10 +39,13 @@
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
+#include <sgct/multicast.h>
 #include <sgct/mutexes.h>
 #include <sgct/networkmanager.h>
+#include <sgct/networkreactor.h>
 #include <sgct/profiling.h>
 #include <sgct/shareddata.h>
+#include <zlib.h>
 #include <algorithm>
 #include <cstring>
 
@@ -52,6 +58,10 @@ namespace {
 
     constexpr const int MaxNetworkSyncFrameNumber = 10000;
 
+    // How long the client waits for the missing fragments of a multicast frame before
+    // requesting them through TCP
+    constexpr const std::chrono::milliseconds MulticastTimeout(2);
+
     std::string getTypeStr(sgct::Network::ConnectionType ct) {
         using N = sgct::Network;
         switch (ct) {
@@ -62,6 +72,58 @@ namespace {
         }
     }
 
+    // The messages that carry the sync data of a frame from the master to a client
+    bool isSyncBlock(char headerId) {
+        using N = sgct::Network;
+        return headerId == N::DataId || headerId == N::DeltaDataId ||
+               headerId == N::MulticastFrameId;
+    }
+
+    // The answer to a time request carries the time at which it is written to the
+    // socket, which is only known once it is its turn to be sent. Waiting in the send
+    // queue would otherwise count as network delay on the way back
+    void stampTimeResponse(char headerId, std::vector<char>& payload) {
+        if (headerId == sgct::Network::TimeResponseId &&
+            payload.size() == 3 * sizeof(double))
+        {
+            const double t = sgct::Engine::getTime();
+            std::memcpy(payload.data() + 2 * sizeof(double), &t, sizeof(double));
+        }
+    }
+
+    bool isWouldBlock(int error) {
+#ifdef WIN32
+        return error == WSAEWOULDBLOCK;
+#else // WIN32
+#if EAGAIN != EWOULDBLOCK
+        return error == EAGAIN || error == EWOULDBLOCK;
+#else // EAGAIN != EWOULDBLOCK
+        return error == EAGAIN;
+#endif // EAGAIN != EWOULDBLOCK
+#endif // WIN32
+    }
+
+    void setNonBlocking(SGCT_SOCKET s) {
+#ifdef WIN32
+        u_long mode = 1;
+        ioctlsocket(s, FIONBIO, &mode);
+#else // WIN32
+        fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif // WIN32
+    }
+
+    // Sockets that are serviced by the NetworkReactor are non-blocking, so sending has to
+    // wait for the socket to accept more data if its send buffer is full
+    void waitUntilWritable(SGCT_SOCKET s) {
+#ifdef WIN32
+        WSAPOLLFD fd = { s, POLLWRNORM, 0 };
+        WSAPoll(&fd, 1, -1);
+#else // WIN32
+        pollfd fd = { s, POLLOUT, 0 };
+        poll(&fd, 1, -1);
+#endif // WIN32
+    }
+
     bool isDisconnectPackage(const char* header) {
         constexpr const char rhs[] = {
             sgct::Network::DisconnectId, 24, '\r', '\n', 27, '\r', '\n', '\0'
@@ -93,8 +155,8 @@ Network::Network(int port, std::string address, bool isServer, ConnectionType t)
     std::memset(&hints, 0, sizeof(hints));
     hints.ai_family = AF_INET;
     hints.ai_socktype = SOCK_STREAM;
-    // @TODO (abock, 2019-11-28);  We could probably get away with using the UDP stack as
-    // we are always waiting for ack messages from the clients anyway
+    // The sync data itself can be sent through UDP multicast (see MulticastSender), but
+    // the frame tokens and acks always go through TCP
     hints.ai_protocol = IPPROTO_TCP;
     hints.ai_flags = AI_PASSIVE;
 
@@ -176,8 +238,120 @@ Network::~Network() {
     closeNetwork(false);
 }
 
-void Network::initialize() {
-    _mainThread = std::make_unique<std::thread>([this]() { connectionHandler(); });
+void Network::initialize(NetworkReactor* reactor) {
+    if (reactor) {
+        setNonBlocking(_isServer ? _listenSocket : _socket);
+        reactor->add(*this);
+    }
+    else {
+        _mainThread = std::make_unique<std::thread>([this]() { connectionHandler(); });
+    }
+
+    if (_connectionType == ConnectionType::SyncConnection && _isServer) {
+        _sendThread = std::make_unique<std::thread>([this]() { sendHandler(); });
+    }
+}
+
+void Network::sendHandler() {
+    while (true) {
+        SendRequest request;
+        {
+            std::unique_lock lock(_sendMutex);
+            _sendCond.wait(
+                lock,
+                [this]() { return !_sendQueue.empty() || _stopSending; }
+            );
+            if (_sendQueue.empty()) {
+                // Only reached when stopping, after all remaining messages were sent
+                return;
+            }
+            request = std::move(_sendQueue.front());
+            _sendQueue.pop_front();
+            if (!request.buffer.empty()) {
+                request.data = request.buffer.data();
+            }
+        }
+
+        try {
+            if (_isConnected) {
+                stampTimeResponse(request.header[0], request.buffer);
+                sendData(request.header.data(), HeaderSize, request.data, request.length);
+            }
+        }
+        catch (const std::runtime_error& e) {
+            Log::Error(e.what());
+        }
+        const double now = Engine::getTime();
+        _sendLatency = now - request.queueTime;
+        if (isSyncBlock(request.header[0])) {
+            _syncSendTime = now;
+        }
+
+        {
+            std::unique_lock lock(_sendMutex);
+            _nPendingSends--;
+        }
+        _sendCond.notify_all();
+    }
+}
+
+void Network::queueData(const std::array<char, HeaderSize>& header, const void* data,
+                        int length)
+{
+    ZoneScoped
+
+    if (!_sendThread) {
+        sendData(header.data(), HeaderSize, data, length);
+        if (isSyncBlock(header[0])) {
+            _syncSendTime = Engine::getTime();
+        }
+        return;
+    }
+
+    {
+        std::unique_lock lock(_sendMutex);
+        _sendQueue.push_back({ header, data, length, Engine::getTime(), {} });
+        _nPendingSends++;
+        if (isSyncBlock(header[0])) {
+            _syncSendTime = 0.0;
+        }
+    }
+    _sendCond.notify_all();
+}
+
+void Network::queueData(const std::array<char, HeaderSize>& header,
+                        std::vector<char> data)
+{
+    ZoneScoped
+
+    if (!_sendThread) {
+        stampTimeResponse(header[0], data);
+        sendData(header.data(), HeaderSize, data.data(), static_cast<int>(data.size()));
+        return;
+    }
+
+    {
+        std::unique_lock lock(_sendMutex);
+        SendRequest request;
+        request.header = header;
+        request.length = static_cast<int>(data.size());
+        request.queueTime = Engine::getTime();
+        request.buffer = std::move(data);
+        _sendQueue.push_back(std::move(request));
+        _nPendingSends++;
+    }
+    _sendCond.notify_all();
+}
+
+void Network::waitForSendQueue() {
+    ZoneScoped
+
+    std::unique_lock lock(_sendMutex);
+    _sendCond.wait(lock, [this]() { return _nPendingSends == 0; });
+}
+
+double Network::sendLatency() const {
+    return _sendLatency;
 }
 
 void Network::connectionHandler() {
@@ -386,12 +560,23 @@ double Network::loopTime() const {
 bool Network::isUpdated() const {
     bool state = false;
     if (_isServer) {
+        // The number of frames that were sent but not acknowledged yet, taking the
+        // wrap-around of the frame counter into account
+        constexpr int NFrameNumbers = MaxNetworkSyncFrameNumber + 1;
+        const int nFramesInFlight =
+            (_currentSendFrame - _currentRecvFrame + NFrameNumbers) % NFrameNumbers;
         state = ClusterManager::instance().firmFrameLockSyncStatus() ?
-            // master sends first -> so on reply they should be equal
-            (_currentRecvFrame == _currentSendFrame) :
+            // master sends first -> so on reply they should be equal unless the next
+            // frames are allowed to be in flight already
+            (nFramesInFlight < _maxFramesInFlight) :
             // don't check if loose sync
             true;
     }
+    else if (isBufferingSyncFrames()) {
+        // The client can start the next frame as soon as its data is available
+        std::unique_lock lock(_syncFrameMutex);
+        state = !_pendingSyncFrames.empty();
+    }
     else {
         state = ClusterManager::instance().firmFrameLockSyncStatus() ?
             // clients receive first and then send so the prev should be equal to the send
@@ -407,6 +592,10 @@ void Network::setDecodeFunction(std::function<void(const char*, int)> fn) {
     decoderCallback = std::move(fn);
 }
 
+void Network::setDeltaDecodeFunction(std::function<void(const char*, int)> fn) {
+    _deltaDecoderCallback = std::move(fn);
+}
+
 void Network::setPackageDecodeFunction(std::function<void(void*, int, int, int)> fn) {
     _packageDecoderCallback = std::move(fn);
 }
@@ -423,6 +612,153 @@ void Network::setAcknowledgeFunction(std::function<void(int, int)> fn) {
     _acknowledgeCallback = std::move(fn);
 }
 
+void Network::setNackFunction(
+                           std::function<void(Network*, uint32_t, const char*, int)> fn)
+{
+    _nackCallback = std::move(fn);
+}
+
+void Network::enableMulticast(const MulticastGroup& group) {
+    std::unique_lock lock(_multicastMutex);
+    _multicastReceiver = std::make_unique<MulticastReceiver>(
+        group,
+        [this]() {
+            // Called when a frame was completed or the repair timeout has passed
+            std::unique_lock l(_multicastMutex);
+            if (!_multicastReceiver) {
+                return;
+            }
+            try {
+                processMulticastFrames();
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(e.what());
+            }
+        }
+    );
+}
+
+void Network::setMaxFramesInFlight(int frames) {
+    _maxFramesInFlight = std::max(frames, 1);
+}
+
+bool Network::isBufferingSyncFrames() const {
+    return !_isServer && _maxFramesInFlight > 1;
+}
+
+void Network::bufferSyncFrame(int32_t frame, char blockId, const char* data, int length)
+{
+    std::unique_lock lock(_syncFrameMutex);
+    SyncFrame f;
+    f.frame = frame;
+    f.blockId = blockId;
+    f.receiveTime = Engine::getTime();
+    if (!_unusedSyncFrameBuffers.empty()) {
+        f.data = std::move(_unusedSyncFrameBuffers.back());
+        _unusedSyncFrameBuffers.pop_back();
+    }
+    f.data.assign(data, data + length);
+    _pendingSyncFrames.push_back(std::move(f));
+}
+
+void Network::requestClockSync() {
+    const double t0 = Engine::getTime();
+    const uint32_t size = sizeof(t0);
+    char header[HeaderSize];
+    header[0] = TimeRequestId;
+    std::memset(header + 1, DefaultId, 4);
+    std::memcpy(header + 5, &size, sizeof(size));
+    std::memset(header + 9, DefaultId, 4);
+    sendData(header, HeaderSize, &t0, static_cast<int>(size));
+}
+
+const ClockSync& Network::clockSync() const {
+    return _clockSync;
+}
+
+double Network::syncReceiveTime() const {
+    return _syncReceiveTime;
+}
+
+double Network::syncDecodeTime() const {
+    return _syncDecodeTime;
+}
+
+void Network::sendFrameTimestamps(const FrameTimestamps& timestamps) {
+    std::array<char, FrameTimestamps::SerializedSize> payload;
+    timestamps.serialize(payload.data());
+    const uint32_t size = static_cast<uint32_t>(payload.size());
+    char header[HeaderSize];
+    header[0] = FrameTimestampsId;
+    std::memcpy(header + 1, &timestamps.frame, sizeof(timestamps.frame));
+    std::memcpy(header + 5, &size, sizeof(size));
+    std::memset(header + 9, DefaultId, 4);
+    sendData(header, HeaderSize, payload.data(), static_cast<int>(size));
+}
+
+std::vector<FrameTimestamps> Network::takeRemoteFrameTimestamps() {
+    std::unique_lock lock(_remoteTimestampsMutex);
+    std::vector<FrameTimestamps> res(_remoteTimestamps.begin(), _remoteTimestamps.end());
+    _remoteTimestamps.clear();
+    return res;
+}
+
+double Network::syncSendTime() const {
+    return _syncSendTime;
+}
+
+void Network::decodeSyncFrame(char blockId, const char* data, int length) {
+    if (length <= 0) {
+        return;
+    }
+
+    if (blockId == DataId && decoderCallback) {
+        decoderCallback(data, length);
+    }
+    else if (blockId == DeltaDataId && _deltaDecoderCallback) {
+        _deltaDecoderCallback(data, length);
+    }
+}
+
+void Network::applySyncFrame() {
+    ZoneScoped
+
+    if (!isBufferingSyncFrames()) {
+        return;
+    }
+
+    std::unique_lock lock(_syncFrameMutex);
+    // Only with loose sync can a client fall behind by more frames than are allowed to
+    // be in flight. In that case it catches up by decoding the older frames back to back
+    do {
+        if (_pendingSyncFrames.empty()) {
+            return;
+        }
+        SyncFrame f = std::move(_pendingSyncFrames.front());
+        _pendingSyncFrames.pop_front();
+        lock.unlock();
+
+        decodeSyncFrame(f.blockId, f.data.data(), static_cast<int>(f.data.size()));
+        setRecvFrame(f.frame);
+        _syncReceiveTime = f.receiveTime;
+        _syncDecodeTime = Engine::getTime();
+
+        lock.lock();
+        _unusedSyncFrameBuffers.push_back(std::move(f.data));
+    } while (static_cast<int>(_pendingSyncFrames.size()) >= _maxFramesInFlight);
+}
+
+std::array<char, Network::HeaderSize> Network::createHeader(char id, int32_t value,
+                                                           int size, int uncompressedSize)
+{
+    std::array<char, HeaderSize> header;
+    header[0] = id;
+    std::memcpy(header.data() + 1, &value, sizeof(value));
+    std::memcpy(header.data() + 5, &size, sizeof(size));
+    std::memcpy(header.data() + 9, &uncompressedSize, sizeof(uncompressedSize));
+    return header;
+}
+
 void Network::setConnectedStatus(bool state) {
     std::unique_lock lock(_connectionMutex);
     _isConnected = state;
@@ -432,6 +768,111 @@ bool Network::isConnected() const {
     return _isConnected;
 }
 
+bool Network::needsKeyframe() const {
+    return _needsKeyframe;
+}
+
+void Network::setNeedsKeyframe(bool state) {
+    _needsKeyframe = state;
+}
+
+bool Network::takeKeyframeRequest() {
+    return _needsKeyframe.exchange(false);
+}
+
+bool Network::acceptSyncBlock(char blockId) {
+    if (blockId == DataId) {
+        _needsKeyframe = false;
+        return true;
+    }
+    return blockId != DeltaDataId || !_needsKeyframe;
+}
+
+void Network::setCompression(Compression compression, int threshold) {
+    _compression = compression;
+    _compressionThreshold = threshold;
+}
+
+Network::Compression Network::compression() const {
+    return _compression;
+}
+
+Network::CompressionStatistics Network::compressionStatistics() const {
+    std::unique_lock lock(_compressionStatisticsMutex);
+    return _compressionStatistics;
+}
+
+bool Network::compressPayload(const void* payload, int length, std::vector<char>& result)
+{
+    ZoneScoped
+
+    const Compression compression = _compression;
+    if (compression == Compression::None || length <= 0 ||
+        length < _compressionThreshold)
+    {
+        return false;
+    }
+
+    const double t0 = Engine::getTime();
+    uLongf compressedSize = compressBound(static_cast<uLong>(length));
+    result.resize(compressedSize);
+    const int res = compress2(
+        reinterpret_cast<Bytef*>(result.data()),
+        &compressedSize,
+        reinterpret_cast<const Bytef*>(payload),
+        static_cast<uLong>(length),
+        compression == Compression::Fast ? Z_BEST_SPEED : Z_DEFAULT_COMPRESSION
+    );
+    if (res != Z_OK) {
+        throw Err(5019, fmt::format("Failed to compress data: {}", zError(res)));
+    }
+    if (compressedSize >= static_cast<uLongf>(length)) {
+        // Incompressible data, so it is cheaper to just send the original
+        return false;
+    }
+    result.resize(compressedSize);
+
+    std::unique_lock lock(_compressionStatisticsMutex);
+    _compressionStatistics.uncompressedBytes += static_cast<uint64_t>(length);
+    _compressionStatistics.compressedBytes += static_cast<uint64_t>(compressedSize);
+    _compressionStatistics.nCompressedMessages++;
+    _compressionStatistics.compressionTime += Engine::getTime() - t0;
+    return true;
+}
+
+char* Network::decompressPayload(uint32_t& dataSize, uint32_t uncompressedDataSize) {
+    if (uncompressedDataSize == 0) {
+        return _recvBuffer.data();
+    }
+
+    ZoneScoped
+
+    const double t0 = Engine::getTime();
+    uLongf size = static_cast<uLongf>(uncompressedDataSize);
+    const int res = uncompress(
+        reinterpret_cast<Bytef*>(_uncompressBuffer.data()),
+        &size,
+        reinterpret_cast<const Bytef*>(_recvBuffer.data()),
+        static_cast<uLong>(dataSize)
+    );
+    if (res != Z_OK || size != uncompressedDataSize) {
+        const int code = type() == ConnectionType::SyncConnection ? 5011 : 5012;
+        throw Err(
+            code,
+            fmt::format(
+                "Failed to uncompress data for connection {}: {}",
+                _id, res != Z_OK ? zError(res) : "Size mismatch"
+            )
+        );
+    }
+    dataSize = uncompressedDataSize;
+
+    std::unique_lock lock(_compressionStatisticsMutex);
+    _compressionStatistics.nDecompressedMessages++;
+    _compressionStatistics.decompressionTime += Engine::getTime() - t0;
+    return _uncompressBuffer.data();
+}
+
 Network::ConnectionType Network::type() const {
     std::unique_lock lock(_connectionMutex);
     return _connectionType;
@@ -499,36 +940,57 @@ void Network::updateBuffer(std::vector<char>& buf, uint32_t reqSize, uint32_t& c
     curSize = reqSize;
 }
 
+void Network::parseSyncHeader(const char* header, int32_t& syncFrame, uint32_t& dataSize,
+                              uint32_t& uncompressedDataSize, uint32_t& sequence)
+{
+    _headerId = header[0];
+    if (_headerId == DataId || _headerId == DeltaDataId) {
+        std::memcpy(&syncFrame, header + 1, sizeof(syncFrame));
+        std::memcpy(&dataSize, header + 5, sizeof(dataSize));
+        std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
+
+        // Buffered frames are only marked as received once their data is decoded
+        if (!isBufferingSyncFrames()) {
+            setRecvFrame(syncFrame);
+        }
+        if (syncFrame < 0) {
+            const std::string s = std::to_string(syncFrame);
+            const std::string i = std::to_string(_id);
+            throw Err(
+                5010,
+                fmt::format("Error in sync frame {} for connection {}", s, i)
+            );
+        }
+
+        // resize buffer if needed
+        updateBuffer(_recvBuffer, dataSize, _bufferSize);
+        updateBuffer(_uncompressBuffer, uncompressedDataSize, _uncompressedBufferSize);
+    }
+    else if (_headerId == MulticastFrameId) {
+        // The frame is only marked as received once its data has been decoded
+        std::memcpy(&syncFrame, header + 1, sizeof(syncFrame));
+        std::memcpy(&sequence, header + 9, sizeof(sequence));
+    }
+    else if (_headerId == NackId || _headerId == RepairId) {
+        std::memcpy(&sequence, header + 1, sizeof(sequence));
+        std::memcpy(&dataSize, header + 5, sizeof(dataSize));
+        updateBuffer(_recvBuffer, dataSize, _bufferSize);
+    }
+    else if (_headerId == TimeRequestId || _headerId == TimeResponseId ||
+             _headerId == FrameTimestampsId)
+    {
+        std::memcpy(&dataSize, header + 5, sizeof(dataSize));
+        updateBuffer(_recvBuffer, dataSize, _bufferSize);
+    }
+}
+
 int Network::readSyncMessage(char* header, int32_t& syncFrame, uint32_t& dataSize,
-                             uint32_t& uncompressedDataSize)
+                             uint32_t& uncompressedDataSize, uint32_t& sequence)
 {
     int iResult = receiveData(_socket, header, static_cast<int>(HeaderSize), 0);
 
     if (iResult == static_cast<int>(HeaderSize)) {
-        _headerId = header[0];
-        if (_headerId == DataId) {
-            std::memcpy(&syncFrame, header + 1, sizeof(syncFrame));
-            std::memcpy(&dataSize, header + 5, sizeof(dataSize));
-            std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
-
-            setRecvFrame(syncFrame);
-            if (syncFrame < 0) {
-                const std::string s = std::to_string(syncFrame);
-                const std::string i = std::to_string(_id);
-                throw Err(
-                    5010,
-                    fmt::format("Error in sync frame {} for connection {}", s, i)
-                );
-            }
-
-            // resize buffer if needed
-            updateBuffer(_recvBuffer, dataSize, _bufferSize);
-            updateBuffer(
-                _uncompressBuffer,
-                uncompressedDataSize,
-                _uncompressedBufferSize
-            );
-        }
+        parseSyncHeader(header, syncFrame, dataSize, uncompressedDataSize, sequence);
     }
 
     // Get the data/message
@@ -539,31 +1001,102 @@ int Network::readSyncMessage(char* header, int32_t& syncFrame, uint32_t& dataSiz
     return iResult;
 }
 
+void Network::processMulticastFrames() {
+    ZoneScoped
+
+    // The frames have to be delivered in the order of their tokens, so a frame with
+    // missing fragments blocks all later frames until its repair has arrived. Instead of
+    // waiting here, this function is called again when the frame has been completed or
+    // when the time for the missing fragments to arrive has passed
+    while (!_pendingMulticastFrames.empty()) {
+        const auto [frame, sequence] = _pendingMulticastFrames.front();
+        const bool isLost = sequence == _lostSequence;
+        if (!isLost && !_multicastReceiver->isComplete(sequence)) {
+            const auto now = std::chrono::steady_clock::now();
+            if (!_isAwaitingMulticastFrame) {
+                _isAwaitingMulticastFrame = true;
+                _multicastDeadline = now + MulticastTimeout;
+                _multicastReceiver->wakeAfter(MulticastTimeout);
+            }
+            else if (now >= _multicastDeadline && _nackedSequence != sequence) {
+                const std::vector<char> nack = _multicastReceiver->createNack(sequence);
+                const uint32_t size = static_cast<uint32_t>(nack.size());
+                char header[HeaderSize];
+                header[0] = NackId;
+                std::memcpy(header + 1, &sequence, sizeof(sequence));
+                std::memcpy(header + 5, &size, sizeof(size));
+                std::memset(header + 9, DefaultId, 4);
+                sendData(header, HeaderSize, nack.data(), static_cast<int>(size));
+                _nackedSequence = sequence;
+            }
+            return;
+        }
+        _pendingMulticastFrames.pop_front();
+        _isAwaitingMulticastFrame = false;
+
+        char blockId = DefaultId;
+        int size = 0;
+        if (isLost) {
+            // Later deltas would be applied to the wrong data, so they are skipped until
+            // the next full data block arrives
+            Log::Warning(fmt::format(
+                "Multicast frame {} is no longer available on the server", sequence
+            ));
+            _needsKeyframe = true;
+        }
+        else if (_multicastReceiver->takeFrame(sequence, blockId, _multicastBuffer)) {
+            if (acceptSyncBlock(blockId)) {
+                size = static_cast<int>(_multicastBuffer.size());
+            }
+        }
+
+        if (isBufferingSyncFrames()) {
+            bufferSyncFrame(frame, blockId, _multicastBuffer.data(), size);
+        }
+        else {
+            _syncReceiveTime = Engine::getTime();
+            decodeSyncFrame(blockId, _multicastBuffer.data(), size);
+            _syncDecodeTime = Engine::getTime();
+            setRecvFrame(frame);
+        }
+        NetworkManager::frameSignal.notify();
+    }
+}
+
+void Network::parseDataTransferHeader(const char* header, int32_t& packageId,
+                                      uint32_t& dataSize, uint32_t& uncompressedDataSize)
+{
+    _headerId = header[0];
+    if (_headerId == DataId || _headerId == DataChunkId) {
+        // parse the package _id
+        std::memcpy(&packageId, header + 1, sizeof(packageId));
+        std::memcpy(&dataSize, header + 5, sizeof(dataSize));
+        std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
+
+        // resize buffer if needed
+        updateBuffer(_recvBuffer, dataSize, _bufferSize);
+        updateBuffer(_uncompressBuffer, uncompressedDataSize, _uncompressedBufferSize);
+    }
+    else if (_headerId == DataBeginId) {
+        // The total size of a package that is sent in chunks is in the place of the
+        // uncompressed size and the message itself has no payload
+        std::memcpy(&packageId, header + 1, sizeof(packageId));
+        std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
+        dataSize = 0;
+    }
+    else if (_headerId == Ack && _acknowledgeCallback != nullptr) {
+        std::memcpy(&packageId, header + 1, sizeof(packageId));
+        _acknowledgeCallback(packageId, _id);
+    }
+}
+
 int Network::readDataTransferMessage(char* header, int32_t& packageId, uint32_t& dataSize,
                                      uint32_t& uncompressedDataSize)
 {
     int iResult = receiveData(_socket, header, static_cast<int>(HeaderSize), 0);
 
     if (iResult == static_cast<int>(HeaderSize)) {
-        _headerId = header[0];
-        if (_headerId == DataId) {
-            // parse the package _id
-            std::memcpy(&packageId, header + 1, sizeof(packageId));
-            std::memcpy(&dataSize, header + 5, sizeof(dataSize));
-            std::memcpy(&uncompressedDataSize, header + 9, sizeof(uncompressedDataSize));
-
-            // resize buffer if needed
-            updateBuffer(_recvBuffer, dataSize, _bufferSize);
-            updateBuffer(
-                _uncompressBuffer,
-                uncompressedDataSize,
-                _uncompressedBufferSize
-            );
-        }
-        else if (_headerId == Ack && _acknowledgeCallback != nullptr) {
-            std::memcpy(&packageId, header + 1, sizeof(packageId));
-            _acknowledgeCallback(packageId, _id);
-        }
+        parseDataTransferHeader(header, packageId, dataSize, uncompressedDataSize);
     }
 
     // Get the data/message
@@ -594,6 +1127,282 @@ int Network::readExternalMessage() {
     return static_cast<int>(iResult);
 }
 
+void Network::startConnection() {
+    // The peer has no previous data block that a delta could be based on
+    _needsKeyframe = true;
+    setConnectedStatus(true);
+    Log::Info(fmt::format("Connection {} established", _id));
+
+    if (_updateCallback) {
+        _updateCallback(this);
+    }
+
+    // init buffers
+    {
+        std::unique_lock lk(_connectionMutex);
+        _recvBuffer.resize(_bufferSize);
+        _uncompressBuffer.resize(_uncompressedBufferSize);
+    }
+    _extBuffer.clear();
+    _receiveState = ReceiveState();
+}
+
+void Network::endConnection() {
+    _recvBuffer.clear();
+    _uncompressBuffer.clear();
+    {
+        std::unique_lock lock(_syncFrameMutex);
+        _pendingSyncFrames.clear();
+    }
+    _clockSync.reset();
+    _partialPackages.clear();
+
+    // Close socket; contains mutex
+    closeSocket(_socket);
+
+    if (_updateCallback) {
+        _updateCallback(this);
+    }
+
+    Log::Info(fmt::format("Node {} disconnected", _id));
+}
+
+bool Network::handleMessage(const char* header, int32_t value, uint32_t dataSize,
+                            uint32_t uncompressedDataSize, uint32_t sequence)
+{
+    if (type() == ConnectionType::SyncConnection) {
+        // handle sync disconnect
+        if (isDisconnectPackage(header)) {
+            setConnectedStatus(false);
+
+            // Terminate client only. The server only resets the connection,
+            // allowing clients to connect.
+            if (!_isServer) {
+                _shouldTerminate = true;
+            }
+
+            Log::Info(fmt::format("Client {} terminated connection", _id));
+            return false;
+        }
+        // handle sync communication
+        const bool isSyncData = _headerId == DataId || _headerId == DeltaDataId;
+        if (isSyncData && !_isServer && !acceptSyncBlock(_headerId)) {
+            // A delta that arrives before the first full data block of this connection,
+            // for example after a reconnect, would be applied to the wrong data
+            Log::Warning(fmt::format(
+                "Dropping delta for frame {} on connection {} without a full data block",
+                value, _id
+            ));
+            dataSize = 0;
+        }
+        if (isSyncData && isBufferingSyncFrames()) {
+            const char* d = nullptr;
+            if (dataSize > 0) {
+                d = decompressPayload(dataSize, uncompressedDataSize);
+            }
+            bufferSyncFrame(value, _headerId, d, static_cast<int>(dataSize));
+
+            NetworkManager::frameSignal.notify();
+        }
+        else if (_headerId == DataId && decoderCallback) {
+            _syncReceiveTime = Engine::getTime();
+            if (dataSize > 0) {
+                const char* d = decompressPayload(dataSize, uncompressedDataSize);
+                decoderCallback(d, dataSize);
+            }
+            _syncDecodeTime = Engine::getTime();
+
+            NetworkManager::frameSignal.notify();
+        }
+        else if (_headerId == DeltaDataId && _deltaDecoderCallback) {
+            _syncReceiveTime = Engine::getTime();
+            if (dataSize > 0) {
+                const char* d = decompressPayload(dataSize, uncompressedDataSize);
+                _deltaDecoderCallback(d, dataSize);
+            }
+            _syncDecodeTime = Engine::getTime();
+
+            NetworkManager::frameSignal.notify();
+        }
+        else if (_headerId == ConnectedId && _connectedCallback) {
+            _connectedCallback();
+            NetworkManager::frameSignal.notify();
+        }
+        else if (_headerId == MulticastFrameId) {
+            std::unique_lock lock(_multicastMutex);
+            if (_multicastReceiver) {
+                _pendingMulticastFrames.emplace_back(value, sequence);
+                processMulticastFrames();
+            }
+        }
+        else if (_headerId == RepairId) {
+            std::unique_lock lock(_multicastMutex);
+            if (_multicastReceiver) {
+                if (dataSize > 0) {
+                    _multicastReceiver->applyRepair(
+                        sequence,
+                        _recvBuffer.data(),
+                        static_cast<int>(dataSize)
+                    );
+                }
+                else {
+                    _lostSequence = sequence;
+                }
+                processMulticastFrames();
+            }
+        }
+        else if (_headerId == NackId && _nackCallback) {
+            const int size = static_cast<int>(dataSize);
+            _nackCallback(this, sequence, _recvBuffer.data(), size);
+        }
+        else if (_headerId == TimeRequestId && dataSize == sizeof(double)) {
+            // Answer with the time the request arrived. The time the answer is written to
+            // the socket is filled in by queueData or the sender thread
+            std::array<double, 3> times;
+            std::memcpy(&times[0], _recvBuffer.data(), sizeof(double));
+            times[1] = Engine::getTime();
+            times[2] = times[1];
+            const uint32_t size = sizeof(times);
+            std::array<char, HeaderSize> response;
+            response[0] = TimeResponseId;
+            std::memset(response.data() + 1, DefaultId, 4);
+            std::memcpy(response.data() + 5, &size, sizeof(size));
+            std::memset(response.data() + 9, DefaultId, 4);
+            std::vector<char> payload(size);
+            std::memcpy(payload.data(), times.data(), size);
+            queueData(response, std::move(payload));
+        }
+        else if (_headerId == TimeResponseId && dataSize == 3 * sizeof(double)) {
+            const double t3 = Engine::getTime();
+            std::array<double, 3> times;
+            std::memcpy(times.data(), _recvBuffer.data(), sizeof(times));
+            _clockSync.addSample(times[0], times[1], times[2], t3);
+        }
+        else if (_headerId == FrameTimestampsId &&
+                 dataSize == FrameTimestamps::SerializedSize)
+        {
+            FrameTimestamps ts = FrameTimestamps::deserialize(_recvBuffer.data());
+            std::unique_lock lock(_remoteTimestampsMutex);
+            if (_remoteTimestamps.size() == MaxRemoteFrameTimestamps) {
+                _remoteTimestamps.pop_front();
+            }
+            _remoteTimestamps.push_back(ts);
+        }
+    }
+    // handle data transfer communication
+    else if (type() == ConnectionType::DataTransfer) {
+        // Disconnect if requested
+        if (isDisconnectPackage(header)) {
+            setConnectedStatus(false);
+            Log::Info(fmt::format("File connection {} terminated", _id));
+        }
+        //  Handle communication
+        else {
+            if (_headerId == DataBeginId) {
+                PartialPackage& package = _partialPackages[value];
+                package.size = uncompressedDataSize;
+                package.data.clear();
+                package.data.reserve(package.size);
+                if (package.size == 0) {
+                    completePackage(value);
+                }
+            }
+            else if (_headerId == DataChunkId) {
+                auto it = _partialPackages.find(value);
+                if (it == _partialPackages.end()) {
+                    Log::Warning(fmt::format(
+                        "Received chunk of unknown package {} on connection {}",
+                        value, _id
+                    ));
+                }
+                else if (dataSize > 0) {
+                    const char* d = decompressPayload(dataSize, uncompressedDataSize);
+                    it->second.data.insert(it->second.data.end(), d, d + dataSize);
+                    if (it->second.data.size() >= it->second.size) {
+                        completePackage(value);
+                    }
+                }
+            }
+            else if (_headerId == DataId && _packageDecoderCallback && dataSize > 0) {
+                char* d = decompressPayload(dataSize, uncompressedDataSize);
+                _packageDecoderCallback(d, dataSize, value, _id);
+                sendAcknowledge(value);
+
+                {
+                    // Clear the buffers
+                    std::unique_lock lk(_connectionMutex);
+
+                    _recvBuffer.clear();
+                    _uncompressBuffer.clear();
+
+                    _bufferSize = 0;
+                    _uncompressedBufferSize = 0;
+                }
+            }
+            else if (_headerId == ConnectedId && _connectedCallback) {
+                _connectedCallback();
+                NetworkManager::frameSignal.notify();
+            }
+        }
+    }
+    return true;
+}
+
+void Network::completePackage(int32_t packageId) {
+    auto it = _partialPackages.find(packageId);
+    if (it == _partialPackages.end()) {
+        return;
+    }
+
+    std::vector<char> data = std::move(it->second.data);
+    _partialPackages.erase(it);
+    if (_packageDecoderCallback) {
+        const int size = static_cast<int>(data.size());
+        _packageDecoderCallback(data.data(), size, packageId, _id);
+    }
+    sendAcknowledge(packageId);
+}
+
+void Network::sendAcknowledge(int32_t packageId) {
+    uint32_t pLength = 0;
+    std::array<char, HeaderSize> sendBuff;
+    sendBuff[0] = Ack;
+    std::memcpy(sendBuff.data() + 1, &packageId, sizeof(packageId));
+    std::memcpy(sendBuff.data() + 5, &pLength, sizeof(pLength));
+    std::memset(sendBuff.data() + 9, DefaultId, 4);
+    queueData(sendBuff, nullptr, 0);
+}
+
+bool Network::handleExternalMessage(const char* data, int length) {
+    _extBuffer.append(data, length);
+
+    if (_extBuffer.find(24) != std::string::npos ||
+        _extBuffer.find(27) != std::string::npos ||
+        _extBuffer.find("quit") != std::string::npos)
+    {
+        setConnectedStatus(false);
+        return false;
+    }
+
+    // separate messages by <CR><NL>
+    size_t found = _extBuffer.find("\r\n");
+    while (found != std::string::npos) {
+        std::string extMessage = _extBuffer.substr(0, found);
+        _extBuffer = _extBuffer.substr(found + 2); // jump over \r\n
+
+        if (decoderCallback) {
+            const int size = static_cast<int>(extMessage.size());
+            decoderCallback(extMessage.c_str(), size);
+        }
+
+        // reply
+        std::string msg = "OK\r\n";
+        sendData(msg.c_str(), static_cast<int>(msg.size()));
+        found = _extBuffer.find("\r\n");
+    }
+    return true;
+}
+
 void Network::communicationHandler() {
     if (_shouldTerminate) {
         return;
@@ -630,24 +1439,11 @@ void Network::communicationHandler() {
         }
     }
 
-    setConnectedStatus(true);
-    Log::Info(fmt::format("Connection {} established", _id));
+    startConnection();
 
-    if (_updateCallback) {
-        _updateCallback(this);
-    }
-
-    // init buffers
     char RecvHeader[HeaderSize];
     std::memset(RecvHeader, DefaultId, HeaderSize);
 
-    {
-        std::unique_lock lk(_connectionMutex);
-        _recvBuffer.resize(_bufferSize);
-        _uncompressBuffer.resize(_uncompressedBufferSize);
-    }
-    std::string extBuffer; // for external communication
-
     // Receive data until the server closes the connection
     int iResult = 0;
     do {
@@ -658,25 +1454,26 @@ void Network::communicationHandler() {
             ));
             updateBuffer(_recvBuffer, _requestedSize, _bufferSize);
         }
-        int32_t packageId = -1;
+        int32_t value = -1;
         uint32_t dataSize = 0;
         uint32_t uncompressedDataSize = 0;
+        uint32_t sequence = 0;
 
         _headerId = DefaultId;
 
         if (type() == ConnectionType::SyncConnection) {
-            int32_t syncFrameNumber = -1;
             iResult = readSyncMessage(
                 RecvHeader,
-                syncFrameNumber,
+                value,
                 dataSize,
-                uncompressedDataSize
+                uncompressedDataSize,
+                sequence
             );
         }
         else if (type() == ConnectionType::DataTransfer) {
             iResult = readDataTransferMessage(
                 RecvHeader,
-                packageId,
+                value,
                 dataSize,
                 uncompressedDataSize
             );
@@ -698,117 +1495,151 @@ void Network::communicationHandler() {
             );
         }
 
-        if (type() == ConnectionType::SyncConnection) {
-            // handle sync disconnect
-            if (isDisconnectPackage(RecvHeader)) {
-                setConnectedStatus(false);
-
-                // Terminate client only. The server only resets the connection,
-                // allowing clients to connect.
-                if (!_isServer) {
-                    _shouldTerminate = true;
-                }
+        const bool keepOpen = type() == ConnectionType::ExternalConnection ?
+            handleExternalMessage(_recvBuffer.data(), std::max(iResult, 0)) :
+            handleMessage(RecvHeader, value, dataSize, uncompressedDataSize, sequence);
+        if (!keepOpen) {
+            break;
+        }
+    } while (iResult > 0 || _isConnected);
 
-                Log::Info(fmt::format("Client {} terminated connection", _id));
-                break;
-            }
-            // handle sync communication
-            if (_headerId == DataId && decoderCallback) {
-                if (dataSize > 0) {
-                    decoderCallback(_recvBuffer.data(), dataSize);
-                }
+    endConnection();
+}
+
+bool Network::acceptConnection() {
+    _socket = accept(_listenSocket, nullptr, nullptr);
+    if (_socket == INVALID_SOCKET) {
+        if (!isWouldBlock(SGCT_ERRNO)) {
+            Log::Error(
+                fmt::format("Accept connection {} failed. Error: {}", _id, SGCT_ERRNO)
+            );
+        }
+        return false;
+    }
 
-                NetworkManager::cond.notify_all();
+    setNonBlocking(_socket);
+    startConnection();
+    return true;
+}
+
+bool Network::receiveAvailable() {
+    ZoneScoped
+
+    // Read until the socket is drained, as the reactor is only notified again when new
+    // data arrives
+    while (true) {
+        ReceiveState& state = _receiveState;
+
+        char* target = nullptr;
+        uint32_t length = 0;
+        if (type() == ConnectionType::ExternalConnection) {
+            target = _recvBuffer.data();
+            length = _bufferSize;
+        }
+        else if (!state.isReadingPayload) {
+            target = state.header.data() + state.nBytes;
+            length = static_cast<uint32_t>(HeaderSize) - state.nBytes;
+        }
+        else {
+            target = _recvBuffer.data() + state.nBytes;
+            length = state.dataSize - state.nBytes;
+        }
+
+        const long res = recv(_socket, target, length, 0);
+        if (res == 0) {
+            setConnectedStatus(false);
+            Log::Info(fmt::format("TCP connection {} closed", _id));
+            return false;
+        }
+        if (res < 0) {
+            const int error = SGCT_ERRNO;
+            if (isWouldBlock(error)) {
+                return true;
             }
-            else if (_headerId == ConnectedId && _connectedCallback) {
-                _connectedCallback();
-                NetworkManager::cond.notify_all();
+#ifdef WIN32
+            if (error == WSAEINTR) {
+#else // WIN32
+            if (error == EINTR) {
+#endif // WIN32
+                continue;
             }
+            setConnectedStatus(false);
+            Log::Error(
+                fmt::format("TCP connection {} receive failed: {}", _id, error)
+            );
+            return false;
         }
-        // handle external ascii communication
-        else if (type() == ConnectionType::ExternalConnection) {
-            extBuffer += std::string(_recvBuffer.data()).substr(0, iResult);
 
-            if (extBuffer.find(24) != std::string::npos ||
-                extBuffer.find(27) != std::string::npos ||
-                extBuffer.find("quit") != std::string::npos)
-            {
-                setConnectedStatus(false);
-                break;
+        if (type() == ConnectionType::ExternalConnection) {
+            if (!handleExternalMessage(target, static_cast<int>(res))) {
+                return false;
             }
+            continue;
+        }
 
-            // separate messages by <CR><NL>
-            size_t found = extBuffer.find("\r\n");
-            while (found != std::string::npos) {
-                std::string extMessage = extBuffer.substr(0, found);
-                extBuffer = extBuffer.substr(found + 2); // jump over \r\n
-
-                if (decoderCallback) {
-                    const int size = static_cast<int>(extMessage.size());
-                    decoderCallback(extMessage.c_str(), size);
-                }
+        state.nBytes += static_cast<uint32_t>(res);
+        if (state.nBytes < (state.isReadingPayload ? state.dataSize : HeaderSize)) {
+            continue;
+        }
 
-                // reply
-                std::string msg = "OK\r\n";
-                sendData(msg.c_str(), static_cast<int>(msg.size()));
-                found = extBuffer.find("\r\n");
+        if (!state.isReadingPayload) {
+            // resize buffer request
+            if (type() == ConnectionType::SyncConnection && _requestedSize > _bufferSize)
+            {
+                updateBuffer(_recvBuffer, _requestedSize, _bufferSize);
             }
-        }
-        // handle data transfer communication
-        else if (type() == ConnectionType::DataTransfer) {
-            // Disconnect if requested
-            if (isDisconnectPackage(RecvHeader)) {
-                setConnectedStatus(false);
-                Log::Info(fmt::format("File connection {} terminated", _id));
+
+            _headerId = DefaultId;
+            const char* header = state.header.data();
+            bool hasPayload = false;
+            if (type() == ConnectionType::SyncConnection) {
+                parseSyncHeader(
+                    header,
+                    state.value,
+                    state.dataSize,
+                    state.uncompressedDataSize,
+                    state.sequence
+                );
+                hasPayload = state.dataSize > 0;
             }
-            //  Handle communication
             else {
-                if (_headerId == DataId && _packageDecoderCallback && dataSize > 0) {
-                    _packageDecoderCallback(_recvBuffer.data(), dataSize, packageId, _id);
-
-                    // send acknowledge
-                    uint32_t pLength = 0;
-                    char sendBuff[HeaderSize];
-                    sendBuff[0] = Ack;
-                    std::memcpy(sendBuff + 1, &packageId, sizeof(packageId));
-                    std::memcpy(sendBuff + 5, &pLength, sizeof(pLength));
-                    sendData(sendBuff, HeaderSize);
-
-                    {
-                        // Clear the buffers
-                        std::unique_lock lk(_connectionMutex);
-
-                        _recvBuffer.clear();
-                        _uncompressBuffer.clear();
-
-                        _bufferSize = 0;
-                        _uncompressedBufferSize = 0;
-                    }
-                }
-                else if (_headerId == ConnectedId && _connectedCallback) {
-                    _connectedCallback();
-                    NetworkManager::cond.notify_all();
-                }
+                parseDataTransferHeader(
+                    header,
+                    state.value,
+                    state.dataSize,
+                    state.uncompressedDataSize
+                );
+                hasPayload = state.dataSize > 0 && state.value > -1;
             }
-        }
-    } while (iResult > 0 || _isConnected);
-
-    _recvBuffer.clear();
-    _uncompressBuffer.clear();
 
-    // Close socket; contains mutex
-    closeSocket(_socket);
+            if (hasPayload) {
+                state.isReadingPayload = true;
+                state.nBytes = 0;
+                continue;
+            }
+        }
 
-    if (_updateCallback) {
-        _updateCallback(this);
+        // The message is complete
+        const ReceiveState message = state;
+        state = ReceiveState();
+        const bool keepOpen = handleMessage(
+            message.header.data(),
+            message.value,
+            message.dataSize,
+            message.uncompressedDataSize,
+            message.sequence
+        );
+        if (!keepOpen || !_isConnected) {
+            return false;
+        }
     }
-
-    Log::Info(fmt::format("Node {} disconnected", _id));
 }
 
 void Network::sendData(const void* data, int length) {
     ZoneScoped
 
+    std::unique_lock lock(_sendDataMutex);
+
     long sendSize = length;
 
     while (sendSize > 0) {
@@ -820,25 +1651,113 @@ void Network::sendData(const void* data, int length) {
             0
         );
         if (sentLen == SOCKET_ERROR) {
+            if (isWouldBlock(SGCT_ERRNO)) {
+                waitUntilWritable(_socket);
+                continue;
+            }
             throw Err(5014, fmt::format("Send data failed: {}", SGCT_ERRNO));
         }
         sendSize -= sentLen;
     }
 }
 
+void Network::sendData(const void* header, int headerLength, const void* data,
+                       int length)
+{
+    ZoneScoped
+
+    std::unique_lock lock(_sendDataMutex);
+
+#ifdef WIN32
+    // Winsock does not return before all buffers of a blocking socket have been sent
+    WSABUF buffers[2];
+    buffers[0].buf = reinterpret_cast<char*>(const_cast<void*>(header));
+    buffers[0].len = static_cast<ULONG>(headerLength);
+    buffers[1].buf = reinterpret_cast<char*>(const_cast<void*>(data));
+    buffers[1].len = static_cast<ULONG>(length);
+    DWORD sentLen = 0;
+    const int res = WSASend(_socket, buffers, length > 0 ? 2 : 1, &sentLen, 0, 0, 0);
+    if (res == SOCKET_ERROR) {
+        throw Err(5014, fmt::format("Send data failed: {}", SGCT_ERRNO));
+    }
+#else // WIN32
+    iovec buffers[2];
+    buffers[0].iov_base = const_cast<void*>(header);
+    buffers[0].iov_len = static_cast<size_t>(headerLength);
+    buffers[1].iov_base = const_cast<void*>(data);
+    buffers[1].iov_len = static_cast<size_t>(length);
+
+    msghdr message = {};
+    message.msg_iov = buffers;
+    message.msg_iovlen = length > 0 ? 2 : 1;
+
+    while (message.msg_iovlen > 0) {
+        const ssize_t sentLen = sendmsg(_socket, &message, 0);
+        if (sentLen == SOCKET_ERROR) {
+            if (isWouldBlock(SGCT_ERRNO)) {
+                waitUntilWritable(_socket);
+                continue;
+            }
+            throw Err(5014, fmt::format("Send data failed: {}", SGCT_ERRNO));
+        }
+
+        // Skip over everything that has been sent and retry with the remainder
+        size_t remaining = static_cast<size_t>(sentLen);
+        while (message.msg_iovlen > 0 && remaining >= message.msg_iov->iov_len) {
+            remaining -= message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+        if (message.msg_iovlen > 0) {
+            message.msg_iov->iov_base =
+                reinterpret_cast<char*>(message.msg_iov->iov_base) + remaining;
+            message.msg_iov->iov_len -= remaining;
+        }
+    }
+#endif // WIN32
+}
+
 void Network::closeNetwork(bool forced) {
     ZoneScoped
 
+    // The threads of the receiver decode frames as well, so they have to be stopped
+    // before the callbacks are removed. They are joined without holding the lock as they
+    // might be waiting for it
+    std::unique_ptr<MulticastReceiver> multicastReceiver;
+    {
+        std::unique_lock lock(_multicastMutex);
+        multicastReceiver = std::move(_multicastReceiver);
+    }
+    multicastReceiver = nullptr;
+
     decoderCallback = nullptr;
+    _deltaDecoderCallback = nullptr;
     _updateCallback = nullptr;
     _connectedCallback = nullptr;
     _acknowledgeCallback = nullptr;
     _packageDecoderCallback = nullptr;
+    _nackCallback = nullptr;
 
     // release conditions
-    NetworkManager::cond.notify_all();
+    NetworkManager::frameSignal.notify();
     _startConnectionCond.notify_all();
 
+    {
+        std::unique_lock lock(_sendMutex);
+        _stopSending = true;
+    }
+    _sendCond.notify_all();
+    if (_sendThread) {
+        // The sender thread might be blocked on a dead socket, so it cannot be joined
+        if (forced) {
+            _sendThread->detach();
+        }
+        else {
+            _sendThread->join();
+        }
+    }
+    _sendThread = nullptr;
+
     // blocking sockets -> cannot wait for thread so just kill it brutally
 
     if (_commThread && !forced) {
@@ -857,8 +1776,11 @@ void Network::closeNetwork(bool forced) {
 void Network::initShutdown() {
     ZoneScoped
 
+    // Messages that are still queued have to arrive before the disconnect message
+    waitForSendQueue();
+
     if (_isConnected) {
-        constexpr const char GameOver[9] = {
+        constexpr const char GameOver[HeaderSize] = {
             DisconnectId, 24, '\r', '\n', 27, '\r', '\n', '\0', DefaultId
         };
         sendData(GameOver, HeaderSize);
@@ -16,11 +16,14 @@
 #endif
 
 #include <sgct/clustermanager.h>
+#include <sgct/datatransferqueue.h>
 #include <sgct/engine.h>
 #include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
+#include <sgct/multicast.h>
 #include <sgct/mutexes.h>
+#include <sgct/networkreactor.h>
 #include <sgct/node.h>
 #include <sgct/profiling.h>
 #include <sgct/shareddata.h>
@@ -41,9 +44,15 @@
 
 #define Error(code, msg) Error(Error::Component::Network, code, msg)
 
+namespace {
+    // The clock is synchronized more often until the first estimate has arrived
+    constexpr const double ClockSyncInterval = 1.0;
+    constexpr const double InitialClockSyncInterval = 0.1;
+} // namespace
+
 namespace sgct {
 
-std::condition_variable NetworkManager::cond;
+FrameSignal NetworkManager::frameSignal;
 
 NetworkManager* NetworkManager::_instance = nullptr;
 
@@ -56,7 +65,8 @@ void NetworkManager::create(NetworkMode nm,
                             std::function<void(bool)> externalStatus,
                             std::function<void(void*, int, int, int)> dataTransferDecode,
                             std::function<void(bool, int)> dataTransferStatus,
-                            std::function<void(int, int)> dataTransferAcknowledge)
+                            std::function<void(int, int)> dataTransferAcknowledge,
+                            std::function<void(int, int, float)> dataTransferProgress)
 {
     ZoneScoped
 
@@ -69,7 +79,8 @@ void NetworkManager::create(NetworkMode nm,
         std::move(externalStatus),
         std::move(dataTransferDecode),
         std::move(dataTransferStatus),
-        std::move(dataTransferAcknowledge)
+        std::move(dataTransferAcknowledge),
+        std::move(dataTransferProgress)
     );
 }
 
@@ -83,13 +94,17 @@ NetworkManager::NetworkManager(NetworkMode nm,
                                std::function<void(bool)> externalStatus,
                              std::function<void(void*, int, int, int)> dataTransferDecode,
                                         std::function<void(bool, int)> dataTransferStatus,
-                                    std::function<void(int, int)> dataTransferAcknowledge)
+                                    std::function<void(int, int)> dataTransferAcknowledge,
+                                std::function<void(int, int, float)> dataTransferProgress)
     : _externalDecodeFn(std::move(externalDecode))
     , _externalStatusFn(std::move(externalStatus))
     , _dataTransferDecodeFn(std::move(dataTransferDecode))
     , _dataTransferStatusFn(std::move(dataTransferStatus))
     , _dataTransferAcknowledgeFn(std::move(dataTransferAcknowledge))
     , _mode(nm)
+    , _dataTransferQueue(
+        std::make_unique<DataTransferQueue>(std::move(dataTransferProgress))
+    )
 {
     ZoneScoped
 
@@ -195,7 +210,12 @@ NetworkManager::~NetworkManager() {
     ZoneScoped
 
     _isRunning = false;
-    cond.notify_all();
+    frameSignal.notify();
+
+    // The reactor and the data transfer threads have to stop touching the sockets before
+    // they are closed
+    _reactor = nullptr;
+    _dataTransferQueue = nullptr;
 
     // signal to terminate
     for (std::unique_ptr<Network>& connection : _networkConnections) {
@@ -263,6 +283,20 @@ void NetworkManager::initialize() {
         _localAddresses.push_back(cm.thisNode().address());
     }
 
+    if (cm.useNetworkReactor()) {
+        if (NetworkReactor::isSupported()) {
+            Log::Info("Servicing all connections from a single network thread");
+            _reactor = std::make_unique<NetworkReactor>();
+        }
+        else {
+            Log::Warning("The network reactor is not supported on this platform");
+        }
+    }
+
+    if (_isServer && cm.multicastGroup() && cm.numberOfNodes() > 1) {
+        _multicastSender = std::make_unique<MulticastSender>(*cm.multicastGroup());
+    }
+
     // Add Cluster Functionality
     if (ClusterManager::instance().numberOfNodes() > 1) {
         ZoneScopedN("Create cluster connections")
@@ -292,6 +326,14 @@ void NetworkManager::initialize() {
                     SharedData::instance().decode(data, length);
                 }
             );
+            _networkConnections.back()->setDeltaDecodeFunction(
+                [](const char* data, int length) {
+                    SharedData::instance().decodeDelta(data, length);
+                }
+            );
+            if (cm.multicastGroup()) {
+                _networkConnections.back()->enableMulticast(*cm.multicastGroup());
+            }
 
             // add data transfer connection
             if (cm.thisNode().dataTransferPort() > 0 && !remoteAddress.empty()) {
@@ -330,6 +372,13 @@ void NetworkManager::initialize() {
                         Log::Info(fmt::format("[client]: {} [end]", d.data()));
                     }
                 );
+                if (_multicastSender) {
+                    _networkConnections.back()->setNackFunction(
+                        [this](Network* c, uint32_t seq, const char* nack, int length) {
+                            sendRepair(c, seq, nack, length);
+                        }
+                    );
+                }
 
                 // add data transfer connection
                 if (n.dataTransferPort() != 0 && !remoteAddress.empty()) {
@@ -387,9 +436,33 @@ std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) {
         return std::nullopt;
     }
     if (sm == SyncMode::SendDataToClients) {
+        if (_multicastSender && syncMulticast()) {
+            double maxTime = -std::numeric_limits<double>::max();
+            double minTime = std::numeric_limits<double>::max();
+            for (Network* connection : _syncConnections) {
+                if (connection->isServer() && connection->isConnected()) {
+                    maxTime = std::max(connection->loopTime(), maxTime);
+                    minTime = std::min(connection->loopTime(), minTime);
+                }
+            }
+            return std::make_pair(minTime, maxTime);
+        }
+
         double maxTime = -std::numeric_limits<double>::max();
         double minTime = std::numeric_limits<double>::max();
 
+        // A full data block is sent periodically even if deltas are available so that
+        // a client that missed a frame does not stay out of sync indefinitely
+        const int interval = ClusterManager::instance().deltaSyncKeyframeInterval();
+        const bool isKeyframe = _nFramesSinceKeyframe >= interval - 1;
+        const bool hasDelta = !isKeyframe && SharedData::instance().deltaSize() > 0;
+        _nFramesSinceKeyframe = isKeyframe ? 0 : _nFramesSinceKeyframe + 1;
+
+        // Each block is compressed at most once per codec and then shared between all of
+        // the connections that use the same codec
+        std::array<std::optional<bool>, 3> isDataCompressed;
+        std::array<std::optional<bool>, 3> isDeltaCompressed;
+
         bool hasFoundConnection = false;
         for (Network* connection : _syncConnections) {
             if (!connection->isServer() || !connection->isConnected()) {
@@ -402,20 +475,48 @@ std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) {
             maxTime = std::max(currentTime, maxTime);
             minTime = std::min(currentTime, minTime);
 
-            const int currentSize =
-                SharedData::instance().dataSize() - static_cast<int>(Network::HeaderSize);
+            const bool sendDelta = !connection->takeKeyframeRequest() && hasDelta;
+            const void* payload = sendDelta ?
+                SharedData::instance().deltaBlock() :
+                SharedData::instance().dataBlock();
+            int payloadSize = sendDelta ?
+                SharedData::instance().deltaSize() :
+                SharedData::instance().dataSize();
+            int uncompressedSize = 0;
+
+            if (connection->compression() != Network::Compression::None) {
+                const size_t codec = static_cast<size_t>(connection->compression());
+                std::optional<bool>& isCompressed = sendDelta ?
+                    isDeltaCompressed[codec] :
+                    isDataCompressed[codec];
+                std::vector<char>& buffer = sendDelta ?
+                    _compressedDeltaBlocks[codec] :
+                    _compressedDataBlocks[codec];
+
+                if (!isCompressed.has_value()) {
+                    isCompressed =
+                        connection->compressPayload(payload, payloadSize, buffer);
+                }
+                if (*isCompressed) {
+                    uncompressedSize = payloadSize;
+                    payload = buffer.data();
+                    payloadSize = static_cast<int>(buffer.size());
+                }
+            }
 
             // iterate counter
             const int currentFrame = connection->iterateFrameCounter();
 
-            unsigned char* dataBlock = SharedData::instance().dataBlock();
-            std::memcpy(dataBlock + 1, &currentFrame, sizeof(currentFrame));
-            std::memcpy(dataBlock + 5, &currentSize, sizeof(currentSize));
-
-            connection->sendData(
-                SharedData::instance().dataBlock(),
-                SharedData::instance().dataSize()
+            // The header is the only part that differs between the connections, so it is
+            // sent from its own buffer instead of being patched into the shared payload.
+            // The payload itself stays untouched until waitForPendingSends is called
+            const std::array<char, Network::HeaderSize> header = Network::createHeader(
+                sendDelta ? Network::DeltaDataId : Network::DataId,
+                currentFrame,
+                payloadSize,
+                uncompressedSize
             );
+            connection->queueData(header, payload, payloadSize);
         }
 
         if (hasFoundConnection) {
@@ -423,8 +524,28 @@ std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) {
         }
     }
     else if (sm == SyncMode::Acknowledge) {
+        const double now = Engine::getTime();
+        const bool hasClockEstimate = std::all_of(
+            _syncConnections.begin(),
+            _syncConnections.end(),
+            [](Network* c) { return c->isServer() || c->clockSync().hasEstimate(); }
+        );
+        const double interval =
+            hasClockEstimate ? ClockSyncInterval : InitialClockSyncInterval;
+        const bool shouldSyncClock = now - _lastClockSyncTime >= interval;
+        if (shouldSyncClock) {
+            _lastClockSyncTime = now;
+        }
+
         for (Network* connection : _syncConnections) {
             if (!connection->isServer() && connection->isConnected()) {
+                if (shouldSyncClock) {
+                    connection->requestClockSync();
+                }
+
+                // With pipelined sync the data for this frame has been buffered so far
+                connection->applySyncFrame();
+
                 // The servers's render function is locked until a message starting with
                 // the ack-byte is received.
                 connection->pushClientMessage();
@@ -434,6 +555,154 @@ std::optional<std::pair<double, double>> NetworkManager::sync(SyncMode sm) {
     return std::nullopt;
 }
 
+bool NetworkManager::syncMulticast() {
+    ZoneScoped
+
+    std::vector<Network*> connections;
+    bool needsKeyframe = false;
+    for (Network* connection : _syncConnections) {
+        if (connection->isServer() && connection->isConnected()) {
+            connections.push_back(connection);
+            needsKeyframe |= connection->needsKeyframe();
+        }
+    }
+    if (connections.empty()) {
+        return false;
+    }
+
+    // All clients receive the same datagrams, so a delta can only be sent if every
+    // client has the previous data block
+    const int interval = ClusterManager::instance().deltaSyncKeyframeInterval();
+    const bool isKeyframe = needsKeyframe || _nFramesSinceKeyframe >= interval - 1;
+    const bool sendDelta = !isKeyframe && SharedData::instance().deltaSize() > 0;
+    const int payloadSize = sendDelta ?
+        SharedData::instance().deltaSize() :
+        SharedData::instance().dataSize();
+    if (!MulticastSender::canSend(payloadSize)) {
+        return false;
+    }
+    _nFramesSinceKeyframe = isKeyframe ? 0 : _nFramesSinceKeyframe + 1;
+
+    // The payload is not compressed as the multicast traffic does not grow with the
+    // number of clients
+    const void* payload = sendDelta ?
+        SharedData::instance().deltaBlock() :
+        SharedData::instance().dataBlock();
+    const uint32_t sequence = _multicastSender->send(
+        sendDelta ? Network::DeltaDataId : Network::DataId,
+        payload,
+        payloadSize
+    );
+
+    // Every client still gets its own token through TCP so that the frame lock works the
+    // same way as without multicast
+    for (Network* connection : connections) {
+        const int currentFrame = connection->iterateFrameCounter();
+        const std::array<char, Network::HeaderSize> header = Network::createHeader(
+            Network::MulticastFrameId,
+            currentFrame,
+            0,
+            static_cast<int>(sequence)
+        );
+        connection->queueData(header, nullptr, 0);
+
+        // A connection that was re-established since the check above missed the full
+        // data block and keeps its request for the next frame
+        if (connection->takeKeyframeRequest() && sendDelta) {
+            connection->setNeedsKeyframe(true);
+        }
+    }
+    return true;
+}
+
+void NetworkManager::sendRepair(Network* connection, uint32_t sequence, const char* nack,
+                                int nackLength)
+{
+    ZoneScoped
+
+    std::vector<char> repair;
+    if (!_multicastSender->createRepair(sequence, nack, nackLength, repair)) {
+        // An empty repair tells the client to skip the frame. The next frame then has to
+        // contain the full data block again
+        Log::Warning(fmt::format(
+            "Multicast frame {} requested by connection {} is no longer available",
+            sequence, connection->id()
+        ));
+        repair.clear();
+        connection->setNeedsKeyframe(true);
+    }
+
+    const std::array<char, Network::HeaderSize> header = Network::createHeader(
+        Network::RepairId,
+        static_cast<int32_t>(sequence),
+        static_cast<int>(repair.size()),
+        0
+    );
+    connection->queueData(header, std::move(repair));
+}
+
+void NetworkManager::waitForPendingSends() {
+    ZoneScoped
+
+    for (Network* connection : _syncConnections) {
+        if (connection->isServer()) {
+            connection->waitForSendQueue();
+        }
+    }
+}
+
+double NetworkManager::clockOffset() const {
+    for (Network* connection : _syncConnections) {
+        if (!connection->isServer()) {
+            return connection->clockSync().offset();
+        }
+    }
+    return 0.0;
+}
+
+double NetworkManager::clockRoundTripTime() const {
+    for (Network* connection : _syncConnections) {
+        if (!connection->isServer()) {
+            return connection->clockSync().roundTripTime();
+        }
+    }
+    return 0.0;
+}
+
+void NetworkManager::sendFrameTimestamps(const FrameTimestamps& timestamps) {
+    for (Network* connection : _syncConnections) {
+        if (!connection->isServer() && connection->isConnected()) {
+            connection->sendFrameTimestamps(timestamps);
+        }
+    }
+}
+
+std::vector<std::vector<FrameTimestamps>> NetworkManager::takeClientFrameTimestamps() {
+    std::vector<std::vector<FrameTimestamps>> res;
+    res.reserve(_syncConnections.size());
+    for (Network* connection : _syncConnections) {
+        if (connection->isServer()) {
+            res.push_back(connection->takeRemoteFrameTimestamps());
+        }
+    }
+    return res;
+}
+
+double NetworkManager::syncSendTime() const {
+    double res = 0.0;
+    for (Network* connection : _syncConnections) {
+        if (!connection->isServer() || !connection->isConnected()) {
+            continue;
+        }
+        const double t = connection->syncSendTime();
+        if (t == 0.0) {
+            return 0.0;
+        }
+        res = std::max(res, t);
+    }
+    return res;
+}
+
 bool NetworkManager::isSyncComplete() const {
     const unsigned int counter = static_cast<unsigned int>(std::count_if(
         _syncConnections.cbegin(),
@@ -448,47 +717,82 @@ Network* NetworkManager::externalControlConnection() {
 }
 
 void NetworkManager::transferData(const void* data, int length, int packageId) {
-    std::vector<char> buffer;
-    prepareTransferData(data, buffer, length, packageId);
+    ZoneScoped
+
+    // Only compress the package once per codec, no matter how many nodes receive it
+    std::array<std::optional<bool>, 3> isCompressed;
+    std::array<std::vector<char>, 3> compressed;
     for (Network* connection : _dataTransferConnections) {
-        if (connection->isConnected()) {
-            connection->sendData(buffer.data(), length);
+        if (!connection->isConnected()) {
+            continue;
         }
+
+        if (connection->compression() != Network::Compression::None) {
+            const size_t codec = static_cast<size_t>(connection->compression());
+            if (!isCompressed[codec].has_value()) {
+                isCompressed[codec] =
+                    connection->compressPayload(data, length, compressed[codec]);
+            }
+            if (*isCompressed[codec]) {
+                const int size = static_cast<int>(compressed[codec].size());
+                const std::array<char, Network::HeaderSize> header =
+                    Network::createHeader(Network::DataId, packageId, size, length);
+                connection->sendData(
+                    header.data(),
+                    Network::HeaderSize,
+                    compressed[codec].data(),
+                    size
+                );
+                continue;
+            }
+        }
+
+        const std::array<char, Network::HeaderSize> header =
+            Network::createHeader(Network::DataId, packageId, length, 0);
+        connection->sendData(header.data(), Network::HeaderSize, data, length);
     }
 }
 
 void NetworkManager::transferData(const void* data, int length, int packageId,
                                   Network& connection)
 {
-    if (connection.isConnected()) {
-        std::vector<char> buffer;
-        prepareTransferData(data, buffer, length, packageId);
-        connection.sendData(buffer.data(), length);
+    ZoneScoped
+
+    if (!connection.isConnected()) {
+        return;
+    }
+
+    std::vector<char> compressed;
+    if (connection.compressPayload(data, length, compressed)) {
+        const int size = static_cast<int>(compressed.size());
+        const std::array<char, Network::HeaderSize> header =
+            Network::createHeader(Network::DataId, packageId, size, length);
+        connection.sendData(header.data(), Network::HeaderSize, compressed.data(), size);
+    }
+    else {
+        const std::array<char, Network::HeaderSize> header =
+            Network::createHeader(Network::DataId, packageId, length, 0);
+        connection.sendData(header.data(), Network::HeaderSize, data, length);
     }
 }
 
-void NetworkManager::prepareTransferData(const void* data, std::vector<char>& buffer,
-                                         int& length, int packageId)
+void NetworkManager::transferDataAsync(std::shared_ptr<const std::vector<char>> data,
+                                       int packageId)
 {
-    int messageLength = length;
-
-    length += static_cast<int>(Network::HeaderSize);
-    buffer.resize(length);
-
-    buffer[0] = Network::DataId;
-    std::memcpy(buffer.data() + 1, &packageId, sizeof(packageId));
+    ZoneScoped
 
-    // set uncompressed size to DefaultId since compression is not used
-    std::memset(buffer.data() + 9, Network::DefaultId, sizeof(int));
+    _dataTransferQueue->push(std::move(data), packageId, _dataTransferConnections);
+}
 
-    // add data to buffer
-    std::memcpy(
-        buffer.data() + Network::HeaderSize,
-        data,
-        length - Network::HeaderSize
+void NetworkManager::transferDataAsync(std::vector<char> data, int packageId) {
+    transferDataAsync(
+        std::make_shared<const std::vector<char>>(std::move(data)),
+        packageId
     );
+}
 
-    std::memcpy(buffer.data() + 5, &messageLength, sizeof(messageLength));
+int NetworkManager::nPendingDataTransfers() const {
+    return _dataTransferQueue->nPendingTransfers();
 }
 
 unsigned int NetworkManager::activeConnectionsCount() const {
@@ -579,7 +883,8 @@ void NetworkManager::updateConnectionStatus(Network* connection) {
                 std::array<char, Network::HeaderSize> data;
                 std::fill(data.begin(), data.end(), Network::DefaultId);
                 data[0] = Network::ConnectedId;
-                syncConnection->sendData(&data, Network::HeaderSize);
+                // Goes through the sender thread so it cannot overtake queued frames
+                syncConnection->queueData(data, nullptr, 0);
             }
             for (Network* dataConnection : _dataTransferConnections) {
                 if (dataConnection->isConnected()) {
@@ -615,7 +920,7 @@ void NetworkManager::updateConnectionStatus(Network* connection) {
     }
 
     // signal done to caller
-    cond.notify_all();
+    frameSignal.notify();
 }
 
 void NetworkManager::setAllNodesConnected() {
@@ -650,11 +955,20 @@ void NetworkManager::addConnection(int port, std::string address,
     Log::Debug(fmt::format(
         "Initiating connection {} at port {}", _networkConnections.size(), port
     ));
+    if (connectionType != Network::ConnectionType::ExternalConnection) {
+        const ClusterManager& cm = ClusterManager::instance();
+        net->setCompression(cm.compression(), cm.compressionThreshold());
+    }
+    if (connectionType == Network::ConnectionType::SyncConnection) {
+        // Pipelining allows the next frame to be sent before the current one is acked
+        const ClusterManager& cm = ClusterManager::instance();
+        net->setMaxFramesInFlight(cm.pipelinedSync() ? 2 : 1);
+    }
     net->setUpdateFunction([this](Network* c) { updateConnectionStatus(c); });
     net->setConnectedFunction([this]() { setAllNodesConnected(); });
 
     // must be initialized after binding
-    net->initialize();
+    net->initialize(_reactor.get());
     _networkConnections.push_back(std::move(net));
 
     // Update the previously existing shortcuts (maybe remove them altogether?)
@@ -0,0 +1,204 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/networkreactor.h>
+
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/network.h>
+#include <sgct/profiling.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <errno.h>
+#include <unistd.h>
+#include <array>
+#include <cstring>
+#endif // __linux__
+
+#define Err(code, msg) Error(Error::Component::Network, code, msg)
+
+namespace sgct {
+
+#ifdef __linux__
+
+bool NetworkReactor::isSupported() {
+    return true;
+}
+
+NetworkReactor::NetworkReactor() {
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll == -1) {
+        throw Err(
+            5035,
+            fmt::format("Failed to create network reactor: {}", std::strerror(errno))
+        );
+    }
+
+    // The eventfd is only used to wake up the reactor thread when shutting down
+    _wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_wakeup == -1) {
+        close(_epoll);
+        throw Err(
+            5035,
+            fmt::format("Failed to create network reactor: {}", std::strerror(errno))
+        );
+    }
+    watch(_wakeup, nullptr, EPOLLIN);
+
+    _thread = std::thread([this]() { run(); });
+}
+
+NetworkReactor::~NetworkReactor() {
+    _shouldTerminate = true;
+    const uint64_t value = 1;
+    [[maybe_unused]] const ssize_t res = write(_wakeup, &value, sizeof(value));
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+
+    close(_wakeup);
+    close(_epoll);
+}
+
+void NetworkReactor::add(Network& connection) {
+    ZoneScoped
+
+    if (connection.isServer()) {
+        Log::Info(fmt::format(
+            "Waiting for client {} to connect on port {}",
+            connection.id(), connection.port()
+        ));
+        watch(connection._listenSocket, &connection, EPOLLIN);
+    }
+    else {
+        // A connected socket is writable right away, so the connection is started on the
+        // reactor thread just like all other connection state changes
+        watch(connection._socket, &connection, EPOLLIN | EPOLLOUT);
+    }
+}
+
+void NetworkReactor::run() {
+    std::array<epoll_event, 64> events;
+    while (!_shouldTerminate) {
+        const int n = epoll_wait(_epoll, events.data(), events.size(), -1);
+        if (n == -1) {
+            if (errno != EINTR) {
+                Log::Error(fmt::format(
+                    "Network reactor failed to wait for events: {}", std::strerror(errno)
+                ));
+                return;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < n && !_shouldTerminate; i++) {
+            Network* connection = reinterpret_cast<Network*>(events[i].data.ptr);
+            if (!connection) {
+                continue;
+            }
+
+            try {
+                service(*connection);
+            }
+            catch (const std::runtime_error& e) {
+                Log::Error(e.what());
+            }
+        }
+    }
+}
+
+void NetworkReactor::service(Network& connection) {
+    ZoneScoped
+
+    if (!connection.isConnected()) {
+        if (connection.isServer()) {
+            if (connection.acceptConnection()) {
+                unwatch(connection._listenSocket);
+                watch(connection._socket, &connection, EPOLLIN);
+            }
+        }
+        else if (!connection._shouldTerminate) {
+            connection.startConnection();
+            unwatch(connection._socket);
+            watch(connection._socket, &connection, EPOLLIN);
+        }
+        return;
+    }
+
+    bool isOpen = false;
+    try {
+        isOpen = connection.receiveAvailable();
+    }
+    catch (const std::runtime_error& e) {
+        Log::Error(e.what());
+    }
+    if (isOpen) {
+        return;
+    }
+
+    // The socket has to be removed before it is closed, as the descriptor might be
+    // reused right away
+    unwatch(connection._socket);
+    connection.endConnection();
+    if (connection.isServer() && !connection._shouldTerminate) {
+        // Allow the client to reconnect
+        Log::Info(fmt::format(
+            "Waiting for client {} to connect on port {}",
+            connection.id(), connection.port()
+        ));
+        watch(connection._listenSocket, &connection, EPOLLIN);
+    }
+}
+
+void NetworkReactor::watch(int socket, Network* connection, unsigned int events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.ptr = connection;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) == -1) {
+        throw Err(
+            5036,
+            fmt::format(
+                "Failed to add connection {} to the network reactor: {}",
+                connection ? connection->id() : -1, std::strerror(errno)
+            )
+        );
+    }
+}
+
+void NetworkReactor::unwatch(int socket) {
+    epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+#else // __linux__
+
+bool NetworkReactor::isSupported() {
+    return false;
+}
+
+NetworkReactor::NetworkReactor() {
+    throw Err(5035, "Failed to create network reactor: Only supported on Linux");
+}
+
+NetworkReactor::~NetworkReactor() {}
+
+void NetworkReactor::add(Network&) {}
+
+void NetworkReactor::run() {}
+
+void NetworkReactor::service(Network&) {}
+
+void NetworkReactor::watch(int, Network*, unsigned int) {}
+
+void NetworkReactor::unwatch(int) {}
+
+#endif // __linux__
+
+} // namespace sgct
@@ -64,6 +64,8 @@ void NonLinearProjection::initialize(unsigned int internalFormat, unsigned int f
     initShaders();
 }
 
+void NonLinearProjection::prepareMeshes() {}
+
 void NonLinearProjection::updateFrustums(Frustum::Mode mode, float nearClip,
                                          float farClip)
 {
@@ -83,6 +83,13 @@ SphericalMirrorProjection::~SphericalMirrorProjection() {
 
 void SphericalMirrorProjection::update(vec2) {}
 
+void SphericalMirrorProjection::prepareMeshes() {
+    _meshBottom.prepareMesh(_meshPathBottom, _subViewports.bottom);
+    _meshLeft.prepareMesh(_meshPathLeft, _subViewports.left);
+    _meshRight.prepareMesh(_meshPathRight, _subViewports.right);
+    _meshTop.prepareMesh(_meshPathTop, _subViewports.top);
+}
+
 void SphericalMirrorProjection::render(const Window& window, const BaseViewport& viewport,
                                        Frustum::Mode frustumMode)
 {
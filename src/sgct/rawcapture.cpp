@@ -0,0 +1,444 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/rawcapture.h>
+
+#include <sgct/error.h>
+#include <sgct/fmt.h>
+#include <sgct/log.h>
+#include <sgct/profiling.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <Windows.h>
+#else // WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // WIN32
+
+#define Err(code, msg) Error(Error::Component::RawCapture, code, msg)
+
+namespace {
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    std::string lastError() {
+#ifdef WIN32
+        return std::to_string(GetLastError());
+#else // WIN32
+        return std::strerror(errno);
+#endif // WIN32
+    }
+
+    uint64_t mappingGranularity() {
+#ifdef WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else // WIN32
+        return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif // WIN32
+    }
+} // namespace
+
+namespace sgct {
+
+namespace rawcapture {
+
+/// A view of a part of a file that is unmapped when the object is destroyed
+struct MappedRegion {
+    MappedRegion(void* regionBase, size_t regionLength, unsigned char* regionData)
+        : base(regionBase), length(regionLength), data(regionData)
+    {}
+
+    ~MappedRegion() {
+#ifdef WIN32
+        UnmapViewOfFile(base);
+#else // WIN32
+        munmap(base, length);
+#endif // WIN32
+    }
+
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    void* const base;
+    const size_t length;
+    unsigned char* const data;
+};
+
+/// The platform-specific file handling that is needed to grow and map a file
+class MappedFile {
+public:
+    MappedFile(std::string path, bool isWritable)
+        : _path(std::move(path))
+        , _isWritable(isWritable)
+    {
+#ifdef WIN32
+        _handle = CreateFileA(
+            _path.c_str(),
+            isWritable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            isWritable ? CREATE_ALWAYS : OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+        );
+        if (_handle == INVALID_HANDLE_VALUE) {
+            throw Err(
+                9100,
+                fmt::format(
+                    "Could not open raw capture file '{}': {}", _path, lastError()
+                )
+            );
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(_handle, &size);
+        _size = static_cast<uint64_t>(size.QuadPart);
+#else // WIN32
+        _handle = isWritable ?
+            open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) :
+            open(_path.c_str(), O_RDONLY);
+        if (_handle == -1) {
+            throw Err(
+                9100,
+                fmt::format(
+                    "Could not open raw capture file '{}': {}", _path, lastError()
+                )
+            );
+        }
+        struct stat info;
+        fstat(_handle, &info);
+        _size = static_cast<uint64_t>(info.st_size);
+#endif // WIN32
+    }
+
+    ~MappedFile() {
+#ifdef WIN32
+        CloseHandle(_handle);
+#else // WIN32
+        close(_handle);
+#endif // WIN32
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Grows or shrinks the file. Growing allocates the space on disk where possible, so
+    /// that running out of disk space fails here rather than when writing to a mapping
+    void resize(uint64_t size) {
+#ifdef WIN32
+        LARGE_INTEGER s;
+        s.QuadPart = static_cast<LONGLONG>(size);
+        const bool success = SetFilePointerEx(_handle, s, nullptr, FILE_BEGIN) &&
+                             SetEndOfFile(_handle);
+#else // WIN32
+        bool success = ftruncate(_handle, static_cast<off_t>(size)) == 0;
+#ifdef __linux__
+        if (success && size > _size) {
+            const off_t begin = static_cast<off_t>(_size);
+            const off_t length = static_cast<off_t>(size - _size);
+            success = posix_fallocate(_handle, begin, length) == 0;
+        }
+#endif // __linux__
+#endif // WIN32
+        if (!success) {
+            throw Err(
+                9101,
+                fmt::format(
+                    "Could not resize raw capture file '{}' to {} bytes: {}",
+                    _path, size, lastError()
+                )
+            );
+        }
+        _size = size;
+    }
+
+    std::unique_ptr<MappedRegion> map(uint64_t offset, uint64_t length) {
+        // The offset of a mapping has to be a multiple of the granularity, so we map from
+        // the previous multiple and hide the additional bytes in front
+        static const uint64_t Granularity = mappingGranularity();
+        const uint64_t begin = offset / Granularity * Granularity;
+        const size_t size = static_cast<size_t>(offset - begin + length);
+
+#ifdef WIN32
+        HANDLE mapping = CreateFileMappingA(
+            _handle,
+            nullptr,
+            _isWritable ? PAGE_READWRITE : PAGE_READONLY,
+            0,
+            0,
+            nullptr
+        );
+        void* base = nullptr;
+        if (mapping) {
+            base = MapViewOfFile(
+                mapping,
+                _isWritable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                static_cast<DWORD>(begin >> 32),
+                static_cast<DWORD>(begin & 0xFFFFFFFF),
+                size
+            );
+            // The view keeps the mapping object alive
+            CloseHandle(mapping);
+        }
+        const bool success = base != nullptr;
+#else // WIN32
+        void* base = mmap(
+            nullptr,
+            size,
+            _isWritable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+            MAP_SHARED,
+            _handle,
+            static_cast<off_t>(begin)
+        );
+        const bool success = base != MAP_FAILED;
+#endif // WIN32
+        if (!success) {
+            throw Err(
+                9102,
+                fmt::format("Could not map raw capture file '{}': {}", _path, lastError())
+            );
+        }
+
+        unsigned char* data = reinterpret_cast<unsigned char*>(base) + (offset - begin);
+        return std::make_unique<MappedRegion>(base, size, data);
+    }
+
+    uint64_t size() const {
+        return _size;
+    }
+
+private:
+    const std::string _path;
+    const bool _isWritable;
+    uint64_t _size = 0;
+#ifdef WIN32
+    HANDLE _handle = INVALID_HANDLE_VALUE;
+#else // WIN32
+    int _handle = -1;
+#endif // WIN32
+};
+
+} // namespace rawcapture
+
+struct RawCaptureWriter::Segment {
+    std::unique_ptr<rawcapture::MappedRegion> region;
+    uint64_t nWritten = 0;
+};
+
+RawCaptureWriter::RawCaptureWriter(std::string path, ivec2 size, int nChannels,
+                                   int bytesPerChannel, bool isFloatingPoint,
+                                   uint64_t segmentSize)
+    : _path(std::move(path))
+{
+    ZoneScoped
+
+    _frameSize = static_cast<uint64_t>(size.x) * size.y * nChannels * bytesPerChannel;
+
+    _header.width = size.x;
+    _header.height = size.y;
+    _header.nChannels = nChannels;
+    _header.bytesPerChannel = bytesPerChannel;
+    _header.isFloatingPoint = isFloatingPoint ? 1 : 0;
+    _header.frameStride = alignUp(
+        _frameSize + sizeof(rawcapture::FrameFooter),
+        rawcapture::FrameAlignment
+    );
+    _framesPerSegment = std::max<uint64_t>(segmentSize / _header.frameStride, 1);
+
+    _file = std::make_unique<rawcapture::MappedFile>(_path, true);
+    _file->resize(rawcapture::HeaderSize);
+    _headerRegion = _file->map(0, rawcapture::HeaderSize);
+    std::memcpy(_headerRegion->data, &_header, sizeof(rawcapture::FileHeader));
+
+    Log::Debug(fmt::format(
+        "Writing {}x{}x{} frames to raw capture file '{}'",
+        size.x, size.y, nChannels, _path
+    ));
+}
+
+RawCaptureWriter::~RawCaptureWriter() {
+    // All mappings have to be gone before the preallocated space can be cut off
+    if (_nextSegment.valid()) {
+        try {
+            _nextSegment.get();
+        }
+        catch (const Error& e) {
+            Log::Error(e.what());
+        }
+    }
+    _segments.clear();
+    _header.nFrames = _nFrames;
+    std::memcpy(_headerRegion->data, &_header, sizeof(rawcapture::FileHeader));
+    _headerRegion = nullptr;
+
+    try {
+        _file->resize(rawcapture::HeaderSize + _nFrames * _header.frameStride);
+    }
+    catch (const Error& e) {
+        Log::Error(e.what());
+    }
+    Log::Debug(fmt::format("Wrote {} frames to raw capture file '{}'", _nFrames, _path));
+}
+
+uint64_t RawCaptureWriter::reserveFrame() {
+    std::unique_lock lock(_mutex);
+
+    const uint64_t index = _nFrames;
+    const uint64_t segment = index / _framesPerSegment;
+    if (segment == _segments.size()) {
+        // Usually the segment has been created in the background already
+        _segments.push_back(
+            _nextSegment.valid() ? _nextSegment.get() : createSegment(segment)
+        );
+
+        // The previous segment stays mapped until its last frame has been written
+        if (segment > 0 && _segments[segment - 1] &&
+            _segments[segment - 1]->nWritten == _framesPerSegment)
+        {
+            _segments[segment - 1] = nullptr;
+        }
+    }
+
+    if (index % _framesPerSegment == _framesPerSegment / 2 && !_nextSegment.valid()) {
+        _nextSegment = std::async(
+            std::launch::async,
+            [this, next = segment + 1]() { return createSegment(next); }
+        );
+    }
+
+    _nFrames++;
+    return index;
+}
+
+std::shared_ptr<RawCaptureWriter::Segment>
+RawCaptureWriter::createSegment(uint64_t segment) {
+    ZoneScopedN("Grow raw capture file")
+
+    // Only one segment is created at a time and the rest of the writer does not touch
+    // the file, so this does not need to hold the mutex
+    const uint64_t segmentSize = _framesPerSegment * _header.frameStride;
+    const uint64_t offset = rawcapture::HeaderSize + segment * segmentSize;
+    _file->resize(offset + segmentSize);
+
+    auto s = std::make_shared<Segment>();
+    s->region = _file->map(offset, segmentSize);
+    return s;
+}
+
+void RawCaptureWriter::writeFrame(uint64_t index, uint64_t frameNumber,
+                                  const unsigned char* data)
+{
+    ZoneScoped
+
+    const uint64_t segment = index / _framesPerSegment;
+    std::shared_ptr<Segment> s;
+    {
+        std::unique_lock lock(_mutex);
+        s = _segments[segment];
+    }
+
+    unsigned char* dst =
+        s->region->data + (index % _framesPerSegment) * _header.frameStride;
+    std::memcpy(dst, data, _frameSize);
+
+    rawcapture::FrameFooter footer;
+    footer.frameNumber = frameNumber;
+    footer.magic = rawcapture::FrameMagic;
+    std::memcpy(dst + _frameSize, &footer, sizeof(rawcapture::FrameFooter));
+
+    std::unique_lock lock(_mutex);
+    s->nWritten++;
+    // Completed segments are unmapped, unless they are still used for new frames
+    if (s->nWritten == _framesPerSegment && segment + 1 < _segments.size()) {
+        _segments[segment] = nullptr;
+    }
+}
+
+uint64_t RawCaptureWriter::frameSize() const {
+    return _frameSize;
+}
+
+const std::string& RawCaptureWriter::path() const {
+    return _path;
+}
+
+RawCaptureReader::RawCaptureReader(const std::string& path) {
+    ZoneScoped
+
+    _file = std::make_unique<rawcapture::MappedFile>(path, false);
+    if (_file->size() < rawcapture::HeaderSize) {
+        throw Err(9103, fmt::format("File '{}' is not a raw capture file", path));
+    }
+    _region = _file->map(0, _file->size());
+
+    std::memcpy(&_header, _region->data, sizeof(rawcapture::FileHeader));
+    if (_header.magic != rawcapture::Magic || _header.frameStride == 0) {
+        throw Err(9103, fmt::format("File '{}' is not a raw capture file", path));
+    }
+    if (_header.version != rawcapture::Version) {
+        throw Err(
+            9104,
+            fmt::format(
+                "Unsupported raw capture version {} in '{}'", _header.version, path
+            )
+        );
+    }
+
+    _frameSize = static_cast<uint64_t>(_header.width) * _header.height *
+        _header.nChannels * _header.bytesPerChannel;
+
+    // If the application was terminated before the file was closed, the number of
+    // frames in the header is outdated, but the frames that made it to disk are usable
+    const uint64_t nSlots =
+        (_file->size() - _header.headerSize) / _header.frameStride;
+    _nFrames = _header.nFrames > 0 ? std::min(_header.nFrames, nSlots) : nSlots;
+}
+
+RawCaptureReader::~RawCaptureReader() = default;
+
+const rawcapture::FileHeader& RawCaptureReader::header() const {
+    return _header;
+}
+
+uint64_t RawCaptureReader::numberOfFrames() const {
+    return _nFrames;
+}
+
+const unsigned char* RawCaptureReader::frame(uint64_t index) const {
+    if (index >= _nFrames) {
+        return nullptr;
+    }
+
+    const unsigned char* data =
+        _region->data + _header.headerSize + index * _header.frameStride;
+    rawcapture::FrameFooter footer;
+    std::memcpy(&footer, data + _frameSize, sizeof(rawcapture::FrameFooter));
+    return footer.magic == rawcapture::FrameMagic ? data : nullptr;
+}
+
+uint64_t RawCaptureReader::frameNumber(uint64_t index) const {
+    const unsigned char* data = frame(index);
+    if (!data) {
+        return 0;
+    }
+    rawcapture::FrameFooter footer;
+    std::memcpy(&footer, data + _frameSize, sizeof(rawcapture::FrameFooter));
+    return footer.frameNumber;
+}
+
+} // namespace sgct
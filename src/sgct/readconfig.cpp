@@ -125,9 +125,29 @@ namespace {
         if (format == "png" || format == "PNG") { return Capture::Format::PNG; }
         if (format == "tga" || format == "TGA") { return Capture::Format::TGA; }
         if (format == "jpg" || format == "JPG") { return Capture::Format::JPG; }
+        if (format == "exr" || format == "EXR") { return Capture::Format::EXR; }
+        if (format == "raw" || format == "RAW") { return Capture::Format::RAW; }
         throw Err(6060, "Unknown capturing format");
     }
 
+    sgct::config::Capture::QueuePolicy parseQueuePolicy(std::string_view policy) {
+        using namespace sgct::config;
+
+        if (policy == "block") { return Capture::QueuePolicy::Block; }
+        if (policy == "dropoldest") { return Capture::QueuePolicy::DropOldest; }
+        if (policy == "dropnewest") { return Capture::QueuePolicy::DropNewest; }
+        throw Err(6093, fmt::format("Unknown capture queue policy {}", policy));
+    }
+
+    sgct::config::Cluster::Compression parseCompression(std::string_view compression) {
+        using namespace sgct::config;
+
+        if (compression == "none") { return Cluster::Compression::None; }
+        if (compression == "fast") { return Cluster::Compression::Fast; }
+        if (compression == "high") { return Cluster::Compression::High; }
+        throw Err(6089, fmt::format("Unknown compression {}", compression));
+    }
+
     sgct::config::Viewport::Eye parseEye(std::string_view eye) {
         if (eye == "center") { return sgct::config::Viewport::Eye::Mono; }
         if (eye == "left")   { return sgct::config::Viewport::Eye::StereoLeft; }
@@ -705,6 +725,9 @@ sgct::config::Window parseWindow(tinyxml2::XMLElement& elem, int count) {
     if (const char* a = elem.Attribute("mpcdi"); a) {
         window.mpcdi = std::filesystem::absolute(a).string();
     }
+    if (const char* a = elem.Attribute("mpcdiBuffer"); a) {
+        window.mpcdiBuffer = a;
+    }
 
     if (tinyxml2::XMLElement* e = elem.FirstChildElement("Stereo"); e) {
         window.stereo = parseStereoType(e->Attribute("type"));
@@ -833,6 +856,18 @@ sgct::config::Settings parseSettings(tinyxml2::XMLElement& elem) {
         display.refreshRate = parseValue<int>(*e, "refreshRate");
         settings.display = display;
     }
+    if (const char* a = elem.Attribute("TextureCachePath"); a) {
+        settings.textureCachePath = a;
+    }
+    settings.textureUploadBudget = parseValue<int>(elem, "TextureUploadBudget");
+    if (const char* a = elem.Attribute("FrameTracePath"); a) {
+        settings.frameTracePath = a;
+    }
+    if (const char* a = elem.Attribute("MeshCachePath"); a) {
+        settings.meshCachePath = a;
+    }
+    settings.meshSimplificationError =
+        parseValue<float>(elem, "MeshSimplificationError");
 
     return settings;
 }
@@ -858,12 +893,19 @@ sgct::config::Capture parseCapture(tinyxml2::XMLElement& element) {
     if (rangeEnd) {
         res.range->last = *rangeEnd;
     }
+
+    res.queueSize = parseValue<int>(element, "queue-size");
+    if (const char* a = element.Attribute("queue-policy"); a) {
+        res.queuePolicy = parseQueuePolicy(a);
+    }
+    res.fastEncoding = parseValue<bool>(element, "fast-encoding");
     return res;
 }
 
 sgct::config::Device parseDevice(tinyxml2::XMLElement& element) {
     sgct::config::Device device;
     device.name = element.Attribute("name");
+    device.predictionLatency = parseValue<double>(element, "predictionLatency");
 
     tinyxml2::XMLElement* sensorElem = element.FirstChildElement("Sensor");
     while (sensorElem) {
@@ -1291,6 +1333,12 @@ void from_json(const nlohmann::json& j, Settings& s) {
         parseValue(*it, "refreshrate", display.refreshRate);
         s.display = display;
     }
+
+    parseValue(j, "texturecachepath", s.textureCachePath);
+    parseValue(j, "textureuploadbudget", s.textureUploadBudget);
+    parseValue(j, "frametracepath", s.frameTracePath);
+    parseValue(j, "meshcachepath", s.meshCachePath);
+    parseValue(j, "meshsimplificationerror", s.meshSimplificationError);
 }
 
 void to_json(nlohmann::json& j, const Settings& s) {
@@ -1329,6 +1377,26 @@ void to_json(nlohmann::json& j, const Settings& s) {
         }
         j["display"] = display;
     }
+
+    if (s.textureCachePath.has_value()) {
+        j["texturecachepath"] = *s.textureCachePath;
+    }
+
+    if (s.textureUploadBudget.has_value()) {
+        j["textureuploadbudget"] = *s.textureUploadBudget;
+    }
+
+    if (s.frameTracePath.has_value()) {
+        j["frametracepath"] = *s.frameTracePath;
+    }
+
+    if (s.meshCachePath.has_value()) {
+        j["meshcachepath"] = *s.meshCachePath;
+    }
+
+    if (s.meshSimplificationError.has_value()) {
+        j["meshsimplificationerror"] = *s.meshSimplificationError;
+    }
 }
 
 void from_json(const nlohmann::json& j, Capture& c) {
@@ -1353,6 +1421,13 @@ void from_json(const nlohmann::json& j, Capture& c) {
     if (rangeEnd) {
         c.range->last = *rangeEnd;
     }
+
+    parseValue(j, "queuesize", c.queueSize);
+    if (auto it = j.find("queuepolicy"); it != j.end()) {
+        std::string policy = it->get<std::string>();
+        c.queuePolicy = parseQueuePolicy(policy);
+    }
+    parseValue(j, "fastencoding", c.fastEncoding);
 }
 
 void to_json(nlohmann::json& j, const Capture& c) {
@@ -1373,6 +1448,12 @@ void to_json(nlohmann::json& j, const Capture& c) {
             case Capture::Format::JPG:
                 j["format"] = "jpg";
                 break;
+            case Capture::Format::EXR:
+                j["format"] = "exr";
+                break;
+            case Capture::Format::RAW:
+                j["format"] = "raw";
+                break;
         }
     }
 
@@ -1380,6 +1461,28 @@ void to_json(nlohmann::json& j, const Capture& c) {
         j["rangebegin"] = c.range->first;
         j["rangeend"] = c.range->last;
     }
+
+    if (c.queueSize.has_value()) {
+        j["queuesize"] = *c.queueSize;
+    }
+
+    if (c.queuePolicy.has_value()) {
+        switch (*c.queuePolicy) {
+            case Capture::QueuePolicy::Block:
+                j["queuepolicy"] = "block";
+                break;
+            case Capture::QueuePolicy::DropOldest:
+                j["queuepolicy"] = "dropoldest";
+                break;
+            case Capture::QueuePolicy::DropNewest:
+                j["queuepolicy"] = "dropnewest";
+                break;
+        }
+    }
+
+    if (c.fastEncoding.has_value()) {
+        j["fastencoding"] = *c.fastEncoding;
+    }
 }
 
 void from_json(const nlohmann::json& j, Device::Sensors& s) {
@@ -1425,6 +1528,7 @@ void from_json(const nlohmann::json& j, Device& d) {
     parseValue(j, "axes", d.axes);
     parseValue(j, "offset", d.offset);
     parseValue(j, "matrix", d.transformation);
+    parseValue(j, "predictionlatency", d.predictionLatency);
 }
 
 void to_json(nlohmann::json& j, const Device& d) {
@@ -1442,6 +1546,10 @@ void to_json(nlohmann::json& j, const Device& d) {
     if (d.transformation.has_value()) {
         j["matrix"] = *d.transformation;
     }
+
+    if (d.predictionLatency.has_value()) {
+        j["predictionlatency"] = *d.predictionLatency;
+    }
 }
 
 void from_json(const nlohmann::json& j, Tracker& t) {
@@ -2155,6 +2263,7 @@ void from_json(const nlohmann::json& j, Window& w) {
     if (auto it = j.find("mpcdi");  it != j.end()) {
         w.mpcdi = std::filesystem::absolute(it->get<std::string>()).string();
     }
+    parseValue(j, "mpcdibuffer", w.mpcdiBuffer);
 
     if (auto it = j.find("stereo");  it != j.end()) {
         w.stereo = parseStereoType(it->get<std::string>());
@@ -2279,6 +2388,10 @@ void to_json(nlohmann::json& j, const Window& w) {
         j["mpcdi"] = *w.mpcdi;
     }
 
+    if (w.mpcdiBuffer.has_value()) {
+        j["mpcdibuffer"] = *w.mpcdiBuffer;
+    }
+
     if (w.stereo.has_value()) {
         j["stereo"] = toString(*w.stereo);
     }
@@ -2341,6 +2454,38 @@ void to_json(nlohmann::json& j, const Node& n) {
     }
 }
 
+void from_json(const nlohmann::json& j, Multicast& m) {
+    if (auto it = j.find("address");  it != j.end()) {
+        it->get_to(m.address);
+    }
+    else {
+        throw Err(6091, "Missing field address in multicast");
+    }
+
+    if (auto it = j.find("port");  it != j.end()) {
+        it->get_to(m.port);
+    }
+    else {
+        throw Err(6092, "Missing field port in multicast");
+    }
+
+    parseValue(j, "ttl", m.ttl);
+    parseValue(j, "interface", m.interfaceAddress);
+}
+
+void to_json(nlohmann::json& j, const Multicast& m) {
+    j["address"] = m.address;
+    j["port"] = m.port;
+
+    if (m.ttl.has_value()) {
+        j["ttl"] = *m.ttl;
+    }
+
+    if (m.interfaceAddress.has_value()) {
+        j["interface"] = *m.interfaceAddress;
+    }
+}
+
 void from_json(const nlohmann::json& j, Cluster& c) {
     if (auto it = j.find("masteraddress");  it != j.end()) {
         it->get_to(c.masterAddress);
@@ -2353,6 +2498,18 @@ void from_json(const nlohmann::json& j, Cluster& c) {
     parseValue(j, "debuglog", c.debugLog);
     parseValue(j, "externalcontrolport", c.externalControlPort);
     parseValue(j, "firmsync", c.firmSync);
+    parseValue(j, "deltasync", c.deltaSync);
+    parseValue(j, "deltasynckeyframeinterval", c.deltaSyncKeyframeInterval);
+    if (auto it = j.find("compression");  it != j.end()) {
+        std::string compression = it->get<std::string>();
+        c.compression = parseCompression(compression);
+    }
+    parseValue(j, "compressionthreshold", c.compressionThreshold);
+    parseValue(j, "networkreactor", c.networkReactor);
+    parseValue(j, "framelockspintime", c.frameLockSpinTime);
+    parseValue(j, "pipelinedsync", c.pipelinedSync);
+    parseValue(j, "frametimestamps", c.frameTimestamps);
+    parseValue(j, "multicast", c.multicast);
 
     parseValue(j, "scene", c.scene);
     parseValue(j, "users", c.users);
@@ -2382,6 +2539,52 @@ void to_json(nlohmann::json& j, const Cluster& c) {
         j["firmsync"] = *c.firmSync;
     }
 
+    if (c.deltaSync.has_value()) {
+        j["deltasync"] = *c.deltaSync;
+    }
+
+    if (c.deltaSyncKeyframeInterval.has_value()) {
+        j["deltasynckeyframeinterval"] = *c.deltaSyncKeyframeInterval;
+    }
+
+    if (c.compression.has_value()) {
+        switch (*c.compression) {
+            case Cluster::Compression::None:
+                j["compression"] = "none";
+                break;
+            case Cluster::Compression::Fast:
+                j["compression"] = "fast";
+                break;
+            case Cluster::Compression::High:
+                j["compression"] = "high";
+                break;
+        }
+    }
+
+    if (c.compressionThreshold.has_value()) {
+        j["compressionthreshold"] = *c.compressionThreshold;
+    }
+
+    if (c.networkReactor.has_value()) {
+        j["networkreactor"] = *c.networkReactor;
+    }
+
+    if (c.frameLockSpinTime.has_value()) {
+        j["framelockspintime"] = *c.frameLockSpinTime;
+    }
+
+    if (c.pipelinedSync.has_value()) {
+        j["pipelinedsync"] = *c.pipelinedSync;
+    }
+
+    if (c.frameTimestamps.has_value()) {
+        j["frametimestamps"] = *c.frameTimestamps;
+    }
+
+    if (c.multicast.has_value()) {
+        j["multicast"] = *c.multicast;
+    }
+
     if (c.scene.has_value()) {
         j["scene"] = *c.scene;
     }
@@ -8,36 +8,23 @@
 
 #include <sgct/screencapture.h>
 
+#include <sgct/capturethreadpool.h>
 #include <sgct/clustermanager.h>
 #include <sgct/engine.h>
+#include <sgct/error.h>
 #include <sgct/fmt.h>
 #include <sgct/image.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
 #include <sgct/profiling.h>
+#include <sgct/rawcapture.h>
 #include <sgct/settings.h>
 #include <sgct/window.h>
 #include <cstring>
+#include <new>
 #include <string>
 
-// @TODO (abock, 2019-12-01) This class might want a complete overhaul; right now, there
-// is one instance of this class for each window, and it might be better to replace it
-// with a global version that keeps threads usable by all windows of the application
-
 namespace {
-    void screenCaptureHandler(void* arg) {
-        using SCTI = sgct::ScreenCapture::ScreenCaptureThreadInfo;
-        SCTI* ptr = reinterpret_cast<SCTI*>(arg);
-
-        try {
-            ptr->frameBufferImage->save(ptr->filename);
-        }
-        catch (const std::runtime_error& e) {
-            sgct::Log::Error(e.what());
-        }
-        ptr->isRunning = false;
-    }
-
     GLenum sourceForCaptureSource(sgct::ScreenCapture::CaptureSource source) {
         using Source = sgct::ScreenCapture::CaptureSource;
         switch (source) {
@@ -48,6 +35,9 @@ namespace {
         }
     }
 
+    // Maximum time in nanoseconds that a single wait for a readback fence blocks
+    constexpr GLuint64 FenceTimeout = 1'000'000'000;
+
     GLenum getDownloadFormat(int nChannels) {
         switch (nChannels) {
             case 1: return GL_RED;
@@ -57,63 +47,68 @@ namespace {
             default: throw std::logic_error("Unhandled case label");
         }
     }
+
+    bool isFloatingPointType(GLenum type) {
+        return type == GL_HALF_FLOAT || type == GL_FLOAT;
+    }
 } // namespace
 
 namespace sgct {
 
-ScreenCapture::ScreenCapture()
-    : _nThreads(Settings::instance().numberCaptureThreads())
-{
+ScreenCapture::ScreenCapture() {
     ZoneScoped
 }
 
 ScreenCapture::~ScreenCapture() {
-    for (ScreenCaptureThreadInfo& info : _captureInfos) {
-        // kill threads that are still running
-        if (info.captureThread) {
-            info.captureThread->join();
-            info.captureThread = nullptr;
-        }
+    finishAllReadbacks();
 
-        std::unique_lock lock(_mutex);
-        info.frameBufferImage = nullptr;
-        info.isRunning = false;
-    }
+    // The jobs in the capture queue hand their images back to us, so we have to stay
+    // alive until all of them are finished
+    std::unique_lock lock(_mutex);
+    _jobFinished.wait(lock, [this]() { return _nPendingJobs == 0; });
+    _freeImages.clear();
+    lock.unlock();
+    _rawWriter = nullptr;
 
-    glDeleteBuffers(1, &_pbo);
+    for (Readback& rb : _readbacks) {
+        glDeleteBuffers(1, &rb.pbo);
+    }
 }
 
 void ScreenCapture::initOrResize(ivec2 resolution, int channels, int bytesPerColor) {
-    glDeleteBuffers(1, &_pbo);
-
-    _resolution = std::move(resolution);
-    _bytesPerColor = bytesPerColor;
+    // The readbacks in flight have the old size and can't be mapped after the resize
+    finishAllReadbacks();
+    for (Readback& rb : _readbacks) {
+        glDeleteBuffers(1, &rb.pbo);
+    }
 
-    _nChannels = channels;
+    {
+        // Images that are still in the capture queue are discarded by finishJob when
+        // they come back as their size no longer matches
+        std::unique_lock lock(_mutex);
+        _resolution = std::move(resolution);
+        _bytesPerColor = bytesPerColor;
+        _nChannels = channels;
+        _isFloatingPoint = isFloatingPointType(_downloadType);
+        _freeImages.clear();
+    }
+    // Frames of a different size can't be added to the same file, so the next
+    // screenshot starts a new one
+    _rawWriter = nullptr;
     _dataSize = _resolution.x * _resolution.y * _nChannels * _bytesPerColor;
 
     _downloadFormat = getDownloadFormat(_nChannels);
 
-    std::unique_lock lock(_mutex);
-    for (ScreenCaptureThreadInfo& info : _captureInfos) {
-        if (info.frameBufferImage) {
-            // kill threads that are still running
-            if (info.captureThread) {
-                info.captureThread->join();
-                info.captureThread = nullptr;
-            }
-            info.frameBufferImage = nullptr;
-        }
-        info.isRunning = false;
-    }
-
-    glGenBuffers(1, &_pbo);
-    Log::Debug(fmt::format(
-        "Generating {}x{}x{} PBO: {}", _resolution.x, _resolution.y, _nChannels, _pbo
-    ));
+    for (Readback& rb : _readbacks) {
+        glGenBuffers(1, &rb.pbo);
+        Log::Debug(fmt::format(
+            "Generating {}x{}x{} PBO: {}",
+            _resolution.x, _resolution.y, _nChannels, rb.pbo
+        ));
 
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbo);
-    glBufferData(GL_PIXEL_PACK_BUFFER, _dataSize, nullptr, GL_STATIC_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, _dataSize, nullptr, GL_STREAM_READ);
+    }
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 }
 
@@ -121,10 +116,17 @@ void ScreenCapture::setTextureTransferProperties(GLenum type) {
     _downloadType = type;
     _downloadTypeSetByUser = _downloadType;
     _downloadFormat = getDownloadFormat(_nChannels);
+
+    std::unique_lock lock(_mutex);
+    _isFloatingPoint = isFloatingPointType(_downloadType);
+    _freeImages.clear();
 }
 
 void ScreenCapture::setCaptureFormat(CaptureFormat cf) {
+    finishAllReadbacks();
+    _rawWriter = nullptr;
     _format = cf;
+    _hasLoggedFormatChange = false;
 }
 
 void ScreenCapture::saveScreenCapture(unsigned int textureId, CaptureSource capSrc) {
@@ -145,16 +147,24 @@ void ScreenCapture::saveScreenCapture(unsigned int textureId, CaptureSource capS
 
     std::string file = createFilename(number);
     checkImageBuffer(capSrc);
-
-    int threadIndex = availableCaptureThread();
-    if (threadIndex == -1) {
-        Log::Error("Error finding available capture thread");
+    if (_dataSize == 0) {
+        Log::Error("Error allocating image for screenshot");
         return;
     }
 
-    Image* imPtr = prepareImage(threadIndex, std::move(file));
+    // Hand over everything the GPU has finished already and make room in the ring if
+    // all buffers are still in flight; only the latter has to wait for the GPU
+    update();
+    if (_nReadbacks == NumberOfPBOs) {
+        finishReadback(_readbacks[_firstReadback]);
+    }
+
+    Readback& rb = _readbacks[(_firstReadback + _nReadbacks) % NumberOfPBOs];
+    rb.filename = std::move(file);
+    rb.frameNumber = number;
+
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb.pbo);
 
     if (capSrc == CaptureSource::Texture) {
         glBindTexture(GL_TEXTURE_2D, textureId);
@@ -163,46 +173,149 @@ void ScreenCapture::saveScreenCapture(unsigned int textureId, CaptureSource capS
     else {
         // set the target framebuffer to read
         glReadBuffer(sourceForCaptureSource(capSrc));
-        const ivec2& s = imPtr->size();
-        const GLsizei w = static_cast<GLsizei>(s.x);
-        const GLsizei h = static_cast<GLsizei>(s.y);
+        const GLsizei w = static_cast<GLsizei>(_resolution.x);
+        const GLsizei h = static_cast<GLsizei>(_resolution.y);
         glReadPixels(0, 0, w, h, _downloadFormat, _downloadType, nullptr);
     }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    rb.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _nReadbacks++;
+}
 
+void ScreenCapture::update() {
+    while (_nReadbacks > 0) {
+        Readback& rb = _readbacks[_firstReadback];
+        const GLenum res = glClientWaitSync(static_cast<GLsync>(rb.fence), 0, 0);
+        if (res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED) {
+            // The readbacks finish in order, so there is no need to look further
+            break;
+        }
+        finishReadback(rb);
+    }
+}
+
+void ScreenCapture::finishReadback(Readback& readback) {
+    ZoneScoped
+
+    GLsync fence = static_cast<GLsync>(readback.fence);
+    // The first wait has to flush, otherwise the fence might never reach the GPU
+    GLenum res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeout);
+    while (res == GL_TIMEOUT_EXPIRED) {
+        res = glClientWaitSync(fence, 0, FenceTimeout);
+    }
+    if (res == GL_WAIT_FAILED) {
+        // Mapping the buffer synchronizes implicitly, so we can continue anyway
+        Log::Warning("Waiting for the screenshot readback failed");
+    }
+    glDeleteSync(fence);
+    readback.fence = nullptr;
+
+    _firstReadback = (_firstReadback + 1) % NumberOfPBOs;
+    _nReadbacks--;
+
+    // The PBO is only bound and mapped once the image exists, so none of the failures
+    // below leaves the buffer mapped, and the readback slot can be reused right away
+    std::unique_ptr<Image> image;
+    try {
+        image = acquireImage();
+    }
+    catch (const std::bad_alloc&) {}
+    if (!image) {
+        Log::Error(fmt::format(
+            "Error allocating image for screenshot {}", readback.filename
+        ));
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
     unsigned char* ptr = reinterpret_cast<unsigned char*>(
         glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)
     );
-    if (ptr) {
-        std::memcpy(imPtr->data(), ptr, _dataSize);
-
-        // save the image
-        _captureInfos[threadIndex].isRunning = true;
-        _captureInfos[threadIndex].captureThread = std::make_unique<std::thread>(
-            screenCaptureHandler,
-            &_captureInfos[threadIndex]
-        );
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    if (!ptr) {
+        Log::Error(fmt::format(
+            "Can't map data (0) from GPU in frame capture {}", readback.filename
+        ));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        std::unique_lock lock(_mutex);
+        _freeImages.push_back(std::move(image));
+        return;
     }
-    else {
-        Log::Error("Can't map data (0) from GPU in frame capture");
+    std::memcpy(image->data(), ptr, _dataSize);
+    if (!glUnmapBuffer(GL_PIXEL_PACK_BUFFER)) {
+        // The content of the buffer got lost while it was mapped
+        Log::Warning(fmt::format(
+            "Screenshot {} might be corrupted", readback.filename
+        ));
     }
-
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    CaptureThreadPool::Job job;
+    if (_format == CaptureFormat::Raw) {
+        try {
+            if (!_rawWriter) {
+                _rawWriter = std::make_shared<RawCaptureWriter>(
+                    readback.filename,
+                    _resolution,
+                    _nChannels,
+                    _bytesPerColor,
+                    _isFloatingPoint
+                );
+            }
+            // The slot is reserved here so that the frames are stored in the order in
+            // which they were taken, regardless of which capture thread copies them. As
+            // the pixels have been copied already, no slot is reserved for a frame that
+            // is never written
+            const uint64_t index = _rawWriter->reserveFrame();
+            const uint64_t number = readback.frameNumber;
+            job.write = [w = _rawWriter, index, number](const Image& img) {
+                w->writeFrame(index, number, img.data());
+            };
+        }
+        catch (const Error& e) {
+            Log::Error(e.what());
+            std::unique_lock lock(_mutex);
+            _freeImages.push_back(std::move(image));
+            return;
+        }
+    }
+
+    {
+        std::unique_lock lock(_mutex);
+        _nPendingJobs++;
+    }
+    job.image = std::move(image);
+    job.filename = std::move(readback.filename);
+    job.completion = [this](std::unique_ptr<Image> img) { finishJob(std::move(img)); };
+    CaptureThreadPool::instance().push(std::move(job));
+}
+
+void ScreenCapture::finishAllReadbacks() {
+    while (_nReadbacks > 0) {
+        finishReadback(_readbacks[_firstReadback]);
+    }
 }
 
 void ScreenCapture::initialize(int windowIndex, ScreenCapture::EyeIndex ei) {
     _eyeIndex = ei;
+    _windowIndex = windowIndex;
+}
 
-    _captureInfos.resize(_nThreads);
-    for (unsigned int i = 0; i < _nThreads; i++) {
-        _captureInfos[i].frameBufferImage = nullptr;
-        _captureInfos[i].captureThread = nullptr;
-        _captureInfos[i].mutex = &_mutex;
-        _captureInfos[i].isRunning = false;
+ScreenCapture::CaptureFormat ScreenCapture::effectiveFormat() {
+    if (!_isFloatingPoint || _format == CaptureFormat::EXR ||
+        _format == CaptureFormat::Raw)
+    {
+        return _format;
     }
-    _windowIndex = windowIndex;
 
-    Log::Debug(fmt::format("Number of screencapture threads is set to {}", _nThreads));
+    if (!_hasLoggedFormatChange) {
+        Log::Warning(
+            "Floating point framebuffers can't be saved as PNG, JPEG, or TGA. Saving "
+            "screenshots as EXR instead"
+        );
+        _hasLoggedFormatChange = true;
+    }
+    return CaptureFormat::EXR;
 }
 
 std::string ScreenCapture::createFilename(uint64_t frameNumber) {
@@ -224,9 +337,11 @@ std::string ScreenCapture::createFilename(uint64_t frameNumber) {
             case CaptureFormat::PNG: return "png";
             case CaptureFormat::TGA: return "tga";
             case CaptureFormat::JPEG: return "jpg";
+            case CaptureFormat::EXR: return "exr";
+            case CaptureFormat::Raw: return "sgctraw";
             default: throw std::logic_error("Unhandled case label");
         }
-    }(_format);
+    }(effectiveFormat());
 
     std::string file;
     if (!Settings::instance().capturePath().empty()) {
@@ -255,26 +370,6 @@ std::string ScreenCapture::createFilename(uint64_t frameNumber) {
     return file + std::string(Buffer.begin(), Buffer.end()) + '.' + suffix;
 }
 
-int ScreenCapture::availableCaptureThread() {
-    while (true) {
-        for (unsigned int i = 0; i < _captureInfos.size(); i++) {
-            // check if thread is dead
-            if (_captureInfos[i].captureThread == nullptr) {
-                return i;
-            }
-
-            if (!_captureInfos[i].isRunning) {
-                _captureInfos[i].captureThread->join();
-                _captureInfos[i].captureThread = nullptr;
-
-                return i;
-            }
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
-}
-
 void ScreenCapture::checkImageBuffer(CaptureSource captureSource) {
     const Window& win = *Engine::instance().windows()[_windowIndex];
 
@@ -296,23 +391,41 @@ void ScreenCapture::checkImageBuffer(CaptureSource captureSource) {
     }
 }
 
-Image* ScreenCapture::prepareImage(int index, std::string file) {
-    Log::Debug(fmt::format("Starting thread for screenshot/capture [{}]", index));
-
-    if (_captureInfos[index].frameBufferImage == nullptr) {
-        _captureInfos[index].frameBufferImage = std::make_unique<Image>();
-        _captureInfos[index].frameBufferImage->setBytesPerChannel(_bytesPerColor);
-        _captureInfos[index].frameBufferImage->setChannels(_nChannels);
-        _captureInfos[index].frameBufferImage->setSize(_resolution);
-        if (_bytesPerColor * _nChannels * _resolution.x * _resolution.y == 0) {
-            _captureInfos[index].frameBufferImage = nullptr;
-            return nullptr;
+std::unique_ptr<Image> ScreenCapture::acquireImage() {
+    if (_bytesPerColor * _nChannels * _resolution.x * _resolution.y == 0) {
+        return nullptr;
+    }
+
+    {
+        std::unique_lock lock(_mutex);
+        if (!_freeImages.empty()) {
+            std::unique_ptr<Image> image = std::move(_freeImages.back());
+            _freeImages.pop_back();
+            return image;
         }
-        _captureInfos[index].frameBufferImage->allocateOrResizeData();
     }
-    _captureInfos[index].filename = std::move(file);
 
-    return _captureInfos[index].frameBufferImage.get();
+    std::unique_ptr<Image> image = std::make_unique<Image>();
+    image->setBytesPerChannel(_bytesPerColor);
+    image->setFloatingPoint(_isFloatingPoint);
+    image->setChannels(_nChannels);
+    image->setSize(_resolution);
+    image->allocateOrResizeData();
+    return image;
+}
+
+void ScreenCapture::finishJob(std::unique_ptr<Image> image) {
+    std::unique_lock lock(_mutex);
+    // The pixel format might have changed while the image was waiting in the queue
+    const bool isReusable = image && image->size().x == _resolution.x &&
+        image->size().y == _resolution.y && image->channels() == _nChannels &&
+        image->bytesPerChannel() == _bytesPerColor &&
+        image->isFloatingPoint() == _isFloatingPoint;
+    if (isReusable) {
+        _freeImages.push_back(std::move(image));
+    }
+    _nPendingJobs--;
+    _jobFinished.notify_all();
 }
 
 } // namespace sgct
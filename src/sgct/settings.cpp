@@ -12,6 +12,7 @@
 #include <sgct/engine.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
+#include <algorithm>
 
 namespace sgct {
 
@@ -60,6 +61,21 @@ void Settings::applySettings(const config::Settings& settings) {
             setRefreshRateHint(*settings.display->refreshRate);
         }
     }
+    if (settings.textureCachePath) {
+        setTextureCachePath(*settings.textureCachePath);
+    }
+    if (settings.textureUploadBudget) {
+        setTextureUploadBudget(*settings.textureUploadBudget);
+    }
+    if (settings.frameTracePath) {
+        setFrameTracePath(*settings.frameTracePath);
+    }
+    if (settings.meshCachePath) {
+        setMeshCachePath(*settings.meshCachePath);
+    }
+    if (settings.meshSimplificationError) {
+        setMeshSimplificationError(*settings.meshSimplificationError);
+    }
 }
 
 void Settings::applyCapture(const config::Capture& capture) {
@@ -72,6 +88,8 @@ void Settings::applyCapture(const config::Capture& capture) {
                 case config::Capture::Format::PNG: return CaptureFormat::PNG;
                 case config::Capture::Format::JPG: return CaptureFormat::JPG;
                 case config::Capture::Format::TGA: return CaptureFormat::TGA;
+                case config::Capture::Format::EXR: return CaptureFormat::EXR;
+                case config::Capture::Format::RAW: return CaptureFormat::Raw;
                 default:      throw std::logic_error("Unhandled case label");
             }
         }(*capture.format);
@@ -83,6 +101,25 @@ void Settings::applyCapture(const config::Capture& capture) {
         _screenshot.limits->begin = capture.range->first;
         _screenshot.limits->end = capture.range->last;
     }
+
+    if (capture.queueSize) {
+        setCaptureQueueSize(*capture.queueSize);
+    }
+    if (capture.queuePolicy) {
+        CaptureQueuePolicy p = [](config::Capture::QueuePolicy policy) {
+            using QP = config::Capture::QueuePolicy;
+            switch (policy) {
+                case QP::Block:      return CaptureQueuePolicy::Block;
+                case QP::DropOldest: return CaptureQueuePolicy::DropOldest;
+                case QP::DropNewest: return CaptureQueuePolicy::DropNewest;
+                default:      throw std::logic_error("Unhandled case label");
+            }
+        }(*capture.queuePolicy);
+        setCaptureQueuePolicy(p);
+    }
+    if (capture.fastEncoding) {
+        setCaptureFastEncoding(*capture.fastEncoding);
+    }
 }
 
 void Settings::setSwapInterval(int val) {
@@ -126,6 +163,23 @@ void Settings::setNumberOfCaptureThreads(int count) {
     }
 }
 
+void Settings::setCaptureQueueSize(int size) {
+    if (size <= 0) {
+        Log::Error("Only positive capture queue sizes allowed");
+    }
+    else {
+        _captureQueueSize = size;
+    }
+}
+
+void Settings::setCaptureQueuePolicy(CaptureQueuePolicy policy) {
+    _captureQueuePolicy = policy;
+}
+
+void Settings::setCaptureFastEncoding(bool state) {
+    _captureFastEncoding = state;
+}
+
 bool Settings::useDepthTexture() const {
     return _useDepthTexture;
 }
@@ -142,6 +196,18 @@ int Settings::numberCaptureThreads() const {
     return _nCaptureThreads;
 }
 
+int Settings::captureQueueSize() const {
+    return _captureQueueSize.value_or(2 * _nCaptureThreads);
+}
+
+Settings::CaptureQueuePolicy Settings::captureQueuePolicy() const {
+    return _captureQueuePolicy;
+}
+
+bool Settings::captureFastEncoding() const {
+    return _captureFastEncoding;
+}
+
 Settings::DrawBufferType Settings::drawBufferType() const {
     if (_usePositionTexture) {
         if (_useNormalTexture) {
@@ -193,6 +259,26 @@ void Settings::setExportWarpingMeshes(bool state) {
     _exportWarpingMeshes = state;
 }
 
+void Settings::setTextureCachePath(std::string path) {
+    _textureCachePath = std::move(path);
+}
+
+void Settings::setTextureUploadBudget(int bytes) {
+    _textureUploadBudget = std::max(bytes, 1);
+}
+
+void Settings::setFrameTracePath(std::string path) {
+    _frameTracePath = std::move(path);
+}
+
+void Settings::setMeshCachePath(std::string path) {
+    _meshCachePath = std::move(path);
+}
+
+void Settings::setMeshSimplificationError(float maxError) {
+    _meshSimplificationError = std::max(maxError, 0.f);
+}
+
 void Settings::setAddNodeNameToScreenshot(bool state) {
     _screenshot.addNodeName = state;
 }
@@ -205,6 +291,26 @@ bool Settings::exportWarpingMeshes() const {
     return _exportWarpingMeshes;
 }
 
+const std::string& Settings::textureCachePath() const {
+    return _textureCachePath;
+}
+
+int Settings::textureUploadBudget() const {
+    return _textureUploadBudget;
+}
+
+const std::string& Settings::frameTracePath() const {
+    return _frameTracePath;
+}
+
+const std::string& Settings::meshCachePath() const {
+    return _meshCachePath;
+}
+
+std::optional<float> Settings::meshSimplificationError() const {
+    return _meshSimplificationError;
+}
+
 bool Settings::captureFromBackBuffer() const {
     return _captureBackBuffer;
 }
@@ -8,12 +8,143 @@
 
 #include <sgct/shareddata.h>
 
+#include <sgct/clustermanager.h>
+#include <sgct/error.h>
+#include <sgct/fmt.h>
 #include <sgct/log.h>
 #include <sgct/profiling.h>
 #include <zlib.h>
+#include <algorithm>
 #include <cstring>
 #include <string>
 
+#define Err(code, msg) sgct::Error(sgct::Error::Component::Network, code, msg)
+
+namespace {
+    // A delta block starts with the size of the block it is based on and the size of the
+    // resulting block, followed by a list of runs. Each run consists of the offset into
+    // the resulting block, the length of the run, and the bytes that replace the old ones
+    constexpr const size_t DeltaHeaderSize = 2 * sizeof(uint32_t);
+    constexpr const size_t RunHeaderSize = 2 * sizeof(uint32_t);
+
+    void appendRun(std::vector<std::byte>& delta, const std::byte* data, uint32_t offset,
+                   uint32_t length)
+    {
+        const size_t pos = delta.size();
+        delta.resize(pos + RunHeaderSize + length);
+        std::memcpy(delta.data() + pos, &offset, sizeof(uint32_t));
+        std::memcpy(delta.data() + pos + sizeof(uint32_t), &length, sizeof(uint32_t));
+        std::memcpy(delta.data() + pos + RunHeaderSize, data + offset, length);
+    }
+
+    // Appends the difference between `prev` and `curr` to the `delta` vector. Returns
+    // false if the resulting delta would be at least as big as `curr` itself, in which
+    // case the contents of `delta` are unspecified
+    bool createDelta(const std::byte* prev, size_t prevSize, const std::byte* curr,
+                     size_t currSize, std::vector<std::byte>& delta)
+    {
+        const size_t start = delta.size();
+        const uint32_t baseSize = static_cast<uint32_t>(prevSize);
+        const uint32_t resultSize = static_cast<uint32_t>(currSize);
+        delta.resize(start + DeltaHeaderSize);
+        std::memcpy(delta.data() + start, &baseSize, sizeof(uint32_t));
+        std::memcpy(
+            delta.data() + start + sizeof(uint32_t),
+            &resultSize,
+            sizeof(uint32_t)
+        );
+
+        // Every byte past the end of the previous block counts as changed
+        const size_t common = std::min(prevSize, currSize);
+        size_t i = 0;
+        while (i < currSize) {
+            // Skip the unchanged bytes
+            while (i < common && prev[i] == curr[i]) {
+                i++;
+            }
+            if (i == currSize) {
+                break;
+            }
+
+            const size_t begin = i;
+            size_t end = i;
+            while (i < currSize) {
+                if (i < common && prev[i] == curr[i]) {
+                    // Short stretches of unchanged bytes are cheaper to send than the
+                    // header of a new run, so only end the run on a longer stretch
+                    size_t j = i;
+                    while (j < common && prev[j] == curr[j] && j - i < RunHeaderSize) {
+                        j++;
+                    }
+                    if (j - i >= RunHeaderSize || j == currSize) {
+                        break;
+                    }
+                    i = j;
+                }
+                else {
+                    i++;
+                    end = i;
+                }
+            }
+
+            appendRun(
+                delta,
+                curr,
+                static_cast<uint32_t>(begin),
+                static_cast<uint32_t>(end - begin)
+            );
+            if (delta.size() - start >= currSize) {
+                return false;
+            }
+        }
+        return delta.size() - start < currSize;
+    }
+
+    void applyDelta(std::vector<std::byte>& block, const char* delta, size_t deltaSize) {
+        if (deltaSize < DeltaHeaderSize) {
+            throw Err(
+                5015,
+                fmt::format("Delta block of size {} is too small", deltaSize)
+            );
+        }
+
+        uint32_t baseSize;
+        std::memcpy(&baseSize, delta, sizeof(uint32_t));
+        uint32_t resultSize;
+        std::memcpy(&resultSize, delta + sizeof(uint32_t), sizeof(uint32_t));
+        if (baseSize != block.size()) {
+            throw Err(
+                5016,
+                fmt::format(
+                    "Delta block is based on a block of size {} but {} was available",
+                    baseSize, block.size()
+                )
+            );
+        }
+
+        block.resize(resultSize);
+        size_t pos = DeltaHeaderSize;
+        while (pos < deltaSize) {
+            if (deltaSize - pos < RunHeaderSize) {
+                throw Err(5017, "Delta block contains a truncated run");
+            }
+            uint32_t offset;
+            std::memcpy(&offset, delta + pos, sizeof(uint32_t));
+            uint32_t length;
+            std::memcpy(&length, delta + pos + sizeof(uint32_t), sizeof(uint32_t));
+            pos += RunHeaderSize;
+
+            if (static_cast<size_t>(offset) + length > resultSize ||
+                deltaSize - pos < length)
+            {
+                throw Err(5018, "Delta block contains a run outside of the data block");
+            }
+            std::memcpy(block.data() + offset, delta + pos, length);
+            pos += length;
+        }
+    }
+} // namespace
+
 namespace sgct {
 
 SharedData* SharedData::_instance = nullptr;
@@ -34,16 +165,18 @@ SharedData::SharedData() {
     constexpr const int DefaultSize = 1024;
 
     _dataBlock.reserve(DefaultSize);
-
-    // fill rest of header with Network::DefaultId
-    std::memset(_headerSpace.data(), Network::DefaultId, Network::HeaderSize);
-    _headerSpace[0] = std::byte { Network::DataId };
 }
 
 void SharedData::setEncodeFunction(std::function<std::vector<std::byte>()> function) {
     _encodeFn = std::move(function);
 }
 
+void SharedData::setEncodeToBufferFunction(
+                                    std::function<void(std::vector<std::byte>&)> function)
+{
+    _encodeToBufferFn = std::move(function);
+}
+
 void SharedData::setDecodeFunction(
                 std::function<void(const std::vector<std::byte>&, unsigned int)> function)
 {
@@ -79,38 +212,82 @@ void SharedData::decode(const char* receivedData, int receivedLength) {
     }
 }
 
+void SharedData::decodeDelta(const char* receivedData, int receivedLength) {
+    ZoneScoped
+
+    std::vector<std::byte> data;
+    {
+        std::unique_lock lk(mutex::DataSync);
+        applyDelta(_dataBlock, receivedData, static_cast<size_t>(receivedLength));
+        if (_decodeFn) {
+            data = _dataBlock;
+        }
+    }
+
+    if (_decodeFn) {
+        _decodeFn(data, 0u);
+    }
+}
+
 void SharedData::encode() {
     ZoneScoped
 
+    const bool useDelta = ClusterManager::instance().useDeltaSync();
+    const bool hasPrevious = _hasEncoded;
     {
         std::unique_lock lk(mutex::DataSync);
+        if (useDelta) {
+            // Keep the last frame around as the base for the next delta block
+            std::swap(_dataBlock, _previousDataBlock);
+        }
         _dataBlock.clear();
+        _deltaBlock.clear();
+        _hasEncoded = true;
+    }
 
-        _dataBlock.insert(
-            _dataBlock.begin(),
-            _headerSpace.cbegin(),
-            _headerSpace.cbegin() + Network::HeaderSize
-        );
+    if (_encodeToBufferFn) {
+        _encodeToBufferFn(_dataBlock);
     }
+    else if (_encodeFn) {
+        _dataBlock = _encodeFn();
+    }
+
+    if (useDelta && hasPrevious) {
+        ZoneScopedN("Delta")
 
-    if (_encodeFn) {
-        std::vector<std::byte> data = _encodeFn();
-        _dataBlock.insert(_dataBlock.end(), data.begin(), data.end());
+        const bool isSmaller = createDelta(
+            _previousDataBlock.data(),
+            _previousDataBlock.size(),
+            _dataBlock.data(),
+            _dataBlock.size(),
+            _deltaBlock
+        );
+        if (!isSmaller) {
+            _deltaBlock.clear();
+        }
     }
 }
 
-unsigned char* SharedData::dataBlock() {
-    return reinterpret_cast<unsigned char*>(_dataBlock.data());
+const unsigned char* SharedData::dataBlock() const {
+    return reinterpret_cast<const unsigned char*>(_dataBlock.data());
 }
 
-int SharedData::dataSize() {
+int SharedData::dataSize() const {
     return static_cast<int>(_dataBlock.size());
 }
 
-int SharedData::bufferSize() {
+int SharedData::bufferSize() const {
     return static_cast<int>(_dataBlock.capacity());
 }
 
+const unsigned char* SharedData::deltaBlock() const {
+    return reinterpret_cast<const unsigned char*>(_deltaBlock.data());
+}
+
+int SharedData::deltaSize() const {
+    return static_cast<int>(_deltaBlock.size());
+}
+
 template <>
 void serializeObject(std::vector<std::byte>& buffer, std::string_view value) {
     uint32_t length = static_cast<uint32_t>(value.size());
@@ -200,7 +200,7 @@ void StatisticsRenderer::update() {
 
     // Histogram update
     auto updateHist = [](std::array<int, Histogram::Bins>& hValues,
-                         const std::array<double, Histogram::Bins>& sValues, double scale)
+                         const Engine::Statistics::History& sValues, double scale)
     {
         std::fill(hValues.begin(), hValues.end(), 0);
 
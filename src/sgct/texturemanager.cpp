@@ -10,54 +10,54 @@
 
 #include <sgct/fmt.h>
 #include <sgct/image.h>
+#include <sgct/imageloader.h>
 #include <sgct/log.h>
 #include <sgct/opengl.h>
+#include <sgct/profiling.h>
+#include <sgct/settings.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <optional>
 
 namespace {
-    unsigned int uploadImage(const sgct::Image& img, bool interpolate, int mipmap,
-                             float anisotropicFilterSize)
-    {
-        unsigned int tex;
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
+    // Guards the creation of the instance, as the asynchronous loading functions can be
+    // the first ones that are called and may be called from any thread
+    std::mutex instanceMutex;
+
+    struct TextureFormat {
+        GLenum type;
+        GLenum internalFormat;
+        GLenum format;
+    };
+
+    TextureFormat textureFormat(const sgct::Image& img) {
+        const int bpc = img.bytesPerChannel();
+        if (bpc != 1 && bpc != 2) {
+            throw std::logic_error("Unhandled case label");
+        }
 
-        const auto [type, internalFormat] = [](int c) -> std::pair<GLenum, GLenum> {
+        const auto [type, internalFormat] = [bpc](int c) -> std::pair<GLenum, GLenum> {
             switch (c) {
-                case 1: return { GL_RED, GL_R8 };
-                case 2: return { GL_RG, GL_RG8 };
-                case 3: return { GL_BGR, GL_RGB8 };
-                case 4: return { GL_BGRA, GL_RGBA8 };
+                case 1: return { GL_RED, bpc == 1 ? GL_R8 : GL_R16 };
+                case 2: return { GL_RG, bpc == 1 ? GL_RG8 : GL_RG16 };
+                case 3: return { GL_BGR, bpc == 1 ? GL_RGB8 : GL_RGB16 };
+                case 4: return { GL_BGRA, bpc == 1 ? GL_RGBA8 : GL_RGBA16 };
                 default: throw std::logic_error("Unhandled case label");
             }
         }(img.channels());
 
-        sgct::Log::Debug(fmt::format(
-            "Creating texture. Size: {}x{}, {}-channels, Type: {:#04x}, Format: {:#04x}",
-            img.size().x, img.size().y, img.channels(), type, internalFormat
-        ));
-
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        const GLenum format = bpc == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+        return { type, internalFormat, format };
+    }
 
-        GLenum format = GL_UNSIGNED_BYTE;
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            internalFormat,
-            img.size().x,
-            img.size().y,
-            0,
-            type,
-            format,
-            img.data()
-        );
+    void setTextureParameters(bool interpolate, int mipmap, float anisotropicFilterSize)
+    {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipmap - 1);
 
         if (mipmap > 1) {
-            glGenerateMipmap(GL_TEXTURE_2D);
-
             glTexParameteri(
                 GL_TEXTURE_2D,
                 GL_TEXTURE_MIN_FILTER,
@@ -89,16 +89,77 @@ namespace {
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    unsigned int uploadImage(const sgct::Image& img, bool interpolate, int mipmap,
+                             float anisotropicFilterSize)
+    {
+        unsigned int tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+
+        const auto [type, internalFormat, format] = textureFormat(img);
+
+        sgct::Log::Debug(fmt::format(
+            "Creating texture. Size: {}x{}, {}-channels, Type: {:#04x}, Format: {:#04x}",
+            img.size().x, img.size().y, img.channels(), type, internalFormat
+        ));
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            internalFormat,
+            img.size().x,
+            img.size().y,
+            0,
+            type,
+            format,
+            img.data()
+        );
+        setTextureParameters(interpolate, mipmap, anisotropicFilterSize);
+        if (mipmap > 1) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
 
         return tex;
     }
+
+    /// \return the number of mipmap levels that \p size can have, but at most \p mipmap
+    int numberOfLevels(sgct::ivec2 size, int mipmap) {
+        const int maxLevels =
+            static_cast<int>(std::log2(std::max(std::max(size.x, size.y), 1))) + 1;
+        return std::clamp(mipmap, 1, maxLevels);
+    }
 } // namespace
 
 namespace sgct {
 
+struct TextureManager::PendingUpload {
+    std::future<Image> future;
+    std::promise<unsigned int> promise;
+    std::string name;
+    bool interpolate = true;
+    float anisotropicFilterSize = 1.f;
+    int mipmapLevels = 8;
+
+    // Only valid once the image has been decoded
+    std::optional<Image> image;
+    TextureFormat format = {};
+    unsigned int texture = 0;
+    int nLevels = 1;
+    int nextRow = 0;
+
+    // Set after the last row has been uploaded, the texture is ready once it is signaled
+    GLsync fence = nullptr;
+};
+
 TextureManager* TextureManager::_instance = nullptr;
 
 TextureManager& TextureManager::instance() {
+    std::lock_guard lock(instanceMutex);
     if (!_instance) {
         _instance = new TextureManager;
     }
@@ -106,25 +167,40 @@ TextureManager& TextureManager::instance() {
 }
 
 void TextureManager::destroy() {
-    delete _instance;
-    _instance = nullptr;
+    TextureManager* instance = nullptr;
+    {
+        std::lock_guard lock(instanceMutex);
+        std::swap(instance, _instance);
+    }
+    delete instance;
 }
 
+TextureManager::TextureManager()
+    : _uploadBudget(static_cast<size_t>(Settings::instance().textureUploadBudget()))
+{}
+
 TextureManager::~TextureManager() {
+    // The futures of the unfinished uploads report a broken promise
+    for (const std::unique_ptr<PendingUpload>& upload : _uploads) {
+        if (upload->fence) {
+            glDeleteSync(upload->fence);
+        }
+        if (upload->texture) {
+            glDeleteTextures(1, &upload->texture);
+        }
+    }
+    if (_pixelBuffer) {
+        glDeleteBuffers(1, &_pixelBuffer);
+    }
+
     glDeleteTextures(static_cast<GLsizei>(_textures.size()), _textures.data());
 }
 
 unsigned int TextureManager::loadTexture(const std::string& filename, bool interpolate,
                                          float anisotropicFilterSize, int mipmapLevels)
 {
-    // load image
-    Image img;
-    img.load(filename);
-
-    if (img.data() == nullptr) {
-        // image data not valid
-        return 0;
-    }
+    // Going through the loader uses the texture cache if one is configured
+    Image img = ImageLoader::instance().load(filename).get();
 
     unsigned int t = loadTexture(
         std::move(img),
@@ -145,6 +221,201 @@ unsigned int TextureManager::loadTexture(Image img, bool interpolate,
     return t;
 }
 
+std::shared_future<unsigned int> TextureManager::loadTextureAsync(
+                                                              std::string filename,
+                                                              bool interpolate,
+                                                              float anisotropicFilterSize,
+                                                              int mipmapLevels)
+{
+    std::future<Image> image = ImageLoader::instance().load(filename);
+    return addUpload(
+        std::move(image),
+        std::move(filename),
+        interpolate,
+        anisotropicFilterSize,
+        mipmapLevels
+    );
+}
+
+std::shared_future<unsigned int> TextureManager::loadTextureAsync(
+                                                              std::future<Image> image,
+                                                              bool interpolate,
+                                                              float anisotropicFilterSize,
+                                                              int mipmapLevels)
+{
+    return addUpload(
+        std::move(image),
+        "<memory>",
+        interpolate,
+        anisotropicFilterSize,
+        mipmapLevels
+    );
+}
+
+std::shared_future<unsigned int> TextureManager::addUpload(std::future<Image> image,
+                                                           std::string name,
+                                                           bool interpolate,
+                                                           float anisotropicFilterSize,
+                                                           int mipmapLevels)
+{
+    auto upload = std::make_unique<PendingUpload>();
+    upload->future = std::move(image);
+    upload->name = std::move(name);
+    upload->interpolate = interpolate;
+    upload->anisotropicFilterSize = anisotropicFilterSize;
+    upload->mipmapLevels = mipmapLevels;
+    std::shared_future<unsigned int> res = upload->promise.get_future().share();
+
+    std::unique_lock lock(_mutex);
+    _requests.push_back(std::move(upload));
+    return res;
+}
+
+void TextureManager::update() {
+    ZoneScoped
+
+    {
+        std::unique_lock lock(_mutex);
+        std::move(_requests.begin(), _requests.end(), std::back_inserter(_uploads));
+        _requests.clear();
+    }
+    if (_uploads.empty()) {
+        return;
+    }
+
+    size_t budget = _uploadBudget;
+    for (auto it = _uploads.begin(); it != _uploads.end();) {
+        PendingUpload& u = **it;
+
+        if (u.fence) {
+            // All rows and mipmaps have been uploaded, but the texture can only be used
+            // in the other contexts once the GPU has processed those commands
+            const GLenum res = glClientWaitSync(u.fence, 0, 0);
+            if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED) {
+                glDeleteSync(u.fence);
+                _textures.push_back(u.texture);
+                Log::Debug(fmt::format(
+                    "Texture created from '{}' [id={}]", u.name, u.texture
+                ));
+                u.promise.set_value(u.texture);
+                it = _uploads.erase(it);
+            }
+            else {
+                it++;
+            }
+            continue;
+        }
+
+        if (!u.image) {
+            if (u.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                it++;
+                continue;
+            }
+
+            try {
+                u.image = u.future.get();
+                u.format = textureFormat(*u.image);
+            }
+            catch (...) {
+                u.promise.set_exception(std::current_exception());
+                it = _uploads.erase(it);
+                continue;
+            }
+
+            // The storage is allocated at once, but filled over the next frames
+            u.nLevels = numberOfLevels(u.image->size(), u.mipmapLevels);
+            glGenTextures(1, &u.texture);
+            glBindTexture(GL_TEXTURE_2D, u.texture);
+            glTexStorage2D(
+                GL_TEXTURE_2D,
+                u.nLevels,
+                u.format.internalFormat,
+                u.image->size().x,
+                u.image->size().y
+            );
+            setTextureParameters(u.interpolate, u.nLevels, u.anisotropicFilterSize);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        // A texture with rows that are larger than the entire budget gets a full frame
+        const size_t rowSize = static_cast<size_t>(u.image->size().x) *
+            u.image->channels() * u.image->bytesPerChannel();
+        if (budget < rowSize && budget < _uploadBudget) {
+            it++;
+            continue;
+        }
+        budget -= std::min(upload(u, std::max(budget, rowSize)), budget);
+        it++;
+    }
+}
+
+size_t TextureManager::upload(PendingUpload& pending, size_t budget) {
+    ZoneScoped
+
+    const Image& img = *pending.image;
+    const size_t rowSize = static_cast<size_t>(img.size().x) * img.channels() *
+        img.bytesPerChannel();
+    const int nRows = std::min(
+        img.size().y - pending.nextRow,
+        static_cast<int>(std::min<size_t>(budget / rowSize, img.size().y))
+    );
+    const size_t size = nRows * rowSize;
+    const unsigned char* src = img.data() + pending.nextRow * rowSize;
+
+    if (_pixelBuffer == 0) {
+        glGenBuffers(1, &_pixelBuffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffer);
+    // Orphaning the storage of the last frame lets the driver hand out new memory while
+    // the previous transfer is still in flight instead of waiting for it
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* ptr = glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER,
+        0,
+        size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+    );
+    if (ptr) {
+        std::memcpy(ptr, src, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        src = nullptr;
+    }
+    else {
+        // Without the buffer the rows are copied directly from the image
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, pending.texture);
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        0,
+        pending.nextRow,
+        img.size().x,
+        nRows,
+        pending.format.type,
+        pending.format.format,
+        src
+    );
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pending.nextRow += nRows;
+
+    if (pending.nextRow == img.size().y) {
+        if (pending.nLevels > 1) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Flushing makes sure that the fence and the texture reach the GPU even though
+        // nothing is rendered in this context
+        glFlush();
+        pending.image = std::nullopt;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return size;
+}
+
 void TextureManager::removeTexture(unsigned int textureId) {
     _textures.erase(
         std::remove(_textures.begin(), _textures.end(), textureId),
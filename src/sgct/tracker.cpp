@@ -36,8 +36,8 @@ void Tracker::setEnabled(bool state) {
     }
 }
 
-void Tracker::addDevice(std::string name, int index) {
-    _trackingDevices.push_back(std::make_unique<TrackingDevice>(index, name));
+void Tracker::addDevice(std::string name) {
+    _trackingDevices.push_back(std::make_unique<TrackingDevice>(*this, name));
     Log::Info(fmt::format("{}: Adding device '{}'", _name, name));
 }
 
@@ -71,7 +71,7 @@ void Tracker::setOrientation(quat q) {
     _orientation = fromGLM<glm::mat4, mat4>(orientation);
 
     glm::mat4 transMat = glm::translate(glm::mat4(1.f), glm::make_vec3(&_offset.x));
-    _transform = fromGLM<glm::mat4, mat4>(transMat * orientation);
+    _transform.store(fromGLM<glm::mat4, mat4>(transMat * orientation));
 }
 
 void Tracker::setOrientation(float xRot, float yRot, float zRot) {
@@ -86,11 +86,12 @@ void Tracker::setOffset(vec3 offset) {
     std::unique_lock lock(mutex::Tracking);
     _offset = std::move(offset);
     glm::mat4 trans = glm::translate(glm::mat4(1.f), glm::make_vec3(&_offset.x));
-    _transform = fromGLM<glm::mat4, mat4>(trans * glm::make_mat4(_orientation.values));
+    _transform.store(
+        fromGLM<glm::mat4, mat4>(trans * glm::make_mat4(_orientation.values))
+    );
 }
 
 void Tracker::setScale(double scaleVal) {
-    std::unique_lock lock(mutex::Tracking);
     if (scaleVal > 0.0) {
         _scale = scaleVal;
     }
@@ -98,16 +99,14 @@ void Tracker::setScale(double scaleVal) {
 
 void Tracker::setTransform(mat4 mat) {
     std::unique_lock lock(mutex::Tracking);
-    _transform = std::move(mat);
+    _transform.store(mat);
 }
 
 mat4 Tracker::getTransform() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _transform;
+    return _transform.load();
 }
 
 double Tracker::scale() const {
-    std::unique_lock lock(mutex::Tracking);
     return _scale;
 }
 
@@ -8,13 +8,9 @@
 
 #include <sgct/trackingdevice.h>
 
-#include <sgct/clustermanager.h>
 #include <sgct/engine.h>
-#include <sgct/fmt.h>
-#include <sgct/log.h>
 #include <sgct/mutexes.h>
 #include <sgct/tracker.h>
-#include <sgct/trackingmanager.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -31,13 +27,12 @@ namespace {
     }
 } // namespace
 
-TrackingDevice::TrackingDevice(int parentIndex, std::string name)
+TrackingDevice::TrackingDevice(const Tracker& parent, std::string name)
     : _name(std::move(name))
-    , _parentIndex(parentIndex)
+    , _parent(parent)
 {}
 
 void TrackingDevice::setEnabled(bool state) {
-    std::unique_lock lock(mutex::Tracking);
     _isEnabled = state;
 }
 
@@ -46,53 +41,29 @@ void TrackingDevice::setSensorId(int id) {
 }
 
 void TrackingDevice::setNumberOfButtons(int numOfButtons) {
-    _buttons.resize(numOfButtons, false);
-    _buttonsPrevious.resize(numOfButtons, false);
-    _buttonTime.resize(numOfButtons, 0.0);
-    _buttonTimePrevious.resize(numOfButtons, 0.0);
+    _buttons = std::vector<SeqLock<Value<bool>>>(numOfButtons);
     _nButtons = numOfButtons;
 }
 
 void TrackingDevice::setNumberOfAxes(int numOfAxes) {
-    _axes.resize(numOfAxes, 0.0);
-    _axesPrevious.resize(numOfAxes, 0.0);
+    _axes = std::vector<SeqLock<Value<double>>>(numOfAxes);
     _nAxes = numOfAxes;
 }
 
 void TrackingDevice::setSensorTransform(vec3 vec, quat rot) {
-    Tracker* parent = TrackingManager::instance().trackers()[_parentIndex].get();
-
-    if (parent == nullptr) {
-        Log::Error(fmt::format("Error getting handle to tracker for device '{}'", _name));
-        return;
-    }
-
-    const glm::mat4 parentTrans = glm::make_mat4(parent->getTransform().values);
-
-    // create matrixes
-    const glm::mat4 sensorTransMat = glm::translate(
-        glm::mat4(1.f),
-        glm::make_vec3(&vec.x)
-    );
-    const glm::mat4 sensorRotMat = glm::mat4_cast(glm::make_quat(&rot.x));
-
-    {
-        std::unique_lock lock(mutex::Tracking);
-
-        // swap
-        _sensorRotationPrevious = std::move(_sensorRotation);
-        _sensorRotation = std::move(rot);
-
-        _sensorPosPrevious = std::move(_sensorPos);
-        _sensorPos = std::move(vec);
+    setSensorTransform(vec, rot, Engine::getTime());
+}
 
-        _worldTransformPrevious = std::move(_worldTransform);
-        _worldTransform = fromGLM<glm::mat4, mat4>(
-            parentTrans * sensorTransMat * sensorRotMat * 
-            glm::make_mat4(_deviceTransform.values)
-        );
-    }
-    setTrackerTimeStamp();
+void TrackingDevice::setSensorTransform(vec3 vec, quat rot, double timestamp) {
+    // Only this function writes to the sensor, so the last sample can't change under us
+    Sensor sensor = _sensor.load();
+    sensor.previous = sensor.current;
+    sensor.current.position = vec;
+    sensor.current.rotation = rot;
+    sensor.current.worldTransform = worldTransform(vec, rot);
+    sensor.current.timestamp = timestamp;
+    sensor.nSamples++;
+    _sensor.store(sensor);
 }
 
 void TrackingDevice::setButtonValue(bool val, int index) {
@@ -100,24 +71,24 @@ void TrackingDevice::setButtonValue(bool val, int index) {
         return;
     }
 
-    {
-        std::unique_lock lock(mutex::Tracking);
-        // swap
-        _buttonsPrevious[index] = _buttons[index];
-        _buttons[index] = val;
-    }
-    setButtonTimeStamp(index);
+    Value<bool> button = _buttons[index].load();
+    button.previous = button.current;
+    button.current = val;
+    button.timePrevious = button.time;
+    button.time = Engine::getTime();
+    _buttons[index].store(button);
 }
 
 void TrackingDevice::setAnalogValue(const double* array, int size) {
-    {
-        std::unique_lock lock(mutex::Tracking);
-        for (int i = 0; i < std::min(size, _nAxes); i++) {
-            _axesPrevious[i] = _axes[i];
-            _axes[i] = array[i];
-        }
+    const double time = Engine::getTime();
+    for (int i = 0; i < std::min(size, _nAxes); i++) {
+        Value<double> axis = _axes[i].load();
+        axis.previous = axis.current;
+        axis.current = array[i];
+        axis.timePrevious = axis.time;
+        axis.time = time;
+        _axes[i].store(axis);
     }
-    setAnalogTimeStamp();
 }
 
 void TrackingDevice::setOrientation(float xRot, float yRot, float zRot) {
@@ -146,7 +117,16 @@ void TrackingDevice::setOffset(vec3 offset) {
 
 void TrackingDevice::setTransform(mat4 mat) {
     std::unique_lock lock(mutex::Tracking);
-    _deviceTransform = std::move(mat);
+    _deviceTransform.store(mat);
+}
+
+void TrackingDevice::setPredictionLatency(std::optional<double> latency) {
+    _predictionLatency = latency.has_value() ? std::max(*latency, 0.0) : -1.0;
+}
+
+std::optional<double> TrackingDevice::predictionLatency() const {
+    const double latency = _predictionLatency;
+    return latency >= 0.0 ? std::optional<double>(latency) : std::nullopt;
 }
 
 const std::string& TrackingDevice::name() const {
@@ -161,112 +141,133 @@ int TrackingDevice::numberOfAxes() const {
     return _nAxes;
 }
 
+mat4 TrackingDevice::worldTransform(vec3 position, quat rotation) const {
+    const glm::mat4 parentTrans = glm::make_mat4(_parent.getTransform().values);
+    const glm::mat4 sensorTransMat = glm::translate(
+        glm::mat4(1.f),
+        glm::make_vec3(&position.x)
+    );
+    const glm::mat4 sensorRotMat = glm::mat4_cast(glm::make_quat(&rotation.x));
+    return fromGLM<glm::mat4, mat4>(
+        parentTrans * sensorTransMat * sensorRotMat *
+        glm::make_mat4(_deviceTransform.load().values)
+    );
+}
+
 void TrackingDevice::calculateTransform() {
     glm::mat4 transMat = glm::translate(glm::mat4(1.f), glm::make_vec3(&_offset.x));
-    _deviceTransform = fromGLM<glm::mat4, mat4>(
+    _deviceTransform.store(fromGLM<glm::mat4, mat4>(
         transMat * glm::mat4_cast(glm::make_quat(&_orientation.x))
-    );
+    ));
 }
 
-int TrackingDevice::sensorId() {
-    std::unique_lock lock(mutex::Tracking);
+int TrackingDevice::sensorId() const {
     return _sensorId;
 }
 
 bool TrackingDevice::button(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return index < _nButtons ? _buttons[index] : false;
+    return index < _nButtons ? _buttons[index].load().current : false;
 }
 
 bool TrackingDevice::buttonPrevious(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return index < _nButtons ? _buttonsPrevious[index] : false;
+    return index < _nButtons ? _buttons[index].load().previous : false;
 }
 
 double TrackingDevice::analog(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return index < _nAxes ? _axes[index] : 0.0;
+    return index < _nAxes ? _axes[index].load().current : 0.0;
 }
 
 double TrackingDevice::analogPrevious(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return index < _nAxes ? _axesPrevious[index] : 0.0;
+    return index < _nAxes ? _axes[index].load().previous : 0.0;
 }
 
 vec3 TrackingDevice::position() const {
-    std::unique_lock lock(mutex::Tracking);
-    glm::mat4 m = glm::make_mat4(_worldTransform.values);
+    glm::mat4 m = glm::make_mat4(_sensor.load().current.worldTransform.values);
     glm::vec3 p = glm::vec3(m[3]);
     return fromGLM<glm::vec3, vec3>(p);
 }
 
 vec3 TrackingDevice::previousPosition() const {
-    std::unique_lock lock(mutex::Tracking);
-    glm::mat4 m = glm::make_mat4(_worldTransformPrevious.values);
+    glm::mat4 m = glm::make_mat4(_sensor.load().previous.worldTransform.values);
     glm::vec3 p = glm::vec3(m[3]);
     return fromGLM<glm::vec3, vec3>(p);
 }
 
 vec3 TrackingDevice::eulerAngles() const {
-    std::unique_lock lock(mutex::Tracking);
+    const mat4 m = _sensor.load().current.worldTransform;
     return fromGLM<glm::vec3, vec3>(
-        glm::eulerAngles(glm::quat_cast(glm::make_mat4(_worldTransform.values)))
+        glm::eulerAngles(glm::quat_cast(glm::make_mat4(m.values)))
     );
 }
 
 vec3 TrackingDevice::eulerAnglesPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
+    const mat4 m = _sensor.load().previous.worldTransform;
     return fromGLM<glm::vec3, vec3>(
-        glm::eulerAngles(glm::quat_cast(glm::make_mat4(_worldTransformPrevious.values)))
+        glm::eulerAngles(glm::quat_cast(glm::make_mat4(m.values)))
     );
 }
 
 quat TrackingDevice::rotation() const {
-    std::unique_lock lock(mutex::Tracking);
-    return fromGLM<glm::quat, quat>(
-        glm::quat_cast(glm::make_mat4(_worldTransform.values))
-    );
+    const mat4 m = _sensor.load().current.worldTransform;
+    return fromGLM<glm::quat, quat>(glm::quat_cast(glm::make_mat4(m.values)));
 }
 
 quat TrackingDevice::rotationPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
-    return fromGLM<glm::quat, quat>(
-        glm::quat_cast(glm::make_mat4(_worldTransformPrevious.values))
-    );
+    const mat4 m = _sensor.load().previous.worldTransform;
+    return fromGLM<glm::quat, quat>(glm::quat_cast(glm::make_mat4(m.values)));
 }
 
 mat4 TrackingDevice::worldTransform() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _worldTransform;
+    return _sensor.load().current.worldTransform;
 }
 
 mat4 TrackingDevice::worldTransformPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _worldTransformPrevious;
+    return _sensor.load().previous.worldTransform;
 }
 
 quat TrackingDevice::sensorRotation() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _sensorRotation;
+    return _sensor.load().current.rotation;
 }
 
 quat TrackingDevice::sensorRotationPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _sensorRotationPrevious;
+    return _sensor.load().previous.rotation;
 }
 
 vec3 TrackingDevice::sensorPosition() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _sensorPos;
+    return _sensor.load().current.position;
 }
 
 vec3 TrackingDevice::sensorPositionPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _sensorPosPrevious;
+    return _sensor.load().previous.position;
+}
+
+mat4 TrackingDevice::predictedWorldTransform(double time) const {
+    const Sensor sensor = _sensor.load();
+    const double dt = sensor.current.timestamp - sensor.previous.timestamp;
+    if (sensor.nSamples < 2 || dt <= 0.0) {
+        return sensor.current.worldTransform;
+    }
+
+    // The velocities are estimated from the last two samples. Extrapolating too far ahead
+    // amplifies the noise of the tracker, so the prediction is capped
+    const double h = std::clamp(time - sensor.current.timestamp, 0.0, MaxPrediction);
+    const float t = static_cast<float>(1.0 + h / dt);
+
+    const glm::vec3 p0 = glm::make_vec3(&sensor.previous.position.x);
+    const glm::vec3 p1 = glm::make_vec3(&sensor.current.position.x);
+    const glm::vec3 position = p0 + (p1 - p0) * t;
+
+    const glm::quat q0 = glm::make_quat(&sensor.previous.rotation.x);
+    const glm::quat q1 = glm::make_quat(&sensor.current.rotation.x);
+    const glm::quat rotation = glm::normalize(glm::slerp(q0, q1, t));
+
+    return worldTransform(
+        fromGLM<glm::vec3, vec3>(position),
+        fromGLM<glm::quat, quat>(rotation)
+    );
 }
 
 bool TrackingDevice::isEnabled() const {
-    std::unique_lock lock(mutex::Tracking);
     return _isEnabled;
 }
 
@@ -282,67 +283,47 @@ bool TrackingDevice::hasAnalogs() const {
     return _nAxes > 0;
 }
 
-void TrackingDevice::setTrackerTimeStamp() {
-    std::unique_lock lock(mutex::Tracking);
-    _trackerTimePrevious = _trackerTime;
-    _trackerTime = Engine::getTime();
-}
-
-void TrackingDevice::setAnalogTimeStamp() {
-    std::unique_lock lock(mutex::Tracking);
-    _analogTimePrevious = _analogTime;
-    _analogTime = Engine::getTime();
-}
-
-void TrackingDevice::setButtonTimeStamp(int index) {
-    std::unique_lock lock(mutex::Tracking);
-    _buttonTimePrevious[index] = _buttonTime[index];
-    _buttonTime[index] = Engine::getTime();
-}
-
-double TrackingDevice::trackerTimeStamp() {
-    std::unique_lock lock(mutex::Tracking);
-    return _trackerTime;
+double TrackingDevice::trackerTimeStamp() const {
+    return _sensor.load().current.timestamp;
 }
 
-double TrackingDevice::trackerTimeStampPrevious() {
-    std::unique_lock lock(mutex::Tracking);
-    return _trackerTimePrevious;
+double TrackingDevice::trackerTimeStampPrevious() const {
+    return _sensor.load().previous.timestamp;
 }
 
 double TrackingDevice::analogTimeStamp() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _analogTime;
+    // All axes are updated together, so they share their timestamps
+    return _nAxes > 0 ? _axes[0].load().time : 0.0;
 }
 
 double TrackingDevice::analogTimeStampPrevious() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _analogTimePrevious;
+    return _nAxes > 0 ? _axes[0].load().timePrevious : 0.0;
 }
 
 double TrackingDevice::buttonTimeStamp(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return _buttonTime[index];
+    return _buttons[index].load().time;
 }
 
 double TrackingDevice::buttonTimeStampPrevious(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return _buttonTimePrevious[index];
+    return _buttons[index].load().timePrevious;
 }
 
 double TrackingDevice::trackerDeltaTime() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _trackerTime - _trackerTimePrevious;
+    const Sensor sensor = _sensor.load();
+    return sensor.current.timestamp - sensor.previous.timestamp;
 }
 
 double TrackingDevice::analogDeltaTime() const {
-    std::unique_lock lock(mutex::Tracking);
-    return _analogTime - _analogTimePrevious;
+    if (_nAxes == 0) {
+        return 0.0;
+    }
+    const Value<double> axis = _axes[0].load();
+    return axis.time - axis.timePrevious;
 }
 
 double TrackingDevice::buttonDeltaTime(int index) const {
-    std::unique_lock lock(mutex::Tracking);
-    return _buttonTime[index] - _buttonTimePrevious[index];
+    const Value<bool> button = _buttons[index].load();
+    return button.time - button.timePrevious;
 }
 
 } // namespace sgct
@@ -13,7 +13,6 @@
 #include <sgct/engine.h>
 #include <sgct/fmt.h>
 #include <sgct/log.h>
-#include <sgct/mutexes.h>
 #include <sgct/profiling.h>
 #include <sgct/trackingdevice.h>
 #include <sgct/user.h>
@@ -138,10 +137,7 @@ void TrackingManager::destroy() {
 TrackingManager::~TrackingManager() {
     Log::Info("Disconnecting VRPN");
 
-    {
-        std::unique_lock lock(mutex::Tracking);
-        _isRunning = false;
-    }
+    _isRunning = false;
 
     // destroy thread
     if (_samplingThread) {
@@ -172,6 +168,7 @@ void TrackingManager::applyDevice(const config::Device& device) {
     if (device.transformation) {
         _trackers.back()->devices().back()->setTransform(*device.transformation);
     }
+    _trackers.back()->devices().back()->setPredictionLatency(device.predictionLatency);
 }
 
 void TrackingManager::applyTracker(const config::Tracker& tracker) {
@@ -194,7 +191,6 @@ void TrackingManager::applyTracker(const config::Tracker& tracker) {
 }
 
 bool TrackingManager::isRunning() const {
-    std::unique_lock lock(mutex::Tracking);
     return _isRunning;
 }
 
@@ -229,13 +225,18 @@ void TrackingManager::startSampling() {
     _samplingThread = std::make_unique<std::thread>(samplingLoop, this);
 }
 
-void TrackingManager::updateTrackingDevices() {
+void TrackingManager::updateTrackingDevices(double displayTime) {
     ZoneScoped
 
     for (const std::unique_ptr<Tracker>& tracker : _trackers) {
         for (const std::unique_ptr<TrackingDevice>& device : tracker->devices()) {
             if (device->isEnabled() && device.get() == _head && _headUser) {
-                _headUser->setTransform(device->worldTransform());
+                const std::optional<double> latency = device->predictionLatency();
+                _headUser->setTransform(
+                    latency.has_value() ?
+                        device->predictedWorldTransform(displayTime + *latency) :
+                        device->worldTransform()
+                );
             }
         }
     }
@@ -253,7 +254,7 @@ void TrackingManager::addTracker(std::string name) {
 }
 
 void TrackingManager::addDeviceToCurrentTracker(std::string name) {
-    _trackers.back()->addDevice(std::move(name), static_cast<int>(_trackers.size() - 1));
+    _trackers.back()->addDevice(std::move(name));
     gTrackers.back().emplace_back(VRPNPointer());
 }
 
@@ -292,13 +293,14 @@ void TrackingManager::addButtonsToCurrentDevice(std::string address, int nButton
     VRPNPointer& ptr = gTrackers.back().back();
     TrackingDevice* device = _trackers.back()->devices().back().get();
 
-    if (ptr.buttonDevice == nullptr && device) {
+    // The buttons can't be resized while the sampling thread might be writing them
+    if (ptr.buttonDevice == nullptr && device && !_samplingThread) {
         Log::Info(fmt::format(
             "Connecting to buttons '{}' on device {}", address, device->name()
         ));
+        device->setNumberOfButtons(nButtons);
         ptr.buttonDevice = std::make_unique<vrpn_Button_Remote>(address.c_str());
         ptr.buttonDevice->register_change_handler(device, updateButton);
-        device->setNumberOfButtons(nButtons);
     }
     else {
         Log::Error(fmt::format("Failed to connect to buttons '{}'", address));
@@ -313,14 +315,15 @@ void TrackingManager::addAnalogsToCurrentDevice(std::string address, int nAxes)
     VRPNPointer& ptr = gTrackers.back().back();
     TrackingDevice* device = _trackers.back()->devices().back().get();
 
-    if (ptr.analogDevice == nullptr && device) {
+    // The axes can't be resized while the sampling thread might be writing them
+    if (ptr.analogDevice == nullptr && device && !_samplingThread) {
         Log::Info(fmt::format(
             "Connecting to analog '{}' on device {}", address, device->name()
         ));
 
+        device->setNumberOfAxes(nAxes);
         ptr.analogDevice = std::make_unique<vrpn_Analog_Remote>(address.c_str());
         ptr.analogDevice->register_change_handler(device, updateAnalog);
-        device->setNumberOfAxes(nAxes);
     }
     else {
         Log::Error(fmt::format("Failed to connect to analogs '{}'", address));
@@ -351,12 +354,10 @@ void TrackingManager::setEnabled(bool state) {
 }
 
 void TrackingManager::setSamplingTime(double t) {
-    std::unique_lock lock(mutex::Tracking);
     _samplingTime = t;
 }
 
 double TrackingManager::samplingTime() const {
-    std::unique_lock lock(mutex::Tracking);
     return _samplingTime;
 }
 
@@ -10,6 +10,7 @@
 
 #include <sgct/clustermanager.h>
 #include <sgct/config.h>
+#include <sgct/imageloader.h>
 #include <sgct/log.h>
 #include <sgct/profiling.h>
 #include <sgct/readconfig.h>
@@ -24,6 +25,7 @@
 #include <sgct/projection/spoutflat.h>
 #include <algorithm>
 #include <array>
+#include <future>
 #include <optional>
 #include <variant>
 
@@ -31,6 +33,12 @@ namespace {
     // Helper structs for the visitor pattern of the std::variant on projections
     template <class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
     template <class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+
+    std::future<sgct::Image> readyImage(sgct::Image image) {
+        std::promise<sgct::Image> promise;
+        promise.set_value(std::move(image));
+        return promise.get_future();
+    }
 } // namespace
 
 namespace sgct {
@@ -340,41 +348,86 @@ void Viewport::applySphericalMirrorProjection(const config::SphericalMirrorProje
     _nonLinearProjection = std::move(proj);
 }
 
-void Viewport::setMpcdiWarpMesh(std::vector<char> data) {
-    _mpcdiWarpMesh = std::move(data);
+void Viewport::setMpcdiWarpMesh(correction::Buffer mesh) {
+    _hasMpcdiWarpMesh = true;
+    _mpcdiWarpMesh = std::move(mesh);
+}
+
+void Viewport::setMpcdiMasks(Image blendMask, Image blackLevelMask) {
+    // The masks are already decoded, so they are only waiting to be uploaded by loadData
+    if (blendMask.data()) {
+        _blendMaskImage = readyImage(std::move(blendMask));
+    }
+    if (blackLevelMask.data()) {
+        _blackLevelMaskImage = readyImage(std::move(blackLevelMask));
+    }
+}
+
+void Viewport::prepareData() {
+    ZoneScoped
+
+    prepareImagesAndMesh();
+    if (_nonLinearProjection) {
+        _nonLinearProjection->prepareMeshes();
+    }
 }
 
 void Viewport::loadData() {
     ZoneScoped
 
+    if (!_isDataPrepared) {
+        prepareImagesAndMesh();
+    }
+    _isDataPrepared = false;
+
     TextureManager& mgr = TextureManager::instance();
-    if (!_overlayFilename.empty()) {
-        _overlayTextureIndex = mgr.loadTexture(_overlayFilename, true, 1);
+    if (_overlayImage.valid()) {
+        _overlayTextureIndex = mgr.loadTexture(_overlayImage.get(), true, 1);
+    }
+    if (_blendMaskImage.valid()) {
+        _blendMaskTextureIndex = mgr.loadTexture(_blendMaskImage.get(), true, 1);
+    }
+    if (_blackLevelMaskImage.valid()) {
+        _blackLevelMaskTextureIndex =
+            mgr.loadTexture(_blackLevelMaskImage.get(), true, 1);
     }
 
+    _mesh.loadMesh(
+        meshPath(),
+        *this,
+        hasBlendMaskTexture() || hasBlackLevelMaskTexture()
+    );
+}
+
+void Viewport::prepareImagesAndMesh() {
+    // All images are decoded concurrently before the first one is uploaded
+    ImageLoader& loader = ImageLoader::instance();
+    if (!_overlayFilename.empty()) {
+        _overlayImage = loader.load(_overlayFilename);
+    }
     if (!_blendMaskFilename.empty()) {
-        _blendMaskTextureIndex = mgr.loadTexture(_blendMaskFilename, true, 1);
+        _blendMaskImage = loader.load(_blendMaskFilename);
     }
-
     if (!_blackLevelMaskFilename.empty()) {
-        _blackLevelMaskTextureIndex = mgr.loadTexture(_blackLevelMaskFilename, true, 1);
+        _blackLevelMaskImage = loader.load(_blackLevelMaskFilename);
     }
 
-    if (!_mpcdiWarpMesh.empty()) {
-        _mesh.loadMesh(
-            "mesh.mpcdi",
-            *this,
-            hasBlendMaskTexture() || hasBlackLevelMaskTexture()
-        );
+    const bool hasMasks = _blendMaskImage.valid() || _blackLevelMaskImage.valid();
+    if (_hasMpcdiWarpMesh) {
+        // The mesh is only needed to generate the meshes that are uploaded, so it is
+        // moved there instead of being kept for the lifetime of the viewport
+        _mesh.prepareMesh(meshPath(), std::move(_mpcdiWarpMesh), *this, hasMasks);
+        _mpcdiWarpMesh = correction::Buffer();
     }
     else {
-        // load default if _meshFilename is empty
-        _mesh.loadMesh(
-            _meshFilename,
-            *this,
-            hasBlendMaskTexture() || hasBlackLevelMaskTexture()
-        );
+        _mesh.prepareMesh(meshPath(), *this, hasMasks);
     }
+    _isDataPrepared = true;
+}
+
+std::string Viewport::meshPath() const {
+    // load default if _meshFilename is empty
+    return _hasMpcdiWarpMesh ? "mesh.mpcdi" : _meshFilename;
 }
 
 void Viewport::renderQuadMesh() const {
@@ -437,8 +490,4 @@ NonLinearProjection* Viewport::nonLinearProjection() const {
     return _nonLinearProjection.get();
 }
 
-const std::vector<char>& Viewport::mpcdiWarpMesh() const {
-    return _mpcdiWarpMesh;
-}
-
 } // namespace sgct
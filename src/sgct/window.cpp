@@ -180,16 +180,18 @@ void Window::applyWindow(const config::Window& window) {
     if (window.mpcdi) {
         ZoneScopedN("MPCDI")
 
-        mpcdi::ReturnValue r = mpcdi::parseMpcdiConfiguration(*window.mpcdi);
+        mpcdi::ReturnValue r =
+            mpcdi::parseMpcdiConfiguration(*window.mpcdi, window.mpcdiBuffer);
         setWindowPosition(ivec2{ 0, 0 });
         initWindowResolution(r.resolution);
         setFramebufferResolution(r.resolution);
         setFixResolution(true);
 
-        for (const mpcdi::ReturnValue::ViewportInfo& vp : r.viewports) {
+        for (mpcdi::ReturnValue::ViewportInfo& vp : r.viewports) {
             auto v = std::make_unique<Viewport>(this);
             v->applySettings(vp.proj);
-            v->setMpcdiWarpMesh(vp.meshData);
+            v->setMpcdiWarpMesh(std::move(vp.mesh));
+            v->setMpcdiMasks(std::move(vp.alphaMap), std::move(vp.betaMap));
             addViewport(std::move(v));
         }
         return;
@@ -484,6 +486,15 @@ void Window::swap(bool takeScreenshot) {
             }
         }
     }
+    else {
+        // Screenshots from previous frames might still wait for their readback
+        if (_screenCaptureLeftOrMono) {
+            _screenCaptureLeftOrMono->update();
+        }
+        if (_screenCaptureRight) {
+            _screenCaptureRight->update();
+        }
+    }
 
     // swap
     _windowResOld = _windowRes;
@@ -956,6 +967,8 @@ void Window::initScreenCapture() {
                 case CF::PNG: return ScreenCapture::CaptureFormat::PNG;
                 case CF::TGA: return ScreenCapture::CaptureFormat::TGA;
                 case CF::JPG: return ScreenCapture::CaptureFormat::JPEG;
+                case CF::EXR: return ScreenCapture::CaptureFormat::EXR;
+                case CF::Raw: return ScreenCapture::CaptureFormat::Raw;
                 default: throw std::logic_error("Unhandled case label");
             }
         }(format);
@@ -0,0 +1,113 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/fmt.h>
+#include <sgct/image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Measures how long Image::save takes for typical screenshot sizes and pixel formats.
+// Usage: SGCTBenchmarkImage [number of iterations] [format (png, jpg, tga, exr)]
+
+namespace {
+    struct Configuration {
+        sgct::ivec2 size;
+        int nChannels;
+        int bytesPerChannel;
+    };
+
+    void fillImage(sgct::Image& image) {
+        // A smooth gradient with some noise on top compresses roughly like a rendering
+        std::mt19937 rnd(1337);
+        std::uniform_int_distribution<int> noise(-4, 4);
+
+        const sgct::ivec2 size = image.size();
+        const int nValues = image.channels() * image.bytesPerChannel();
+        unsigned char* data = image.data();
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                const int base = (x * 255 / size.x + y * 255 / size.y) / 2;
+                for (int c = 0; c < nValues; c++) {
+                    *data = static_cast<unsigned char>(
+                        std::clamp(base + c * 16 + noise(rnd), 0, 255)
+                    );
+                    data++;
+                }
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const int nIterations = argc > 1 ? std::max(std::stoi(argv[1]), 1) : 5;
+    const std::string format = argc > 2 ? argv[2] : "png";
+
+    const std::vector<Configuration> configurations = {
+        { sgct::ivec2{ 1920, 1080 }, 3, 1 },
+        { sgct::ivec2{ 1920, 1080 }, 4, 1 },
+        { sgct::ivec2{ 3840, 2160 }, 3, 1 },
+        { sgct::ivec2{ 3840, 2160 }, 4, 1 },
+        { sgct::ivec2{ 3840, 2160 }, 4, 2 },
+        { sgct::ivec2{ 4096, 4096 }, 4, 1 },
+        { sgct::ivec2{ 8192, 8192 }, 3, 1 },
+        { sgct::ivec2{ 8192, 8192 }, 4, 1 }
+    };
+
+    const std::filesystem::path file =
+        std::filesystem::temp_directory_path() / ("sgct-benchmark." + format);
+
+    fmt::print("{:>11} {:>3} {:>3} {:>8} {:>10} {:>10} {:>10} {:>10}\n",
+        "size", "ch", "bpc", "preset", "min (ms)", "avg (ms)", "MB/s", "ratio");
+    for (const Configuration& conf : configurations) {
+        sgct::Image image;
+        image.setSize(conf.size);
+        image.setChannels(conf.nChannels);
+        image.setBytesPerChannel(conf.bytesPerChannel);
+        image.allocateOrResizeData();
+        fillImage(image);
+
+        const double nBytes = static_cast<double>(conf.size.x) * conf.size.y *
+            conf.nChannels * conf.bytesPerChannel;
+
+        using Compression = sgct::Image::Compression;
+        for (Compression compression : { Compression::Default, Compression::Fast }) {
+            double min = std::numeric_limits<double>::max();
+            double sum = 0.0;
+            for (int i = 0; i < nIterations; i++) {
+                using Clock = std::chrono::steady_clock;
+                const Clock::time_point start = Clock::now();
+                image.save(file.string(), compression);
+                const std::chrono::duration<double, std::milli> t = Clock::now() - start;
+                min = std::min(min, t.count());
+                sum += t.count();
+            }
+
+            const double fileSize = static_cast<double>(std::filesystem::file_size(file));
+            fmt::print(
+                "{:>11} {:>3} {:>3} {:>8} {:>10.2f} {:>10.2f} {:>10.1f} {:>10.3f}\n",
+                fmt::format("{}x{}", conf.size.x, conf.size.y),
+                conf.nChannels,
+                conf.bytesPerChannel,
+                compression == Compression::Fast ? "fast" : "default",
+                min,
+                sum / nIterations,
+                nBytes / (min * 1000.0),
+                fileSize / nBytes
+            );
+        }
+    }
+
+    std::filesystem::remove(file);
+    return 0;
+}
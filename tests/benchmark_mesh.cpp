@@ -0,0 +1,293 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <sgct/clustermanager.h>
+#include <sgct/config.h>
+#include <sgct/fmt.h>
+#include <sgct/viewport.h>
+#include <sgct/correction/domeprojection.h>
+#include <sgct/correction/obj.h>
+#include <sgct/correction/paulbourke.h>
+#include <sgct/correction/scalable.h>
+#include <sgct/correction/simcad.h>
+#include <sgct/correction/skyskan.h>
+#include <sgct/projection/nonlinearprojection.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Measures how long it takes to parse the text-based warping mesh formats. Without any
+// files, meshes with the resolution of a high-resolution projector mesh are generated for
+// each of the formats. The printed hash covers all vertices and indices of the resulting
+// buffer, so it has to be identical before and after a change to one of the parsers.
+// Usage: SGCTBenchmarkMesh [number of iterations] [mesh files...]
+
+namespace {
+    constexpr int Width = 512;
+    constexpr int Height = 400;
+    const sgct::vec2 Position = sgct::vec2{ 0.25f, 0.125f };
+    const sgct::vec2 Size = sgct::vec2{ 0.5f, 0.75f };
+    constexpr float AspectRatio = 16.f / 9.f;
+
+    // Writes the values in the mix of notations that are found in the wild
+    class ValueWriter {
+    public:
+        std::string operator()(float value) {
+            switch (_notation(_rnd)) {
+                case 0: return fmt::format("{:.6f}", value);
+                case 1: return fmt::format("{}", value);
+                case 2: return fmt::format("{:.9e}", value);
+                default: return fmt::format("{:+.7f}", value);
+            }
+        }
+
+        float uniform(float min, float max) {
+            return std::uniform_real_distribution<float>(min, max)(_rnd);
+        }
+
+    private:
+        std::mt19937 _rnd = std::mt19937(1337);
+        std::uniform_int_distribution<int> _notation =
+            std::uniform_int_distribution<int>(0, 3);
+    };
+
+    void writeObj(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        for (int i = 0; i < Width * Height; i++) {
+            file << fmt::format(
+                "v {} {} 0.000000\n", v(v.uniform(-1.f, 1.f)), v(v.uniform(-1.f, 1.f))
+            );
+        }
+        for (int i = 0; i < Width * Height; i++) {
+            file << fmt::format(
+                "vt {} {}\n", v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f))
+            );
+        }
+        for (int y = 0; y < Height - 1; y++) {
+            for (int x = 0; x < Width - 1; x++) {
+                const int i = y * Width + x + 1;
+                file << fmt::format(
+                    "f {0}/{0} {1}/{1} {2}/{2}\nf {0}/{0} {2}/{2} {3}/{3}\n",
+                    i, i + 1, i + Width + 1, i + Width
+                );
+            }
+        }
+    }
+
+    void writePaulBourke(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        file << fmt::format("2\n{} {}\n", Width, Height);
+        for (int i = 0; i < Width * Height; i++) {
+            file << fmt::format(
+                "{} {} {} {} {}\n",
+                v(v.uniform(-1.f, 1.f)), v(v.uniform(-1.f, 1.f)), v(v.uniform(0.f, 1.f)),
+                v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f))
+            );
+        }
+    }
+
+    void writeDomeProjection(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        for (int y = 0; y < Height; y++) {
+            for (int x = 0; x < Width; x++) {
+                file << fmt::format(
+                    "{};{};{};{};{};{}\n",
+                    v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f)),
+                    v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f)), x, y
+                );
+            }
+        }
+    }
+
+    void writeSkySkan(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        file << "Dome Azimuth=33.3\nDome Elevation=12.5\nHorizontal FOV=60\n"
+            "Vertical FOV=40\nU Tweak=0.99\n";
+        file << fmt::format("{} {}\n", Width, Height);
+        for (int i = 0; i < Width * Height; i++) {
+            file << fmt::format(
+                "{} {} {} {}\n", v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f)),
+                v(v.uniform(0.f, 1.f)), v(v.uniform(0.f, 1.f))
+            );
+        }
+    }
+
+    void writeScalable(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        file << fmt::format(
+            "OPENMESH Version 1.1\nVERTICES {}\nFACES {}\nMAPPING NORMALIZED\n"
+            "PERSPECTIVE_LEFT -30.5\nPERSPECTIVE_RIGHT 30.5\nPERSPECTIVE_TOP 20\n"
+            "PERSPECTIVE_BOTTOM -20\nNATIVEXRES 1920\nNATIVEYRES 1200\n",
+            Width * Height, (Width - 1) * (Height - 1) * 2
+        );
+        for (int y = 0; y < Height; y++) {
+            for (int x = 0; x < Width; x++) {
+                file << fmt::format(
+                    "{} {} {} {} {}\n",
+                    v(x * 1920.f / Width), v(y * 1200.f / Height),
+                    static_cast<int>(v.uniform(0.f, 255.f)), v(v.uniform(0.f, 1.f)),
+                    v(v.uniform(0.f, 1.f))
+                );
+            }
+        }
+        for (int y = 0; y < Height - 1; y++) {
+            for (int x = 0; x < Width - 1; x++) {
+                const int i = y * Width + x;
+                file << fmt::format(
+                    "[ {0} {1} {2} ]\n[ {0} {2} {3} ]\n",
+                    i, i + 1, i + Width + 1, i + Width
+                );
+            }
+        }
+    }
+
+    void writeSimCAD(const std::filesystem::path& path) {
+        ValueWriter v;
+        std::ofstream file(path);
+        file << "<?xml version=\"1.0\"?>\n<GeometryFile><GeometryDefinition>\n";
+        for (const char* axis : { "X", "Y" }) {
+            file << fmt::format("<{}-FlatParameters range=\"100\">", axis);
+            for (int i = 0; i < Width * Width; i++) {
+                file << v(v.uniform(-1.f, 1.f)) << ' ';
+            }
+            file << fmt::format("</{}-FlatParameters>\n", axis);
+        }
+        file << "</GeometryDefinition></GeometryFile>\n";
+    }
+
+    sgct::correction::Buffer load(const std::string& path, const sgct::Viewport& vp) {
+        using namespace sgct::correction;
+        const std::string ext = path.substr(path.rfind('.') + 1);
+        if (ext == "obj") {
+            return generateOBJMesh(path);
+        }
+        else if (ext == "data") {
+            return generatePaulBourkeMesh(path, Position, Size, AspectRatio);
+        }
+        else if (ext == "csv") {
+            return generateDomeProjectionMesh(path, Position, Size);
+        }
+        else if (ext == "skyskan" || ext == "txt") {
+            return generateSkySkanMesh(path, vp);
+        }
+        else if (ext == "ol") {
+            return generateScalableMesh(path, vp);
+        }
+        else if (ext == "simcad") {
+            return generateSimCADMesh(path, Position, Size);
+        }
+        throw std::runtime_error(fmt::format("Unsupported mesh format '{}'", ext));
+    }
+
+    // 64 bit FNV-1a over the raw bytes of the buffer
+    uint64_t hash(const sgct::correction::Buffer& buf) {
+        uint64_t res = 14695981039346656037ull;
+        auto add = [&res](const void* data, size_t size) {
+            const unsigned char* d = reinterpret_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                res = (res ^ d[i]) * 1099511628211ull;
+            }
+        };
+        add(&buf.geometryType, sizeof(buf.geometryType));
+        add(
+            buf.vertices.data(),
+            buf.vertices.size() * sizeof(sgct::correction::CorrectionMeshVertex)
+        );
+        add(buf.indices.data(), buf.indices.size() * sizeof(unsigned int));
+        return res;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const int nIterations = argc > 1 ? std::max(std::stoi(argv[1]), 1) : 5;
+
+    // The meshes that depend on the viewport only use its position and size
+    sgct::ClusterManager::create(sgct::config::Cluster(), 0);
+    sgct::Viewport viewport(nullptr);
+    viewport.setPos(Position);
+    viewport.setSize(Size);
+
+    std::vector<std::string> paths;
+    std::vector<std::filesystem::path> generated;
+    if (argc > 2) {
+        paths.assign(argv + 2, argv + argc);
+    }
+    else {
+        using Writer = std::function<void(const std::filesystem::path&)>;
+        const std::vector<std::pair<std::string, Writer>> writers = {
+            { "obj", writeObj },
+            { "data", writePaulBourke },
+            { "csv", writeDomeProjection },
+            { "skyskan", writeSkySkan },
+            { "ol", writeScalable },
+            { "simcad", writeSimCAD }
+        };
+        for (const auto& [ext, writer] : writers) {
+            std::filesystem::path path =
+                std::filesystem::temp_directory_path() / ("sgct-benchmark." + ext);
+            writer(path);
+            paths.push_back(path.string());
+            generated.push_back(std::move(path));
+        }
+    }
+
+    fmt::print("{:>24} {:>9} {:>9} {:>9} {:>10} {:>10} {:>8} {:>16}\n",
+        "file", "MB", "vertices", "indices", "min (ms)", "avg (ms)", "MB/s", "hash");
+    for (const std::string& path : paths) {
+        try {
+            const double nMegaBytes =
+                static_cast<double>(std::filesystem::file_size(path)) / (1024 * 1024);
+
+            sgct::correction::Buffer buf;
+            double min = std::numeric_limits<double>::max();
+            double sum = 0.0;
+            for (int i = 0; i < nIterations; i++) {
+                using Clock = std::chrono::steady_clock;
+                const Clock::time_point start = Clock::now();
+                buf = load(path, viewport);
+                const std::chrono::duration<double, std::milli> t = Clock::now() - start;
+                min = std::min(min, t.count());
+                sum += t.count();
+            }
+
+            fmt::print(
+                "{:>24} {:>9.2f} {:>9} {:>9} {:>10.2f} {:>10.2f} {:>8.1f} {:>16x}\n",
+                std::filesystem::path(path).filename().string(),
+                nMegaBytes,
+                buf.vertices.size(),
+                buf.indices.size(),
+                min,
+                sum / nIterations,
+                nMegaBytes / (min / 1000.0),
+                hash(buf)
+            );
+        }
+        catch (const std::exception& e) {
+            const std::string name = std::filesystem::path(path).filename().string();
+            fmt::print("{:>24} {}\n", name, e.what());
+        }
+    }
+
+    for (const std::filesystem::path& path : generated) {
+        std::filesystem::remove(path);
+    }
+    sgct::ClusterManager::destroy();
+    return 0;
+}
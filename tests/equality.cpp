@@ -82,7 +82,18 @@ bool operator==(const Capture& lhs, const Capture& rhs) {
     return
         lhs.path == rhs.path &&
         lhs.format == rhs.format &&
-        lhs.range == rhs.range;
+        lhs.range == rhs.range &&
+        lhs.queueSize == rhs.queueSize &&
+        lhs.queuePolicy == rhs.queuePolicy &&
+        lhs.fastEncoding == rhs.fastEncoding;
+}
+
+bool operator==(const Multicast& lhs, const Multicast& rhs) {
+    return
+        lhs.address == rhs.address &&
+        lhs.port == rhs.port &&
+        lhs.ttl == rhs.ttl &&
+        lhs.interfaceAddress == rhs.interfaceAddress;
 }
 
 bool operator==(const Scene& lhs, const Scene& rhs) {
@@ -102,7 +113,12 @@ bool operator==(const Settings& lhs, const Settings& rhs) {
         lhs.useNormalTexture == rhs.useNormalTexture &&
         lhs.usePositionTexture == rhs.usePositionTexture &&
         lhs.bufferFloatPrecision == rhs.bufferFloatPrecision &&
-        lhs.display == rhs.display;
+        lhs.display == rhs.display &&
+        lhs.textureCachePath == rhs.textureCachePath &&
+        lhs.textureUploadBudget == rhs.textureUploadBudget &&
+        lhs.frameTracePath == rhs.frameTracePath &&
+        lhs.meshCachePath == rhs.meshCachePath &&
+        lhs.meshSimplificationError == rhs.meshSimplificationError;
 }
 
 bool operator==(const Device::Sensors& lhs, const Device::Sensors& rhs) {
@@ -124,7 +140,8 @@ bool operator==(const Device& lhs, const Device& rhs) {
         lhs.buttons == rhs.buttons &&
         lhs.axes == rhs.axes &&
         lhs.offset == rhs.offset &&
-        lhs.transformation == rhs.transformation;
+        lhs.transformation == rhs.transformation &&
+        lhs.predictionLatency == rhs.predictionLatency;
 }
 
 bool operator==(const Tracker& lhs, const Tracker& rhs) {
@@ -297,6 +314,7 @@ bool operator==(const Window& lhs, const Window& rhs) {
         lhs.blitWindowId == rhs.blitWindowId &&
         lhs.monitor == rhs.monitor &&
         lhs.mpcdi == rhs.mpcdi &&
+        lhs.mpcdiBuffer == rhs.mpcdiBuffer &&
         lhs.stereo == rhs.stereo &&
         lhs.pos == rhs.pos &&
         lhs.size == rhs.size &&
@@ -321,6 +339,15 @@ bool operator==(const Cluster& lhs, const Cluster& rhs) {
         lhs.setThreadAffinity == rhs.setThreadAffinity &&
         lhs.externalControlPort == rhs.externalControlPort &&
         lhs.firmSync == rhs.firmSync &&
+        lhs.deltaSync == rhs.deltaSync &&
+        lhs.deltaSyncKeyframeInterval == rhs.deltaSyncKeyframeInterval &&
+        lhs.compression == rhs.compression &&
+        lhs.compressionThreshold == rhs.compressionThreshold &&
+        lhs.networkReactor == rhs.networkReactor &&
+        lhs.frameLockSpinTime == rhs.frameLockSpinTime &&
+        lhs.pipelinedSync == rhs.pipelinedSync &&
+        lhs.frameTimestamps == rhs.frameTimestamps &&
+        lhs.multicast == rhs.multicast &&
         lhs.scene == rhs.scene &&
         lhs.nodes == rhs.nodes &&
         lhs.users == rhs.users &&
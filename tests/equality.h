@@ -28,6 +28,7 @@ bool operator==(const User::Tracking& lhs, const User::Tracking& rhs);
 bool operator==(const User& lhs, const User& rhs);
 bool operator==(const Capture::ScreenShotRange& lhs, const Capture::ScreenShotRange& rhs);
 bool operator==(const Capture& lhs, const Capture& rhs);
+bool operator==(const Multicast& lhs, const Multicast& rhs);
 bool operator==(const Scene& lhs, const Scene& rhs);
 bool operator==(const Settings::Display& lhs, const Settings::Display& rhs);
 bool operator==(const Settings& lhs, const Settings& rhs);
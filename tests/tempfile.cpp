@@ -0,0 +1,54 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "tempfile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+namespace {
+    class TempDirectory {
+    public:
+        TempDirectory() {
+            // A random name instead of the process id as that is also unique between
+            // the containers or machines that share a temporary directory
+            std::random_device device;
+            std::mt19937_64 random((static_cast<uint64_t>(device()) << 32) | device());
+            const std::filesystem::path base = std::filesystem::temp_directory_path();
+            for (int i = 0; i < 100; i++) {
+                const std::filesystem::path path =
+                    base / ("sgct-test-" + std::to_string(random()));
+                // Fails if the directory exists already, in which case we try again
+                if (std::filesystem::create_directory(path)) {
+                    _path = path;
+                    return;
+                }
+            }
+            throw std::runtime_error("Could not create temporary directory");
+        }
+
+        ~TempDirectory() {
+            std::error_code ec;
+            std::filesystem::remove_all(_path, ec);
+        }
+
+        const std::filesystem::path& path() const {
+            return _path;
+        }
+
+    private:
+        std::filesystem::path _path;
+    };
+} // namespace
+
+std::string tempFile(const std::string& name) {
+    static const TempDirectory Directory;
+    return (Directory.path() / name).string();
+}
@@ -0,0 +1,18 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include <string>
+
+/**
+ * \return the path of the file \p name in a directory that belongs to this run of the
+ *         tests only, so that tests that are run in parallel or by different users don't
+ *         overwrite each other's files. The directory is created in the system's
+ *         temporary directory on first use and removed with all its files when the tests
+ *         end
+ */
+std::string tempFile(const std::string& name);
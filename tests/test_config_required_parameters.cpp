@@ -35,6 +35,42 @@ TEST_CASE("Parse Required: Cluster/Master Address", "[parse]") {
     );
 }
 
+TEST_CASE("Parse Required: Multicast/Address", "[parse]") {
+    constexpr const char Sources[] = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "port": 20500
+  }
+}
+)";
+    CHECK_THROWS_MATCHES(
+        sgct::readJsonConfig(Sources),
+        std::runtime_error,
+        Catch::Matchers::Message(
+            "[ReadConfig] (6091): Missing field address in multicast"
+        )
+    );
+}
+
+TEST_CASE("Parse Required: Multicast/Port", "[parse]") {
+    constexpr const char Sources[] = R"(
+{
+  "version": 1,
+  "masteraddress": "localhost",
+  "multicast": {
+    "address": "239.255.0.1"
+  }
+}
+)";
+    CHECK_THROWS_MATCHES(
+        sgct::readJsonConfig(Sources),
+        std::runtime_error,
+        Catch::Matchers::Message("[ReadConfig] (6092): Missing field port in multicast")
+    );
+}
+
 TEST_CASE("Parse Required: Node/Address", "[parse]") {
     constexpr const char Sources[] = R"(
 {
@@ -149,6 +149,272 @@ TEST_CASE("Cluster/FirmSync", "[roundtrip]") {
     }
 }
 
+TEST_CASE("Cluster/DeltaSync", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSync = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSync = false;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSync = true;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/DeltaSyncKeyframeInterval", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSyncKeyframeInterval = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSyncKeyframeInterval = 1;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.deltaSyncKeyframeInterval = 120;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/Compression", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compression = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compression = sgct::config::Cluster::Compression::None;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compression = sgct::config::Cluster::Compression::Fast;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compression = sgct::config::Cluster::Compression::High;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/CompressionThreshold", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compressionThreshold = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compressionThreshold = 0;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.compressionThreshold = 4096;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/NetworkReactor", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.networkReactor = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.networkReactor = false;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.networkReactor = true;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/FrameLockSpinTime", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameLockSpinTime = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameLockSpinTime = 0;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameLockSpinTime = 250;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/PipelinedSync", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.pipelinedSync = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.pipelinedSync = false;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.pipelinedSync = true;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Cluster/FrameTimestamps", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameTimestamps = std::nullopt;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameTimestamps = false;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+        input.frameTimestamps = true;
+        
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
 TEST_CASE("Scene", "[roundtrip]") {
     {
         sgct::config::Cluster input;
@@ -1666,6 +1932,25 @@ TEST_CASE("Window/MPCDI", "[roundtrip]") {
         sgct::config::Cluster output = sgct::readJsonConfig(str);
         REQUIRE(input == output);
     }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        sgct::config::Node node;
+        node.address = "abc";
+        node.port = 1;
+
+        sgct::config::Window window;
+        window.mpcdi = std::filesystem::absolute("def").string();
+        window.mpcdiBuffer = "Buffer 1";
+        node.windows.push_back(window);
+        input.nodes.push_back(node);
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
 }
 
 TEST_CASE("Window/Stereo", "[roundtrip]") {
@@ -6444,12 +6729,12 @@ TEST_CASE("User/Tracking", "[roundtrip]") {
     }
 }
 
-TEST_CASE("Capture", "[roundtrip]") {
+TEST_CASE("Multicast", "[roundtrip]") {
     {
         sgct::config::Cluster input;
         input.success = true;
 
-        input.capture = std::nullopt;
+        input.multicast = std::nullopt;
 
         std::string str = sgct::serializeConfig(input);
         sgct::config::Cluster output = sgct::readJsonConfig(str);
@@ -6460,7 +6745,9 @@ TEST_CASE("Capture", "[roundtrip]") {
         sgct::config::Cluster input;
         input.success = true;
 
-        input.capture = sgct::config::Capture();
+        input.multicast = sgct::config::Multicast();
+        input.multicast->address = "239.255.0.1";
+        input.multicast->port = 20500;
 
         std::string str = sgct::serializeConfig(input);
         sgct::config::Cluster output = sgct::readJsonConfig(str);
@@ -6468,12 +6755,96 @@ TEST_CASE("Capture", "[roundtrip]") {
     }
 }
 
-TEST_CASE("Capture/Path", "[roundtrip]") {
+TEST_CASE("Multicast/TTL", "[roundtrip]") {
     {
         sgct::config::Cluster input;
         input.success = true;
 
-        input.capture = sgct::config::Capture();
+        input.multicast = sgct::config::Multicast();
+        input.multicast->address = "239.255.0.1";
+        input.multicast->port = 20500;
+        input.multicast->ttl = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.multicast = sgct::config::Multicast();
+        input.multicast->address = "239.255.0.1";
+        input.multicast->port = 20500;
+        input.multicast->ttl = 4;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Multicast/Interface", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.multicast = sgct::config::Multicast();
+        input.multicast->address = "239.255.0.1";
+        input.multicast->port = 20500;
+        input.multicast->interfaceAddress = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.multicast = sgct::config::Multicast();
+        input.multicast->address = "239.255.0.1";
+        input.multicast->port = 20500;
+        input.multicast->interfaceAddress = "127.0.0.1";
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Capture", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Capture/Path", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
         input.capture->path = std::nullopt;
 
         std::string str = sgct::serializeConfig(input);
@@ -6554,6 +6925,30 @@ TEST_CASE("Capture/Format", "[roundtrip]") {
         sgct::config::Cluster output = sgct::readJsonConfig(str);
         REQUIRE(input == output);
     }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->format = sgct::config::Capture::Format::EXR;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->format = sgct::config::Capture::Format::RAW;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
 }
 
 TEST_CASE("Capture/ScreenShotRange", "[roundtrip]") {
@@ -6594,6 +6989,135 @@ TEST_CASE("Capture/ScreenShotRange", "[roundtrip]") {
     }
 }
 
+TEST_CASE("Capture/QueueSize", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queueSize = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queueSize = 1;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queueSize = 16;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Capture/QueuePolicy", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queuePolicy = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queuePolicy =
+            sgct::config::Capture::QueuePolicy::Block;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queuePolicy =
+            sgct::config::Capture::QueuePolicy::DropOldest;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->queuePolicy =
+            sgct::config::Capture::QueuePolicy::DropNewest;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Capture/FastEncoding", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->fastEncoding = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->fastEncoding = true;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.capture = sgct::config::Capture();
+        input.capture->fastEncoding = false;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
 TEST_CASE("Tracker", "[roundtrip]") {
     {
         sgct::config::Cluster input;
@@ -7006,6 +7530,53 @@ TEST_CASE("Tracker/Device/Transformation", "[roundtrip]") {
     }
 }
 
+TEST_CASE("Tracker/Device/PredictionLatency", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        sgct::config::Tracker tracker;
+        sgct::config::Device device;
+        device.predictionLatency = std::nullopt;
+        tracker.devices.push_back(device);
+        input.trackers.push_back(tracker);
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        sgct::config::Tracker tracker;
+        sgct::config::Device device;
+        device.predictionLatency = 0.0;
+        tracker.devices.push_back(device);
+        input.trackers.push_back(tracker);
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        sgct::config::Tracker tracker;
+        sgct::config::Device device;
+        device.predictionLatency = 0.025;
+        tracker.devices.push_back(device);
+        input.trackers.push_back(tracker);
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
 TEST_CASE("Tracker/Offset", "[roundtrip]") {
     {
         sgct::config::Cluster input;
@@ -7416,3 +7987,133 @@ TEST_CASE("Settings/Display", "[roundtrip]") {
         REQUIRE(input == output);
     }
 }
+
+TEST_CASE("Settings/TextureCachePath", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->textureCachePath = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->textureCachePath = "abc";
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Settings/TextureUploadBudget", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->textureUploadBudget = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->textureUploadBudget = 1048576;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Settings/FrameTracePath", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->frameTracePath = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->frameTracePath = "traces";
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Settings/MeshCachePath", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->meshCachePath = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->meshCachePath = "meshcache";
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
+
+TEST_CASE("Settings/MeshSimplificationError", "[roundtrip]") {
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->meshSimplificationError = std::nullopt;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+
+    {
+        sgct::config::Cluster input;
+        input.success = true;
+
+        input.settings = sgct::config::Settings();
+        input.settings->meshSimplificationError = 0.0005f;
+
+        std::string str = sgct::serializeConfig(input);
+        sgct::config::Cluster output = sgct::readJsonConfig(str);
+        REQUIRE(input == output);
+    }
+}
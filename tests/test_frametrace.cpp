@@ -0,0 +1,168 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/engine.h>
+#include <sgct/error.h>
+#include <sgct/frametrace.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+using namespace sgct;
+
+namespace {
+    frametrace::Record createRecord(int frame) {
+        frametrace::Record record;
+        record.frame = frame;
+        record.encodeSize = 100 + frame;
+        record.frameTime = 0.016 + frame * 1e-6;
+        record.drawTime = 0.005;
+        record.encode = 10.0 + frame;
+        record.send = 10.001 + frame;
+        record.swapEnd = 10.015 + frame;
+        record.clockOffset = -0.25;
+        return record;
+    }
+
+    bool isEqual(const frametrace::Record& lhs, const frametrace::Record& rhs) {
+        return std::memcmp(&lhs, &rhs, sizeof(frametrace::Record)) == 0;
+    }
+} // namespace
+
+TEST_CASE("Statistics/History Order", "[statistics]") {
+    Engine::Statistics::History history;
+    CHECK(history.front() == 0.0);
+
+    history.add(1.0);
+    history.add(2.0);
+    history.add(3.0);
+    CHECK(history.front() == 3.0);
+    CHECK(history[0] == 3.0);
+    CHECK(history[1] == 2.0);
+    CHECK(history[2] == 1.0);
+    CHECK(history[3] == 0.0);
+}
+
+TEST_CASE("Statistics/History Wrap Around", "[statistics]") {
+    constexpr int Length = Engine::Statistics::HistoryLength;
+    Engine::Statistics::History history;
+
+    // Once the history is full, every new value replaces the oldest one
+    for (int i = 1; i <= Length + 10; i++) {
+        history.add(static_cast<double>(i));
+    }
+    CHECK(history.front() == Length + 10);
+    for (int i = 0; i < Length; i++) {
+        CHECK(history[i] == Length + 10 - i);
+    }
+
+    // The iterators cover exactly the values that are in the history
+    const double sum = std::accumulate(history.begin(), history.end(), 0.0);
+    CHECK(sum == (11.0 + Length + 10) * Length / 2.0);
+}
+
+TEST_CASE("Statistics/Frame Times", "[statistics]") {
+    Engine::Statistics stats;
+    stats.frametimes.add(0.010);
+    stats.frametimes.add(0.030);
+    stats.frametimes.add(0.020);
+    CHECK(stats.dt() == 0.020);
+    CHECK(stats.maxDt() == 0.030);
+
+    // The values that have not been filled yet are not part of the average
+    CHECK(stats.avgDt(3) == Approx(0.020));
+}
+
+TEST_CASE("FrameTrace/Roundtrip", "[frametrace]") {
+    const std::string file = tempFile("roundtrip.sgcttrace");
+    {
+        FrameTraceWriter writer(file, 2, false, "192.168.0.2");
+        CHECK(writer.path() == file);
+        for (int i = 0; i < 5; i++) {
+            writer.write(createRecord(i));
+        }
+    }
+
+    {
+        FrameTraceReader reader(file);
+        const frametrace::FileHeader& header = reader.header();
+        CHECK(header.magic == frametrace::Magic);
+        CHECK(header.version == frametrace::Version);
+        CHECK(header.recordSize == sizeof(frametrace::Record));
+        CHECK(header.nodeIndex == 2);
+        CHECK(header.isMaster == 0);
+        CHECK(std::string(header.nodeAddress.data()) == "192.168.0.2");
+
+        REQUIRE(reader.records().size() == 5);
+        for (int i = 0; i < 5; i++) {
+            CHECK(isEqual(reader.records()[i], createRecord(i)));
+        }
+    }
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("FrameTrace/Long Address", "[frametrace]") {
+    const std::string file = tempFile("address.sgcttrace");
+    const std::string address(100, 'a');
+    {
+        FrameTraceWriter writer(file, 0, true, address);
+    }
+
+    // The address is cut off to fit into the header and stays null terminated
+    FrameTraceReader reader(file);
+    CHECK(reader.header().isMaster == 1);
+    const std::string stored = reader.header().nodeAddress.data();
+    CHECK(stored == address.substr(0, reader.header().nodeAddress.size() - 1));
+    CHECK(reader.records().empty());
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("FrameTrace/Partial Record", "[frametrace]") {
+    const std::string file = tempFile("partial.sgcttrace");
+    {
+        FrameTraceWriter writer(file, 1, false, "node");
+        writer.write(createRecord(0));
+        writer.write(createRecord(1));
+    }
+
+    // A crashed application can leave a record that was only written in parts
+    std::filesystem::resize_file(
+        file,
+        sizeof(frametrace::FileHeader) + sizeof(frametrace::Record) + 20
+    );
+    FrameTraceReader reader(file);
+    REQUIRE(reader.records().size() == 1);
+    CHECK(isEqual(reader.records()[0], createRecord(0)));
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("FrameTrace/Invalid Files", "[frametrace]") {
+    const std::string file = tempFile("invalid.sgcttrace");
+
+    CHECK_THROWS_AS(FrameTraceReader(tempFile("missing.sgcttrace")), Error);
+
+    {
+        std::ofstream f(file, std::ios::binary);
+        f << std::string(2 * sizeof(frametrace::FileHeader), 'x');
+    }
+    CHECK_THROWS_AS(FrameTraceReader(file), Error);
+
+    {
+        frametrace::FileHeader header;
+        header.version = frametrace::Version + 1;
+        std::ofstream f(file, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    CHECK_THROWS_AS(FrameTraceReader(file), Error);
+    std::filesystem::remove(file);
+}
@@ -0,0 +1,625 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/image.h>
+#include <stb_image.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+    sgct::Image createImage(sgct::ivec2 size, int nChannels, int bytesPerChannel) {
+        sgct::Image image;
+        image.setSize(size);
+        image.setChannels(nChannels);
+        image.setBytesPerChannel(bytesPerChannel);
+        image.allocateOrResizeData();
+
+        // Noise compresses badly, so large images really end up in several strips
+        uint32_t state = 12345;
+        const size_t nBytes =
+            static_cast<size_t>(size.x) * size.y * nChannels * bytesPerChannel;
+        for (size_t i = 0; i < nBytes; i++) {
+            state = state * 1664525 + 1013904223;
+            image.data()[i] = static_cast<unsigned char>(state >> 24);
+        }
+        return image;
+    }
+
+    /**
+     * Compares the \p image, which is stored as BGR(A) with the bottom row first, with
+     * the \p decoded pixels in the RGB(A) order with the top row first that stb_image
+     * and PNG files use
+     */
+    template <typename T>
+    bool isEqual(const sgct::Image& image, const T* decoded) {
+        const int w = image.size().x;
+        const int h = image.size().y;
+        const int c = image.channels();
+        const T* pixels = reinterpret_cast<const T*>(image.data());
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                const T* src = pixels + (static_cast<size_t>(h - 1 - y) * w + x) * c;
+                const T* dst = decoded + (static_cast<size_t>(y) * w + x) * c;
+                for (int i = 0; i < c; i++) {
+                    // The first and third channel are swapped for color images
+                    const int j = (c >= 3 && (i == 0 || i == 2)) ? 2 - i : i;
+                    if (src[j] != dst[i]) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // PNG files with the features that libpng has to expand to match stb_image, created
+    // with libpng from random pixels
+
+    // 9x5 image with a 16 color palette at 4 bits per pixel
+    constexpr unsigned char Palette4Bit[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x05,
+        0x04, 0x03, 0x00, 0x00, 0x00, 0x65, 0x7d, 0xdb, 0x58, 0x00, 0x00, 0x00,
+        0x30, 0x50, 0x4c, 0x54, 0x45, 0x6c, 0x4e, 0x74, 0x92, 0x13, 0x25, 0x22,
+        0x2e, 0x31, 0xa1, 0xcd, 0x13, 0xbe, 0x12, 0xed, 0x42, 0x69, 0x66, 0xce,
+        0x24, 0xfc, 0x23, 0xd7, 0xda, 0x8d, 0x20, 0x97, 0x61, 0x6a, 0x06, 0x95,
+        0x6e, 0xc2, 0x8a, 0xd4, 0x03, 0x13, 0x68, 0x28, 0xd4, 0x57, 0x1e, 0x3c,
+        0x5d, 0xee, 0x6e, 0x5e, 0xc0, 0x01, 0xad, 0xab, 0x00, 0x00, 0x00, 0x00,
+        0x27, 0x49, 0x44, 0x41, 0x54, 0x08, 0x99, 0x63, 0xf0, 0x9a, 0x28, 0x18,
+        0x1f, 0xcb, 0x60, 0x1d, 0x68, 0x77, 0x28, 0x98, 0x61, 0x89, 0xd8, 0xda,
+        0xbc, 0xa7, 0x0c, 0x16, 0x53, 0x04, 0x2f, 0x68, 0x30, 0xcc, 0x5a, 0xec,
+        0xf3, 0xf5, 0x00, 0x00, 0x95, 0x15, 0x0b, 0x55, 0x44, 0x21, 0x51, 0xf2,
+        0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    // 9x5 image with a 4 color palette at 2 bits per pixel and a tRNS chunk
+    constexpr unsigned char PaletteTransparency[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x05,
+        0x02, 0x03, 0x00, 0x00, 0x00, 0xea, 0x3d, 0x2e, 0xf8, 0x00, 0x00, 0x00,
+        0x0c, 0x50, 0x4c, 0x54, 0x45, 0x34, 0x7c, 0x59, 0xca, 0xf0, 0x84, 0x95,
+        0xf3, 0x61, 0x1b, 0x0b, 0x50, 0x64, 0x6d, 0xfd, 0x93, 0x00, 0x00, 0x00,
+        0x03, 0x74, 0x52, 0x4e, 0x53, 0x00, 0x80, 0xc8, 0x54, 0x4a, 0x16, 0x17,
+        0x00, 0x00, 0x00, 0x1d, 0x49, 0x44, 0x41, 0x54, 0x08, 0x99, 0x63, 0x38,
+        0xd3, 0xb3, 0x9f, 0xe1, 0xeb, 0xfe, 0x7d, 0x0c, 0x87, 0xb8, 0x6f, 0x33,
+        0xfc, 0xc8, 0x9e, 0xc3, 0xf0, 0xd4, 0xbf, 0x15, 0x00, 0x68, 0xd1, 0x09,
+        0xea, 0x82, 0x77, 0x9d, 0xe2, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e,
+        0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    // 11x6 grayscale image with 1 bit per pixel
+    constexpr unsigned char Gray1Bit[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x06,
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x3d, 0x49, 0x59, 0x55, 0x00, 0x00, 0x00,
+        0x1a, 0x49, 0x44, 0x41, 0x54, 0x08, 0x99, 0x63, 0xd8, 0xc6, 0xce, 0x70,
+        0xde, 0x8d, 0xe1, 0xa5, 0x17, 0x83, 0xb7, 0x16, 0xc3, 0xef, 0x2b, 0x0c,
+        0x4f, 0xfb, 0x01, 0x36, 0x6d, 0x06, 0xbe, 0x9a, 0xdd, 0x9a, 0x1d, 0x00,
+        0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    // 7x5 grayscale image with an alpha channel
+    constexpr unsigned char GrayAlpha[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x05,
+        0x08, 0x04, 0x00, 0x00, 0x00, 0x23, 0x93, 0x3e, 0x53, 0x00, 0x00, 0x00,
+        0x56, 0x49, 0x44, 0x41, 0x54, 0x08, 0x99, 0x01, 0x4b, 0x00, 0xb4, 0xff,
+        0x01, 0x4f, 0xe1, 0x0d, 0x30, 0xb6, 0x71, 0x06, 0x21, 0x13, 0x75, 0xcc,
+        0x5a, 0xe8, 0x1d, 0x03, 0xae, 0x0a, 0xaf, 0x16, 0xb2, 0x76, 0xf9, 0x71,
+        0x44, 0x00, 0x97, 0x45, 0x00, 0x49, 0x03, 0x21, 0xa9, 0xeb, 0xb9, 0xf1,
+        0xff, 0x90, 0xb7, 0xbd, 0xb2, 0xf5, 0x2b, 0x7d, 0x01, 0x01, 0xd8, 0x5e,
+        0xb8, 0x10, 0x1d, 0xae, 0x2c, 0x8f, 0x11, 0xf3, 0xe9, 0x3c, 0xb5, 0xbe,
+        0x01, 0xdb, 0xe0, 0x28, 0xe1, 0x3f, 0xbd, 0xa9, 0xf4, 0xcd, 0xdb, 0x74,
+        0xb6, 0x4b, 0x78, 0xc2, 0x15, 0x23, 0xb4, 0x3c, 0xf3, 0x0c, 0xe5, 0x00,
+        0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    // 7x5 RGB image with a transparent color key in a tRNS chunk
+    constexpr unsigned char RGBColorKey[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x05,
+        0x08, 0x02, 0x00, 0x00, 0x00, 0x06, 0xf8, 0x61, 0x8f, 0x00, 0x00, 0x00,
+        0x06, 0x74, 0x52, 0x4e, 0x53, 0x00, 0x03, 0x00, 0x05, 0x00, 0x07, 0xb1,
+        0xa9, 0x2a, 0x09, 0x00, 0x00, 0x00, 0x48, 0x49, 0x44, 0x41, 0x54, 0x08,
+        0x99, 0x05, 0xc1, 0x01, 0x12, 0x80, 0x00, 0x08, 0x02, 0x30, 0x01, 0xad,
+        0xff, 0x7f, 0xb7, 0x43, 0x69, 0x43, 0xcd, 0x2b, 0x17, 0xe6, 0x3b, 0x53,
+        0x00, 0x95, 0x0a, 0x01, 0x74, 0x61, 0x89, 0x21, 0x6f, 0x01, 0x5c, 0xd6,
+        0x61, 0x49, 0x68, 0x71, 0xe1, 0xec, 0x7d, 0x4c, 0xb1, 0xdf, 0x48, 0x44,
+        0xbb, 0x50, 0xb9, 0x99, 0x47, 0x8e, 0x21, 0x80, 0x7d, 0x32, 0xd7, 0xa3,
+        0x67, 0xcf, 0xd7, 0x37, 0x81, 0xf9, 0x03, 0x7b, 0x79, 0x27, 0x41, 0x26,
+        0xc6, 0xbc, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae,
+        0x42, 0x60, 0x82,
+    };
+
+    // 13x9 RGBA image with Adam7 interlacing
+    constexpr unsigned char RGBAInterlaced[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+        0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x09,
+        0x08, 0x06, 0x00, 0x00, 0x01, 0x9e, 0x7d, 0x96, 0xfc, 0x00, 0x00, 0x01,
+        0xf2, 0x49, 0x44, 0x41, 0x54, 0x18, 0x95, 0x01, 0xe7, 0x01, 0x18, 0xfe,
+        0x03, 0xc7, 0x03, 0xc1, 0xec, 0xf0, 0x7d, 0x35, 0xa1, 0x02, 0x71, 0x3b,
+        0xcd, 0xdb, 0x0d, 0x92, 0xf2, 0xe4, 0x03, 0x50, 0xcb, 0x02, 0xa5, 0xd6,
+        0xba, 0xc2, 0x2b, 0x00, 0xcc, 0xab, 0x66, 0x26, 0xa3, 0xf1, 0xb8, 0x02,
+        0x03, 0x9c, 0x49, 0xf5, 0xbd, 0xd9, 0x42, 0x17, 0xf2, 0xfc, 0xe1, 0x54,
+        0xf2, 0x3c, 0x0e, 0xce, 0x0a, 0x01, 0x6e, 0x37, 0xbe, 0x45, 0xfc, 0x09,
+        0xdd, 0x5b, 0x55, 0x1d, 0xdc, 0x19, 0x03, 0x3d, 0x93, 0x09, 0x0e, 0x9c,
+        0xf0, 0x16, 0x83, 0xda, 0x5a, 0xb8, 0xf1, 0x02, 0xd7, 0x0c, 0xc8, 0x44,
+        0x5b, 0x18, 0xd8, 0xf8, 0xe0, 0x6a, 0x24, 0xca, 0x03, 0xfd, 0x98, 0x26,
+        0xe3, 0xb3, 0x1a, 0x3a, 0x02, 0xda, 0xb5, 0x1e, 0x8e, 0xb1, 0xa4, 0xc5,
+        0xed, 0xc6, 0xd1, 0x19, 0x23, 0x38, 0x1c, 0x3f, 0x1d, 0xf3, 0x17, 0x61,
+        0x69, 0x03, 0x18, 0xce, 0xdb, 0x31, 0x91, 0xb0, 0xdf, 0x56, 0x06, 0x98,
+        0x20, 0x8e, 0x53, 0xfa, 0x3c, 0x76, 0x33, 0x08, 0x79, 0x12, 0x1f, 0xb4,
+        0x64, 0x21, 0xd1, 0xb0, 0xc4, 0xa9, 0x01, 0x6f, 0x81, 0x7e, 0x27, 0x84,
+        0x0c, 0xfc, 0x88, 0x62, 0xb7, 0x42, 0xa6, 0x19, 0x66, 0xa5, 0x52, 0x08,
+        0x47, 0xe3, 0x92, 0x07, 0x02, 0x33, 0xf8, 0x02, 0x32, 0xfd, 0x2f, 0x0d,
+        0x22, 0xa9, 0x1b, 0xff, 0x2b, 0xf6, 0xc8, 0xad, 0xf9, 0x20, 0xc1, 0xb2,
+        0xb6, 0xe2, 0x10, 0x2c, 0x10, 0x79, 0x44, 0xb5, 0x01, 0x20, 0xc3, 0x23,
+        0x8d, 0x0a, 0xd7, 0x36, 0x7e, 0xd4, 0xd0, 0x18, 0x00, 0x52, 0xc5, 0xae,
+        0xc6, 0xdb, 0xe3, 0xb5, 0xdc, 0x50, 0xd5, 0x6a, 0xcc, 0x04, 0x74, 0x11,
+        0x24, 0x7b, 0xd0, 0x40, 0x3d, 0x8f, 0x11, 0x78, 0xa9, 0x27, 0xe4, 0xa1,
+        0x62, 0x89, 0x58, 0xf1, 0x06, 0x7e, 0x2f, 0x0b, 0x45, 0x01, 0x03, 0x75,
+        0xb7, 0xd8, 0x43, 0x01, 0x04, 0x54, 0x04, 0xbd, 0x0f, 0xfc, 0x9e, 0x3a,
+        0x14, 0x1a, 0x43, 0xfb, 0xc8, 0x54, 0xc8, 0x87, 0xdf, 0x4a, 0x01, 0x00,
+        0xf1, 0xba, 0xce, 0xbe, 0x7c, 0xf2, 0x79, 0x2a, 0x1d, 0xf9, 0x53, 0x9a,
+        0x42, 0x70, 0x92, 0xd1, 0xa6, 0x92, 0xd1, 0x8d, 0x71, 0x20, 0x87, 0x50,
+        0x0f, 0x10, 0x4b, 0xeb, 0xcc, 0xf5, 0xca, 0xcf, 0x34, 0x2d, 0x84, 0x13,
+        0x2d, 0xcc, 0x49, 0x45, 0xd0, 0x4c, 0x77, 0xf0, 0x0c, 0xf1, 0xf0, 0xf1,
+        0xf9, 0xfd, 0xdd, 0x7a, 0x03, 0xac, 0xfe, 0xcd, 0xc8, 0xc3, 0x58, 0x59,
+        0x9c, 0xcf, 0x95, 0xd6, 0xd1, 0xed, 0x86, 0x7c, 0xb7, 0x15, 0x5b, 0x1a,
+        0x5e, 0x15, 0x15, 0xea, 0x80, 0x3b, 0x25, 0x33, 0x95, 0xef, 0x91, 0xe1,
+        0xf4, 0x4c, 0x13, 0xad, 0x7b, 0xce, 0x30, 0x3c, 0xa9, 0xeb, 0x65, 0xb9,
+        0xbe, 0x2b, 0x40, 0xfa, 0x5a, 0x5a, 0xff, 0xa1, 0x23, 0x04, 0x62, 0x53,
+        0x91, 0xf7, 0x58, 0xd1, 0x83, 0x4f, 0x85, 0x83, 0xc6, 0xfb, 0x05, 0xed,
+        0xe8, 0xf3, 0x05, 0xfd, 0xa2, 0x6a, 0xd0, 0xdc, 0xdf, 0xe5, 0x29, 0x4f,
+        0x4c, 0x64, 0x69, 0x21, 0xbb, 0xef, 0xf6, 0x63, 0xad, 0x23, 0x5b, 0xc1,
+        0xef, 0x21, 0xe7, 0x1d, 0x5c, 0xa1, 0xe2, 0xd0, 0x06, 0x54, 0x92, 0xf7,
+        0x3f, 0xf0, 0x00, 0x85, 0x5c, 0xf0, 0xe0, 0xe5, 0xee, 0x39, 0x64, 0xa8,
+        0xca, 0x52, 0x7e, 0x63, 0x1b, 0x69, 0xc2, 0xbe, 0xcf, 0x17, 0x23, 0x13,
+        0x03, 0x5f, 0x41, 0xcc, 0x2d, 0x67, 0x76, 0x79, 0x0b, 0xf4, 0x9f, 0xb4,
+        0x4f, 0xa7, 0xaa, 0xb5, 0x07, 0xf9, 0xe4, 0xb4, 0xce, 0xf8, 0x00, 0x02,
+        0xb4, 0xbf, 0xe6, 0xe5, 0xee, 0xb6, 0x41, 0xf0, 0x9f, 0xf0, 0x33, 0x84,
+        0x07, 0x18, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae,
+        0x42, 0x60, 0x82,
+    };
+
+    // An image with smoothly changing values that compresses well
+    sgct::Image createGradient(sgct::ivec2 size, int nChannels, int bytesPerChannel) {
+        sgct::Image image;
+        image.setSize(size);
+        image.setChannels(nChannels);
+        image.setBytesPerChannel(bytesPerChannel);
+        image.setFloatingPoint(true);
+        image.allocateOrResizeData();
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                for (int c = 0; c < nChannels; c++) {
+                    const size_t i =
+                        (static_cast<size_t>(y) * size.x + x) * nChannels + c;
+                    unsigned char* dst = image.data() + i * bytesPerChannel;
+                    if (bytesPerChannel == 2) {
+                        // Halfs between 0.5 and 1
+                        const uint16_t v = static_cast<uint16_t>(0x3800 + x + 4 * y + c);
+                        std::memcpy(dst, &v, sizeof(uint16_t));
+                    }
+                    else {
+                        const float v = static_cast<float>(x) / size.x + y + c;
+                        std::memcpy(dst, &v, sizeof(float));
+                    }
+                }
+            }
+        }
+        return image;
+    }
+
+    float halfToFloat(uint16_t half) {
+        const int exponent = (half >> 10) & 0x1F;
+        const float mantissa = static_cast<float>(half & 0x3FF);
+        const float sign = (half & 0x8000) ? -1.f : 1.f;
+        if (exponent == 0) {
+            return sign * std::ldexp(mantissa, -24);
+        }
+        return sign * std::ldexp(1024.f + mantissa, exponent - 25);
+    }
+
+    /// The channels of an OpenEXR file and their values, with the top row first
+    struct EXRFile {
+        sgct::ivec2 size = sgct::ivec2{ 0, 0 };
+        std::vector<std::string> channels;
+        std::vector<int> pixelTypes;
+        int compression = -1;
+        int nStoredBlocks = 0;
+        std::map<std::string, std::vector<unsigned char>> values;
+    };
+
+    /**
+     * Reads the single-part scanline OpenEXR file \p path with ZIP compression, which is
+     * all that Image::saveEXR writes, independent of the writer
+     */
+    EXRFile readEXR(const std::string& path) {
+        std::ifstream f(path, std::ios::binary);
+        const std::vector<unsigned char> file = std::vector<unsigned char>(
+            std::istreambuf_iterator<char>(f),
+            {}
+        );
+        auto int32 = [&file](size_t pos) {
+            REQUIRE(pos + 4 <= file.size());
+            int32_t v;
+            std::memcpy(&v, &file[pos], sizeof(int32_t));
+            return v;
+        };
+        auto string = [&file](size_t& pos) {
+            const std::string s = reinterpret_cast<const char*>(&file[pos]);
+            pos += s.size() + 1;
+            return s;
+        };
+
+        REQUIRE(file.size() > 8);
+        REQUIRE(int32(0) == 20000630);
+        // Version 2 without any flags, which is a single-part scanline file
+        REQUIRE(int32(4) == 2);
+
+        EXRFile res;
+        size_t pos = 8;
+        while (file[pos] != '\0') {
+            const std::string name = string(pos);
+            const std::string type = string(pos);
+            const size_t size = static_cast<size_t>(int32(pos));
+            pos += 4;
+            REQUIRE(pos + size <= file.size());
+            if (name == "channels") {
+                REQUIRE(type == "chlist");
+                size_t p = pos;
+                while (file[p] != '\0') {
+                    res.channels.push_back(string(p));
+                    res.pixelTypes.push_back(int32(p));
+                    CHECK(int32(p + 8) == 1); // xSampling
+                    CHECK(int32(p + 12) == 1); // ySampling
+                    p += 16;
+                }
+                CHECK(p + 1 == pos + size);
+            }
+            else if (name == "compression") {
+                REQUIRE(type == "compression");
+                res.compression = file[pos];
+            }
+            else if (name == "dataWindow") {
+                REQUIRE(type == "box2i");
+                CHECK(int32(pos) == 0);
+                CHECK(int32(pos + 4) == 0);
+                res.size.x = int32(pos + 8) + 1;
+                res.size.y = int32(pos + 12) + 1;
+            }
+            else if (name == "lineOrder") {
+                CHECK(file[pos] == 0);
+            }
+            pos += size;
+        }
+        pos++;
+        REQUIRE(res.compression == 3);
+        REQUIRE(!res.channels.empty());
+        REQUIRE(res.size.x > 0);
+        REQUIRE(res.size.y > 0);
+
+        // HALF values take 2 bytes, FLOAT values 4 bytes
+        std::vector<size_t> valueSizes;
+        size_t lineSize = 0;
+        for (int type : res.pixelTypes) {
+            REQUIRE((type == 1 || type == 2));
+            valueSizes.push_back(type == 1 ? 2 : 4);
+            lineSize += res.size.x * valueSizes.back();
+        }
+
+        // ZIP compression stores 16 lines per block
+        const int nBlocks = (res.size.y + 15) / 16;
+        std::vector<uint64_t> offsets(nBlocks);
+        REQUIRE(pos + nBlocks * sizeof(uint64_t) <= file.size());
+        std::memcpy(offsets.data(), &file[pos], nBlocks * sizeof(uint64_t));
+        pos += nBlocks * sizeof(uint64_t);
+
+        for (int i = 0; i < nBlocks; i++) {
+            // The blocks follow the table without any gaps
+            REQUIRE(offsets[i] == pos);
+            const int firstLine = int32(pos);
+            const size_t size = static_cast<size_t>(int32(pos + 4));
+            pos += 8;
+            REQUIRE(firstLine == i * 16);
+            REQUIRE(pos + size <= file.size());
+            const int nLines = std::min(16, res.size.y - firstLine);
+            const size_t rawSize = lineSize * nLines;
+
+            // Blocks that would not get smaller are stored without compression, all
+            // others are delta-encoded and split into even and odd bytes before zlib
+            std::vector<unsigned char> raw(rawSize);
+            if (size == rawSize) {
+                std::memcpy(raw.data(), &file[pos], rawSize);
+                res.nStoredBlocks++;
+            }
+            else {
+                REQUIRE(size < rawSize);
+                std::vector<unsigned char> predicted(rawSize);
+                uLongf length = static_cast<uLongf>(rawSize);
+                const int r = uncompress(
+                    predicted.data(),
+                    &length,
+                    &file[pos],
+                    static_cast<uLong>(size)
+                );
+                REQUIRE(r == Z_OK);
+                REQUIRE(length == rawSize);
+                for (size_t j = 1; j < rawSize; j++) {
+                    predicted[j] = static_cast<unsigned char>(
+                        predicted[j - 1] + predicted[j] - 128
+                    );
+                }
+                const size_t half = (rawSize + 1) / 2;
+                for (size_t j = 0; j < rawSize; j++) {
+                    raw[j] = predicted[(j % 2 == 0) ? j / 2 : half + j / 2];
+                }
+            }
+            pos += size;
+
+            const unsigned char* src = raw.data();
+            for (int l = 0; l < nLines; l++) {
+                for (size_t c = 0; c < res.channels.size(); c++) {
+                    const size_t n = res.size.x * valueSizes[c];
+                    std::vector<unsigned char>& values = res.values[res.channels[c]];
+                    values.insert(values.end(), src, src + n);
+                    src += n;
+                }
+            }
+        }
+        CHECK(pos == file.size());
+        return res;
+    }
+
+    /**
+     * Checks that the values of \p exr are the same as the floating point values of
+     * \p image, which stores the channels as BGR(A) with the bottom row first
+     */
+    void checkFloatingPointEXR(const sgct::Image& image, const EXRFile& exr) {
+        // The channels in alphabetical order and their offset in the image's pixels
+        const std::vector<std::pair<std::string, int>> channels = [](int n) {
+            switch (n) {
+                case 1: return std::vector<std::pair<std::string, int>>{ { "Y", 0 } };
+                case 2: return std::vector<std::pair<std::string, int>>{
+                    { "A", 1 }, { "Y", 0 }
+                };
+                case 3: return std::vector<std::pair<std::string, int>>{
+                    { "B", 0 }, { "G", 1 }, { "R", 2 }
+                };
+                default: return std::vector<std::pair<std::string, int>>{
+                    { "A", 3 }, { "B", 0 }, { "G", 1 }, { "R", 2 }
+                };
+            }
+        }(image.channels());
+
+        const int w = image.size().x;
+        const int h = image.size().y;
+        const int nChannels = image.channels();
+        const int bpc = image.bytesPerChannel();
+        REQUIRE(exr.size.x == w);
+        REQUIRE(exr.size.y == h);
+        REQUIRE(exr.channels.size() == channels.size());
+        for (size_t c = 0; c < channels.size(); c++) {
+            CHECK(exr.channels[c] == channels[c].first);
+            CHECK(exr.pixelTypes[c] == (bpc == 2 ? 1 : 2));
+
+            const std::vector<unsigned char>& values = exr.values.at(channels[c].first);
+            REQUIRE(values.size() == static_cast<size_t>(w) * h * bpc);
+            bool isEqual = true;
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    const size_t i = (static_cast<size_t>(h - 1 - y) * w + x) *
+                        nChannels + channels[c].second;
+                    const size_t j = static_cast<size_t>(y) * w + x;
+                    isEqual &= std::memcmp(
+                        image.data() + i * bpc,
+                        values.data() + j * bpc,
+                        bpc
+                    ) == 0;
+                }
+            }
+            CHECK(isEqual);
+        }
+    }
+
+    /**
+     * Decodes the PNG file in \p data with both Image::load, which uses libpng, and
+     * stb_image and returns whether the results are the same
+     */
+    bool decodesLikeStb(const unsigned char* data, int length) {
+        sgct::Image image;
+        image.load(data, length);
+
+        int w = 0;
+        int h = 0;
+        int c = 0;
+        // Image::load flips the images of stb_image, which is a global setting
+        stbi_set_flip_vertically_on_load(0);
+        unsigned char* decoded = stbi_load_from_memory(data, length, &w, &h, &c, 0);
+        if (!decoded) {
+            return false;
+        }
+        const bool res = image.size().x == w && image.size().y == h &&
+            image.channels() == c && isEqual(image, decoded);
+        stbi_image_free(decoded);
+        return res;
+    }
+} // namespace
+
+TEST_CASE("Image/PNG Roundtrip Multiple Strips", "[image]") {
+    // Large enough to be split into several strips of 4 MB
+    sgct::Image image = createImage(sgct::ivec2{ 2048, 1536 }, 4, 1);
+    const std::string file = tempFile("strips.png");
+    image.save(file);
+
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    unsigned char* decoded = stbi_load(file.c_str(), &w, &h, &c, 0);
+    REQUIRE(decoded);
+    CHECK(w == 2048);
+    CHECK(h == 1536);
+    CHECK(c == 4);
+    CHECK(isEqual(image, decoded));
+    stbi_image_free(decoded);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Image/PNG Roundtrip Channels", "[image]") {
+    for (int nChannels = 1; nChannels <= 4; nChannels++) {
+        sgct::Image image = createImage(sgct::ivec2{ 33, 17 }, nChannels, 1);
+        const std::string file = tempFile("channels.png");
+        image.save(file, sgct::Image::Compression::Fast);
+
+        int w = 0;
+        int h = 0;
+        int c = 0;
+        unsigned char* decoded = stbi_load(file.c_str(), &w, &h, &c, 0);
+        REQUIRE(decoded);
+        CHECK(w == 33);
+        CHECK(h == 17);
+        CHECK(c == nChannels);
+        CHECK(isEqual(image, decoded));
+        stbi_image_free(decoded);
+        std::filesystem::remove(file);
+    }
+}
+
+TEST_CASE("Image/PNG Roundtrip 16 Bit", "[image]") {
+    sgct::Image image = createImage(sgct::ivec2{ 64, 48 }, 3, 2);
+    const std::string file = tempFile("16bit.png");
+    image.save(file);
+
+    int w = 0;
+    int h = 0;
+    int c = 0;
+    uint16_t* decoded = stbi_load_16(file.c_str(), &w, &h, &c, 0);
+    REQUIRE(decoded);
+    CHECK(w == 64);
+    CHECK(h == 48);
+    CHECK(c == 3);
+    CHECK(isEqual(image, decoded));
+    stbi_image_free(decoded);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Image/PNG Decode Matches stb_image", "[image]") {
+    CHECK(decodesLikeStb(Palette4Bit, sizeof(Palette4Bit)));
+    CHECK(decodesLikeStb(PaletteTransparency, sizeof(PaletteTransparency)));
+    CHECK(decodesLikeStb(Gray1Bit, sizeof(Gray1Bit)));
+    CHECK(decodesLikeStb(GrayAlpha, sizeof(GrayAlpha)));
+    CHECK(decodesLikeStb(RGBColorKey, sizeof(RGBColorKey)));
+    CHECK(decodesLikeStb(RGBAInterlaced, sizeof(RGBAInterlaced)));
+}
+
+TEST_CASE("Image/PNG Decode Written Image", "[image]") {
+    // Images that were written by savePNG are read back with libpng
+    sgct::Image image = createImage(sgct::ivec2{ 300, 200 }, 4, 1);
+    const std::string file = tempFile("decode.png");
+    image.save(file);
+
+    sgct::Image loaded;
+    loaded.load(file);
+    REQUIRE(loaded.size().x == 300);
+    REQUIRE(loaded.size().y == 200);
+    REQUIRE(loaded.channels() == 4);
+    CHECK(std::memcmp(loaded.data(), image.data(), 300 * 200 * 4) == 0);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Image/EXR Roundtrip Half", "[image]") {
+    // Two full blocks of lines that compress well
+    sgct::Image image = createGradient(sgct::ivec2{ 37, 32 }, 4, 2);
+    const std::string file = tempFile("half.exr");
+    image.save(file);
+
+    const EXRFile exr = readEXR(file);
+    CHECK(exr.nStoredBlocks == 0);
+    checkFloatingPointEXR(image, exr);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Image/EXR Roundtrip Float", "[image]") {
+    for (int nChannels = 1; nChannels <= 4; nChannels++) {
+        sgct::Image image = createGradient(sgct::ivec2{ 20, 16 }, nChannels, 4);
+        const std::string file = tempFile("float.exr");
+        image.save(file, sgct::Image::Compression::Fast);
+
+        const EXRFile exr = readEXR(file);
+        CHECK(exr.nStoredBlocks == 0);
+        checkFloatingPointEXR(image, exr);
+        std::filesystem::remove(file);
+    }
+}
+
+TEST_CASE("Image/EXR Partial Block", "[image]") {
+    // The last block only has 5 lines and the noise doesn't compress, so the blocks are
+    // stored without compression
+    sgct::Image image = createImage(sgct::ivec2{ 19, 21 }, 3, 4);
+    image.setFloatingPoint(true);
+    const std::string file = tempFile("partial.exr");
+    image.save(file);
+
+    const EXRFile exr = readEXR(file);
+    CHECK(exr.nStoredBlocks == 2);
+    checkFloatingPointEXR(image, exr);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Image/EXR Integer Conversion", "[image]") {
+    // Images that don't use floating point are converted to halfs between 0 and 1
+    const sgct::ivec2 size = sgct::ivec2{ 23, 17 };
+    for (int bpc = 1; bpc <= 2; bpc++) {
+        sgct::Image image = createImage(size, 2, bpc);
+        const std::string file = tempFile("integer.exr");
+        image.save(file);
+
+        const EXRFile exr = readEXR(file);
+        REQUIRE(exr.channels.size() == 2);
+        CHECK(exr.pixelTypes[0] == 1);
+        CHECK(exr.pixelTypes[1] == 1);
+        const float max = bpc == 1 ? 255.f : 65535.f;
+        bool isEqual = true;
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                const size_t i = (static_cast<size_t>(size.y - 1 - y) * size.x + x) * 2;
+                const size_t j = static_cast<size_t>(y) * size.x + x;
+                for (int c = 0; c < 2; c++) {
+                    // The alpha channel comes first in the file, but last in the image
+                    const std::string name = c == 0 ? "A" : "Y";
+                    const unsigned char* src = image.data() + (i + 1 - c) * bpc;
+                    uint16_t half;
+                    std::memcpy(&half, exr.values.at(name).data() + j * 2, 2);
+                    uint16_t value = *src;
+                    if (bpc == 2) {
+                        std::memcpy(&value, src, sizeof(uint16_t));
+                    }
+                    // Halfs have 11 significant bits
+                    const float expected = value / max;
+                    const float error = std::abs(halfToFloat(half) - expected);
+                    isEqual &= error <= expected / 2048.f;
+                }
+            }
+        }
+        CHECK(isEqual);
+        std::filesystem::remove(file);
+    }
+}
@@ -0,0 +1,205 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <sgct/log.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // More messages than fit into the buffer of the Log
+    constexpr int NMessages = 10000;
+
+    /**
+     * Collects the messages that the Log writes. The background thread is held in the
+     * callback of the first message until release is called, so that the buffer fills up
+     */
+    class Collector {
+    public:
+        Collector() {
+            Log::instance().setLogToConsole(false);
+            Log::instance().setNotifyLevel(Log::Level::Info);
+            Log::instance().setLogCallback(
+                [this](Log::Level level, std::string_view message) {
+                    std::unique_lock lock(_mutex);
+                    _released.wait(lock, [this]() { return _isReleased; });
+                    _messages.emplace_back(level, std::string(message));
+                }
+            );
+        }
+
+        ~Collector() {
+            release();
+            Log::instance().flush();
+            Log::instance().setLogCallback(nullptr);
+            Log::instance().setOverflowPolicy(Log::OverflowPolicy::Discard);
+            Log::instance().setLogToConsole(true);
+        }
+
+        void release() {
+            std::unique_lock lock(_mutex);
+            _isReleased = true;
+            _released.notify_all();
+        }
+
+        std::vector<std::pair<Log::Level, std::string>> messages() {
+            std::unique_lock lock(_mutex);
+            return _messages;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _released;
+        bool _isReleased = false;
+        std::vector<std::pair<Log::Level, std::string>> _messages;
+    };
+} // namespace
+
+TEST_CASE("Log/Flush", "[log]") {
+    Collector collector;
+    collector.release();
+    Log::Info("first");
+    Log::Warning("second");
+    Log::Debug("filtered");
+    Log::Error("third");
+    Log::instance().flush();
+
+    const std::vector<std::pair<Log::Level, std::string>> m = collector.messages();
+    REQUIRE(m.size() == 3);
+    CHECK(m[0].first == Log::Level::Info);
+    CHECK(m[0].second == "(Info) first");
+    CHECK(m[1].first == Log::Level::Warning);
+    CHECK(m[1].second == "(Warning) second");
+    CHECK(m[2].first == Log::Level::Error);
+    CHECK(m[2].second == "(Error) third");
+}
+
+TEST_CASE("Log/Error Written Before Return", "[log]") {
+    Collector collector;
+    collector.release();
+
+    // Errors do not need a flush, they have been written when the call returns
+    Log::Error("written");
+    const std::vector<std::pair<Log::Level, std::string>> m = collector.messages();
+    REQUIRE(m.size() == 1);
+    CHECK(m[0].first == Log::Level::Error);
+    CHECK(m[0].second == "(Error) written");
+}
+
+TEST_CASE("Log/Error Blocked Callback", "[log]") {
+    Collector collector;
+
+    // The callback is held as if it waited for a lock of the caller, so the caller only
+    // waits for a limited time before it continues
+    const auto begin = std::chrono::steady_clock::now();
+    Log::Error("blocked");
+    const auto duration = std::chrono::steady_clock::now() - begin;
+    CHECK(duration >= std::chrono::milliseconds(400));
+    CHECK(duration < std::chrono::seconds(5));
+    CHECK(collector.messages().empty());
+
+    collector.release();
+    Log::instance().flush();
+    const std::vector<std::pair<Log::Level, std::string>> m = collector.messages();
+    REQUIRE(m.size() == 1);
+    CHECK(m[0].second == "(Error) blocked");
+}
+
+TEST_CASE("Log/Overflow Discard", "[log]") {
+    Collector collector;
+    Log::instance().setOverflowPolicy(Log::OverflowPolicy::Discard);
+
+    // Nothing is written while the collector is held, so the buffer overflows
+    for (int i = 0; i < NMessages; i++) {
+        Log::Info(std::to_string(i));
+    }
+    collector.release();
+    Log::instance().flush();
+
+    int nWritten = 0;
+    int nDiscarded = 0;
+    int last = -1;
+    for (const std::pair<Log::Level, std::string>& m : collector.messages()) {
+        if (m.first == Log::Level::Warning) {
+            // "(Warning) Discarded {} log messages as the log buffer was full"
+            nDiscarded += std::stoi(m.second.substr(m.second.find(' ', 10)));
+            continue;
+        }
+        // The messages that made it into the buffer keep their order
+        const int i = std::stoi(m.second.substr(m.second.find(' ') + 1));
+        CHECK(i > last);
+        last = i;
+        nWritten++;
+    }
+    CHECK(nDiscarded > 0);
+    CHECK(nWritten + nDiscarded == NMessages);
+}
+
+TEST_CASE("Log/Overflow Block", "[log]") {
+    Collector collector;
+    Log::instance().setOverflowPolicy(Log::OverflowPolicy::Block);
+
+    // Logging waits for space once the buffer is full, so the collector has to be
+    // released from another thread
+    std::thread releaser([&collector]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        collector.release();
+    });
+    for (int i = 0; i < NMessages; i++) {
+        Log::Info(std::to_string(i));
+    }
+    Log::instance().flush();
+    releaser.join();
+
+    const std::vector<std::pair<Log::Level, std::string>> m = collector.messages();
+    REQUIRE(m.size() == NMessages);
+    for (int i = 0; i < NMessages; i++) {
+        CHECK(m[i].second == "(Info) " + std::to_string(i));
+    }
+}
+
+TEST_CASE("Log/Ordering Multiple Threads", "[log]") {
+    Collector collector;
+    collector.release();
+    Log::instance().setOverflowPolicy(Log::OverflowPolicy::Block);
+
+    // The messages of different threads interleave, but each thread's stay in order
+    constexpr int NThreads = 4;
+    constexpr int NPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NThreads; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < NPerThread; i++) {
+                Log::Info(std::to_string(t) + ' ' + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    Log::instance().flush();
+
+    const std::vector<std::pair<Log::Level, std::string>> m = collector.messages();
+    REQUIRE(m.size() == NThreads * NPerThread);
+    std::vector<int> next(NThreads, 0);
+    for (const std::pair<Log::Level, std::string>& message : m) {
+        // "(Info) <thread> <index>"
+        const size_t space = message.second.find(' ', 7);
+        const int t = std::stoi(message.second.substr(7, space - 7));
+        const int i = std::stoi(message.second.substr(space + 1));
+        CHECK(i == next[t]);
+        next[t] = i + 1;
+    }
+}
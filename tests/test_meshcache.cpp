@@ -0,0 +1,162 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/correction/meshcache.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace sgct;
+using namespace sgct::correction;
+
+namespace {
+    Buffer createBuffer() {
+        Buffer buffer;
+        for (int i = 0; i < 9; i++) {
+            CorrectionMeshVertex v;
+            v.x = static_cast<float>(i % 3);
+            v.y = static_cast<float>(i / 3);
+            v.s = v.x / 2.f;
+            v.t = v.y / 2.f;
+            v.r = 1.f;
+            v.g = 0.5f;
+            v.b = 0.25f;
+            v.a = 1.f;
+            buffer.vertices.push_back(v);
+        }
+        buffer.indices = { 0, 1, 3, 1, 4, 3, 4, 5, 7, 5, 8, 7 };
+        buffer.geometryType = 0x0005; // GL_TRIANGLE_STRIP
+        return buffer;
+    }
+
+    bool isEqual(const Buffer& lhs, const Buffer& rhs) {
+        return lhs.vertices.size() == rhs.vertices.size() &&
+            std::memcmp(
+                lhs.vertices.data(),
+                rhs.vertices.data(),
+                lhs.vertices.size() * sizeof(CorrectionMeshVertex)
+            ) == 0 &&
+            lhs.indices == rhs.indices && lhs.geometryType == rhs.geometryType;
+    }
+} // namespace
+
+TEST_CASE("MeshCache/Roundtrip", "[meshcache]") {
+    const std::filesystem::path file = tempFile("roundtrip.sgctmesh");
+    const std::string key = "mesh.data|12345|678|0,0|1,1|1.77|-1";
+    const Buffer buffer = createBuffer();
+    writeMeshCache(file, key, buffer);
+
+    std::optional<Buffer> res = readMeshCache(file, key);
+    REQUIRE(res.has_value());
+    CHECK(isEqual(*res, buffer));
+
+    // The mesh does not change the viewport unless the source file said so
+    CHECK_FALSE(res->userPosition.has_value());
+    CHECK_FALSE(res->viewPlane.has_value());
+    CHECK_FALSE(res->projectionPlaneOffset.has_value());
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("MeshCache/Viewport Changes", "[meshcache]") {
+    const std::filesystem::path file = tempFile("viewport.sgctmesh");
+    const std::string key = "mesh.sgc|1|2|0,0|1,1|0|0.001";
+    Buffer buffer = createBuffer();
+    buffer.userPosition = vec3{ 0.f, 1.5f, -2.f };
+    Buffer::ViewPlane viewPlane;
+    viewPlane.up = 30.f;
+    viewPlane.down = 25.f;
+    viewPlane.left = 40.f;
+    viewPlane.right = 45.f;
+    viewPlane.orientation = quat{ 0.f, 0.7071f, 0.f, 0.7071f };
+    buffer.viewPlane = viewPlane;
+    buffer.projectionPlaneOffset = vec3{ 0.1f, 0.2f, 0.3f };
+    writeMeshCache(file, key, buffer);
+
+    std::optional<Buffer> res = readMeshCache(file, key);
+    REQUIRE(res.has_value());
+    CHECK(isEqual(*res, buffer));
+    REQUIRE(res->userPosition.has_value());
+    CHECK(res->userPosition->y == 1.5f);
+    CHECK(res->userPosition->z == -2.f);
+    REQUIRE(res->viewPlane.has_value());
+    CHECK(res->viewPlane->up == 30.f);
+    CHECK(res->viewPlane->down == 25.f);
+    CHECK(res->viewPlane->left == 40.f);
+    CHECK(res->viewPlane->right == 45.f);
+    CHECK(res->viewPlane->orientation.y == 0.7071f);
+    REQUIRE(res->projectionPlaneOffset.has_value());
+    CHECK(res->projectionPlaneOffset->x == 0.1f);
+    CHECK(res->projectionPlaneOffset->z == 0.3f);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("MeshCache/Stale Key", "[meshcache]") {
+    const std::filesystem::path file = tempFile("stale.sgctmesh");
+    writeMeshCache(file, "mesh.data|12345|678", createBuffer());
+
+    // Keys of the same and of a different length that don't match are both rejected
+    CHECK_FALSE(readMeshCache(file, "mesh.data|12346|678").has_value());
+    CHECK_FALSE(readMeshCache(file, "mesh.data|123456|678").has_value());
+    CHECK(readMeshCache(file, "mesh.data|12345|678").has_value());
+    std::filesystem::remove(file);
+
+    CHECK_FALSE(readMeshCache(file, "mesh.data|12345|678").has_value());
+}
+
+TEST_CASE("MeshCache/Damaged File", "[meshcache]") {
+    const std::filesystem::path file = tempFile("damaged.sgctmesh");
+    const std::string key = "mesh.data";
+    writeMeshCache(file, key, createBuffer());
+
+    // A file that was cut off is not read at all
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) - 4);
+    CHECK_FALSE(readMeshCache(file, key).has_value());
+
+    {
+        std::ofstream f(file, std::ios::binary | std::ios::trunc);
+        f << std::string(512, 'x');
+    }
+    CHECK_FALSE(readMeshCache(file, key).has_value());
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("MeshCache/Key", "[meshcache]") {
+    const std::filesystem::path file = tempFile("key.data");
+    {
+        std::ofstream f(file);
+        f << "mesh";
+    }
+
+    const vec2 pos = vec2{ 0.f, 0.f };
+    const vec2 size = vec2{ 1.f, 1.f };
+    const std::string key = meshCacheKey(file.string(), pos, size, 1.f, std::nullopt);
+    CHECK_FALSE(key.empty());
+    CHECK(meshCacheKey(file.string(), pos, size, 1.f, std::nullopt) == key);
+    CHECK(meshCacheName(key) == meshCacheName(key));
+
+    // Everything that changes the generated mesh leads to a different key
+    CHECK(meshCacheKey(file.string(), vec2{ 0.5f, 0.f }, size, 1.f, std::nullopt) != key);
+    CHECK(meshCacheKey(file.string(), pos, vec2{ 0.5f, 1.f }, 1.f, std::nullopt) != key);
+    CHECK(meshCacheKey(file.string(), pos, size, 2.f, std::nullopt) != key);
+    CHECK(meshCacheKey(file.string(), pos, size, 1.f, 0.001f) != key);
+    {
+        std::ofstream f(file, std::ios::app);
+        f << " changed";
+    }
+    const std::string changed = meshCacheKey(file.string(), pos, size, 1.f, std::nullopt);
+    CHECK(changed != key);
+    CHECK(meshCacheName(changed) != meshCacheName(key));
+    std::filesystem::remove(file);
+
+    // No key can be created for a file that does not exist
+    CHECK(meshCacheKey(file.string(), pos, size, 1.f, std::nullopt).empty());
+}
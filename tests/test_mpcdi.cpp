@@ -0,0 +1,245 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/error.h>
+#include <sgct/image.h>
+#include <sgct/mpcdi.h>
+#include <zip.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr const char* Display = R"(
+  <display>
+    <buffer id="Left" xResolution="1920" yResolution="1080">
+      <region id="A" x="0.0" y="0.0" xSize="0.5" ySize="1.0">
+        <frustum>
+          <yaw>-20</yaw><pitch>0</pitch><roll>0</roll>
+          <rightAngle>20</rightAngle><leftAngle>-20</leftAngle>
+          <upAngle>15</upAngle><downAngle>-15</downAngle>
+        </frustum>
+      </region>
+      <region id="B" x="0.5" y="0.0" xSize="0.5" ySize="1.0">
+        <frustum>
+          <yaw>20</yaw><pitch>0</pitch><roll>0</roll>
+          <rightAngle>20</rightAngle><leftAngle>-20</leftAngle>
+          <upAngle>15</upAngle><downAngle>-15</downAngle>
+        </frustum>
+      </region>
+    </buffer>
+    <buffer id="Right" xResolution="1280" yResolution="720">
+      <region id="C" x="0.0" y="0.0" xSize="1.0" ySize="1.0">
+        <frustum>
+          <yaw>0</yaw><pitch>10</pitch><roll>0</roll>
+          <rightAngle>30</rightAngle><leftAngle>-30</leftAngle>
+          <upAngle>20</upAngle><downAngle>-20</downAngle>
+        </frustum>
+      </region>
+    </buffer>
+  </display>)";
+
+    constexpr const char* Files = R"(
+  <files>
+    <fileset region="B">
+      <geometryWarpFile>
+        <path>b.pfm</path>
+        <interpolation>linear</interpolation>
+      </geometryWarpFile>
+    </fileset>
+    <fileset region="A">
+      <geometryWarpFile>
+        <path>a.pfm</path>
+        <interpolation>linear</interpolation>
+      </geometryWarpFile>
+      <alphaMap><path>a_alpha.png</path></alphaMap>
+      <betaMap><path>a_beta.png</path></betaMap>
+    </fileset>
+    <fileset region="C">
+      <geometryWarpFile>
+        <path>c.pfm</path>
+        <interpolation>linear</interpolation>
+      </geometryWarpFile>
+    </fileset>
+  </files>)";
+
+    size_t nBytes(const Image& img) {
+        return static_cast<size_t>(img.size().x) * img.size().y * img.channels() *
+            img.bytesPerChannel();
+    }
+
+    std::string mpcdiXml(const std::string& files) {
+        return std::string(R"(<MPCDI profile="3d" geometry="1" version="2.0">)") +
+            Display + files + "\n</MPCDI>\n";
+    }
+
+    // A PFM file with a grid of the provided size in which every offset is zero
+    std::string pfmFile(int width, int height) {
+        std::string res = "PF\n" + std::to_string(width) + ' ' +
+            std::to_string(height) + "\n-1.000000\n";
+        res.append(width * height * 3 * sizeof(float), '\0');
+        return res;
+    }
+
+    // A grayscale PNG file in which every pixel has the provided value
+    std::string pngFile(unsigned char value) {
+        Image img;
+        img.setSize(ivec2{ 4, 2 });
+        img.setChannels(1);
+        img.setBytesPerChannel(1);
+        img.allocateOrResizeData();
+        std::fill(img.data(), img.data() + nBytes(img), value);
+
+        const std::string file = tempFile("mpcdi.png");
+        img.save(file);
+        std::ifstream f(file, std::ios::binary);
+        std::string res = std::string(std::istreambuf_iterator<char>(f), {});
+        f.close();
+        std::filesystem::remove(file);
+        return res;
+    }
+
+    void writeArchive(const std::string& path,
+                      const std::map<std::string, std::string>& files)
+    {
+        zipFile zip = zipOpen(path.c_str(), APPEND_STATUS_CREATE);
+        REQUIRE(zip);
+        for (const std::pair<const std::string, std::string>& p : files) {
+            const int open = zipOpenNewFileInZip(
+                zip,
+                p.first.c_str(),
+                nullptr,
+                nullptr,
+                0,
+                nullptr,
+                0,
+                nullptr,
+                Z_DEFLATED,
+                Z_DEFAULT_COMPRESSION
+            );
+            REQUIRE(open == ZIP_OK);
+            const int write = zipWriteInFileInZip(
+                zip,
+                p.second.data(),
+                static_cast<unsigned int>(p.second.size())
+            );
+            REQUIRE(write == ZIP_OK);
+            zipCloseFileInZip(zip);
+        }
+        zipClose(zip, nullptr);
+    }
+
+    std::map<std::string, std::string> archiveFiles() {
+        return {
+            { "mpcdi.xml", mpcdiXml(Files) },
+            { "a.pfm", pfmFile(3, 2) },
+            { "b.pfm", pfmFile(4, 3) },
+            { "c.pfm", pfmFile(5, 4) },
+            { "a_alpha.png", pngFile(200) },
+            { "a_beta.png", pngFile(10) }
+        };
+    }
+} // namespace
+
+TEST_CASE("Mpcdi/Buffer Selection", "[mpcdi]") {
+    const std::string file = tempFile("buffer.mpcdi");
+    writeArchive(file, archiveFiles());
+
+    const mpcdi::ReturnValue left = mpcdi::parseMpcdiConfiguration(file, "Left");
+    CHECK(left.resolution.x == 1920);
+    CHECK(left.resolution.y == 1080);
+    REQUIRE(left.viewports.size() == 2);
+    CHECK(*left.viewports[0].proj.id == "A");
+    CHECK(*left.viewports[1].proj.id == "B");
+
+    const mpcdi::ReturnValue right = mpcdi::parseMpcdiConfiguration(file, "Right");
+    CHECK(right.resolution.x == 1280);
+    CHECK(right.resolution.y == 720);
+    REQUIRE(right.viewports.size() == 1);
+    CHECK(*right.viewports[0].proj.id == "C");
+    CHECK(right.viewports[0].mesh.vertices.size() == 5 * 4);
+
+    // With more than one buffer the file does not say which one to use
+    CHECK_THROWS_AS(mpcdi::parseMpcdiConfiguration(file), Error);
+    CHECK_THROWS_AS(mpcdi::parseMpcdiConfiguration(file, "Center"), Error);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Mpcdi/Region Files", "[mpcdi]") {
+    const std::string file = tempFile("region.mpcdi");
+    writeArchive(file, archiveFiles());
+
+    // The filesets are matched to the regions by name and not by their order
+    const mpcdi::ReturnValue res = mpcdi::parseMpcdiConfiguration(file, "Left");
+    REQUIRE(res.viewports.size() == 2);
+    const mpcdi::ReturnValue::ViewportInfo& a = res.viewports[0];
+    const mpcdi::ReturnValue::ViewportInfo& b = res.viewports[1];
+    CHECK(a.mesh.vertices.size() == 3 * 2);
+    CHECK(b.mesh.vertices.size() == 4 * 3);
+
+    // Grayscale alpha and beta maps are turned into color images
+    REQUIRE(a.alphaMap.data());
+    CHECK(a.alphaMap.size().x == 4);
+    CHECK(a.alphaMap.size().y == 2);
+    CHECK(a.alphaMap.channels() == 3);
+    CHECK(a.alphaMap.bytesPerChannel() == 1);
+    for (size_t i = 0; i < nBytes(a.alphaMap); i++) {
+        CHECK(a.alphaMap.data()[i] == 200);
+    }
+    REQUIRE(a.betaMap.data());
+    CHECK(a.betaMap.channels() == 3);
+    for (size_t i = 0; i < nBytes(a.betaMap); i++) {
+        CHECK(a.betaMap.data()[i] == 10);
+    }
+
+    CHECK(b.alphaMap.data() == nullptr);
+    CHECK(b.betaMap.data() == nullptr);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Mpcdi/Invalid Files", "[mpcdi]") {
+    const std::string file = tempFile("invalid.mpcdi");
+
+    // A fileset has to name the region it belongs to
+    std::map<std::string, std::string> files = archiveFiles();
+    files["mpcdi.xml"] = mpcdiXml(R"(
+  <files>
+    <fileset region="A">
+      <alphaMap><path>a_alpha.png</path></alphaMap>
+    </fileset>
+    <fileset>
+      <betaMap><path>a_beta.png</path></betaMap>
+    </fileset>
+  </files>)");
+    writeArchive(file, files);
+    CHECK_THROWS_AS(mpcdi::parseMpcdiConfiguration(file, "Left"), Error);
+
+    // Files of a region have to be part of the archive
+    files = archiveFiles();
+    files.erase("a_beta.png");
+    writeArchive(file, files);
+    CHECK_THROWS_AS(mpcdi::parseMpcdiConfiguration(file, "Left"), Error);
+
+    // but those of the regions of other buffers don't
+    files.erase("c.pfm");
+    files["a_beta.png"] = pngFile(10);
+    writeArchive(file, files);
+    CHECK_NOTHROW(mpcdi::parseMpcdiConfiguration(file, "Left"));
+    std::filesystem::remove(file);
+
+    CHECK_THROWS_AS(mpcdi::parseMpcdiConfiguration(file, "Left"), Error);
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+
+#include "catch2/catch.hpp"
+
+#include <sgct/error.h>
+#include <sgct/opengl.h>
+#include <sgct/correction/mpcdimesh.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace sgct::correction;
+
+namespace {
+    // A PFM file with a 3x2 grid in which every value is offset by its index
+    std::vector<char> pfmFile() {
+        const std::string header = "PF\n3 2\n-1.000000\n";
+        std::vector<char> res(header.begin(), header.end());
+        for (int i = 0; i < 6; i++) {
+            const float value[3] = { 0.01f * i, -0.02f * i, 0.f };
+            const char* v = reinterpret_cast<const char*>(value);
+            res.insert(res.end(), v, v + sizeof(value));
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("MpcdiMesh/Grid", "[mpcdimesh]") {
+    const Buffer buf = generateMpcdiMesh(pfmFile());
+    CHECK(buf.geometryType == GL_TRIANGLES);
+    REQUIRE(buf.vertices.size() == 6);
+    CHECK(buf.indices.size() == 2 * 2 * 3);
+
+    // The first row of the file is the top row of the viewport
+    CHECK(buf.vertices[0].s == 0.f);
+    CHECK(buf.vertices[0].t == 1.f);
+    CHECK(buf.vertices[0].x == -1.f);
+    CHECK(buf.vertices[0].y == 1.f);
+    CHECK(buf.vertices[5].s == 1.f);
+    CHECK(buf.vertices[5].t == 0.f);
+    CHECK(buf.vertices[5].x == 2.f * (1.f + 0.05f) - 1.f);
+    CHECK(buf.vertices[5].y == 2.f * (0.f - 0.1f) - 1.f);
+}
+
+TEST_CASE("MpcdiMesh/Streaming", "[mpcdimesh]") {
+    const std::vector<char> file = pfmFile();
+    const Buffer expected = generateMpcdiMesh(file);
+
+    // Reading the file in small pieces has to produce the same mesh
+    size_t offset = 0;
+    const Buffer buf = generateMpcdiMesh(
+        [&file, &offset](char* dst, size_t size) {
+            const size_t n = std::min({ size, file.size() - offset, size_t(5) });
+            std::memcpy(dst, file.data() + offset, n);
+            offset += n;
+            return n;
+        }
+    );
+    CHECK(offset == file.size());
+    CHECK(buf.indices == expected.indices);
+    REQUIRE(buf.vertices.size() == expected.vertices.size());
+    CHECK(
+        std::memcmp(
+            buf.vertices.data(),
+            expected.vertices.data(),
+            buf.vertices.size() * sizeof(CorrectionMeshVertex)
+        ) == 0
+    );
+}
+
+TEST_CASE("MpcdiMesh/Truncated", "[mpcdimesh]") {
+    std::vector<char> file = pfmFile();
+    file.resize(file.size() - 1);
+    CHECK_THROWS_AS(generateMpcdiMesh(file), sgct::Error);
+
+    file.resize(8);
+    CHECK_THROWS_AS(generateMpcdiMesh(file), sgct::Error);
+}
@@ -0,0 +1,175 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <sgct/multicast.h>
+#include <sgct/network.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    // The group is never joined; the datagrams that the sender emits are not needed as
+    // the tests create the fragments themselves
+    MulticastGroup testGroup() {
+        MulticastGroup group;
+        group.address = "239.255.42.99";
+        group.port = 20599;
+        return group;
+    }
+
+    std::vector<char> payload(int size) {
+        std::vector<char> res(size);
+        for (int i = 0; i < size; i++) {
+            res[i] = static_cast<char>(i * 7 + i / 251);
+        }
+        return res;
+    }
+
+    // Creates the datagram for fragment \p index of the frame \p data in the same layout
+    // that the MulticastSender uses
+    std::vector<char> datagram(char blockId, uint32_t sequence,
+                               const std::vector<char>& data, uint16_t index)
+    {
+        using namespace multicast;
+        const uint32_t size = static_cast<uint32_t>(data.size());
+        const uint16_t nFragments = static_cast<uint16_t>(fragmentCount(size));
+        const int offset = index * FragmentSize;
+        const int length = std::min(FragmentSize, static_cast<int>(size) - offset);
+
+        std::vector<char> res(HeaderSize + length);
+        res[0] = blockId;
+        std::memcpy(res.data() + 1, &sequence, sizeof(sequence));
+        std::memcpy(res.data() + 5, &size, sizeof(size));
+        std::memcpy(res.data() + 9, &index, sizeof(index));
+        std::memcpy(res.data() + 11, &nFragments, sizeof(nFragments));
+        std::memcpy(res.data() + HeaderSize, data.data() + offset, length);
+        return res;
+    }
+
+    bool add(multicast::Reassembler& r, const std::vector<char>& d) {
+        return r.addDatagram(d.data(), static_cast<int>(d.size()));
+    }
+} // namespace
+
+TEST_CASE("Multicast/Reassemble", "[multicast]") {
+    const std::vector<char> data = payload(3 * multicast::FragmentSize - 100);
+    multicast::Reassembler r;
+
+    // Fragments can arrive in any order and duplicates are ignored
+    CHECK_FALSE(add(r, datagram(Network::DataId, 1, data, 2)));
+    CHECK_FALSE(add(r, datagram(Network::DataId, 1, data, 0)));
+    CHECK_FALSE(add(r, datagram(Network::DataId, 1, data, 0)));
+    CHECK_FALSE(r.isComplete(1));
+    CHECK(add(r, datagram(Network::DataId, 1, data, 1)));
+    REQUIRE(r.isComplete(1));
+
+    char blockId = 0;
+    std::vector<char> result;
+    REQUIRE(r.takeFrame(1, blockId, result));
+    CHECK(blockId == Network::DataId);
+    CHECK(result == data);
+}
+
+TEST_CASE("Multicast/Nack", "[multicast]") {
+    const std::vector<char> data = payload(4 * multicast::FragmentSize);
+    multicast::Reassembler r;
+
+    // Nothing is known about a frame of which no fragment has arrived
+    CHECK(r.createNack(1).empty());
+
+    add(r, datagram(Network::DeltaDataId, 1, data, 0));
+    add(r, datagram(Network::DeltaDataId, 1, data, 2));
+    const std::vector<char> nack = r.createNack(1);
+    REQUIRE(nack.size() == 2 * sizeof(uint16_t));
+    uint16_t missing[2];
+    std::memcpy(missing, nack.data(), nack.size());
+    CHECK(missing[0] == 1);
+    CHECK(missing[1] == 3);
+
+    char blockId = 0;
+    std::vector<char> result;
+    CHECK_FALSE(r.takeFrame(1, blockId, result));
+}
+
+TEST_CASE("Multicast/Repair", "[multicast]") {
+    MulticastSender sender(testGroup());
+    const std::vector<char> data = payload(5 * multicast::FragmentSize + 17);
+    const uint32_t sequence =
+        sender.send(Network::DataId, data.data(), static_cast<int>(data.size()));
+
+    // Only the fragments that were listed in the NACK are resent
+    multicast::Reassembler r;
+    add(r, datagram(Network::DataId, sequence, data, 0));
+    add(r, datagram(Network::DataId, sequence, data, 3));
+    add(r, datagram(Network::DataId, sequence, data, 5));
+    const std::vector<char> nack = r.createNack(sequence);
+    std::vector<char> repair;
+    const int nackLength = static_cast<int>(nack.size());
+    REQUIRE(sender.createRepair(sequence, nack.data(), nackLength, repair));
+    CHECK(repair.size() < data.size());
+    CHECK(r.applyRepair(sequence, repair.data(), static_cast<int>(repair.size())));
+
+    char blockId = 0;
+    std::vector<char> result;
+    REQUIRE(r.takeFrame(sequence, blockId, result));
+    CHECK(blockId == Network::DataId);
+    CHECK(result == data);
+}
+
+TEST_CASE("Multicast/Repair Unknown Frame", "[multicast]") {
+    MulticastSender sender(testGroup());
+    const std::vector<char> data = payload(2 * multicast::FragmentSize + 1);
+    const uint32_t sequence =
+        sender.send(Network::DeltaDataId, data.data(), static_cast<int>(data.size()));
+
+    // An empty NACK requests the whole frame
+    multicast::Reassembler r;
+    std::vector<char> repair;
+    REQUIRE(sender.createRepair(sequence, nullptr, 0, repair));
+    CHECK(r.applyRepair(sequence, repair.data(), static_cast<int>(repair.size())));
+
+    char blockId = 0;
+    std::vector<char> result;
+    REQUIRE(r.takeFrame(sequence, blockId, result));
+    CHECK(blockId == Network::DeltaDataId);
+    CHECK(result == data);
+}
+
+TEST_CASE("Multicast/Repair Lost Frame", "[multicast]") {
+    MulticastSender sender(testGroup());
+    const std::vector<char> data = payload(100);
+    const uint32_t first =
+        sender.send(Network::DataId, data.data(), static_cast<int>(data.size()));
+    for (uint32_t i = 0; i < multicast::HistorySize; i++) {
+        sender.send(Network::DataId, data.data(), static_cast<int>(data.size()));
+    }
+
+    std::vector<char> repair;
+    CHECK_FALSE(sender.createRepair(first, nullptr, 0, repair));
+    CHECK(sender.createRepair(first + 1, nullptr, 0, repair));
+}
+
+TEST_CASE("Multicast/Stale Fragment", "[multicast]") {
+    const std::vector<char> data = payload(10);
+    multicast::Reassembler r;
+
+    // Frame 1 + HistorySize occupies the same slot as frame 1, which has to be ignored
+    const uint32_t newer = 1 + multicast::HistorySize;
+    CHECK(add(r, datagram(Network::DataId, newer, data, 0)));
+    CHECK_FALSE(add(r, datagram(Network::DataId, 1, data, 0)));
+    CHECK_FALSE(r.isComplete(1));
+    CHECK(r.isComplete(newer));
+
+    // Datagrams that are too short to contain a header are dropped
+    const char garbage[4] = { 1, 2, 3, 4 };
+    CHECK_FALSE(r.addDatagram(garbage, sizeof(garbage)));
+}
@@ -0,0 +1,263 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <sgct/correction/optimize.h>
+#include <sgct/opengl.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+using namespace sgct::correction;
+
+namespace {
+    using Warp = std::function<sgct::vec2(float, float)>;
+
+    // A grid of vertices that covers the whole viewport with texture coordinates that
+    // are computed by the warp function. Like the MPCDI meshes, the cells are emitted
+    // column by column
+    Buffer grid(int nCols, int nRows, const Warp& warp) {
+        Buffer buf;
+        for (int r = 0; r < nRows; r++) {
+            for (int c = 0; c < nCols; c++) {
+                const float u = static_cast<float>(c) / (nCols - 1);
+                const float v = static_cast<float>(r) / (nRows - 1);
+                const sgct::vec2 st = warp(u, v);
+                CorrectionMeshVertex vertex;
+                vertex.x = 2.f * u - 1.f;
+                vertex.y = 2.f * v - 1.f;
+                vertex.s = st.x;
+                vertex.t = st.y;
+                vertex.r = 1.f;
+                vertex.g = 1.f;
+                vertex.b = 1.f;
+                vertex.a = 1.f;
+                buf.vertices.push_back(vertex);
+            }
+        }
+        for (int c = 0; c < nCols - 1; c++) {
+            for (int r = 0; r < nRows - 1; r++) {
+                const unsigned int i0 = r * nCols + c;
+                const unsigned int i1 = r * nCols + c + 1;
+                const unsigned int i2 = (r + 1) * nCols + c + 1;
+                const unsigned int i3 = (r + 1) * nCols + c;
+                buf.indices.insert(buf.indices.end(), { i0, i1, i2, i0, i2, i3 });
+            }
+        }
+        buf.geometryType = GL_TRIANGLES;
+        return buf;
+    }
+
+    double signedArea(const Buffer& buf, size_t triangle) {
+        const CorrectionMeshVertex& a = buf.vertices[buf.indices[3 * triangle]];
+        const CorrectionMeshVertex& b = buf.vertices[buf.indices[3 * triangle + 1]];
+        const CorrectionMeshVertex& c = buf.vertices[buf.indices[3 * triangle + 2]];
+        return (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    }
+
+    // Interpolates the texture coordinates of the mesh at a position in the viewport
+    std::optional<sgct::vec2> sample(const Buffer& buf, float x, float y) {
+        for (size_t i = 0; i < buf.indices.size(); i += 3) {
+            const CorrectionMeshVertex& a = buf.vertices[buf.indices[i]];
+            const CorrectionMeshVertex& b = buf.vertices[buf.indices[i + 1]];
+            const CorrectionMeshVertex& c = buf.vertices[buf.indices[i + 2]];
+            const double d = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+            const double wa = ((b.y - c.y) * (x - c.x) + (c.x - b.x) * (y - c.y)) / d;
+            const double wb = ((c.y - a.y) * (x - c.x) + (a.x - c.x) * (y - c.y)) / d;
+            const double wc = 1.0 - wa - wb;
+            constexpr double Eps = -1e-6;
+            if (wa >= Eps && wb >= Eps && wc >= Eps) {
+                return sgct::vec2{
+                    static_cast<float>(wa * a.s + wb * b.s + wc * c.s),
+                    static_cast<float>(wa * a.t + wb * b.t + wc * c.t)
+                };
+            }
+        }
+        return std::nullopt;
+    }
+
+    // The largest difference between the texture coordinates of both meshes, sampled on a
+    // grid that is much finer than the meshes
+    float maxDifference(const Buffer& lhs, const Buffer& rhs) {
+        constexpr int N = 97;
+        float res = 0.f;
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                const float x = 1.98f * i / (N - 1) - 0.99f;
+                const float y = 1.98f * j / (N - 1) - 0.99f;
+                const std::optional<sgct::vec2> l = sample(lhs, x, y);
+                const std::optional<sgct::vec2> r = sample(rhs, x, y);
+                if (!l || !r) {
+                    return std::numeric_limits<float>::max();
+                }
+                res = std::max(res, std::abs(l->x - r->x));
+                res = std::max(res, std::abs(l->y - r->y));
+            }
+        }
+        return res;
+    }
+
+    // Average number of vertices that have to be transformed per triangle with a FIFO
+    // post-transform cache
+    float averageCacheMissRatio(const Buffer& buf, size_t cacheSize) {
+        std::vector<unsigned int> cache;
+        int nMisses = 0;
+        for (unsigned int i : buf.indices) {
+            if (std::find(cache.begin(), cache.end(), i) == cache.end()) {
+                nMisses++;
+                cache.insert(cache.begin(), i);
+                if (cache.size() > cacheSize) {
+                    cache.pop_back();
+                }
+            }
+        }
+        return static_cast<float>(nMisses) / (buf.indices.size() / 3);
+    }
+
+    // All triangles by the positions of their corners, starting with the smallest one,
+    // so that two meshes can be compared independent of the order of their triangles
+    std::vector<std::array<float, 6>> triangles(const Buffer& buf) {
+        std::vector<std::array<float, 6>> res;
+        for (size_t i = 0; i < buf.indices.size(); i += 3) {
+            std::array<std::pair<float, float>, 3> corners;
+            for (size_t j = 0; j < 3; j++) {
+                const CorrectionMeshVertex& v = buf.vertices[buf.indices[i + j]];
+                corners[j] = { v.x, v.y };
+            }
+            std::rotate(
+                corners.begin(),
+                std::min_element(corners.begin(), corners.end()),
+                corners.end()
+            );
+            res.push_back({
+                corners[0].first, corners[0].second, corners[1].first, corners[1].second,
+                corners[2].first, corners[2].second
+            });
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+} // namespace
+
+TEST_CASE("Optimize/TriangleStrip", "[optimize]") {
+    Buffer buf;
+    for (int i = 0; i < 6; i++) {
+        CorrectionMeshVertex v;
+        v.x = static_cast<float>(i % 3);
+        v.y = static_cast<float>(i / 3);
+        buf.vertices.push_back(v);
+    }
+    buf.indices = { 0, 3, 1, 4, 2, 5, 5 };
+    buf.geometryType = GL_TRIANGLE_STRIP;
+
+    convertToTriangleList(buf);
+    CHECK(buf.geometryType == GL_TRIANGLES);
+
+    // The triangle that repeats index 5 is removed and all others keep their winding
+    REQUIRE(buf.indices.size() == 4 * 3);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK(signedArea(buf, i) < 0.0);
+    }
+}
+
+TEST_CASE("Optimize/MergeVertices", "[optimize]") {
+    Buffer buf = grid(2, 2, [](float u, float v) { return sgct::vec2{ u, v }; });
+    const Buffer original = buf;
+
+    // Turn the quad into a triangle soup with one vertex per corner of each triangle
+    Buffer soup = buf;
+    soup.vertices.clear();
+    soup.indices.clear();
+    for (unsigned int i : buf.indices) {
+        soup.indices.push_back(static_cast<unsigned int>(soup.vertices.size()));
+        soup.vertices.push_back(buf.vertices[i]);
+    }
+
+    mergeVertices(soup);
+    CHECK(soup.vertices.size() == 4);
+    CHECK(soup.indices.size() == 6);
+    CHECK(triangles(soup) == triangles(original));
+}
+
+TEST_CASE("Optimize/FlatRegion", "[optimize]") {
+    const Buffer original = grid(
+        41, 33,
+        [](float u, float v) { return sgct::vec2{ 0.25f + 0.5f * u, 0.1f + 0.8f * v }; }
+    );
+    Buffer buf = original;
+    simplifyMesh(buf, 1e-4f);
+
+    CHECK(buf.vertices.size() < original.vertices.size() / 20);
+    CHECK(maxDifference(original, buf) < 1e-4f);
+    for (size_t i = 0; i < buf.indices.size() / 3; i++) {
+        CHECK(signedArea(buf, i) > 0.0);
+    }
+}
+
+TEST_CASE("Optimize/CurvedRegion", "[optimize]") {
+    // A warp that is flat on the left half and curved on the right half of the viewport
+    const Buffer original = grid(
+        49, 49,
+        [](float u, float v) {
+            const float bend = u > 0.5f ? 0.1f * (u - 0.5f) * (u - 0.5f) : 0.f;
+            return sgct::vec2{ u, v + bend * std::sin(3.f * v) };
+        }
+    );
+
+    for (float maxError : { 1e-5f, 1e-4f, 1e-3f }) {
+        Buffer buf = original;
+        simplifyMesh(buf, maxError);
+        CHECK(buf.vertices.size() < original.vertices.size());
+        CHECK(maxDifference(original, buf) < 1.25f * maxError);
+    }
+}
+
+TEST_CASE("Optimize/VertexCache", "[optimize]") {
+    const Buffer original = grid(
+        100, 100,
+        [](float u, float v) { return sgct::vec2{ u, v }; }
+    );
+    Buffer buf = original;
+    optimizeVertexCache(buf);
+
+    CHECK(buf.vertices.size() == original.vertices.size());
+    CHECK(triangles(buf) == triangles(original));
+    for (size_t i = 0; i < buf.indices.size() / 3; i++) {
+        CHECK(signedArea(buf, i) > 0.0);
+    }
+
+    // The vertices are ordered by their first use
+    unsigned int next = 0;
+    for (unsigned int i : buf.indices) {
+        CHECK(i <= next);
+        next = std::max(next, i + 1);
+    }
+
+    const float before = averageCacheMissRatio(original, 16);
+    const float after = averageCacheMissRatio(buf, 16);
+    CHECK(after < 0.8f);
+    CHECK(after < before);
+}
+
+TEST_CASE("Optimize/WithoutSimplification", "[optimize]") {
+    const Buffer original = grid(
+        20, 10,
+        [](float u, float v) { return sgct::vec2{ u, v }; }
+    );
+    Buffer buf = original;
+    optimizeMesh(buf, 0.f);
+
+    CHECK(buf.geometryType == GL_TRIANGLES);
+    CHECK(buf.vertices.size() == original.vertices.size());
+    CHECK(triangles(buf) == triangles(original));
+}
@@ -0,0 +1,127 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/rawcapture.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sgct;
+
+namespace {
+    constexpr ivec2 Size = ivec2{ 64, 32 };
+    constexpr int NChannels = 4;
+    constexpr size_t FrameSize = 64 * 32 * 4;
+    // Frames of FrameSize bytes and their footer take up three pages
+    constexpr uint64_t FrameStride = 3 * rawcapture::FrameAlignment;
+
+    std::vector<unsigned char> framePixels(uint64_t number) {
+        std::vector<unsigned char> res(FrameSize);
+        for (size_t i = 0; i < res.size(); i++) {
+            res[i] = static_cast<unsigned char>(i * 3 + number * 101);
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("RawCapture/Roundtrip", "[rawcapture]") {
+    const std::string file = tempFile("roundtrip.sgctraw");
+
+    // Small segments so that the file has to be grown several times, with the frames of
+    // each segment written by different threads in reverse order
+    constexpr int NFrames = 11;
+    {
+        RawCaptureWriter writer(file, Size, NChannels, 1, false, 4 * FrameStride);
+        REQUIRE(writer.frameSize() == FrameSize);
+
+        std::vector<uint64_t> slots;
+        for (int i = 0; i < NFrames; i++) {
+            slots.push_back(writer.reserveFrame());
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = NFrames - 1; i >= 0; i--) {
+            threads.emplace_back([&writer, slot = slots[i], i]() {
+                const uint64_t number = 100 + i;
+                writer.writeFrame(slot, number, framePixels(number).data());
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    {
+        RawCaptureReader reader(file);
+        const rawcapture::FileHeader& header = reader.header();
+        CHECK(header.width == Size.x);
+        CHECK(header.height == Size.y);
+        CHECK(header.nChannels == NChannels);
+        CHECK(header.bytesPerChannel == 1);
+        CHECK(header.isFloatingPoint == 0);
+        CHECK(header.frameStride == FrameStride);
+        CHECK(header.nFrames == NFrames);
+        REQUIRE(reader.numberOfFrames() == NFrames);
+        for (uint64_t i = 0; i < NFrames; i++) {
+            const unsigned char* data = reader.frame(i);
+            REQUIRE(data);
+            CHECK(reader.frameNumber(i) == 100 + i);
+            CHECK(std::memcmp(data, framePixels(100 + i).data(), FrameSize) == 0);
+        }
+        CHECK(reader.frame(NFrames) == nullptr);
+    }
+
+    // The space that was preallocated behind the last frame has been cut off
+    const uint64_t expectedSize = rawcapture::HeaderSize + NFrames * FrameStride;
+    CHECK(std::filesystem::file_size(file) == expectedSize);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("RawCapture/Dropped Frame", "[rawcapture]") {
+    const std::string file = tempFile("dropped.sgctraw");
+    {
+        RawCaptureWriter writer(file, Size, NChannels, 1, false, 4 * FrameStride);
+        const uint64_t first = writer.reserveFrame();
+        writer.reserveFrame(); // never written
+        const uint64_t third = writer.reserveFrame();
+        writer.writeFrame(first, 1, framePixels(1).data());
+        writer.writeFrame(third, 3, framePixels(3).data());
+    }
+
+    {
+        RawCaptureReader reader(file);
+        REQUIRE(reader.numberOfFrames() == 3);
+        CHECK(reader.frame(0));
+        CHECK(reader.frame(1) == nullptr);
+        CHECK(reader.frameNumber(1) == 0);
+        REQUIRE(reader.frame(2));
+        CHECK(reader.frameNumber(2) == 3);
+        CHECK(std::memcmp(reader.frame(2), framePixels(3).data(), FrameSize) == 0);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("RawCapture/Invalid File", "[rawcapture]") {
+    const std::string file = tempFile("invalid.sgctraw");
+    {
+        std::vector<char> garbage(rawcapture::HeaderSize, 'x');
+        FILE* fp = fopen(file.c_str(), "wb");
+        REQUIRE(fp);
+        fwrite(garbage.data(), 1, garbage.size(), fp);
+        fclose(fp);
+    }
+    CHECK_THROWS_AS(RawCaptureReader(file), std::runtime_error);
+    std::filesystem::remove(file);
+}
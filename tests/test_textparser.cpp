@@ -0,0 +1,112 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include "tempfile.h"
+#include <sgct/correction/textparser.h>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace sgct::correction;
+
+TEST_CASE("Scanner/Tokens", "[textparser]") {
+    Scanner scanner("  v\t0.5  -1 \r");
+    CHECK(scanner.token() == "v");
+    CHECK(scanner.rest() == "0.5  -1 \r");
+    CHECK(scanner.token() == "0.5");
+    CHECK(scanner.token() == "-1");
+    CHECK(scanner.isEmpty());
+    CHECK(scanner.token().empty());
+}
+
+TEST_CASE("Scanner/Numbers", "[textparser]") {
+    Scanner scanner("1.5 +2 -3e-2 4/5/6 +-1");
+    float f = 0.f;
+    REQUIRE(scanner.number(f));
+    CHECK(f == 1.5f);
+    int i = 0;
+    REQUIRE(scanner.number(i));
+    CHECK(i == 2);
+    REQUIRE(scanner.number(f));
+    CHECK(f == -3e-2f);
+
+    // Parsing stops at the first character that does not belong to the number
+    unsigned int u = 0;
+    REQUIRE(scanner.number(u));
+    CHECK(u == 4);
+    CHECK_FALSE(scanner.number(u));
+    CHECK(scanner.character('/'));
+    REQUIRE(scanner.number(u));
+    CHECK(u == 5);
+    CHECK(scanner.token() == "/6");
+
+    CHECK_FALSE(scanner.number(f));
+    CHECK(scanner.rest() == "+-1");
+}
+
+TEST_CASE("Scanner/Literals", "[textparser]") {
+    Scanner scanner("Dome Azimuth=12.5;3");
+    CHECK_FALSE(scanner.literal("Dome Elevation"));
+    CHECK(scanner.literal("Dome Azimuth"));
+    CHECK_FALSE(scanner.character(';'));
+    CHECK(scanner.character('='));
+    float f = 0.f;
+    REQUIRE(scanner.number(f));
+    CHECK(f == 12.5f);
+    CHECK(scanner.character(';'));
+    int i = 0;
+    REQUIRE(scanner.number(i));
+    CHECK(i == 3);
+    CHECK(scanner.isEmpty());
+}
+
+TEST_CASE("Scanner/MatchesStrtof", "[textparser]") {
+    // The loaders have to produce the same meshes as before they used the Scanner
+    constexpr const char* Values[] = {
+        "0.1", "0.333333343", "1e-7", "-123456.789", "3.4028234e38", "0.000011920929",
+        "1.00000006", "2.5000000000000000001", "16777217"
+    };
+    for (const char* value : Values) {
+        float f = 0.f;
+        REQUIRE(Scanner(value).number(f));
+        const float expected = std::strtof(value, nullptr);
+        CHECK(std::memcmp(&f, &expected, sizeof(float)) == 0);
+    }
+}
+
+TEST_CASE("TextFile/Lines", "[textparser]") {
+    const std::filesystem::path path = tempFile("textfile.txt");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "first\r\n\nthird line\nlast";
+    }
+
+    {
+        TextFile file(path.string());
+        REQUIRE(file.isOpen());
+        CHECK(file.contents().size() == 23);
+
+        std::string_view line;
+        REQUIRE(file.nextLine(line));
+        CHECK(line == "first");
+        REQUIRE(file.nextLine(line));
+        CHECK(line.empty());
+        REQUIRE(file.nextLine(line));
+        CHECK(line == "third line");
+        REQUIRE(file.nextLine(line));
+        CHECK(line == "last");
+        CHECK(file.lineNumber() == 4);
+        CHECK_FALSE(file.nextLine(line));
+    }
+
+    std::filesystem::remove(path);
+    CHECK_FALSE(TextFile(path.string()).isOpen());
+}
@@ -0,0 +1,153 @@
+/*****************************************************************************************
+ * SGCT                                                                                  *
+ * Simple Graphics Cluster Toolkit                                                       *
+ *                                                                                       *
+ * Copyright (c) 2012-2022                                                               *
+ * For conditions of distribution and use, see copyright notice in LICENSE.md            *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <sgct/tracker.h>
+#include <sgct/trackingdevice.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+    // Replaces a VRPN tracker by a sensor that moves along a known trajectory with a
+    // constant linear velocity while rotating with a constant angular velocity around y
+    struct SyntheticTracker {
+        static constexpr float Velocity = 0.5f;
+        static constexpr float AngularVelocity = 1.f;
+
+        static sgct::vec3 position(double t) {
+            const float v = static_cast<float>(t) * Velocity;
+            return sgct::vec3{ v, 1.f + 2.f * v, -v };
+        }
+
+        static sgct::quat rotation(double t) {
+            const glm::quat q = glm::angleAxis(
+                static_cast<float>(t) * AngularVelocity,
+                glm::vec3(0.f, 1.f, 0.f)
+            );
+            sgct::quat res;
+            std::memcpy(&res, glm::value_ptr(q), sizeof(sgct::quat));
+            return res;
+        }
+
+        static glm::mat4 transform(double t) {
+            const sgct::vec3 p = position(t);
+            const sgct::quat r = rotation(t);
+            return glm::translate(glm::mat4(1.f), glm::make_vec3(&p.x)) *
+                glm::mat4_cast(glm::make_quat(&r.x));
+        }
+
+        static void sample(sgct::TrackingDevice& device, double t) {
+            device.setSensorTransform(position(t), rotation(t), t);
+        }
+    };
+
+    bool isOnTrajectory(const sgct::mat4& lhs, double t) {
+        const glm::mat4 rhs = SyntheticTracker::transform(t);
+        const float* r = glm::value_ptr(rhs);
+        for (int i = 0; i < 16; i++) {
+            if (lhs.values[i] != Approx(r[i]).margin(1e-3)) {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+TEST_CASE("TrackingDevice/Samples", "[tracking]") {
+    sgct::Tracker tracker("tracker");
+    tracker.setOffset(sgct::vec3{ 0.f, 0.f, 2.f });
+    tracker.addDevice("head");
+    sgct::TrackingDevice& device = *tracker.devices().front();
+
+    SyntheticTracker::sample(device, 1.0);
+    SyntheticTracker::sample(device, 1.01);
+
+    CHECK(device.trackerTimeStamp() == 1.01);
+    CHECK(device.trackerTimeStampPrevious() == 1.0);
+    CHECK(device.trackerDeltaTime() == Approx(0.01));
+
+    const sgct::vec3 p = device.sensorPosition();
+    CHECK(p.x == SyntheticTracker::position(1.01).x);
+    CHECK(p.y == SyntheticTracker::position(1.01).y);
+    CHECK(device.sensorPositionPrevious().x == SyntheticTracker::position(1.0).x);
+
+    const sgct::vec3 world = device.position();
+    CHECK(world.x == Approx(SyntheticTracker::position(1.01).x));
+    CHECK(world.z == Approx(SyntheticTracker::position(1.01).z + 2.f));
+}
+
+TEST_CASE("TrackingDevice/Prediction", "[tracking]") {
+    sgct::Tracker tracker("tracker");
+    tracker.addDevice("head");
+    sgct::TrackingDevice& device = *tracker.devices().front();
+    CHECK_FALSE(device.predictionLatency().has_value());
+
+    // With a single sample there is no velocity, so the pose can't be predicted
+    SyntheticTracker::sample(device, 2.0);
+    CHECK(isOnTrajectory(device.predictedWorldTransform(2.05), 2.0));
+
+    SyntheticTracker::sample(device, 2.01);
+    CHECK(isOnTrajectory(device.predictedWorldTransform(2.01), 2.01));
+    CHECK(isOnTrajectory(device.predictedWorldTransform(2.03), 2.03));
+    CHECK(isOnTrajectory(device.predictedWorldTransform(2.06), 2.06));
+
+    // Points in time before the newest sample are not interpolated
+    CHECK(isOnTrajectory(device.predictedWorldTransform(1.0), 2.01));
+
+    const double limit = 2.01 + sgct::TrackingDevice::MaxPrediction;
+    CHECK(isOnTrajectory(device.predictedWorldTransform(5.0), limit));
+
+    device.setPredictionLatency(0.02);
+    REQUIRE(device.predictionLatency().has_value());
+    CHECK(*device.predictionLatency() == 0.02);
+    device.setPredictionLatency(std::nullopt);
+    CHECK_FALSE(device.predictionLatency().has_value());
+}
+
+TEST_CASE("TrackingDevice/ConcurrentReads", "[tracking]") {
+    sgct::Tracker tracker("tracker");
+    tracker.addDevice("head");
+    sgct::TrackingDevice& device = *tracker.devices().front();
+
+    // The sensor is sampled continuously while it is read, which must never return a
+    // pose that is partially from one sample and partially from another
+    constexpr int NumberOfSamples = 200000;
+    std::atomic_bool isDone = false;
+    std::thread sampler([&device, &isDone]() {
+        for (int i = 1; i <= NumberOfSamples; i++) {
+            const float v = static_cast<float>(i);
+            device.setSensorTransform(
+                sgct::vec3{ v, 2.f * v, 3.f * v },
+                sgct::quat{ 0.f, 0.f, 0.f, 1.f },
+                static_cast<double>(i)
+            );
+        }
+        isDone = true;
+    });
+
+    int nTorn = 0;
+    while (!isDone) {
+        const sgct::vec3 p = device.sensorPosition();
+        const sgct::vec3 pp = device.sensorPositionPrevious();
+        if (p.y != 2.f * p.x || p.z != 3.f * p.x || pp.z != 3.f * pp.x) {
+            nTorn++;
+        }
+        if (device.trackerDeltaTime() != 1.0 && device.trackerTimeStamp() > 1.0) {
+            nTorn++;
+        }
+    }
+    sampler.join();
+
+    CHECK(nTorn == 0);
+    CHECK(device.trackerTimeStamp() == NumberOfSamples);
+}